@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include "esp_cpu.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 
@@ -11,10 +12,6 @@ static const char *TAG = "accel";
 #define MC3419_MOTION_INTERRUPT I2C_SWITCH_INT2
 #define MC3419_FIFO_INTERRUPT   I2C_SWITCH_INT0
 
-// Event group bits for accelerometer interrupts
-#define ACCEL_EVENT_MOTION (1 << 0)
-#define ACCEL_EVENT_FIFO   (1 << 1)
-
 // Device configuration
 i2c_manager_device_config_t accel_device = {
     .bus_index = I2C_BUS_OTHER,
@@ -27,101 +24,252 @@ i2c_manager_device_config_t accel_device = {
         },
 };
 
-// Event group for accelerometer interrupts
-static EventGroupHandle_t accel_event_group;
-static QueueHandle_t accel_event_queue;
-
-// Structure to send data via the queue
+// Sample stream configuration - the FIFO raises its watermark interrupt every ACCEL_FIFO_WATERMARK samples and the whole
+// batch is read in one burst, instead of one transfer per sample
+#define ACCEL_SAMPLE_RATE       RATE_100_HZ
+#define ACCEL_SAMPLE_PERIOD_US  10000
+#define ACCEL_FIFO_SIZE         32
+#define ACCEL_FIFO_WATERMARK    16 // ~6 reads a second at 100Hz, leaves 160ms of headroom before the FIFO fills
+#define ACCEL_FIFO_TIMEOUT_MS   ACCEL_SAMPLES_MS(ACCEL_FIFO_SIZE - 1) // How long to wait for the interrupt
+#define ACCEL_FIFO_POLL_MS      ACCEL_SAMPLES_MS(ACCEL_FIFO_SIZE - ACCEL_FIFO_WATERMARK)
+#define ACCEL_MAX_SUBSCRIBERS   4
+#define ACCEL_STREAM_TASK_STACK 3072
+
+// Time the MC3419 takes for a number of samples, counted 5% short as its oscillator can run a few percent fast. Waiting the
+// full nominal time lets the FIFO creep up a sample every few polls until it's full.
+#define ACCEL_SAMPLES_MS(samples) ((samples) * ACCEL_SAMPLE_PERIOD_US * 95 / 100 / 1000)
+
+// Gesture recognition and step counting run on the sample stream in their own task
+#define ACCEL_MOTION_TASK_STACK     3072
+#define ACCEL_MAX_GESTURE_CALLBACKS 4
+#define ACCEL_GESTURE_MAX_EVENTS    4
+
+// Published sample blocks, written by the stream task only
+static accel_ring_t stream_ring          = {0};
+static TaskHandle_t stream_task_handle   = NULL;
+static accel_stream_stats_t stream_stats = {0};
+static mc3419_range_res_t stream_range   = RANGE_2G;
+static accel_timeline_t stream_timeline  = {.period_us = ACCEL_SAMPLE_PERIOD_US};
+
+// Subscribers are notified with xTaskNotifyGive() when a block is published
 typedef struct {
-    mc3419_accel_data_t data;
-    uint32_t timestamp;
-} accel_event_t;
+    accel_reader_t *reader;
+    TaskHandle_t task;
+} accel_subscriber_t;
+static accel_subscriber_t subscribers[ACCEL_MAX_SUBSCRIBERS] = {0};
+static portMUX_TYPE subscribers_lock                         = portMUX_INITIALIZER_UNLOCKED;
+
+// Gesture engine and step counter, owned by the motion task. Their counters are copied out after each block.
+static accel_gesture_engine_t gesture_engine                             = {0};
+static accel_steps_t step_counter                                        = {0};
+static TaskHandle_t motion_task_handle                                   = NULL;
+static accel_gesture_cb_t gesture_callbacks[ACCEL_MAX_GESTURE_CALLBACKS] = {0};
+static accel_gesture_stats_t gesture_stats                               = {0};
+static accel_steps_stats_t step_stats                                    = {0};
+static portMUX_TYPE motion_stats_lock                                    = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Number of samples in the FIFO from the FIFO_RD_P and FIFO_WR_P registers
+ *     The pointers are 5 bits plus a wrap bit, so the difference modulo 64 is the fill level from 0 to 32.
+ */
+static uint32_t fifo_level(mc3419_fifo_rd_p_t rd_p, mc3419_fifo_wr_p_t wr_p) {
+    return (wr_p.raw - rd_p.raw) & 0x3F;
+}
+
+/**
+ * @brief Read the FIFO fill level
+ *
+ * @param[out] level Samples waiting in the FIFO
+ * @return esp_err_t
+ */
+static esp_err_t read_fifo_level(uint32_t *level) {
+    uint8_t reg         = MC3419_REG_FIFO_RD_P; // FIFO_RD_P and FIFO_WR_P are consecutive
+    uint8_t pointers[2] = {0};
+    stream_stats.transfers++;
+    ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, pointers, sizeof(pointers), 100), TAG,
+                        "Failed to read FIFO pointers");
+    *level = fifo_level((mc3419_fifo_rd_p_t){.raw = pointers[0]}, (mc3419_fifo_wr_p_t){.raw = pointers[1]});
+    return ESP_OK;
+}
+
+/**
+ * @brief Notify every subscriber that a block was published
+ */
+static void notify_subscribers() {
+    TaskHandle_t tasks[ACCEL_MAX_SUBSCRIBERS];
+    size_t count = 0;
+    portENTER_CRITICAL(&subscribers_lock);
+    for (size_t i = 0; i < ACCEL_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i].task != NULL) {
+            tasks[count++] = subscribers[i].task;
+        }
+    }
+    portEXIT_CRITICAL(&subscribers_lock);
+
+    for (size_t i = 0; i < count; i++) {
+        xTaskNotifyGive(tasks[i]);
+    }
+}
+
+/**
+ * @brief Burst read ACCEL_FIFO_WATERMARK samples from the FIFO and publish them
+ *
+ * @param newest_us Time the newest sample in the FIFO was taken
+ * @param behind Samples that will still be in the FIFO after this read
+ * @return esp_err_t
+ */
+static esp_err_t publish_fifo_block(int64_t newest_us, uint32_t behind) {
+    // Reading XOUT_EX_L pops samples from the FIFO, RD_CNT is set to the watermark so this is a single transfer
+    accel_block_t *block = accel_ring_claim(&stream_ring);
+    uint8_t reg          = MC3419_REG_XOUT_EX_L;
+    stream_stats.transfers++;
+    ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, (uint8_t *)block->samples,
+                                                     ACCEL_FIFO_WATERMARK * sizeof(mc3419_accel_data_t), 100),
+                        TAG, "Failed to read the FIFO");
+
+    // A full FIFO may have dropped samples, so don't assume this block follows on from the last one
+    bool lost = ACCEL_FIFO_WATERMARK + behind >= ACCEL_FIFO_SIZE;
+    if (lost) {
+        stream_stats.overflows++;
+    }
+
+    block->timestamp_us     = accel_timeline_place(&stream_timeline, newest_us, ACCEL_FIFO_WATERMARK, behind, lost);
+    block->sample_period_us = (stream_timeline.period_q8 + 128) >> 8;
+    block->range            = stream_range;
+    block->count            = ACCEL_FIFO_WATERMARK;
+    block->discontinuity    = lost || stream_stats.resyncs != stream_timeline.resyncs;
+    stream_stats.resyncs    = stream_timeline.resyncs;
+    accel_ring_commit(&stream_ring);
+
+    stream_stats.blocks++;
+    stream_stats.samples += ACCEL_FIFO_WATERMARK;
+    notify_subscribers();
+    return ESP_OK;
+}
+
+/**
+ * @brief Enable or disable the FIFO with its watermark interrupt and burst reads of ACCEL_FIFO_WATERMARK samples
+ *     The device has to be in standby.
+ *
+ * @param enable Whether to enable the FIFO
+ * @return esp_err_t
+ */
+static esp_err_t set_fifo_enabled(bool enable) {
+    mc3419_fifo_th_t th           = {.fifo_th = ACCEL_FIFO_WATERMARK};
+    mc3419_fifo_ctrl2_sr2_t ctrl2 = {.fifo_burst = enable};
+    mc3419_rd_cnt_t rd_cnt        = {.rd_cnt = ACCEL_FIFO_WATERMARK};
+    mc3419_fifo_ctrl_t reset      = {.fifo_reset = true};
+    mc3419_fifo_ctrl_t ctrl       = {.fifo_en = enable, .fifo_th_int_en = enable};
+    uint8_t writes[][2]           = {
+        {MC3419_REG_FIFO_CTRL, reset.raw},
+        {MC3419_REG_FIFO_TH, th.raw},
+        {MC3419_REG_FIFO_CTRL2_SR2, ctrl2.raw},
+        {MC3419_REG_RD_CNT, rd_cnt.raw},
+        {MC3419_REG_FIFO_CTRL, ctrl.raw},
+    };
+
+    // Write all the registers in one batch
+    i2c_manager_op_t ops[sizeof(writes) / sizeof(writes[0])];
+    for (size_t i = 0; i < sizeof(writes) / sizeof(writes[0]); i++) {
+        ops[i] = (i2c_manager_op_t){
+            .device  = &accel_device,
+            .type    = I2C_MANAGER_OP_TRANSMIT,
+            .tx_data = writes[i],
+            .tx_size = sizeof(writes[i]),
+        };
+    }
+    ESP_RETURN_ON_ERROR(i2c_manager_execute(ops, sizeof(ops) / sizeof(ops[0]), true, 100), TAG, "Failed to configure the FIFO");
+    return ESP_OK;
+}
 
-static void accel_event_task(void *arg) {
-    const static mc3419_interrupt_t interrupts[] = {MC3419_INT_TILT,  MC3419_INT_FLIP,    MC3419_INT_ANYM,
-                                                    MC3419_INT_SHAKE, MC3419_INT_TILT_35, MC3419_INT_ACQ};
-    ESP_LOGD(TAG, "Accelerometer event task started");
-    mc3419_intr_stat_t previous_intr_stat = {0};
+static void accel_stream_task(void *arg) {
+    ESP_LOGD(TAG, "Accelerometer stream task started");
 
+    bool polling = i2c_switch_int == NULL;
     while (true) {
-        // ESP_LOGD(TAG, "Waiting for accelerometer interrupt");
-        // EventBits_t bits =
-        //     xEventGroupWaitBits(i2c_switch_int, MC3419_FIFO_INTERRUPT | MC3419_MOTION_INTERRUPT, pdTRUE, pdFALSE,
-        //     portMAX_DELAY);
-
-        // Read the interrupt status register to determine which interrupt(s) occurred
-        mc3419_intr_stat_t intr_stat;
-        esp_err_t err = accel_get_interrupt_status(&intr_stat);
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to read interrupt status");
-            vTaskDelay(pdMS_TO_TICKS(100));
+        // MC3419 INTN2 raises the FIFO watermark interrupt. The switch interrupt is edge triggered and shared, so if another
+        // line holds it low the edge never comes. Poll often enough that the FIFO can't fill up until the interrupt is back.
+        EventBits_t bits = 0;
+        TickType_t wait  = pdMS_TO_TICKS(polling ? ACCEL_FIFO_POLL_MS : ACCEL_FIFO_TIMEOUT_MS);
+        if (i2c_switch_int != NULL) {
+            bits = xEventGroupWaitBits(i2c_switch_int, MC3419_FIFO_INTERRUPT, pdTRUE, pdFALSE, wait);
+        } else {
+            vTaskDelay(wait);
+        }
+        int64_t newest_us = esp_timer_get_time();
+        polling           = (bits & MC3419_FIFO_INTERRUPT) == 0;
+
+        if (!polling) {
+            // The interrupt fires as the FIFO reaches the watermark, so the level is known without asking
+            stream_stats.wakeups_interrupt++;
+            if (publish_fifo_block(newest_us, 0) != ESP_OK) {
+                stream_stats.errors++;
+            }
             continue;
         }
 
-        // // Reset the interrupt status since we've read it
-        // if (intr_stat.raw != 0) {
-        //     ESP_ERROR_CHECK(accel_reset_interrupt_status());
-        // }
-
-        // Check if there are any new interrupts
-        if (intr_stat.raw != previous_intr_stat.raw) {
-            // DEBUG: Log the interrupt status for each interrupt
-            char buffer[256] = {0};
-            size_t offset    = 0;
-            offset += snprintf(buffer + offset, sizeof(buffer) - offset, "\nMC3419 Interrupt Triggered: \n");
-            for (size_t i = 0; i < sizeof(interrupts) / sizeof(interrupts[0]); i++) {
-                switch (interrupts[i]) {
-                    case MC3419_INT_TILT:
-                        offset += snprintf(buffer + offset, sizeof(buffer) - offset, "  Tilt: %d\n", intr_stat.tilt_int);
-                        break;
-                    case MC3419_INT_FLIP:
-                        offset += snprintf(buffer + offset, sizeof(buffer) - offset, "  Flip: %d\n", intr_stat.flip_int);
-                        break;
-                    case MC3419_INT_ANYM:
-                        offset += snprintf(buffer + offset, sizeof(buffer) - offset, "  AnyMotion: %d\n", intr_stat.anym_int);
-                        break;
-                    case MC3419_INT_SHAKE:
-                        offset += snprintf(buffer + offset, sizeof(buffer) - offset, "  Shake: %d\n", intr_stat.shake_int);
-                        break;
-                    case MC3419_INT_TILT_35:
-                        offset += snprintf(buffer + offset, sizeof(buffer) - offset, "  Tilt 35: %d\n", intr_stat.tilt_35_int);
-                        break;
-                    case MC3419_INT_ACQ:
-                        offset += snprintf(buffer + offset, sizeof(buffer) - offset, "  Acquisition: %d\n", intr_stat.acq_int);
-                        break;
-                    default: break;
-                }
-            }
-            ESP_LOGD(TAG, "%s", buffer);
-
-            // if (bits & MC3419_FIFO_INTERRUPT) {
-            //     ESP_LOGD(TAG, "FIFO interrupt detected");
-            //     // Read the FIFO data
-            //     mc3419_accel_data_t data;
-            //     ESP_ERROR_CHECK(accel_read_data(&data));
-            //     // Send the data to the queue
-            //     accel_event_t event = {
-            //         .data      = data,
-            //         .timestamp = esp_timer_get_time(),
-            //     };
-            //     xQueueSend(accel_event_queue, &event, 0);
-            // }
-
-            // if (bits & MC3419_MOTION_INTERRUPT) {
-            if (intr_stat.raw & (MC3419_INT_TILT | MC3419_INT_FLIP | MC3419_INT_ANYM | MC3419_INT_SHAKE | MC3419_INT_TILT_35)) {
-                ESP_LOGD(TAG, "Motion interrupt detected");
-                // Read the status register to clear the interrupt
-                mc3419_status_t status;
-                ESP_ERROR_CHECK(accel_get_status(&status));
-                // Send the event to the event group
-                xEventGroupSetBits(accel_event_group, ACCEL_EVENT_MOTION);
+        // No interrupt, drain whatever has built up
+        stream_stats.wakeups_timeout++;
+        uint32_t level = 0;
+        if (read_fifo_level(&level) != ESP_OK) {
+            stream_stats.errors++;
+            continue;
+        }
+        while (level >= ACCEL_FIFO_WATERMARK) {
+            level -= ACCEL_FIFO_WATERMARK;
+            if (publish_fifo_block(newest_us, level) != ESP_OK) {
+                stream_stats.errors++;
+                break;
             }
-
-            // Update previous interrupt status
-            previous_intr_stat = intr_stat;
         }
+    }
+}
 
-        vTaskDelay(pdMS_TO_TICKS(100));
+static uint32_t motion_clock() {
+    return esp_cpu_get_cycle_count();
+}
+
+static void accel_motion_task(void *arg) {
+    ESP_LOGD(TAG, "Accelerometer motion task started");
+
+    accel_reader_t reader;
+    if (accel_stream_subscribe(&reader, xTaskGetCurrentTaskHandle()) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to subscribe to the sample stream, gestures and steps disabled");
+        motion_task_handle = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+
+    accel_block_t block;
+    accel_gesture_event_t events[ACCEL_GESTURE_MAX_EVENTS];
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t dropped = reader.dropped;
+        while (accel_stream_read(&reader, &block)) {
+            // Blocks this task fell behind on are a gap just like a FIFO overflow
+            block.discontinuity |= reader.dropped != dropped;
+            dropped              = reader.dropped;
+
+            size_t count = accel_gesture_process(&gesture_engine, &block, events, ACCEL_GESTURE_MAX_EVENTS);
+
+            uint32_t start = motion_clock();
+            accel_steps_process(&step_counter, &block);
+            step_counter.stats.cycles += motion_clock() - start;
+
+            portENTER_CRITICAL(&motion_stats_lock);
+            gesture_stats = gesture_engine.stats;
+            step_stats    = step_counter.stats;
+            portEXIT_CRITICAL(&motion_stats_lock);
+
+            for (size_t i = 0; i < count; i++) {
+                ESP_LOGD(TAG, "Gesture: %s", accel_gesture_name(events[i].gesture));
+                for (uint8_t j = 0; j < ACCEL_MAX_GESTURE_CALLBACKS; j++) {
+                    if (gesture_callbacks[j] != NULL) {
+                        gesture_callbacks[j](&events[i]);
+                    }
+                }
+            }
+        }
     }
 }
 
@@ -233,6 +381,13 @@ esp_err_t accel_init(void) {
     //     return ret;
     // }
 
+    // Set the sample rate the stream runs at
+    ret = accel_set_sample_rate(ACCEL_SAMPLE_RATE);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set sample rate");
+        return ret;
+    }
+
     // DEBUG: Get the current interrupt configuration
     mc3419_intr_ctrl_t intr_ctrl;
     ret = accel_get_interrupt_config(&intr_ctrl);
@@ -265,8 +420,10 @@ esp_err_t accel_init(void) {
     //                                  MC3419_INT_TILT_35 | MC3419_INT_ACQ, true);
     // ret = accel_set_interrupt_config(MC3419_INT_ANYM, true);
     // ret = accel_set_interrupt_config(MC3419_INT_TILT_35 | MC3419_INT_ACQ, true);
-    ret = accel_set_interrupt_config(/* MC3419_INT_ANYM | */ MC3419_INT_ACQ, true);
+    // ret = accel_set_interrupt_config(/* MC3419_INT_ANYM | */ MC3419_INT_ACQ, true);
     // ret = accel_set_interrupt_config(MC3419_INT_ANYM, true);
+    // No per-sample interrupt, the FIFO watermark interrupt wakes the stream task instead
+    ret = accel_set_interrupt_config(0, true);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set interrupts");
         return ret;
@@ -280,6 +437,13 @@ esp_err_t accel_init(void) {
     }
     LOG_B(TAG, "Interrupt Configuration: %b", intr_ctrl.raw);
 
+    // Enable the FIFO and its watermark interrupt
+    ret = set_fifo_enabled(true);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable the FIFO");
+        return ret;
+    }
+
     // Put the device into wake mode
     ret = accel_set_mode(MODE_WAKE);
     if (ret != ESP_OK) {
@@ -295,18 +459,22 @@ esp_err_t accel_init(void) {
     }
     LOG_B(TAG, "Current Mode: %b", mode.state);
 
-    // Create the event group
-    accel_event_group = xEventGroupCreate();
-    if (accel_event_group == NULL) {
-        ESP_LOGE(TAG, "Failed to create event group");
-        return ESP_FAIL;
+    // Start streaming samples
+    if (stream_task_handle == NULL &&
+        xTaskCreate(accel_stream_task, "accel_stream", ACCEL_STREAM_TASK_STACK, NULL, 5, &stream_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the accelerometer stream task");
+        return ESP_ERR_NO_MEM;
     }
 
-    // Create the event queue
-    accel_event_queue = xQueueCreate(10, sizeof(accel_event_t));
-
-    // Create the event task
-    // xTaskCreate(accel_event_task, "accel_event_task", 4096, NULL, 5, NULL);
+    // Recognize gestures and count steps on the stream
+    if (motion_task_handle == NULL) {
+        accel_gesture_init(&gesture_engine, ACCEL_SAMPLE_PERIOD_US, motion_clock);
+        accel_steps_init(&step_counter, ACCEL_SAMPLE_PERIOD_US);
+        if (xTaskCreate(accel_motion_task, "accel_motion", ACCEL_MOTION_TASK_STACK, NULL, 4, &motion_task_handle) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create the accelerometer motion task");
+            return ESP_ERR_NO_MEM;
+        }
+    }
 
     return ESP_OK;
 }
@@ -315,7 +483,7 @@ esp_err_t accel_reset() {
     // Put the device in standby mode
     ESP_RETURN_ON_ERROR(accel_set_mode(MODE_STANDBY), TAG, "Failed to set device to standby mode");
     // Reset the device
-    mc3419_register_t reg = 0x1C;
+    uint8_t reg = 0x1C;
     uint8_t data[2]       = {reg, 0x80};
     ESP_RETURN_ON_ERROR(i2c_manager_transmit(&accel_device, data, sizeof(data), 100), TAG, "Failed to reset device");
     vTaskDelay(pdMS_TO_TICKS(50)); // Wait for the device to reset
@@ -343,14 +511,14 @@ esp_err_t accel_reset() {
 }
 
 esp_err_t accel_get_device_id(mc3419_chip_id_t *id) {
-    mc3419_register_t reg = MC3419_REG_CHIP_ID;
+    uint8_t reg = MC3419_REG_CHIP_ID;
     // ESP_RETURN_ON_ERROR(mc3419_read_register(0x18, id, 1), TAG, "Failed to read device ID");
-    ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, id, 1, 100), TAG, "Failed to read device ID");
+    ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &id->raw, 1, 100), TAG, "Failed to read device ID");
     return ESP_OK;
 }
 
 esp_err_t accel_set_mode(mc3419_mode_state_t state) {
-    mc3419_register_t reg = MC3419_REG_MODE;
+    uint8_t reg = MC3419_REG_MODE;
     mc3419_mode_t mode    = {0};
     // Get the current mode
     ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &mode.raw, 1, 100), TAG,
@@ -372,7 +540,7 @@ esp_err_t accel_set_mode(mc3419_mode_state_t state) {
 }
 
 esp_err_t accel_get_mode(mc3419_mode_t *mode) {
-    mc3419_register_t reg = MC3419_REG_MODE;
+    uint8_t reg = MC3419_REG_MODE;
     // Read the mode state register
     ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &mode->raw, 1, 100), TAG,
                         "Failed to read mode state");
@@ -380,7 +548,7 @@ esp_err_t accel_get_mode(mc3419_mode_t *mode) {
 }
 
 esp_err_t accel_set_interrupt_config(uint8_t intr_en, bool autoclear) {
-    mc3419_register_t reg        = MC3419_REG_INTR_CTRL;
+    uint8_t reg                  = MC3419_REG_INTR_CTRL;
     mc3419_intr_ctrl_t intr_ctrl = {0}; // POR is 0x00... we'll apply the bitmask values
     // Get the current interrupt enable register so we can preserve the auto-clear bit
     ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &intr_ctrl.raw, 1, 100), TAG,
@@ -406,7 +574,7 @@ esp_err_t accel_set_interrupt_config(uint8_t intr_en, bool autoclear) {
 }
 
 esp_err_t accel_get_interrupt_config(mc3419_intr_ctrl_t *intr_ctrl) {
-    mc3419_register_t reg = MC3419_REG_INTR_CTRL;
+    uint8_t reg = MC3419_REG_INTR_CTRL;
     // Read the interrupt enable register
     ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &intr_ctrl->raw, 1, 100), TAG,
                         "Failed to read interrupt enable");
@@ -414,7 +582,7 @@ esp_err_t accel_get_interrupt_config(mc3419_intr_ctrl_t *intr_ctrl) {
 }
 
 esp_err_t accel_set_sample_rate(mc3419_rate_t rate) {
-    mc3419_register_t reg = MC3419_REG_SR;
+    uint8_t reg = MC3419_REG_SR;
     mc3419_sr_t sr        = {0};
     // Get the current sample rate
     ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &sr.raw, 1, 100), TAG, "Failed to read sample rate");
@@ -427,7 +595,7 @@ esp_err_t accel_set_sample_rate(mc3419_rate_t rate) {
 }
 
 esp_err_t accel_get_sample_rate(mc3419_sr_t *sr) {
-    mc3419_register_t reg = MC3419_REG_SR;
+    uint8_t reg = MC3419_REG_SR;
     // Read the sample rate register
     ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &sr->raw, 1, 100), TAG,
                         "Failed to read sample rate");
@@ -435,7 +603,7 @@ esp_err_t accel_get_sample_rate(mc3419_sr_t *sr) {
 }
 
 esp_err_t accel_enable_features(uint8_t feature_en) {
-    mc3419_register_t reg            = MC3419_REG_MOTION_CTRL;
+    uint8_t reg                      = MC3419_REG_MOTION_CTRL;
     mc3419_motion_ctrl_t motion_ctrl = {0};
     // Get the current feature enable register
     ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &motion_ctrl.raw, 1, 100), TAG,
@@ -458,7 +626,7 @@ esp_err_t accel_enable_features(uint8_t feature_en) {
 }
 
 esp_err_t accel_set_range(mc3419_range_res_t res) {
-    mc3419_register_t reg = MC3419_REG_RANGE;
+    uint8_t reg = MC3419_REG_RANGE;
     mc3419_range_t range  = {0};
     // Get the current range
     ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &range.raw, 1, 100), TAG, "Failed to read range");
@@ -467,41 +635,52 @@ esp_err_t accel_set_range(mc3419_range_res_t res) {
     // Write the new range
     uint8_t data[2] = {reg, range.raw};
     ESP_RETURN_ON_ERROR(i2c_manager_transmit(&accel_device, data, sizeof(data), 100), TAG, "Failed to set range");
+    stream_range = res;
     return ESP_OK;
 }
 
 esp_err_t accel_get_range(mc3419_range_t *range) {
-    mc3419_register_t reg = MC3419_REG_RANGE;
+    uint8_t reg = MC3419_REG_RANGE;
     // Read the range register
     ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &range->raw, 1, 100), TAG, "Failed to read range");
     return ESP_OK;
 }
 
 esp_err_t accel_read_data(mc3419_accel_data_t *data) {
-    mc3419_register_t reg = MC3419_REG_XOUT_EX_L; // Start reading from XOUT_EX_L for X, Y, Z data (6 bytes)
+    // With the FIFO enabled reading the output registers pops samples from under the stream, use the newest one instead
+    if (stream_task_handle != NULL) {
+        accel_block_t block;
+        if (!accel_ring_latest(&stream_ring, &block)) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        *data = block.samples[block.count - 1];
+        return ESP_OK;
+    }
+
+    uint8_t reg = MC3419_REG_XOUT_EX_L; // Start reading from XOUT_EX_L for X, Y, Z data (6 bytes)
     // Read the raw data
-    ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, data, sizeof(*data), 100), TAG,
+    ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, (uint8_t *)data, sizeof(*data), 100), TAG,
                         "Failed to read data");
     return ESP_OK;
 }
 
 esp_err_t accel_get_status(mc3419_status_t *status) {
-    mc3419_register_t reg = MC3419_REG_STATUS;
+    uint8_t reg = MC3419_REG_STATUS;
     // Read the status register
-    ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, status, 1, 100), TAG, "Failed to read status");
+    ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &status->raw, 1, 100), TAG, "Failed to read status");
     return ESP_OK;
 }
 
 esp_err_t accel_get_interrupt_status(mc3419_intr_stat_t *status) {
-    mc3419_register_t reg = MC3419_REG_INTR_STAT;
+    uint8_t reg = MC3419_REG_INTR_STAT;
     // Read the interrupt status register
-    ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, status, 1, 100), TAG,
+    ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &status->raw, 1, 100), TAG,
                         "Failed to read interrupt status");
     return ESP_OK;
 }
 
 // esp_err_t accel_reset_interrupt_status() {
-//     mc3419_register_t reg = MC3419_REG_INTR_STAT;
+//     uint8_t reg = MC3419_REG_INTR_STAT;
 //     mc3419_intr_stat_t status;
 //     ESP_LOGD(TAG, "Resetting interrupt status");
 //     // Read the interrupt status register to get the current status
@@ -515,7 +694,7 @@ esp_err_t accel_get_interrupt_status(mc3419_intr_stat_t *status) {
 // }
 
 esp_err_t accel_reset_interrupt_status() {
-    mc3419_register_t reg = MC3419_REG_INTR_STAT;
+    uint8_t reg = MC3419_REG_INTR_STAT;
     uint8_t clear         = 0xFF; // Write 0xFF to clear all interrupt statuses
     ESP_LOGD(TAG, "Resetting interrupt status");
     uint8_t data[2] = {reg, clear};
@@ -524,7 +703,7 @@ esp_err_t accel_reset_interrupt_status() {
 }
 
 esp_err_t accel_set_gpio_polarity(bool int1_active_high, bool int2_active_high) {
-    mc3419_register_t reg = MC3419_REG_GPIO_CTRL;
+    uint8_t reg = MC3419_REG_GPIO_CTRL;
     mc3419_gpio_ctrl_t gpio_ctrl;
     // Get the current GPIO control register
     ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &gpio_ctrl.raw, 1, 100), TAG,
@@ -539,7 +718,7 @@ esp_err_t accel_set_gpio_polarity(bool int1_active_high, bool int2_active_high)
 }
 
 esp_err_t accel_set_gpio_drive_mode(bool int1_push_pull, bool int2_push_pull) {
-    mc3419_register_t reg = MC3419_REG_GPIO_CTRL;
+    uint8_t reg = MC3419_REG_GPIO_CTRL;
     mc3419_gpio_ctrl_t gpio_ctrl;
     // Get the current GPIO control register
     ESP_RETURN_ON_ERROR(i2c_manager_transmit_receive(&accel_device, &reg, 1, &gpio_ctrl.raw, 1, 100), TAG,
@@ -552,3 +731,82 @@ esp_err_t accel_set_gpio_drive_mode(bool int1_push_pull, bool int2_push_pull) {
     ESP_RETURN_ON_ERROR(i2c_manager_transmit(&accel_device, data, sizeof(data), 100), TAG, "Failed to set GPIO control");
     return ESP_OK;
 }
+
+esp_err_t accel_stream_subscribe(accel_reader_t *reader, TaskHandle_t task) {
+    if (reader == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    accel_ring_reader_init(&stream_ring, reader);
+
+    esp_err_t err = ESP_ERR_NO_MEM;
+    portENTER_CRITICAL(&subscribers_lock);
+    for (size_t i = 0; i < ACCEL_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i].reader == NULL) {
+            subscribers[i] = (accel_subscriber_t){.reader = reader, .task = task};
+            err            = ESP_OK;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&subscribers_lock);
+    return err;
+}
+
+void accel_stream_unsubscribe(accel_reader_t *reader) {
+    portENTER_CRITICAL(&subscribers_lock);
+    for (size_t i = 0; i < ACCEL_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i].reader == reader) {
+            subscribers[i] = (accel_subscriber_t){0};
+        }
+    }
+    portEXIT_CRITICAL(&subscribers_lock);
+}
+
+bool accel_stream_read(accel_reader_t *reader, accel_block_t *block) {
+    return accel_ring_read(&stream_ring, reader, block);
+}
+
+void accel_stream_get_stats(accel_stream_stats_t *stats) {
+    if (stats != NULL) {
+        *stats = stream_stats;
+    }
+}
+
+esp_err_t accel_add_gesture_callback(accel_gesture_cb_t callback) {
+    for (uint8_t i = 0; i < ACCEL_MAX_GESTURE_CALLBACKS; i++) {
+        if (gesture_callbacks[i] == NULL) {
+            gesture_callbacks[i] = callback;
+            return ESP_OK;
+        }
+    }
+    ESP_LOGW(TAG, "No space for additional gesture callbacks");
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t accel_remove_gesture_callback(accel_gesture_cb_t callback) {
+    for (uint8_t i = 0; i < ACCEL_MAX_GESTURE_CALLBACKS; i++) {
+        if (gesture_callbacks[i] == callback) {
+            gesture_callbacks[i] = NULL;
+            return ESP_OK;
+        }
+    }
+    ESP_LOGW(TAG, "Gesture callback not found");
+    return ESP_ERR_NOT_FOUND;
+}
+
+void accel_gesture_get_stats(accel_gesture_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&motion_stats_lock);
+    *stats = gesture_stats;
+    portEXIT_CRITICAL(&motion_stats_lock);
+}
+
+void accel_steps_get_stats(accel_steps_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&motion_stats_lock);
+    *stats = step_stats;
+    portEXIT_CRITICAL(&motion_stats_lock);
+}
@@ -0,0 +1,344 @@
+#include <string.h>
+
+#include "accel_gesture.h"
+
+// Gravity low pass, each sample moves it 1/2^GRAVITY_SHIFT of the way - about a 160ms time constant at 100Hz
+#define GRAVITY_SHIFT 4
+
+// Sample to sample change summed over the axes, below this the badge counts as still
+#define QUIET_JERK_MG 120
+
+// Wrist raise - the screen is upright (arm hanging, or held sideways) and within RAISE_WINDOW_MS it faces up and holds
+// still for RAISE_HOLD_MS
+#define RAISE_UPRIGHT_MG 500
+#define RAISE_FACE_MG    650
+#define RAISE_WINDOW_MS  1500
+#define RAISE_HOLD_MS    150
+
+// Shake - SHAKE_SWINGS reversals on one axis, each one half a shake period apart
+#define SHAKE_MG         700
+#define SHAKE_SWINGS     4
+#define SHAKE_GAP_MIN_MS 40  // Anything faster is a tap ringing out
+#define SHAKE_GAP_MAX_MS 220 // Slower than about 2.3Hz is an arm swinging while walking
+
+// Double tap - two jerk spikes that rise out of stillness and settle within TAP_LENGTH_MS
+#define TAP_JERK_MG        900
+#define TAP_QUIET_MS       50
+#define TAP_LENGTH_MS      60
+#define TAP_SETTLE_SAMPLES 2
+#define TAP_GAP_MIN_MS     120
+#define TAP_GAP_MAX_MS     500
+
+// Flip - face down past FLIP_MG for FLIP_HOLD_MS, and back above FLIP_RELEASE_MG before it can trigger again
+#define FLIP_MG         800
+#define FLIP_RELEASE_MG 400
+#define FLIP_HOLD_MS    400
+
+// Wrist raise, shake and double tap aren't reported again for this long
+#define GESTURE_COOLDOWN_MS 1000
+
+// Full scale in mg for each mc3419_range_res_t
+static const int32_t range_mg[] = {2000, 4000, 8000, 16000, 12000};
+
+// One block after the shared front end, indexed by sample
+typedef struct {
+    uint32_t count;
+    uint32_t base;                               // engine->n of samples[0]
+    int16_t gravity[ACCEL_BLOCK_MAX_SAMPLES][3]; // Low passed acceleration
+    int16_t dynamic[ACCEL_BLOCK_MAX_SAMPLES][3]; // Acceleration with gravity removed
+    uint16_t jerk[ACCEL_BLOCK_MAX_SAMPLES];      // Change from the previous sample
+    uint16_t quiet[ACCEL_BLOCK_MAX_SAMPLES + 1]; // Quiet run length before each sample, and after the last
+} gesture_frame_t;
+
+typedef struct {
+    accel_gesture_event_t *events;
+    size_t max;
+    size_t count;
+    int64_t timestamp_us;
+    uint32_t period_us;
+} gesture_output_t;
+
+static uint16_t ms_to_samples(uint32_t ms, uint32_t sample_period_us) {
+    return (ms * 1000 + sample_period_us - 1) / sample_period_us;
+}
+
+static bool cooling_down(const accel_gesture_engine_t *engine, accel_gesture_t gesture, uint32_t n) {
+    return (int32_t)(n - engine->quiet_until[gesture]) < 0;
+}
+
+static void emit(accel_gesture_engine_t *engine, gesture_output_t *out, accel_gesture_t gesture, uint32_t n,
+                 uint32_t index) {
+    engine->stats.detections[gesture]++;
+    if (gesture != ACCEL_GESTURE_FLIP) {
+        engine->quiet_until[gesture] = n + engine->cooldown;
+    }
+    if (out->count < out->max) {
+        out->events[out->count++] = (accel_gesture_event_t){
+            .gesture      = gesture,
+            .timestamp_us = out->timestamp_us + (int64_t)index * out->period_us,
+        };
+    }
+}
+
+static void reset_detectors(accel_gesture_engine_t *engine) {
+    engine->primed            = false;
+    engine->quiet_run         = 0;
+    engine->raise_vertical_at = engine->n - engine->raise_window - 1;
+    engine->raise_steady      = 0;
+    engine->shake_sign        = 0;
+    engine->shake_swings      = 0;
+    engine->taps              = 0;
+    engine->tap_active        = false;
+    engine->flip_count        = 0;
+}
+
+/**
+ * @brief Scale a block to mg and split it into gravity, motion and jerk for the detectors
+ */
+static void front_end(accel_gesture_engine_t *engine, const accel_block_t *block, gesture_frame_t *frame) {
+    int32_t full_scale = block->range < sizeof(range_mg) / sizeof(range_mg[0]) ? range_mg[block->range] : range_mg[0];
+    frame->count       = block->count;
+    frame->base        = engine->n;
+    frame->quiet[0]    = engine->quiet_run;
+
+    for (uint32_t i = 0; i < block->count; i++) {
+        const mc3419_accel_data_t *sample = &block->samples[i];
+        int16_t a[3]                      = {
+            (int16_t)((sample->x.value * full_scale) >> 15),
+            (int16_t)((sample->y.value * full_scale) >> 15),
+            (int16_t)((sample->z.value * full_scale) >> 15),
+        };
+        if (!engine->primed) {
+            for (int axis = 0; axis < 3; axis++) {
+                engine->gravity[axis] = (int32_t)a[axis] << GRAVITY_SHIFT;
+                engine->last[axis]    = a[axis];
+            }
+            engine->primed = true;
+        }
+
+        uint32_t jerk = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            int32_t delta      = a[axis] - engine->last[axis];
+            jerk              += delta < 0 ? -delta : delta;
+            engine->last[axis] = a[axis];
+
+            engine->gravity[axis]  += a[axis] - (engine->gravity[axis] >> GRAVITY_SHIFT);
+            frame->gravity[i][axis] = engine->gravity[axis] >> GRAVITY_SHIFT;
+            frame->dynamic[i][axis] = a[axis] - frame->gravity[i][axis];
+        }
+        frame->jerk[i] = jerk > UINT16_MAX ? UINT16_MAX : jerk;
+
+        if (jerk < QUIET_JERK_MG) {
+            engine->quiet_run += engine->quiet_run < UINT16_MAX;
+        } else {
+            engine->quiet_run = 0;
+        }
+        frame->quiet[i + 1] = engine->quiet_run;
+    }
+}
+
+static void detect_wrist_raise(accel_gesture_engine_t *engine, const gesture_frame_t *frame, gesture_output_t *out) {
+    for (uint32_t i = 0; i < frame->count; i++) {
+        uint32_t n = frame->base + i;
+        int32_t z  = frame->gravity[i][2] * ACCEL_GESTURE_SCREEN_UP_Z;
+
+        if (z < RAISE_UPRIGHT_MG && z > -RAISE_UPRIGHT_MG) {
+            engine->raise_vertical_at = n;
+            engine->raise_steady      = 0;
+            engine->raised            = false;
+            continue;
+        }
+        if (z < RAISE_FACE_MG || frame->quiet[i + 1] == 0) {
+            engine->raise_steady = 0;
+            continue;
+        }
+
+        // Only a screen that came up from upright counts, lying on a table face up doesn't
+        if (++engine->raise_steady >= engine->raise_hold && !engine->raised &&
+            n - engine->raise_vertical_at <= engine->raise_window) {
+            engine->raised = true;
+            if (!cooling_down(engine, ACCEL_GESTURE_WRIST_RAISE, n)) {
+                emit(engine, out, ACCEL_GESTURE_WRIST_RAISE, n, i);
+            }
+        }
+    }
+}
+
+static void detect_shake(accel_gesture_engine_t *engine, const gesture_frame_t *frame, gesture_output_t *out) {
+    for (uint32_t i = 0; i < frame->count; i++) {
+        // Follow whichever axis moves most
+        uint8_t axis  = 0;
+        int32_t value = frame->dynamic[i][0];
+        int32_t peak  = value < 0 ? -value : value;
+        for (uint8_t a = 1; a < 3; a++) {
+            int32_t v = frame->dynamic[i][a];
+            int32_t m = v < 0 ? -v : v;
+            if (m > peak) {
+                axis  = a;
+                value = v;
+                peak  = m;
+            }
+        }
+        if (peak < SHAKE_MG) {
+            continue;
+        }
+
+        uint32_t n   = frame->base + i;
+        int8_t sign  = value < 0 ? -1 : 1;
+        uint32_t gap = n - engine->shake_last;
+        if (sign == engine->shake_sign && axis == engine->shake_axis) {
+            continue;
+        }
+        if (axis == engine->shake_axis && engine->shake_swings > 0 && gap < engine->shake_gap_min) {
+            continue;
+        }
+
+        if (axis != engine->shake_axis || gap > engine->shake_gap_max) {
+            engine->shake_swings = 1;
+        } else {
+            engine->shake_swings++;
+        }
+        engine->shake_axis = axis;
+        engine->shake_sign = sign;
+        engine->shake_last = n;
+
+        if (engine->shake_swings >= SHAKE_SWINGS) {
+            engine->shake_swings = 0;
+            engine->shake_sign   = 0;
+            if (!cooling_down(engine, ACCEL_GESTURE_SHAKE, n)) {
+                emit(engine, out, ACCEL_GESTURE_SHAKE, n, i);
+            }
+        }
+    }
+}
+
+static void detect_double_tap(accel_gesture_engine_t *engine, const gesture_frame_t *frame, gesture_output_t *out) {
+    for (uint32_t i = 0; i < frame->count; i++) {
+        uint32_t n = frame->base + i;
+
+        if (!engine->tap_active) {
+            // A tap is a sharp spike out of stillness, anything else is the badge being moved around
+            if (frame->jerk[i] >= TAP_JERK_MG && frame->quiet[i] >= engine->tap_quiet) {
+                engine->tap_active = true;
+                engine->tap_start  = n;
+            }
+        } else if (frame->quiet[i + 1] >= TAP_SETTLE_SAMPLES) {
+            engine->tap_active = false;
+            uint32_t gap       = engine->tap_start - engine->tap_first;
+            if (engine->taps == 1 && gap >= engine->tap_gap_min && gap <= engine->tap_gap_max) {
+                engine->taps = 0;
+                if (!cooling_down(engine, ACCEL_GESTURE_DOUBLE_TAP, n)) {
+                    emit(engine, out, ACCEL_GESTURE_DOUBLE_TAP, n, i);
+                }
+            } else {
+                engine->taps      = 1;
+                engine->tap_first = engine->tap_start;
+            }
+        } else if (n - engine->tap_start > engine->tap_length) {
+            // Too long to be a knock
+            engine->tap_active = false;
+            engine->taps       = 0;
+        }
+
+        if (engine->taps == 1 && !engine->tap_active && n - engine->tap_first > engine->tap_gap_max) {
+            engine->taps = 0;
+        }
+    }
+}
+
+static void detect_flip(accel_gesture_engine_t *engine, const gesture_frame_t *frame, gesture_output_t *out) {
+    for (uint32_t i = 0; i < frame->count; i++) {
+        int32_t z = frame->gravity[i][2] * ACCEL_GESTURE_SCREEN_UP_Z;
+
+        if (engine->face_down) {
+            if (z > -FLIP_RELEASE_MG) {
+                engine->face_down  = false;
+                engine->flip_count = 0;
+            }
+        } else if (z > -FLIP_MG) {
+            engine->flip_count = 0;
+        } else if (++engine->flip_count >= engine->flip_hold) {
+            engine->face_down = true;
+            emit(engine, out, ACCEL_GESTURE_FLIP, frame->base + i, i);
+        }
+    }
+}
+
+typedef void (*gesture_detector_t)(accel_gesture_engine_t *engine, const gesture_frame_t *frame, gesture_output_t *out);
+
+static const gesture_detector_t detectors[ACCEL_GESTURE_COUNT] = {
+    [ACCEL_GESTURE_WRIST_RAISE] = detect_wrist_raise,
+    [ACCEL_GESTURE_SHAKE]       = detect_shake,
+    [ACCEL_GESTURE_DOUBLE_TAP]  = detect_double_tap,
+    [ACCEL_GESTURE_FLIP]        = detect_flip,
+};
+
+static uint32_t lap(const accel_gesture_engine_t *engine, uint32_t *mark) {
+    if (engine->clock == NULL) {
+        return 0;
+    }
+    uint32_t now     = engine->clock();
+    uint32_t elapsed = now - *mark;
+    *mark            = now;
+    return elapsed;
+}
+
+void accel_gesture_init(accel_gesture_engine_t *engine, uint32_t sample_period_us, accel_gesture_clock_t clock) {
+    memset(engine, 0, sizeof(*engine));
+    engine->clock         = clock;
+    engine->raise_window  = ms_to_samples(RAISE_WINDOW_MS, sample_period_us);
+    engine->raise_hold    = ms_to_samples(RAISE_HOLD_MS, sample_period_us);
+    engine->shake_gap_min = ms_to_samples(SHAKE_GAP_MIN_MS, sample_period_us);
+    engine->shake_gap_max = ms_to_samples(SHAKE_GAP_MAX_MS, sample_period_us);
+    engine->tap_quiet     = ms_to_samples(TAP_QUIET_MS, sample_period_us);
+    engine->tap_length    = ms_to_samples(TAP_LENGTH_MS, sample_period_us);
+    engine->tap_gap_min   = ms_to_samples(TAP_GAP_MIN_MS, sample_period_us);
+    engine->tap_gap_max   = ms_to_samples(TAP_GAP_MAX_MS, sample_period_us);
+    engine->flip_hold     = ms_to_samples(FLIP_HOLD_MS, sample_period_us);
+    engine->cooldown      = ms_to_samples(GESTURE_COOLDOWN_MS, sample_period_us);
+    reset_detectors(engine);
+}
+
+size_t accel_gesture_process(accel_gesture_engine_t *engine, const accel_block_t *block, accel_gesture_event_t *events,
+                             size_t max_events) {
+    gesture_output_t out = {
+        .events       = events,
+        .max          = max_events,
+        .timestamp_us = block->timestamp_us,
+        .period_us    = block->sample_period_us,
+    };
+    if (block->count == 0 || block->count > ACCEL_BLOCK_MAX_SAMPLES) {
+        return 0;
+    }
+
+    // Samples went missing, don't stitch motion across the gap
+    if (block->discontinuity && engine->primed) {
+        reset_detectors(engine);
+        engine->stats.resets++;
+    }
+
+    uint32_t mark = engine->clock != NULL ? engine->clock() : 0;
+    gesture_frame_t frame;
+    front_end(engine, block, &frame);
+    engine->stats.front_end_cycles += lap(engine, &mark);
+
+    for (int gesture = 0; gesture < ACCEL_GESTURE_COUNT; gesture++) {
+        detectors[gesture](engine, &frame, &out);
+        engine->stats.detector_cycles[gesture] += lap(engine, &mark);
+    }
+
+    engine->n += block->count;
+    engine->stats.blocks++;
+    engine->stats.samples += block->count;
+    return out.count;
+}
+
+const char *accel_gesture_name(accel_gesture_t gesture) {
+    switch (gesture) {
+        case ACCEL_GESTURE_WRIST_RAISE: return "wrist raise";
+        case ACCEL_GESTURE_SHAKE: return "shake";
+        case ACCEL_GESTURE_DOUBLE_TAP: return "double tap";
+        case ACCEL_GESTURE_FLIP: return "flip";
+        default: return "unknown";
+    }
+}
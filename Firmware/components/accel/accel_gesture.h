@@ -0,0 +1,123 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "accel_stream.h"
+
+// Like the sample stream this has no ESP-IDF dependencies, so recorded traces can be run through it on the host
+
+// Sign of the Z axis when the screen faces up
+#define ACCEL_GESTURE_SCREEN_UP_Z 1
+
+typedef enum {
+    ACCEL_GESTURE_WRIST_RAISE, // Screen turned up towards the face from hanging or vertical, then held still
+    ACCEL_GESTURE_SHAKE,       // Several quick back and forth swings along one axis
+    ACCEL_GESTURE_DOUBLE_TAP,  // Two sharp knocks on the badge in quick succession
+    ACCEL_GESTURE_FLIP,        // Turned face down and left there
+    ACCEL_GESTURE_COUNT,
+} accel_gesture_t;
+
+typedef struct {
+    accel_gesture_t gesture;
+    int64_t timestamp_us; // Time of the sample that completed the gesture
+} accel_gesture_event_t;
+
+// Cycle counter used to measure detector cost, e.g. esp_cpu_get_cycle_count() - any free running counter works
+typedef uint32_t (*accel_gesture_clock_t)(void);
+
+typedef struct {
+    uint32_t blocks;                               // Blocks processed
+    uint32_t samples;                              // Samples processed
+    uint32_t resets;                               // Times the detectors restarted after a stream discontinuity
+    uint32_t detections[ACCEL_GESTURE_COUNT];      // Gestures reported
+    uint64_t front_end_cycles;                     // Clock ticks spent scaling and filtering shared by all detectors
+    uint64_t detector_cycles[ACCEL_GESTURE_COUNT]; // Clock ticks spent in each detector
+} accel_gesture_stats_t;
+
+// Detector state, all acceleration values are in mg. Time is counted in samples so the per-sample work stays in 32 bits.
+typedef struct {
+    accel_gesture_clock_t clock;
+    uint32_t n; // Samples processed since the last reset
+
+    // Windows converted from ms to samples by accel_gesture_init()
+    uint16_t raise_window;
+    uint16_t raise_hold;
+    uint16_t shake_gap_min;
+    uint16_t shake_gap_max;
+    uint16_t tap_quiet;
+    uint16_t tap_length;
+    uint16_t tap_gap_min;
+    uint16_t tap_gap_max;
+    uint16_t flip_hold;
+    uint16_t cooldown;
+
+    // Shared front end
+    bool primed;        // gravity and last hold real samples
+    int32_t gravity[3]; // Low passed acceleration, in fixed point
+    int16_t last[3];    // Previous sample
+    uint32_t quiet_run; // Consecutive samples with little jerk
+
+    // Wrist raise
+    uint32_t raise_vertical_at; // Last sample the screen was upright
+    uint16_t raise_steady;      // Consecutive still, face up samples
+    bool raised;                // Reported, waiting for the screen to go upright again
+
+    // Shake
+    int8_t shake_sign;
+    uint8_t shake_axis;
+    uint8_t shake_swings;
+    uint32_t shake_last;
+
+    // Double tap
+    uint8_t taps;       // Taps in the current sequence
+    bool tap_active;    // Inside a jerk spike that may turn out to be a tap
+    uint32_t tap_start; // First sample of the current spike
+    uint32_t tap_first; // First sample of the first tap in the sequence
+
+    // Flip
+    uint16_t flip_count; // Consecutive face down samples
+    bool face_down;
+
+    uint32_t quiet_until[ACCEL_GESTURE_COUNT]; // Gestures aren't reported again before these samples
+
+    accel_gesture_stats_t stats;
+} accel_gesture_engine_t;
+
+/**
+ * @brief Initialize the gesture engine
+ *
+ * @param engine Engine state to initialize
+ * @param sample_period_us Nominal sample period, the detector windows are converted to samples with it
+ * @param clock Cycle counter for the cost statistics, or NULL to skip measuring
+ */
+void accel_gesture_init(accel_gesture_engine_t *engine, uint32_t sample_period_us, accel_gesture_clock_t clock);
+
+/**
+ * @brief Run a block of samples through the detectors
+ *
+ * @param engine Engine state
+ * @param block Samples in stream order, a discontinuity restarts the detectors
+ * @param[out] events Gestures completed within the block
+ * @param max_events Size of events
+ * @return Number of events written
+ */
+size_t accel_gesture_process(accel_gesture_engine_t *engine, const accel_block_t *block, accel_gesture_event_t *events,
+                             size_t max_events);
+
+/**
+ * @brief Get the name of a gesture for logging
+ *
+ * @param gesture Gesture to name
+ * @return Static string
+ */
+const char *accel_gesture_name(accel_gesture_t gesture);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,139 @@
+#include <string.h>
+
+#include "accel_steps.h"
+
+// Squared magnitude in mg² is scaled down by this much so three axes at 16g still fit comfortably in 32 bits
+#define MAGNITUDE_SHIFT 10
+
+// Baseline low pass, about a 640ms time constant at 100Hz - slow enough to pass the 1-3Hz of walking
+#define BASELINE_SHIFT 6
+
+// Peak detector thresholds on the smoothed magnitude with the baseline removed. At 1g the smoothed magnitude is about
+// 3900, and each step swings it by a couple of thousand.
+#define STEP_HIGH 150
+#define STEP_LOW  150
+
+// Steps are 0.25-2s apart, and a rhythm has to be this many steps long before any of it counts
+#define STEP_INTERVAL_MIN_MS 250
+#define STEP_INTERVAL_MAX_MS 2000
+#define STEP_RUN             4
+#define STEP_DRIFT_SHIFT     3 // Each interval within 1/8 of the last one
+
+// Mean distance from the baseline per sample above which the badge counts as moving
+#define ACTIVE_LEVEL 150
+
+// Full scale in mg for each mc3419_range_res_t
+static const int32_t range_mg[] = {2000, 4000, 8000, 16000, 12000};
+
+static uint16_t ms_to_samples(uint32_t ms, uint32_t sample_period_us) {
+    return (ms * 1000 + sample_period_us - 1) / sample_period_us;
+}
+
+/**
+ * @brief Feed a peak to the rhythm tracker
+ *
+ * @return Steps to count - none until the rhythm is long enough, then the whole run at once, then one per peak
+ */
+static uint32_t step_peak(accel_steps_t *counter, uint32_t n) {
+    uint32_t interval  = n - counter->last_peak;
+    uint32_t previous  = counter->last_interval;
+    counter->last_peak = n;
+
+    // Walking cadence drifts slowly, peaks that are too fast, too slow or out of step with the last one start over
+    bool in_rhythm = counter->run > 0 && interval >= counter->interval_min && interval <= counter->interval_max;
+    if (in_rhythm && counter->run > 1) {
+        uint32_t drift = interval > previous ? interval - previous : previous - interval;
+        in_rhythm      = drift <= previous >> STEP_DRIFT_SHIFT;
+    }
+    counter->last_interval = interval;
+
+    if (!in_rhythm) {
+        if (counter->run < STEP_RUN) {
+            counter->stats.rejected += counter->run;
+        }
+        counter->run = 1;
+        return 0;
+    }
+    if (counter->run < STEP_RUN) {
+        return ++counter->run == STEP_RUN ? STEP_RUN : 0;
+    }
+    return 1;
+}
+
+void accel_steps_init(accel_steps_t *counter, uint32_t sample_period_us) {
+    memset(counter, 0, sizeof(*counter));
+    counter->interval_min = ms_to_samples(STEP_INTERVAL_MIN_MS, sample_period_us);
+    counter->interval_max = ms_to_samples(STEP_INTERVAL_MAX_MS, sample_period_us);
+}
+
+uint32_t accel_steps_process(accel_steps_t *counter, const accel_block_t *block) {
+    if (block->count == 0 || block->count > ACCEL_BLOCK_MAX_SAMPLES) {
+        return 0;
+    }
+
+    // Samples went missing, start over rather than count a step across the gap
+    if (block->discontinuity && counter->primed) {
+        counter->primed = false;
+        counter->armed  = false;
+        counter->run    = 0;
+        counter->stats.resets++;
+    }
+
+    // The filters run over the whole block one stage at a time, so each stage is a short branch free loop the compiler can
+    // unroll, instead of one sample at a time through all of them
+    int32_t full_scale = block->range < sizeof(range_mg) / sizeof(range_mg[0]) ? range_mg[block->range] : range_mg[0];
+    uint32_t count     = block->count;
+    int32_t magnitude[ACCEL_STEPS_SMOOTH - 1 + ACCEL_BLOCK_MAX_SAMPLES];
+    int32_t *block_magnitude = magnitude + ACCEL_STEPS_SMOOTH - 1;
+    for (uint32_t i = 0; i < count; i++) {
+        int32_t x          = (block->samples[i].x.value * full_scale) >> 15;
+        int32_t y          = (block->samples[i].y.value * full_scale) >> 15;
+        int32_t z          = (block->samples[i].z.value * full_scale) >> 15;
+        block_magnitude[i] = (x * x + y * y + z * z) >> MAGNITUDE_SHIFT;
+    }
+
+    if (!counter->primed) {
+        for (int i = 0; i < ACCEL_STEPS_SMOOTH - 1; i++) {
+            counter->history[i] = block_magnitude[0];
+        }
+        counter->baseline = (block_magnitude[0] * ACCEL_STEPS_SMOOTH) << BASELINE_SHIFT;
+        counter->primed   = true;
+    }
+    memcpy(magnitude, counter->history, sizeof(counter->history));
+    memcpy(counter->history, magnitude + count, sizeof(counter->history));
+
+    // Boxcar smoothing, takes the edge off arm jitter and sensor noise
+    int32_t smooth[ACCEL_BLOCK_MAX_SAMPLES];
+    for (uint32_t i = 0; i < count; i++) {
+        int32_t sum = 0;
+        for (int k = 0; k < ACCEL_STEPS_SMOOTH; k++) {
+            sum += magnitude[i + k];
+        }
+        smooth[i] = sum;
+    }
+
+    // Baseline removal and peak detection depend on the previous sample, these stay sequential
+    uint32_t steps  = 0;
+    uint32_t energy = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        counter->baseline += smooth[i] - (counter->baseline >> BASELINE_SHIFT);
+        int32_t signal     = smooth[i] - (counter->baseline >> BASELINE_SHIFT);
+        energy            += signal < 0 ? -signal : signal;
+
+        if (signal < -STEP_LOW) {
+            counter->armed = true;
+        } else if (counter->armed && signal > STEP_HIGH) {
+            counter->armed = false;
+            steps         += step_peak(counter, counter->n + i);
+        }
+    }
+
+    if (energy >= ACTIVE_LEVEL * count) {
+        counter->stats.active_samples += count;
+    }
+    counter->n             += count;
+    counter->stats.steps   += steps;
+    counter->stats.samples += count;
+    counter->stats.blocks++;
+    return steps;
+}
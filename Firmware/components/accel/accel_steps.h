@@ -0,0 +1,69 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "accel_stream.h"
+
+// Like the sample stream this has no ESP-IDF dependencies, so recorded traces can be run through it on the host
+
+// Samples summed by the smoothing filter, carried over from one block to the next
+#define ACCEL_STEPS_SMOOTH 4
+
+typedef struct {
+    uint32_t steps;          // Steps counted
+    uint32_t rejected;       // Peaks that never became part of a walking rhythm
+    uint32_t active_samples; // Samples spent moving
+    uint32_t samples;        // Samples processed
+    uint32_t blocks;         // Blocks processed
+    uint32_t resets;         // Times the filters restarted after a stream discontinuity
+    uint64_t cycles;         // Clock ticks spent counting, measured by the caller
+} accel_steps_stats_t;
+
+// Step counter state. The acceleration magnitude is smoothed, its slowly moving baseline removed, and what's left is run
+// through a peak detector with hysteresis. Peaks only count once a few of them line up into a walking rhythm.
+typedef struct {
+    uint32_t n; // Samples processed
+
+    // Windows converted from ms to samples by accel_steps_init()
+    uint16_t interval_min;
+    uint16_t interval_max;
+
+    // Filters
+    bool primed;
+    int32_t history[ACCEL_STEPS_SMOOTH - 1]; // Last magnitudes of the previous block
+    int32_t baseline;                        // Low passed smoothed magnitude, in fixed point
+
+    // Peak detector
+    bool armed;             // Signal went through a valley since the last peak
+    uint32_t last_peak;     // Sample of the last peak
+    uint32_t last_interval; // Samples between the last two peaks
+    uint8_t run;            // Peaks in the current rhythm, the first few are held back until it's long enough
+
+    accel_steps_stats_t stats;
+} accel_steps_t;
+
+/**
+ * @brief Initialize the step counter
+ *
+ * @param counter Counter state to initialize
+ * @param sample_period_us Nominal sample period, the step intervals are converted to samples with it
+ */
+void accel_steps_init(accel_steps_t *counter, uint32_t sample_period_us);
+
+/**
+ * @brief Run a block of samples through the step counter
+ *
+ * @param counter Counter state
+ * @param block Samples in stream order, a discontinuity restarts the filters
+ * @return Steps counted in this block, including earlier peaks that a rhythm was just confirmed for
+ */
+uint32_t accel_steps_process(accel_steps_t *counter, const accel_block_t *block);
+
+#ifdef __cplusplus
+}
+#endif
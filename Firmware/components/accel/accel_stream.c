@@ -0,0 +1,103 @@
+#include <string.h>
+
+#include "accel_stream.h"
+
+// Estimates further than this many sample periods from the running timeline are taken as a jump rather than jitter
+#define TIMELINE_RESYNC_PERIODS 4
+
+// Fractions of the estimate error folded into the phase and the period per block - small enough that interrupt latency
+// jitter mostly averages out
+#define TIMELINE_PHASE_SHIFT  3
+#define TIMELINE_PERIOD_SHIFT 4
+
+// The learned period stays within 1/TIMELINE_PERIOD_TOLERANCE of nominal, the MC3419 oscillator is specified to a few %
+#define TIMELINE_PERIOD_TOLERANCE 16
+
+accel_block_t *accel_ring_claim(accel_ring_t *ring) {
+    unsigned int seq = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    // Readers check this after copying, anything they copied from this slot from here on is stale
+    atomic_store_explicit(&ring->writing, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    return &ring->blocks[seq % ACCEL_RING_SIZE];
+}
+
+void accel_ring_commit(accel_ring_t *ring) {
+    unsigned int seq                             = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    ring->blocks[seq % ACCEL_RING_SIZE].sequence = seq;
+    atomic_store_explicit(&ring->head, seq + 1, memory_order_release);
+}
+
+void accel_ring_reader_init(accel_ring_t *ring, accel_reader_t *reader) {
+    reader->next    = atomic_load_explicit(&ring->head, memory_order_acquire);
+    reader->dropped = 0;
+}
+
+bool accel_ring_read(accel_ring_t *ring, accel_reader_t *reader, accel_block_t *block) {
+    while (true) {
+        unsigned int head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (head == reader->next) {
+            return false;
+        }
+
+        // Skip blocks that have already been overwritten
+        if (head - reader->next > ACCEL_RING_SIZE) {
+            reader->dropped += head - reader->next - ACCEL_RING_SIZE;
+            reader->next     = head - ACCEL_RING_SIZE;
+        }
+
+        memcpy(block, &ring->blocks[reader->next % ACCEL_RING_SIZE], sizeof(*block));
+        atomic_thread_fence(memory_order_acquire);
+
+        // The producer may have started on this slot while we were copying it
+        unsigned int writing = atomic_load_explicit(&ring->writing, memory_order_relaxed);
+        if (writing - reader->next > ACCEL_RING_SIZE) {
+            reader->dropped++;
+            reader->next++;
+            continue;
+        }
+
+        reader->next++;
+        return true;
+    }
+}
+
+bool accel_ring_latest(accel_ring_t *ring, accel_block_t *block) {
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == 0) {
+        return false;
+    }
+    accel_reader_t reader = {.next = head - 1};
+    return accel_ring_read(ring, &reader, block);
+}
+
+int64_t accel_timeline_place(accel_timeline_t *timeline, int64_t newest_us, uint32_t count, uint32_t behind, bool lost) {
+    int32_t nominal_q8 = (int32_t)timeline->period_us << 8;
+    if (timeline->period_q8 == 0) {
+        timeline->period_q8 = nominal_q8;
+    }
+    int64_t period   = timeline->period_q8;
+    int64_t estimate = newest_us - (((int64_t)count + behind - 1) * period >> 8);
+    int64_t first    = estimate;
+
+    if (timeline->next_us != 0) {
+        int64_t error = estimate - timeline->next_us;
+        int64_t limit = (TIMELINE_RESYNC_PERIODS * period) >> 8;
+        if (lost || error > limit || error < -limit) {
+            timeline->resyncs++;
+        } else {
+            // Nudge the phase towards the estimate and fold the rest of the error into the period
+            first                = timeline->next_us + error / (1 << TIMELINE_PHASE_SHIFT);
+            int64_t period_q8    = period + (error << 8) / ((int64_t)count << TIMELINE_PERIOD_SHIFT);
+            int64_t period_limit = nominal_q8 / TIMELINE_PERIOD_TOLERANCE;
+            if (period_q8 > nominal_q8 + period_limit) {
+                period_q8 = nominal_q8 + period_limit;
+            } else if (period_q8 < nominal_q8 - period_limit) {
+                period_q8 = nominal_q8 - period_limit;
+            }
+            timeline->period_q8 = period_q8;
+        }
+    }
+
+    timeline->next_us = first + (((int64_t)count * timeline->period_q8) >> 8);
+    return first;
+}
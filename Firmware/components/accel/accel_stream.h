@@ -0,0 +1,110 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mc3419.h"
+
+// No ESP-IDF dependencies in here so the sample pipeline can be built on the host and fed from recorded traces
+
+// Most samples in one block - the MC3419 FIFO holds 32
+#define ACCEL_BLOCK_MAX_SAMPLES 32
+
+// Blocks kept in the ring, readers that fall further behind than this lose blocks
+#define ACCEL_RING_SIZE 8
+
+// A run of consecutive samples read from the FIFO in one burst
+typedef struct {
+    int64_t timestamp_us;      // Time of samples[0] on the esp_timer clock
+    uint32_t sample_period_us; // Measured time between samples
+    uint32_t sequence;         // Increments by one per block
+    uint8_t range;             // mc3419_range_res_t the samples were taken with
+    uint8_t count;             // Valid entries in samples
+    bool discontinuity;        // Samples were lost before this block, timestamp_us was resynchronized
+    mc3419_accel_data_t samples[ACCEL_BLOCK_MAX_SAMPLES];
+} accel_block_t;
+
+// Single producer, multiple reader broadcast ring. Readers never block the producer, they detect overwritten blocks instead.
+typedef struct {
+    accel_block_t blocks[ACCEL_RING_SIZE];
+    atomic_uint head;    // Sequence of the next block to publish
+    atomic_uint writing; // Sequence of the block being written plus one
+} accel_ring_t;
+
+typedef struct {
+    uint32_t next;    // Sequence of the next block to read
+    uint32_t dropped; // Blocks overwritten before this reader got to them
+} accel_reader_t;
+
+// Tracks where blocks fall on the esp_timer clock. The MC3419 runs off its own oscillator, so block times are taken from
+// the FIFO level at each read and smoothed, and the real sample period is learned from how the estimates drift.
+typedef struct {
+    uint32_t period_us; // Nominal sample period
+    int32_t period_q8;  // Measured sample period in 1/256 us, 0 until the first block
+    int64_t next_us;    // Expected time of the next sample, 0 until the first block
+    uint32_t resyncs;   // Times the timeline jumped instead of following the estimate
+} accel_timeline_t;
+
+/**
+ * @brief Get the block the next accel_ring_commit() will publish
+ *
+ * @param ring Ring to write to - producer only
+ * @return Block to fill in, its sequence is set on commit
+ */
+accel_block_t *accel_ring_claim(accel_ring_t *ring);
+
+/**
+ * @brief Publish the block returned by accel_ring_claim()
+ *
+ * @param ring Ring to write to - producer only
+ */
+void accel_ring_commit(accel_ring_t *ring);
+
+/**
+ * @brief Point a reader at the next block to be published
+ *
+ * @param ring Ring to read from
+ * @param reader Reader to initialize
+ */
+void accel_ring_reader_init(accel_ring_t *ring, accel_reader_t *reader);
+
+/**
+ * @brief Copy out the next unread block
+ *     Blocks that were overwritten before the reader got to them are skipped and counted in reader->dropped.
+ *
+ * @param ring Ring to read from
+ * @param reader Reader state, owned by the caller
+ * @param[out] block Block to copy into
+ * @return Whether a block was copied
+ */
+bool accel_ring_read(accel_ring_t *ring, accel_reader_t *reader, accel_block_t *block);
+
+/**
+ * @brief Copy out the newest published block, independent of any reader
+ *
+ * @param ring Ring to read from
+ * @param[out] block Block to copy into
+ * @return Whether a block was copied
+ */
+bool accel_ring_latest(accel_ring_t *ring, accel_block_t *block);
+
+/**
+ * @brief Place a block on the timeline
+ *
+ * @param timeline Timeline state
+ * @param newest_us Time the newest sample in the FIFO was taken, usually the time of the watermark interrupt
+ * @param count Samples in the block
+ * @param behind Samples left in the FIFO after the block, between it and the newest sample
+ * @param lost Whether samples were lost before the block, e.g. the FIFO overflowed
+ * @return Time of the first sample in the block
+ */
+int64_t accel_timeline_place(accel_timeline_t *timeline, int64_t newest_us, uint32_t count, uint32_t behind, bool lost);
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,11 +5,31 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_err.h"
 
 // Compmonent headers to expose externally
+#include "../accel_gesture.h"
+#include "../accel_steps.h"
+#include "../accel_stream.h"
 #include "../mc3419.h"
 
+// Sample stream counters
+typedef struct {
+    uint32_t blocks;            // Blocks published
+    uint32_t samples;           // Samples published
+    uint32_t wakeups_interrupt; // Reads started by the FIFO watermark interrupt
+    uint32_t wakeups_timeout;   // Reads started because no interrupt came in time
+    uint32_t transfers;         // I2C transfers issued by the stream
+    uint32_t overflows;         // Blocks read from a full FIFO, samples may have been lost before them
+    uint32_t resyncs;           // Times the sample timeline jumped
+    uint32_t errors;            // Failed FIFO reads
+} accel_stream_stats_t;
+
+// Called from the gesture task for every recognized gesture, keep it short
+typedef void (*accel_gesture_cb_t)(const accel_gesture_event_t *event);
+
 /**
  * @brief Initialize the accelerometer.
  *
@@ -106,6 +126,7 @@ esp_err_t accel_get_range(mc3419_range_t *range);
 
 /**
  * @brief Read accelerometer data.
+ *     While the sample stream is running this is the newest streamed sample, reading the registers would pop the FIFO.
  *
  * @param data Pointer to store the accelerometer data.
  * @return esp_err_t
@@ -153,6 +174,75 @@ esp_err_t accel_set_gpio_polarity(bool int1_active_high, bool int2_active_high);
  */
 esp_err_t accel_set_gpio_drive_mode(bool int1_push_pull, bool int2_push_pull);
 
+/**
+ * @brief Subscribe to the sample stream
+ *     The accelerometer FIFO is read in blocks of samples as it fills up, see accel_block_t. Each subscriber reads the blocks
+ *     at its own pace, one that falls more than ACCEL_RING_SIZE blocks behind loses the oldest ones.
+ *
+ * @param reader Read position, owned by the caller until accel_stream_unsubscribe()
+ * @param task Task to notify with xTaskNotifyGive() when a block is published, or NULL to poll
+ * @return esp_err_t
+ *     - ESP_ERR_NO_MEM if there are too many subscribers
+ */
+esp_err_t accel_stream_subscribe(accel_reader_t *reader, TaskHandle_t task);
+
+/**
+ * @brief Unsubscribe from the sample stream
+ *
+ * @param reader Reader passed to accel_stream_subscribe()
+ */
+void accel_stream_unsubscribe(accel_reader_t *reader);
+
+/**
+ * @brief Read the next sample block
+ *
+ * @param reader Subscribed reader
+ * @param[out] block Block to copy into
+ * @return Whether there was a block to read
+ */
+bool accel_stream_read(accel_reader_t *reader, accel_block_t *block);
+
+/**
+ * @brief Get the sample stream counters
+ *
+ * @param[out] stats Counters since boot
+ */
+void accel_stream_get_stats(accel_stream_stats_t *stats);
+
+/**
+ * @brief Add a callback for recognized gestures
+ *     Callbacks can be added before accel_init(), they start firing once the sample stream runs.
+ *
+ * @param callback Function to call with each gesture
+ * @return esp_err_t
+ *     - ESP_ERR_NO_MEM if there are too many callbacks
+ */
+esp_err_t accel_add_gesture_callback(accel_gesture_cb_t callback);
+
+/**
+ * @brief Remove a gesture callback
+ *
+ * @param callback Function passed to accel_add_gesture_callback()
+ * @return esp_err_t
+ *     - ESP_ERR_NOT_FOUND if the callback wasn't added
+ */
+esp_err_t accel_remove_gesture_callback(accel_gesture_cb_t callback);
+
+/**
+ * @brief Get the gesture engine counters, including the CPU cycles spent in each detector
+ *
+ * @param[out] stats Counters since boot
+ */
+void accel_gesture_get_stats(accel_gesture_stats_t *stats);
+
+/**
+ * @brief Get the step counter totals since boot, including the CPU cycles spent counting
+ *     The counts start from zero on every boot, keep a running total elsewhere if it needs to outlive a restart.
+ *
+ * @param[out] stats Counters since boot
+ */
+void accel_steps_get_stats(accel_steps_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
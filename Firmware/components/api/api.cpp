@@ -4,6 +4,7 @@
 #include <ranges>
 #include <string>
 #include "api.h"
+#include "api_arena.h"
 #include "api_client.h"
 #include "esp_log.h"
 
@@ -13,93 +14,12 @@ constexpr static const char *TAG = "api";
 const static std::unique_ptr<ApiClient> apiClient = std::make_unique<ApiClient>();
 
 // Function prototypes
-char *getstr(const json &json, const char *key);
-void nullsafe_free(void *ptr);
+char *getstr(void *arena, json &json, const char *key);
 
 extern "C" void api_free_result_data(void *data, api_result_type_t type) {
-    if (data == nullptr) {
-        return;
-    }
-
-    switch (type) {
-        case api_result_type_t::API_AUTH_CODE_STATUS: {
-            auto auth_code_status = (api_auth_code_status_t *)data;
-            nullsafe_free(auth_code_status->request_time);
-            nullsafe_free(auth_code_status->claimed_by);
-            nullsafe_free(auth_code_status->claim_time);
-            break;
-        }
-        case api_result_type_t::API_BADGE_DATA: {
-            auto badge_data = (api_badge_data_t *)data;
-            nullsafe_free(badge_data->handle);
-            nullsafe_free(badge_data->badge_id);
-            nullsafe_free(badge_data->community);
-            break;
-        }
-        case api_result_type_t::API_FIRMWARE_DATA: {
-            auto firmware_data = (api_firmware_data_t *)data;
-            nullsafe_free(firmware_data->setting);
-            nullsafe_free(firmware_data->value);
-            break;
-        }
-        case api_result_type_t::API_TOWER_STATUS: {
-            auto tower_status = (api_tower_info_t *)data;
-            nullsafe_free(tower_status->name);
-            nullsafe_free(tower_status->location);
-            nullsafe_free(tower_status->boot_time);
-            break;
-        }
-        case api_result_type_t::API_ALL_TOWER_STATUS: {
-            auto all_tower_status = (api_all_tower_info_t *)data;
-            for (size_t i = 0; i < all_tower_status->count; i++) {
-                nullsafe_free(all_tower_status->towers[i].name);
-                nullsafe_free(all_tower_status->towers[i].location);
-                nullsafe_free(all_tower_status->towers[i].boot_time);
-            }
-            nullsafe_free(all_tower_status->towers);
-            break;
-        }
-        case api_result_type_t::API_IR_CODE: {
-            auto ir_code_result = (api_ir_code_result_t *)data;
-            for (size_t i = 0; i < ir_code_result->count; i++) {
-                nullsafe_free(ir_code_result->ir_codes[i].name);
-                nullsafe_free(ir_code_result->ir_codes[i].response);
-            }
-            nullsafe_free(ir_code_result->ir_codes);
-            break;
-        }
-        case api_result_type_t::API_EQUIP_MINIBADGE: {
-            auto equip_minibadge_data = (api_equip_minibadge_t *)data;
-            nullsafe_free(equip_minibadge_data->slot1.slot);
-            nullsafe_free(equip_minibadge_data->slot1.name);
-            nullsafe_free(equip_minibadge_data->slot1.shortname);
-            nullsafe_free(equip_minibadge_data->slot2.slot);
-            nullsafe_free(equip_minibadge_data->slot2.name);
-            nullsafe_free(equip_minibadge_data->slot2.shortname);
-            break;
-        }
-        case api_result_type_t::API_VEND_ITEMS: {
-            auto vend_items_data = (api_vend_items_t *)data;
-            for (size_t i = 0; i < vend_items_data->count; i++) {
-                nullsafe_free(vend_items_data->items[i].item_name);
-                nullsafe_free(vend_items_data->items[i].image_url);
-            }
-            nullsafe_free(vend_items_data->items);
-            break;
-        }
-        case api_result_type_t::API_BATTLE_STATUS: {
-            auto battle_status = (api_battle_status_t *)data;
-            for (size_t i = 0; i < battle_status->savior_handle_count; i++) {
-                nullsafe_free(battle_status->savior_handle[i]);
-            }
-            nullsafe_free(battle_status->savior_handle);
-            break;
-        }
-        default: //
-            break;
-    }
-
-    nullsafe_free(data);
+    // Result data, along with any arrays and strings it points to, lives in a single arena rooted at the data struct
+    (void)type;
+    api_arena_free(data);
 }
 
 extern "C" void api_free_result(api_result_t *result, bool free_data) {
@@ -107,73 +27,74 @@ extern "C" void api_free_result(api_result_t *result, bool free_data) {
         return;
     }
 
-    nullsafe_free(result->detail);
-
     if (result->data != nullptr && free_data) {
         api_free_result_data(result->data, result->type);
     }
 
-    nullsafe_free(result);
+    // The detail string is allocated from the result's own arena
+    api_arena_free(result);
 }
 
-api_result_t *base_result(const ApiClient::ApiResponse &response) {
+api_result_t *base_result(json &response_json, int status_code);
+
+api_result_t *base_result(const ApiClient::ApiResponse &response, json &response_json) {
     // All valid responses should have a body with a JSON object or array
     if (response.body.empty()) {
         return nullptr;
     }
     ESP_LOGD(TAG, "Response Body: %s", response.body.c_str());
 
-    // Check if the response body is valid JSON
-    if (!json::accept(response.body)) {
+    // Parse the response body once - the parsed DOM is shared with the caller to fill in the result data
+    response_json = response.body_json();
+    if (response_json.is_discarded()) {
         ESP_LOGE(TAG, "Invalid JSON response: %s", response.body.c_str());
         return nullptr;
     }
-
-    // Parse the response body as JSON
-    json response_json = response.body_json();
     if (response_json.is_null() || !response_json.is_object()) {
         ESP_LOGE(TAG, "JSON is null or not an object: %s", response.body.c_str());
         return nullptr;
     }
-    ESP_LOGD(TAG, "Response JSON: %s", response_json.dump().c_str());
 
-    // Create a new result struct to return
-    auto result = (api_result_t *)malloc(sizeof(api_result_t));
+    return base_result(response_json, response.status_code);
+}
+
+api_result_t *base_result(json &response_json, int status_code) {
+    // Get the detail field
+    std::string_view detail;
+    if (response_json.contains("detail") && response_json["detail"] != nullptr) {
+        auto &detail_json = response_json["detail"];
+        if (detail_json.is_array()) {
+            detail = detail_json[0]["msg"].get_ref<const std::string &>();
+        } else if (detail_json.is_string()) {
+            detail = detail_json.get_ref<const std::string &>();
+        }
+    }
+
+    // Create a new result struct to return with room for the detail string
+    auto result = api_arena_new<api_result_t>(detail.empty() ? 0 : detail.size() + 1);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Populate the basic fields
     result->type   = api_result_type_t::API_BASE;
-    result->status = response_json.contains("status") ? (bool)response_json["status"]
-                                                      : response.status_code >= 200 && response.status_code < 300;
-    result->detail = nullptr;
+    result->status = response_json.contains("status") ? (bool)response_json["status"] : status_code >= 200 && status_code < 300;
+    result->detail = detail.empty() ? nullptr : api_arena_strdup(result, detail);
     result->data   = nullptr;
 
-    // Get the detail field
-    if (response_json.contains("detail") && response_json["detail"] != nullptr) {
-        if (response_json["detail"].is_array()) {
-            result->detail = strdup(response_json["detail"][0]["msg"].get<std::string>().c_str());
-        } else if (response_json["detail"].is_string()) {
-            result->detail = strdup(response_json["detail"].get<std::string>().c_str());
-        }
-    }
-
     return result;
 }
 
-char *getstr(const json &json, const char *key) {
-    if (json.contains(key) && json[key] != nullptr) {
-        return strdup(json[key].get<std::string>().c_str());
-    }
-    return nullptr;
+api_result_t *base_result(const ApiClient::ApiResponse &response) {
+    json response_json;
+    return base_result(response, response_json);
 }
 
-void nullsafe_free(void *ptr) {
-    if (ptr != nullptr) {
-        free(ptr);
-        ptr = nullptr;
+char *getstr(void *arena, json &json, const char *key) {
+    if (auto it = json.find(key); it != json.end() && !it->is_null()) {
+        return api_arena_strdup(arena, it->get_ref<const std::string &>());
     }
+    return nullptr;
 }
 
 extern "C" api_result_t *api_request_auth_code() {
@@ -182,18 +103,19 @@ extern "C" api_result_t *api_request_auth_code() {
     }
 
     auto response = apiClient->requestAuthCode();
-    auto result   = base_result(response);
+    json response_json;
+    auto result   = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
-    result->data = malloc(sizeof(api_ir_code_only_t));
+    result->data = api_arena_new<api_ir_code_only_t>(0);
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -215,18 +137,19 @@ extern "C" api_result_t *api_auth_levelup_code() {
     }
 
     auto response = apiClient->authLevelUpCode();
-    auto result   = base_result(response);
+    json response_json;
+    auto result   = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
-    result->data = malloc(sizeof(api_ir_code_only_t));
+    result->data = api_arena_new<api_ir_code_only_t>(0);
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -248,18 +171,19 @@ extern "C" api_result_t *api_auth_status(const uint32_t ir_code) {
     }
 
     auto response = apiClient->authStatus(ir_code);
-    auto result   = base_result(response);
+    json response_json;
+    auto result   = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
-    result->data = malloc(sizeof(api_auth_code_status_t));
+    result->data = api_arena_new<api_auth_code_status_t>(response.body.size());
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -272,9 +196,9 @@ extern "C" api_result_t *api_auth_status(const uint32_t ir_code) {
     auto auth_code_status          = (api_auth_code_status_t *)result->data;
     auth_code_status->code         = result_json["code"];
     auth_code_status->claimed      = result_json["claimed"];
-    auth_code_status->request_time = getstr(result_json, "request_time");
-    auth_code_status->claimed_by   = getstr(result_json, "claimed_by");
-    auth_code_status->claim_time   = getstr(result_json, "claim_time");
+    auth_code_status->request_time = getstr(auth_code_status, result_json, "request_time");
+    auth_code_status->claimed_by   = getstr(auth_code_status, result_json, "claimed_by");
+    auth_code_status->claim_time   = getstr(auth_code_status, result_json, "claim_time");
 
     return result;
 }
@@ -287,20 +211,21 @@ extern "C" api_result_t *api_get_badge_data() {
     auto response = apiClient->getBadgeData();
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_badge_data_t));
+    result->data = api_arena_new<api_badge_data_t>(response.body.size());
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -312,8 +237,8 @@ extern "C" api_result_t *api_get_badge_data() {
     // Copy the badge data
     auto badge_data              = (api_badge_data_t *)result->data;
     badge_data->id               = result_json["id"];
-    badge_data->badge_id         = getstr(result_json, "badge_id");
-    badge_data->handle           = getstr(result_json, "handle");
+    badge_data->badge_id         = getstr(badge_data, result_json, "badge_id");
+    badge_data->handle           = getstr(badge_data, result_json, "handle");
     badge_data->xp               = result_json["xp"];
     badge_data->level            = result_json["level"];
     badge_data->enabled          = result_json["enabled"];
@@ -321,7 +246,7 @@ extern "C" api_result_t *api_get_badge_data() {
     badge_data->staff            = result_json["staff"];
     badge_data->blackbadge       = result_json["blackbadge"];
     badge_data->can_level        = result_json["can_level"];
-    badge_data->community        = getstr(result_json, "community");
+    badge_data->community        = getstr(badge_data, result_json, "community");
     badge_data->community_levels = result_json["community_levels"].is_null() ? 0 : (int)result_json["community_levels"];
     badge_data->is_savior        = result_json["is_savior"];
     badge_data->coins            = result_json["coins"].is_null() ? 0 : (int)result_json["coins"];
@@ -343,20 +268,21 @@ extern "C" api_result_t *api_get_firmware_version() {
     auto response = apiClient->getFirmwareVersion();
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_firmware_data_t));
+    result->data = api_arena_new<api_firmware_data_t>(response.body.size());
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -367,8 +293,8 @@ extern "C" api_result_t *api_get_firmware_version() {
 
     // Copy the firmware data
     auto firmware_data     = (api_firmware_data_t *)result->data;
-    firmware_data->setting = getstr(result_json, "setting");
-    firmware_data->value   = getstr(result_json, "value");
+    firmware_data->setting = getstr(firmware_data, result_json, "setting");
+    firmware_data->value   = getstr(firmware_data, result_json, "value");
 
     return result;
 }
@@ -402,20 +328,21 @@ extern "C" api_result_t *api_join_battle() {
     auto response = apiClient->joinBattle();
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_join_battle_t));
+    result->data = api_arena_new<api_join_battle_t>(0);
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -439,20 +366,21 @@ template <typename T> static api_result_t *api_get_tower_status_impl(const T &id
     auto response = apiClient->getTowerStatus(id);
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_tower_info_t));
+    result->data = api_arena_new<api_tower_info_t>(response.body.size());
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -464,12 +392,12 @@ template <typename T> static api_result_t *api_get_tower_status_impl(const T &id
     // Copy the tower status data
     auto tower_status                  = (api_tower_info_t *)result->data;
     tower_status->id                   = result_json["id"];
-    tower_status->name                 = getstr(result_json, "name");
-    tower_status->location             = getstr(result_json, "location");
+    tower_status->name                 = getstr(tower_status, result_json, "name");
+    tower_status->location             = getstr(tower_status, result_json, "location");
     tower_status->level                = result_json["level"];
     tower_status->health               = result_json["health"];
     tower_status->max_health           = result_json["max_health"];
-    tower_status->boot_time            = getstr(result_json, "boot_time");
+    tower_status->boot_time            = getstr(tower_status, result_json, "boot_time");
     tower_status->ir_code              = result_json["ir_code"];
     tower_status->enabled              = result_json["enabled"];
     tower_status->status               = get_tower_status(result_json["status"].template get<std::string>().c_str());
@@ -490,27 +418,51 @@ extern "C" api_result_t *api_get_tower_status_by_ir_code(const uint32_t ir_code)
 }
 
 extern "C" api_result_t *api_get_all_tower_status() {
+    return api_get_all_tower_status_if_changed(nullptr);
+}
+
+extern "C" api_result_t *api_get_all_tower_status_if_changed(const char *etag) {
     if (apiClient == nullptr) {
         return nullptr;
     }
 
-    auto response = apiClient->getAllTowerStatus();
+    auto response = apiClient->getAllTowerStatus(etag == nullptr ? "" : etag);
+
+    // Nothing changed since the ETag that was sent, so there is no body to parse
+    if (response.status_code == 304) {
+        auto result = api_arena_new<api_result_t>(0);
+        if (result == nullptr) {
+            return nullptr;
+        }
+        result->type   = api_result_type_t::API_ALL_TOWER_STATUS;
+        result->status = true;
+        result->data   = api_arena_new<api_all_tower_info_t>(etag == nullptr ? 0 : std::string_view(etag).size() + 1);
+        if (result->data == nullptr) {
+            api_free_result(result, true);
+            return nullptr;
+        }
+        auto all_tower_status          = (api_all_tower_info_t *)result->data;
+        all_tower_status->not_modified = true;
+        all_tower_status->etag         = etag == nullptr ? nullptr : api_arena_strdup(all_tower_status, etag);
+        return result;
+    }
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_array()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_all_tower_info_t));
+    result->data = api_arena_new<api_all_tower_info_t>(response.body.size() + sizeof(api_tower_info_t) * result_json.size());
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -523,20 +475,20 @@ extern "C" api_result_t *api_get_all_tower_status() {
     auto all_tower_status   = (api_all_tower_info_t *)result->data;
     all_tower_status->count = result_json.size();
     ESP_LOGD(TAG, "Tower count: %d", all_tower_status->count);
-    all_tower_status->towers = (api_tower_info_t *)malloc(sizeof(api_tower_info_t) * all_tower_status->count);
+    all_tower_status->towers = api_arena_array<api_tower_info_t>(all_tower_status, all_tower_status->count);
     if (all_tower_status->towers == nullptr) {
         api_free_result(result, true);
         return nullptr;
     }
     for (size_t i = 0; i < all_tower_status->count; i++) {
-        auto tower_json                                  = result_json[i];
+        auto &tower_json                                 = result_json[i];
         all_tower_status->towers[i].id                   = tower_json["id"];
-        all_tower_status->towers[i].name                 = getstr(tower_json, "name");
-        all_tower_status->towers[i].location             = getstr(tower_json, "location");
+        all_tower_status->towers[i].name                 = getstr(all_tower_status, tower_json, "name");
+        all_tower_status->towers[i].location             = getstr(all_tower_status, tower_json, "location");
         all_tower_status->towers[i].level                = tower_json["level"];
         all_tower_status->towers[i].health               = tower_json["health"];
         all_tower_status->towers[i].max_health           = tower_json["max_health"];
-        all_tower_status->towers[i].boot_time            = getstr(tower_json, "boot_time");
+        all_tower_status->towers[i].boot_time            = getstr(all_tower_status, tower_json, "boot_time");
         all_tower_status->towers[i].ir_code              = tower_json["ir_code"];
         all_tower_status->towers[i].enabled              = tower_json["enabled"];
         all_tower_status->towers[i].status               = get_tower_status(tower_json["status"].get<std::string>().c_str());
@@ -546,6 +498,13 @@ extern "C" api_result_t *api_get_all_tower_status() {
         all_tower_status->towers[i].players_disconnected = tower_json["players_disconnected"];
     }
 
+    // Conditional request metadata for the next refresh
+    auto &delta_json            = response_json["delta"];
+    auto etag_header            = response.header("ETag");
+    all_tower_status->etag      = etag_header.empty() ? nullptr : api_arena_strdup(all_tower_status, etag_header);
+    all_tower_status->delta     = delta_json.is_boolean() && delta_json.get<bool>();
+    all_tower_status->body_size = response.body.size();
+
     return result;
 }
 
@@ -561,20 +520,21 @@ extern "C" api_result_t *api_check_ir_codes(const uint32_t *ir_codes, size_t num
     auto response = apiClient->checkIrCodes(codes);
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_array()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_ir_code_result_t));
+    result->data = api_arena_new<api_ir_code_result_t>(response.body.size() + sizeof(api_ir_code_t) * result_json.size());
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -586,7 +546,7 @@ extern "C" api_result_t *api_check_ir_codes(const uint32_t *ir_codes, size_t num
     // Copy the IR codes
     auto ir_code_result      = (api_ir_code_result_t *)result->data;
     ir_code_result->count    = result_json.size();
-    ir_code_result->ir_codes = (api_ir_code_t *)malloc(sizeof(api_ir_code_t) * ir_code_result->count);
+    ir_code_result->ir_codes = api_arena_array<api_ir_code_t>(ir_code_result, ir_code_result->count);
     if (ir_code_result->ir_codes == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -597,8 +557,8 @@ extern "C" api_result_t *api_check_ir_codes(const uint32_t *ir_codes, size_t num
         ir_code_result->ir_codes[i].is_valid = is_valid;
         if (is_valid) {
             ir_code_result->ir_codes[i].type     = get_ir_code_type(result_json[i]["type"].get<std::string>().c_str());
-            ir_code_result->ir_codes[i].name     = getstr(result_json[i], "name");
-            ir_code_result->ir_codes[i].response = getstr(result_json[i], "response");
+            ir_code_result->ir_codes[i].name     = getstr(ir_code_result, result_json[i], "name");
+            ir_code_result->ir_codes[i].response = getstr(ir_code_result, result_json[i], "response");
             ir_code_result->ir_codes[i].tower_id = result_json[i].contains("tower_id") ? (int)result_json[i]["tower_id"] : 0;
         } else {
             ir_code_result->ir_codes[i].type     = IR_CODE_TYPE_UNKNOWN;
@@ -619,20 +579,21 @@ extern "C" api_result_t *api_equip_minibadge(const char *slot1, const char *slot
     auto response = apiClient->equipMinibadge(slot1, slot2);
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_equip_minibadge_t));
+    result->data = api_arena_new<api_equip_minibadge_t>(response.body.size());
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -646,9 +607,9 @@ extern "C" api_result_t *api_equip_minibadge(const char *slot1, const char *slot
     const char *slot_names[]               = {"slot1", "slot2"};
     api_minibadge_slot_info_t *slot_info[] = {&equip_minibadge_data->slot1, &equip_minibadge_data->slot2};
     for (size_t i = 0; i < sizeof(slot_info) / sizeof(slot_info[0]); i++) {
-        auto slot_json = result_json[slot_names[i]];
+        auto &slot_json = result_json[slot_names[i]];
         if (slot_json.is_null() || !slot_json.is_object()) {
-            slot_info[i]->slot       = strdup(slot_names[i]);
+            slot_info[i]->slot       = api_arena_strdup(equip_minibadge_data, slot_names[i]);
             slot_info[i]->name       = nullptr;
             slot_info[i]->shortname  = nullptr;
             slot_info[i]->buff_type  = MINIBADGE_BUFF_TYPE_NONE;
@@ -656,15 +617,13 @@ extern "C" api_result_t *api_equip_minibadge(const char *slot1, const char *slot
             slot_info[i]->valid      = false;
             slot_info[i]->rewards    = nullptr;
         } else {
-            slot_info[i]->slot       = strdup(slot_names[i]);
-            slot_info[i]->name       = strdup(slot_json["name"].get<std::string>().c_str());
-            slot_info[i]->shortname  = strdup(slot_json["shortname"].get<std::string>().c_str());
+            slot_info[i]->slot       = api_arena_strdup(equip_minibadge_data, slot_names[i]);
+            slot_info[i]->name       = getstr(equip_minibadge_data, slot_json, "name");
+            slot_info[i]->shortname  = getstr(equip_minibadge_data, slot_json, "shortname");
             slot_info[i]->buff_type  = get_minibadge_buff_type(slot_json["buff_type"].get<std::string>().c_str());
             slot_info[i]->buff_value = slot_json["buff_value"];
             slot_info[i]->valid      = slot_json["valid"];
-            slot_info[i]->rewards    = slot_json.contains("rewards") // This seems to only maybe exist
-                                           ? strdup(slot_json["rewards"].get<std::string>().c_str())
-                                           : nullptr;
+            slot_info[i]->rewards    = getstr(equip_minibadge_data, slot_json, "rewards"); // This seems to only maybe exist
         }
     }
 
@@ -679,20 +638,21 @@ extern "C" api_result_t *api_request_level_up(const int level) {
     auto response = apiClient->requestLevelUp(level);
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_ir_code_only_t));
+    result->data = api_arena_new<api_ir_code_only_t>(0);
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -716,20 +676,21 @@ extern "C" api_result_t *api_vend_get_items() {
     auto response = apiClient->vendItems();
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_array()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_vend_items_t));
+    result->data = api_arena_new<api_vend_items_t>(response.body.size() + sizeof(api_vend_item_t) * result_json.size());
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -741,26 +702,35 @@ extern "C" api_result_t *api_vend_get_items() {
     // Copy the vend items data
     auto vend_items_data   = (api_vend_items_t *)result->data;
     vend_items_data->count = result_json.size();
-    vend_items_data->items = (api_vend_item_t *)malloc(sizeof(api_vend_item_t) * vend_items_data->count);
+    vend_items_data->items = api_arena_array<api_vend_item_t>(vend_items_data, vend_items_data->count);
     if (vend_items_data->items == nullptr) {
         api_free_result(result, true);
         return nullptr;
     }
     for (size_t i = 0; i < vend_items_data->count; i++) {
-        auto item_json                            = result_json[i];
+        auto &item_json                           = result_json[i];
         vend_items_data->items[i].item_id         = item_json["item_id"];
-        vend_items_data->items[i].item_name       = getstr(item_json, "item_name");
+        vend_items_data->items[i].item_name       = getstr(vend_items_data, item_json, "item_name");
         vend_items_data->items[i].item_price      = item_json["item_price"];
         vend_items_data->items[i].available_stock = item_json["available_stock"];
         vend_items_data->items[i].purchased       = item_json["purchased"];
         vend_items_data->items[i].sold_out        = item_json["sold_out"];
-        vend_items_data->items[i].image_url       = getstr(item_json, "image_url");
+        vend_items_data->items[i].image_url       = getstr(vend_items_data, item_json, "image_url");
         vend_items_data->items[i].version         = item_json["version"];
     }
 
     return result;
 }
 
+extern "C" api_result_t *api_report_activity(const api_activity_interval_t *intervals, size_t count, uint32_t total_steps) {
+    if (apiClient == nullptr) {
+        return nullptr;
+    }
+
+    auto response = apiClient->reportActivity(intervals, count, total_steps);
+    return base_result(response);
+}
+
 extern "C" api_result_t *api_vend_buy_item(int item_id) {
     if (apiClient == nullptr) {
         return nullptr;
@@ -778,20 +748,21 @@ extern "C" api_result_t *api_send_attack(int battle_id, int stratagem_length, in
     auto response = apiClient->sendAttack(battle_id, stratagem_length, stratagem_count, attack_duration);
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_ir_code_only_t));
+    result->data = api_arena_new<api_send_attack_t>(0);
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -807,20 +778,20 @@ extern "C" api_result_t *api_send_attack(int battle_id, int stratagem_length, in
     return result;
 }
 
-static bool api_make_battle_status_result(ApiClient::ApiResponse &response, api_result_t *result) {
+static bool api_make_battle_status_result(json &response_json, size_t body_size, api_result_t *result) {
     if (result == nullptr) {
         return false;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return false;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_battle_status_t));
+    result->data = api_arena_new<api_battle_status_t>(body_size);
     if (result->data == nullptr) {
         api_free_result(result, true);
         return false;
@@ -851,9 +822,10 @@ static bool api_make_battle_status_result(ApiClient::ApiResponse &response, api_
         result_json["players_disconnected"].is_null() ? 0 : (int)result_json["players_disconnected"];
     if (result_json["savior_handle"].is_array()) {
         battle_status->savior_handle_count = result_json["savior_handle"].size();
-        battle_status->savior_handle       = (char **)malloc(sizeof(char *) * battle_status->savior_handle_count);
+        battle_status->savior_handle       = api_arena_array<char *>(battle_status, battle_status->savior_handle_count);
         for (size_t i = 0; i < battle_status->savior_handle_count; i++) {
-            battle_status->savior_handle[i] = strdup(result_json["savior_handle"][i].get<std::string>().c_str());
+            auto &handle_json               = result_json["savior_handle"][i];
+            battle_status->savior_handle[i] = api_arena_strdup(battle_status, handle_json.get_ref<const std::string &>());
         }
     }
 
@@ -868,12 +840,13 @@ extern "C" api_result_t *api_send_attack_fail(int battle_id) {
     auto response = apiClient->sendFail(battle_id);
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
-    if (!api_make_battle_status_result(response, result)) {
+    if (!api_make_battle_status_result(response_json, response.body.size(), result)) {
         // Already freed by api_make_battle_status_result
         result = nullptr;
     }
@@ -889,12 +862,13 @@ extern "C" api_result_t *api_get_battle_status(int battle_id) {
     auto response = apiClient->getBattleStatus(battle_id);
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
-    if (!api_make_battle_status_result(response, result)) {
+    if (!api_make_battle_status_result(response_json, response.body.size(), result)) {
         // Already freed by api_make_battle_status_result
         result = nullptr;
     }
@@ -902,6 +876,56 @@ extern "C" api_result_t *api_get_battle_status(int battle_id) {
     return result;
 }
 
+extern "C" api_err_t api_stream_battle_status(int battle_id, api_battle_status_stream_cb_t callback, void *user_data) {
+    if (apiClient == nullptr || callback == nullptr) {
+        return api_err_t::API_FAIL;
+    }
+
+    // Updates after the first may only carry the fields that changed, so keep the merged status between lines
+    json status_json = json::object();
+    bool received    = false;
+
+    auto on_line = [&](std::string_view line) {
+        // Blank lines are keep-alives that give the caller a chance to close the stream
+        if (line.empty()) {
+            return callback(nullptr, user_data);
+        }
+
+        json line_json = json::parse(line, nullptr, false);
+        if (line_json.is_discarded() || !line_json.is_object()) {
+            ESP_LOGW(TAG, "Invalid battle status stream line: %.*s", (int)line.size(), line.data());
+            return true;
+        }
+        if (line_json["result"].is_object()) {
+            status_json.update(line_json["result"]);
+        }
+
+        auto result = base_result(line_json, 200);
+        if (result == nullptr) {
+            return true;
+        }
+        line_json["result"] = status_json;
+        if (!api_make_battle_status_result(line_json, line.size(), result)) {
+            // Already freed by api_make_battle_status_result
+            return true;
+        }
+
+        received = true;
+        return callback(result, user_data);
+    };
+
+    if (apiClient->streamBattleStatus(battle_id, on_line) != api_err_t::API_OK || !received) {
+        return api_err_t::API_FAIL;
+    }
+    return api_err_t::API_OK;
+}
+
+extern "C" void api_abort_battle_status_stream() {
+    if (apiClient != nullptr) {
+        apiClient->abortBattleStatusStream();
+    }
+}
+
 extern "C" api_result_t *api_get_savior_code() {
     if (apiClient == nullptr) {
         return nullptr;
@@ -910,20 +934,21 @@ extern "C" api_result_t *api_get_savior_code() {
     auto response = apiClient->getSaviorCode();
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_ir_code_only_t));
+    result->data = api_arena_new<api_ir_code_only_t>(0);
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
@@ -947,12 +972,13 @@ extern "C" api_result_t *api_self_save(int battle_id) {
     auto response = apiClient->selfSave(battle_id);
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
-    if (!api_make_battle_status_result(response, result)) {
+    if (!api_make_battle_status_result(response_json, response.body.size(), result)) {
         // Already freed by api_make_battle_status_result
         result = nullptr;
     }
@@ -968,20 +994,21 @@ extern "C" api_result_t *api_after_action_report(int battle_id) {
     auto response = apiClient->afterActionReport(battle_id);
 
     // Create a new result struct to return
-    auto result = base_result(response);
+    json response_json;
+    auto result = base_result(response, response_json);
     if (result == nullptr) {
         return nullptr;
     }
 
     // Parse the response JSON
-    auto result_json = response.body_json()["result"];
+    auto &result_json = response_json["result"];
     if (result_json.is_null() || !result_json.is_object()) {
         api_free_result(result, true);
         return nullptr;
     }
 
     // Create a new result struct to return in the data field
-    result->data = malloc(sizeof(api_after_action_report_t));
+    result->data = api_arena_new<api_after_action_report_t>(0);
     if (result->data == nullptr) {
         api_free_result(result, true);
         return nullptr;
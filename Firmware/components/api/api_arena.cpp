@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include "api_arena.h"
+
+// Minimum size of overflow blocks chained onto an arena when the initial block is full
+#define API_ARENA_MIN_BLOCK_SIZE 256
+
+// Marks the head block of an arena so that foreign pointers are caught before they are freed
+#define API_ARENA_MAGIC 0x41524e41 // "ARNA"
+
+constexpr static const char *TAG = "api_arena";
+
+// Block header - the usable memory immediately follows the header and keeps its alignment
+struct alignas(alignof(std::max_align_t)) ArenaBlock {
+    uint32_t magic;
+    ArenaBlock *next; // Overflow blocks, only used by the head block
+    size_t capacity;
+    size_t used;
+
+    uint8_t *memory() {
+        return reinterpret_cast<uint8_t *>(this + 1);
+    }
+};
+
+static size_t align_up(size_t size) {
+    return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+}
+
+static ArenaBlock *block_create(size_t capacity) {
+    capacity = align_up(capacity);
+    auto block = static_cast<ArenaBlock *>(
+        heap_caps_malloc_prefer(sizeof(ArenaBlock) + capacity, 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT));
+    if (block == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate %d byte arena block", (int)(sizeof(ArenaBlock) + capacity));
+        return nullptr;
+    }
+    block->magic    = API_ARENA_MAGIC;
+    block->next     = nullptr;
+    block->capacity = capacity;
+    block->used     = 0;
+    return block;
+}
+
+static ArenaBlock *head_block(void *root) {
+    auto head = reinterpret_cast<ArenaBlock *>(root) - 1;
+    assert(head->magic == API_ARENA_MAGIC);
+    return head;
+}
+
+static void *block_alloc(ArenaBlock *block, size_t size) {
+    size = align_up(size);
+    if (block->capacity - block->used < size) {
+        return nullptr;
+    }
+    void *ptr = block->memory() + block->used;
+    block->used += size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+void *api_arena_create(size_t root_size, size_t extra_capacity) {
+    ArenaBlock *head = block_create(align_up(root_size) + extra_capacity);
+    if (head == nullptr) {
+        return nullptr;
+    }
+    return block_alloc(head, root_size);
+}
+
+void *api_arena_alloc(void *root, size_t size) {
+    if (root == nullptr) {
+        return nullptr;
+    }
+
+    // Try the head block first, then any overflow blocks, and finally chain on a new block
+    ArenaBlock *head = head_block(root);
+    for (ArenaBlock *block = head; block != nullptr; block = block->next) {
+        if (void *ptr = block_alloc(block, size); ptr != nullptr) {
+            return ptr;
+        }
+    }
+
+    ArenaBlock *block = block_create(std::max<size_t>(size, API_ARENA_MIN_BLOCK_SIZE));
+    if (block == nullptr) {
+        return nullptr;
+    }
+    ESP_LOGD(TAG, "Arena %p overflowed, chained a %d byte block", root, (int)block->capacity);
+    block->next = head->next;
+    head->next  = block;
+    return block_alloc(block, size);
+}
+
+void api_arena_free(void *root) {
+    if (root == nullptr) {
+        return;
+    }
+
+    ArenaBlock *head  = head_block(root);
+    ArenaBlock *block = head->next;
+    while (block != nullptr) {
+        ArenaBlock *next = block->next;
+        heap_caps_free(block);
+        block = next;
+    }
+    head->magic = 0;
+    heap_caps_free(head);
+}
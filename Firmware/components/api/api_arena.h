@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+/**
+ * @brief Per-result bump allocator for API results
+ *
+ * Each arena is identified by its root object, which is always the first allocation in the arena. Everything else
+ * hanging off the root (arrays, strings) is bump-allocated from the same arena, so the whole object graph is released
+ * with a single call to api_arena_free() on the root. Arenas are allocated from PSRAM when it is available.
+ */
+
+/**
+ * @brief Create a new arena and allocate its zeroed root object
+ *
+ * @param[in] root_size The size of the root object
+ * @param[in] extra_capacity Additional bytes to reserve up front for arrays and strings owned by the root
+ *
+ * @return Pointer to the root object, or nullptr if the allocation failed
+ */
+void *api_arena_create(size_t root_size, size_t extra_capacity);
+
+/**
+ * @brief Allocate zeroed memory from the arena owning the given root object
+ *
+ * @param[in] root The root object of the arena
+ * @param[in] size The number of bytes to allocate
+ *
+ * @return Pointer to the allocated memory, or nullptr if the allocation failed
+ */
+void *api_arena_alloc(void *root, size_t size);
+
+/**
+ * @brief Free an arena and everything allocated from it
+ *
+ * @param[in] root The root object of the arena
+ */
+void api_arena_free(void *root);
+
+/**
+ * @brief Allocate a zeroed root object of type T in a new arena
+ */
+template <typename T> T *api_arena_new(size_t extra_capacity) {
+    return static_cast<T *>(api_arena_create(sizeof(T), extra_capacity));
+}
+
+/**
+ * @brief Allocate a zeroed array of count T from the arena owning the given root object
+ */
+template <typename T> T *api_arena_array(void *root, size_t count) {
+    return static_cast<T *>(api_arena_alloc(root, sizeof(T) * count));
+}
+
+/**
+ * @brief Copy a string into the arena owning the given root object
+ */
+inline char *api_arena_strdup(void *root, const std::string_view str) {
+    auto copy = static_cast<char *>(api_arena_alloc(root, str.size() + 1));
+    if (copy != nullptr) {
+        memcpy(copy, str.data(), str.size());
+        copy[str.size()] = '\0';
+    }
+    return copy;
+}
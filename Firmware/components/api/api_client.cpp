@@ -1,6 +1,7 @@
 #include <iostream>
 #include <sys/socket.h>
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_http_client.h"
 #include "esp_ota_ops.h"
 #include "esp_https_ota.h"
@@ -13,7 +14,10 @@
 #include "ui.h"
 #include "version.h"
 
-#define OTA_BUFFER_SIZE 16 * 1024 // 16 KB
+#define OTA_BUFFER_SIZE      16 * 1024 // 16 KB
+#define STREAM_BUFFER_SIZE   1024      // Read size for streamed responses
+#define STREAM_LINE_MAX      4 * 1024  // Longest streamed line, a server that sends more without a newline is dropped
+#define STREAM_READ_SLICE_MS 250       // Stream read timeout, so an abort is noticed even while the server is quiet
 
 constexpr static const char *TAG = "api_client";
 
@@ -62,55 +66,166 @@ esp_err_t ApiClient::httpEventHandler(esp_http_client_event_t *evt) {
     return ESP_OK;
 }
 
-ApiClient::ApiResponse ApiClient::doRequest(const std::string_view endpoint, const std::string_view method,
-                                            const std::string_view payload) {
-    // Per-request context
-    auto *context = new RequestContext();
+esp_http_client_handle_t ApiClient::acquireClient(const std::string &url, RequestContext *context, bool &pooled, bool &reused,
+                                                  bool fresh) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    int64_t now = esp_timer_get_time();
+
+    // Close any idle connections that have outlived the idle timeout
+    for (auto &entry : client_pool) {
+        if (entry.handle != nullptr && !entry.in_use &&
+            now - entry.last_used_us > (int64_t)CONFIG_API_CLIENT_IDLE_TIMEOUT_MS * 1000) {
+            ESP_LOGD(TAG, "Evicting idle HTTP client %p", entry.handle);
+            esp_http_client_cleanup(entry.handle);
+            entry.handle = nullptr;
+        }
+    }
+
+    // Prefer an already connected client, then an empty slot, then fall back to a one-shot client. A fresh client skips
+    // the connected ones.
+    PooledClient *slot = nullptr;
+    for (auto &entry : client_pool) {
+        if (!fresh && entry.handle != nullptr && !entry.in_use) {
+            slot = &entry;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        for (auto &entry : client_pool) {
+            if (entry.handle == nullptr) {
+                slot = &entry;
+                break;
+            }
+        }
+    }
+
+    if (slot != nullptr && slot->handle != nullptr) {
+        // Reuse the existing connection - only the URL and per-request user data change
+        esp_http_client_set_url(slot->handle, url.c_str());
+        esp_http_client_set_user_data(slot->handle, context);
+        slot->in_use = true;
+        pooled       = true;
+        reused       = true;
+        return slot->handle;
+    }
+    reused = false;
 
     // Set up the HTTP client configuration
     esp_http_client_config_t config = {};
-    std::string url                 = std::string(API_BASE_URL) + endpoint.data();
     config.url                      = url.c_str();
     config.cert_pem                 = reinterpret_cast<const char *>(isrgrootx1_cert);
     config.cert_len                 = isrgrootx1_cert_end - isrgrootx1_cert;
     config.event_handler            = httpEventHandler;
     config.user_data                = context;
-    config.method                   = (method == "POST") ? HTTP_METHOD_POST : HTTP_METHOD_GET;
+    config.keep_alive_enable        = slot != nullptr;
 
     // Initialize the HTTP client
     esp_http_client_handle_t client = esp_http_client_init(&config);
     if (client == nullptr) {
         ESP_LOGE(TAG, "Failed to initialize HTTP client");
-        return ApiResponse();
+        return nullptr;
     }
 
-    // Set the X-API-Key header
+    // The API key never changes so it only needs to be set once per client
     esp_http_client_set_header(client, "X-API-Key", api_key.c_str());
 
-    // Set the payload if it exists for POST requests
-    if (!payload.empty()) {
-        esp_http_client_set_header(client, "Content-Type", "application/json");
-        esp_http_client_set_post_field(client, payload.data(), payload.length());
+    if (slot != nullptr) {
+        slot->handle = client;
+        slot->in_use = true;
+        pooled       = true;
+    } else {
+        ESP_LOGD(TAG, "HTTP client pool exhausted, using a one-shot client");
+        pooled = false;
     }
+    return client;
+}
 
-    ESP_LOGD(TAG, "HTTP Request: %s %s -- %s", config.method == HTTP_METHOD_POST ? "POST" : "GET", config.url,
-             payload.empty() ? "" : payload.data());
+void ApiClient::releaseClient(esp_http_client_handle_t client, bool pooled, bool reusable) {
+    if (!pooled) {
+        esp_http_client_cleanup(client);
+        return;
+    }
 
-    // Perform the HTTP request
-    ApiResponse response;
-    if (esp_err_t err = esp_http_client_perform(client); err != ESP_OK) {
-        ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
-    } else {
-        response.status_code = esp_http_client_get_status_code(client);
-        response.body        = context->response_buffer;
-        response.headers     = context->response_headers;
-        ESP_LOGD(TAG, "HTTP Status = %d, content_length = %d", response.status_code,
-                 (int)esp_http_client_get_content_length(client));
+    // The request context lives on the caller's stack, so don't leave the idle client pointing at it
+    esp_http_client_set_user_data(client, nullptr);
+
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    for (auto &entry : client_pool) {
+        if (entry.handle == client) {
+            entry.in_use = false;
+            if (reusable) {
+                entry.last_used_us = esp_timer_get_time();
+            } else {
+                // Drop the connection so the next request starts from a clean state
+                esp_http_client_cleanup(entry.handle);
+                entry.handle = nullptr;
+            }
+            return;
+        }
     }
+}
 
-    // Clean up the HTTP client and request context
-    esp_http_client_cleanup(client);
-    delete context;
+ApiClient::ApiResponse ApiClient::doRequest(const std::string_view endpoint, const std::string_view method,
+                                            const std::string_view payload, const std::string_view ifNoneMatch) {
+    // Per-request context
+    RequestContext context;
+    std::string url = std::string(API_BASE_URL) + endpoint.data();
+
+    // A pooled connection the server has closed while it sat idle only shows up as a failure on the next request, before
+    // anything comes back. Those get one more try on a fresh connection.
+    ApiResponse response;
+    for (bool fresh = false;; fresh = true) {
+        // Get a client from the pool
+        bool pooled                     = false;
+        bool reused                     = false;
+        esp_http_client_handle_t client = acquireClient(url, &context, pooled, reused, fresh);
+        if (client == nullptr) {
+            return ApiResponse();
+        }
+
+        // Pooled clients keep their headers and post field between requests so reset them every time
+        esp_http_client_set_method(client, (method == "POST") ? HTTP_METHOD_POST : HTTP_METHOD_GET);
+        if (!payload.empty()) {
+            esp_http_client_set_header(client, "Content-Type", "application/json");
+            esp_http_client_set_post_field(client, payload.data(), payload.length());
+        } else {
+            esp_http_client_delete_header(client, "Content-Type");
+            esp_http_client_set_post_field(client, nullptr, 0);
+        }
+        if (!ifNoneMatch.empty()) {
+            esp_http_client_set_header(client, "If-None-Match", std::string(ifNoneMatch).c_str());
+        } else {
+            esp_http_client_delete_header(client, "If-None-Match");
+        }
+
+        ESP_LOGD(TAG, "HTTP Request: %s %s -- %s", method == "POST" ? "POST" : "GET", url.c_str(),
+                 payload.empty() ? "" : payload.data());
+
+        // Perform the HTTP request
+        bool reusable = false;
+        bool retry    = false;
+        if (esp_err_t err = esp_http_client_perform(client); err != ESP_OK) {
+            retry = reused && context.response_headers.empty() && context.response_buffer.empty();
+            if (retry) {
+                ESP_LOGW(TAG, "HTTP request on a reused connection failed: %s, retrying on a fresh one", esp_err_to_name(err));
+            } else {
+                ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
+            }
+        } else {
+            response.status_code = esp_http_client_get_status_code(client);
+            response.body        = std::move(context.response_buffer);
+            response.headers     = std::move(context.response_headers);
+            reusable             = esp_http_client_is_complete_data_received(client);
+            ESP_LOGD(TAG, "HTTP Status = %d, content_length = %d", response.status_code,
+                     (int)esp_http_client_get_content_length(client));
+        }
+
+        // Return the client to the pool, or clean it up if the connection is in an unknown state
+        releaseClient(client, pooled, reusable);
+        if (!retry) {
+            break;
+        }
+    }
 
     // // Update the WiFi status if the request failed
     // if (badge_state.wifi_status == WIFI_STATUS_CONNECTED && response.status_code >= 500) {
@@ -292,8 +407,13 @@ ApiClient::ApiResponse ApiClient::joinTower(const uint32_t towerIrCode) {
 }
 
 api_err_t ApiClient::leaveTower() {
-    if (ApiResponse response = doRequest("/badge/leave_tower", "POST");
-        response.status_code >= 300 || response.body.empty() || response.body_json()["status"] != true) {
+    ApiResponse response = doRequest("/badge/leave_tower", "POST");
+    if (response.status_code >= 300 || response.body.empty()) {
+        return api_err_t::API_FAIL;
+    }
+
+    json response_json = response.body_json();
+    if (!response_json.is_object() || response_json["status"] != true) {
         return api_err_t::API_FAIL;
     }
 
@@ -312,8 +432,8 @@ ApiClient::ApiResponse ApiClient::getTowerStatus(const uint32_t towerIrCode) {
     return doRequest(std::format("/badge/tower_status?ir_code={}", towerIrCode), "GET");
 }
 
-ApiClient::ApiResponse ApiClient::getAllTowerStatus() {
-    return doRequest("/badge/all_tower_status", "GET");
+ApiClient::ApiResponse ApiClient::getAllTowerStatus(const std::string_view etag) {
+    return doRequest("/badge/all_tower_status", "GET", "", etag);
 }
 
 ApiClient::ApiResponse ApiClient::checkIrCodes(const std::vector<uint32_t> &irCodes) {
@@ -331,6 +451,16 @@ ApiClient::ApiResponse ApiClient::requestLevelUp(const int level) {
     return doRequest("/badge/levelup", "POST", payload.dump());
 }
 
+ApiClient::ApiResponse ApiClient::reportActivity(const api_activity_interval_t *intervals, const size_t count,
+                                                 const uint32_t totalSteps) {
+    json payload = {{"total_steps", totalSteps}, {"intervals", json::array()}};
+    for (size_t i = 0; i < count; i++) {
+        payload["intervals"].push_back(
+            {{"start", intervals[i].start}, {"steps", intervals[i].steps}, {"active_seconds", intervals[i].active_s}});
+    }
+    return doRequest("/badge/activity", "POST", payload.dump());
+}
+
 // ------------------------------------------------------------------------------------------------
 // Vending API endpoints
 // ------------------------------------------------------------------------------------------------
@@ -366,6 +496,95 @@ ApiClient::ApiResponse ApiClient::getBattleStatus(const int battleId) {
     return doRequest(std::format("/battle/status/{}", battleId), "GET");
 }
 
+void ApiClient::abortBattleStatusStream() {
+    stream_aborted = true;
+}
+
+api_err_t ApiClient::streamBattleStatus(const int battleId, const std::function<bool(std::string_view line)> &onLine) {
+    // An abort only applies to the stream that was open when it was asked for
+    stream_aborted = false;
+
+    // The stream holds its connection for the whole battle, so it gets its own client rather than a pooled one
+    esp_http_client_config_t config = {};
+    std::string url                 = std::format("{}/battle/status/{}/stream", API_BASE_URL, battleId);
+    config.url                      = url.c_str();
+    config.cert_pem                 = reinterpret_cast<const char *>(isrgrootx1_cert);
+    config.cert_len                 = isrgrootx1_cert_end - isrgrootx1_cert;
+    config.method                   = HTTP_METHOD_GET;
+    config.timeout_ms               = CONFIG_API_BATTLE_STATUS_STREAM_TIMEOUT_MS;
+    config.buffer_size              = STREAM_BUFFER_SIZE;
+
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (client == nullptr) {
+        ESP_LOGE(TAG, "Failed to initialize HTTP client");
+        return api_err_t::API_FAIL;
+    }
+    esp_http_client_set_header(client, "X-API-Key", api_key.c_str());
+    esp_http_client_set_header(client, "Accept", "application/x-ndjson");
+
+    // Open the stream and make sure the server actually supports it before reading
+    if (esp_err_t err = esp_http_client_open(client, 0); err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open battle status stream: %s", esp_err_to_name(err));
+        esp_http_client_cleanup(client);
+        return api_err_t::API_FAIL;
+    }
+    esp_http_client_fetch_headers(client);
+    if (int status_code = esp_http_client_get_status_code(client); status_code != 200) {
+        ESP_LOGW(TAG, "Battle status stream unavailable: HTTP %d", status_code);
+        esp_http_client_close(client);
+        esp_http_client_cleanup(client);
+        return api_err_t::API_FAIL;
+    }
+
+    // Hand each complete line to the caller until it asks to stop, the stream is aborted or the server closes it. Reads
+    // time out in short slices to check for an abort, the stream timeout is counted across them.
+    esp_http_client_set_timeout_ms(client, STREAM_READ_SLICE_MS);
+    std::string line_buffer;
+    char buffer[STREAM_BUFFER_SIZE];
+    bool streaming = true;
+    int idle_ms    = 0;
+    api_err_t ret  = api_err_t::API_OK;
+    while (streaming && !stream_aborted) {
+        int read = esp_http_client_read(client, buffer, sizeof(buffer));
+        if (read == -ESP_ERR_HTTP_EAGAIN) {
+            idle_ms += STREAM_READ_SLICE_MS;
+            if (idle_ms >= CONFIG_API_BATTLE_STATUS_STREAM_TIMEOUT_MS) {
+                ESP_LOGD(TAG, "Battle status stream timed out");
+                break;
+            }
+            continue;
+        }
+        if (read <= 0) {
+            ESP_LOGD(TAG, "Battle status stream closed (%d)", read);
+            break;
+        }
+        idle_ms = 0;
+        line_buffer.append(buffer, read);
+
+        size_t start = 0;
+        for (size_t end; streaming && !stream_aborted && (end = line_buffer.find('\n', start)) != std::string::npos;
+             start = end + 1) {
+            std::string_view line(line_buffer.data() + start, end - start);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            streaming = onLine(line);
+        }
+        line_buffer.erase(0, start);
+
+        // Whatever is left is an unfinished line - give up on the stream rather than buffer it without bound
+        if (line_buffer.size() > STREAM_LINE_MAX) {
+            ESP_LOGW(TAG, "Battle status stream line over %d bytes, closing the stream", STREAM_LINE_MAX);
+            ret = api_err_t::API_FAIL;
+            break;
+        }
+    }
+
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+    return ret;
+}
+
 ApiClient::ApiResponse ApiClient::getSaviorCode() {
     return doRequest("/battle/savior", "GET");
 }
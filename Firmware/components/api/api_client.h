@@ -1,8 +1,14 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <format>
+#include <functional>
 #include <string>
 #include <map>
+#include <mutex>
+#include <strings.h>
+#include "sdkconfig.h"
 #include "esp_mac.h"
 #include "esp_http_client.h"
 
@@ -20,8 +26,18 @@ class ApiClient {
         std::string body;
         int status_code = -1;
         std::map<std::string, std::string, std::less<>> headers;
+        // Parses the body without exceptions - check is_discarded() on the result for invalid JSON
         json body_json() const {
-            return json::parse(body);
+            return json::parse(body, nullptr, false);
+        }
+        // Header names are case-insensitive, so look them up without relying on the server's capitalization
+        std::string_view header(const std::string_view name) const {
+            for (const auto &[key, value] : headers) {
+                if (key.size() == name.size() && strncasecmp(key.data(), name.data(), name.size()) == 0) {
+                    return value;
+                }
+            }
+            return {};
         }
     };
 
@@ -47,10 +63,11 @@ class ApiClient {
     ApiResponse joinBattle();
     ApiResponse getTowerStatus(const int towerId);
     ApiResponse getTowerStatus(const uint32_t towerIrCode);
-    ApiResponse getAllTowerStatus();
+    ApiResponse getAllTowerStatus(const std::string_view etag = "");
     ApiResponse checkIrCodes(const std::vector<uint32_t> &irCodes);
     ApiResponse equipMinibadge(const std::string_view slot1, const std::string_view slot2);
     ApiResponse requestLevelUp(const int level);
+    ApiResponse reportActivity(const api_activity_interval_t *intervals, const size_t count, const uint32_t totalSteps);
 
     // Vending API endpoints
     ApiResponse vendItems();
@@ -69,6 +86,8 @@ class ApiClient {
                            const uint32_t attackDurationMs);
     ApiResponse sendFail(const int battleId);
     ApiResponse getBattleStatus(const int battleId);
+    api_err_t streamBattleStatus(const int battleId, const std::function<bool(std::string_view line)> &onLine);
+    void abortBattleStatusStream();
     ApiResponse getSaviorCode();
     ApiResponse selfSave(const int battleId);
     ApiResponse afterActionReport(const int battleId);
@@ -85,8 +104,21 @@ class ApiClient {
         std::map<std::string, std::string, std::less<>> response_headers;
     };
 
-    ApiResponse doRequest(const std::string_view endpoint, const std::string_view method, const std::string_view payload = "");
+    struct PooledClient {
+        esp_http_client_handle_t handle = nullptr;
+        int64_t last_used_us            = 0;
+        bool in_use                     = false;
+    };
+
+    ApiResponse doRequest(const std::string_view endpoint, const std::string_view method, const std::string_view payload = "",
+                          const std::string_view ifNoneMatch = "");
+    esp_http_client_handle_t acquireClient(const std::string &url, RequestContext *context, bool &pooled, bool &reused,
+                                           bool fresh = false);
+    void releaseClient(esp_http_client_handle_t client, bool pooled, bool reusable);
 
     std::string api_key;
+    std::array<PooledClient, CONFIG_API_CLIENT_POOL_SIZE> client_pool;
+    std::mutex pool_mutex;
+    std::atomic<bool> stream_aborted = false;
     static esp_err_t httpEventHandler(esp_http_client_event_t *evt);
 };
@@ -0,0 +1,343 @@
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "api.h"
+#include "api_executor.h"
+
+#define API_EXECUTOR_TASK_STACK_SIZE 8 * 1024
+#define API_EXECUTOR_TASK_PRIORITY   5
+#define API_EXECUTOR_MAX_QUEUED      32
+
+constexpr static const char *TAG = "api_executor";
+
+// State shared between a blocking api_submit_wait() caller and the executor
+struct Waiter {
+    SemaphoreHandle_t done = nullptr;
+    api_result_t *result   = nullptr;
+    bool abandoned         = false; // Set when the caller gave up waiting, so the executor frees the result
+};
+
+struct ApiRequest {
+    api_request_id_t id;
+    api_request_fn_t request;
+    void *request_arg;
+    api_complete_cb_t callback;
+    void *user_data;
+    const void *owner;
+    int64_t submit_time_us;
+    std::shared_ptr<Waiter> waiter;
+};
+
+// Executor state - everything below is guarded by executor_mutex
+static std::mutex executor_mutex;
+static std::array<std::deque<ApiRequest>, API_PRIORITY_COUNT> queues;
+static SemaphoreHandle_t queued_sem      = nullptr;
+static TaskHandle_t executor_task_handle = nullptr;
+static api_request_id_t next_request_id  = 1;
+static api_request_id_t running_id       = 0;
+static const void *running_owner         = nullptr;
+static bool running_cancelled            = false;
+static bool running_callback             = false; // The running request's completion callback has been called
+static std::condition_variable callback_done;
+static api_executor_stats_t stats        = {};
+static uint64_t wait_time_total_ms       = 0;
+static uint32_t started_count            = 0;
+
+// Deliver a result to a blocking waiter - must be called with executor_mutex held
+static void deliver_to_waiter(const std::shared_ptr<Waiter> &waiter, api_result_t *result) {
+    if (waiter->abandoned) {
+        api_free_result(result, true);
+        return;
+    }
+    waiter->result = result;
+    xSemaphoreGive(waiter->done);
+}
+
+// Pop the next request in priority order - must be called with executor_mutex held
+static bool pop_next(ApiRequest &request) {
+    for (size_t i = 0; i < queues.size(); i++) {
+        if (!queues[i].empty()) {
+            request = std::move(queues[i].front());
+            queues[i].pop_front();
+            stats.priority_depth[i]--;
+            stats.queue_depth--;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void api_executor_task(void *_args) {
+    (void)_args;
+    while (true) {
+        xSemaphoreTake(queued_sem, portMAX_DELAY);
+
+        ApiRequest request;
+        {
+            std::lock_guard<std::mutex> lock(executor_mutex);
+            if (!pop_next(request)) {
+                continue; // Cancelled while queued
+            }
+            running_id        = request.id;
+            running_owner     = request.owner;
+            running_cancelled = false;
+
+            // Track how long the request sat in the queue
+            uint32_t wait_ms        = (esp_timer_get_time() - request.submit_time_us) / 1000;
+            stats.wait_time_last_ms = wait_ms;
+            if (wait_ms > stats.wait_time_max_ms) {
+                stats.wait_time_max_ms = wait_ms;
+            }
+            wait_time_total_ms += wait_ms;
+            started_count++;
+            stats.wait_time_avg_ms = wait_time_total_ms / started_count;
+        }
+
+        // Run the request without holding the lock
+        api_result_t *result = request.request(request.request_arg);
+
+        bool cancelled;
+        {
+            std::lock_guard<std::mutex> lock(executor_mutex);
+            cancelled = running_cancelled;
+            if (!cancelled) {
+                stats.completed++;
+            }
+            if (cancelled || request.callback == nullptr) {
+                running_id    = 0;
+                running_owner = nullptr;
+            } else {
+                // Past this point the request can't be cancelled, api_cancel() waits for the callback to return instead
+                running_callback = true;
+            }
+            if (request.waiter != nullptr) {
+                // Waiters are woken with a NULL result on cancellation so they don't block until their timeout
+                deliver_to_waiter(request.waiter, cancelled ? nullptr : result);
+                if (cancelled) {
+                    api_free_result(result, true);
+                }
+                continue;
+            }
+        }
+
+        if (cancelled) {
+            ESP_LOGD(TAG, "Request %lu was cancelled while running, dropping result", request.id);
+            api_free_result(result, true);
+        } else if (request.callback == nullptr) {
+            api_free_result(result, true);
+        } else {
+            request.callback(result, request.user_data);
+
+            {
+                std::lock_guard<std::mutex> lock(executor_mutex);
+                running_id       = 0;
+                running_owner    = nullptr;
+                running_callback = false;
+            }
+            callback_done.notify_all();
+        }
+    }
+}
+
+// Queue a request - must be called with executor_mutex held
+static api_request_id_t enqueue(api_priority_t priority, ApiRequest &&request) {
+    if (stats.queue_depth >= API_EXECUTOR_MAX_QUEUED) {
+        ESP_LOGE(TAG, "API executor queue is full, dropping request");
+        return 0;
+    }
+
+    request.id = next_request_id++;
+    if (next_request_id == 0) {
+        next_request_id = 1;
+    }
+    request.submit_time_us = esp_timer_get_time();
+    api_request_id_t id    = request.id;
+    queues[priority].emplace_back(std::move(request));
+
+    stats.submitted++;
+    stats.priority_depth[priority]++;
+    stats.queue_depth++;
+    if (stats.queue_depth > stats.queue_depth_max) {
+        stats.queue_depth_max = stats.queue_depth;
+    }
+
+    xSemaphoreGive(queued_sem);
+    return id;
+}
+
+extern "C" esp_err_t api_executor_init() {
+    if (executor_task_handle != nullptr) {
+        return ESP_OK;
+    }
+
+    queued_sem = xSemaphoreCreateCounting(API_EXECUTOR_MAX_QUEUED, 0);
+    if (queued_sem == nullptr) {
+        ESP_LOGE(TAG, "Failed to create API executor semaphore");
+        return ESP_FAIL;
+    }
+
+    if (xTaskCreate(api_executor_task, "api_executor_task", API_EXECUTOR_TASK_STACK_SIZE, nullptr, API_EXECUTOR_TASK_PRIORITY,
+                    &executor_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create API executor task");
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+extern "C" api_request_id_t api_submit(api_priority_t priority, api_request_fn_t request, void *request_arg,
+                                       api_complete_cb_t callback, void *user_data, const void *owner) {
+    if (executor_task_handle == nullptr || request == nullptr || priority >= API_PRIORITY_COUNT) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(executor_mutex);
+    return enqueue(priority, ApiRequest{
+                                 .id             = 0,
+                                 .request        = request,
+                                 .request_arg    = request_arg,
+                                 .callback       = callback,
+                                 .user_data      = user_data,
+                                 .owner          = owner,
+                                 .submit_time_us = 0,
+                                 .waiter         = nullptr,
+                             });
+}
+
+extern "C" api_result_t *api_submit_wait(api_priority_t priority, api_request_fn_t request, void *request_arg,
+                                         const void *owner, TickType_t timeout) {
+    if (executor_task_handle == nullptr || request == nullptr || priority >= API_PRIORITY_COUNT) {
+        return nullptr;
+    }
+
+    // A request submitted from the executor task itself would deadlock, so run it inline instead
+    if (xTaskGetCurrentTaskHandle() == executor_task_handle) {
+        return request(request_arg);
+    }
+
+    auto waiter  = std::make_shared<Waiter>();
+    waiter->done = xSemaphoreCreateBinary();
+    if (waiter->done == nullptr) {
+        return nullptr;
+    }
+
+    api_request_id_t id;
+    {
+        std::lock_guard<std::mutex> lock(executor_mutex);
+        id = enqueue(priority, ApiRequest{
+                                   .id             = 0,
+                                   .request        = request,
+                                   .request_arg    = request_arg,
+                                   .callback       = nullptr,
+                                   .user_data      = nullptr,
+                                   .owner          = owner,
+                                   .submit_time_us = 0,
+                                   .waiter         = waiter,
+                               });
+    }
+
+    api_result_t *result = nullptr;
+    if (id != 0) {
+        bool completed = xSemaphoreTake(waiter->done, timeout) == pdTRUE;
+        std::unique_lock<std::mutex> lock(executor_mutex);
+        if (!completed && xSemaphoreTake(waiter->done, 0) != pdTRUE) {
+            // Timed out - the executor frees the result if the request still completes later
+            ESP_LOGW(TAG, "Timed out waiting for request %lu", id);
+            waiter->abandoned = true;
+            lock.unlock();
+            api_cancel(id);
+        } else {
+            result = waiter->result;
+        }
+    }
+
+    vSemaphoreDelete(waiter->done);
+    waiter->done = nullptr;
+    return result;
+}
+
+// Cancel queued and running requests matching a predicate - must be called with executor_mutex held. A matching request
+// whose callback is already running can't be cancelled any more, its ID is returned in busy_id to wait for.
+template <typename Pred> static int cancel_matching(Pred &&matches, api_request_id_t &busy_id) {
+    int count = 0;
+    busy_id   = 0;
+    for (size_t i = 0; i < queues.size(); i++) {
+        auto &queue = queues[i];
+        for (auto it = queue.begin(); it != queue.end();) {
+            if (matches(it->id, it->owner)) {
+                if (it->waiter != nullptr) {
+                    deliver_to_waiter(it->waiter, nullptr);
+                }
+                it = queue.erase(it);
+                stats.priority_depth[i]--;
+                stats.queue_depth--;
+                stats.cancelled++;
+                count++;
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (running_id != 0 && matches(running_id, running_owner)) {
+        if (running_callback) {
+            busy_id = running_id;
+        } else if (!running_cancelled) {
+            running_cancelled = true;
+            stats.cancelled++;
+            count++;
+        }
+    }
+    return count;
+}
+
+// Block until the callback of a request that was too far along to cancel has returned - must be called with
+// executor_mutex held through the lock. A callback cancelling its own request doesn't wait for itself.
+static void wait_for_callback(std::unique_lock<std::mutex> &lock, api_request_id_t busy_id) {
+    if (busy_id == 0 || xTaskGetCurrentTaskHandle() == executor_task_handle) {
+        return;
+    }
+    ESP_LOGD(TAG, "Waiting for the callback of request %lu", busy_id);
+    callback_done.wait(lock, [busy_id] { return running_id != busy_id; });
+}
+
+extern "C" bool api_cancel(api_request_id_t id) {
+    if (id == 0) {
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(executor_mutex);
+    api_request_id_t busy_id;
+    int count = cancel_matching([id](api_request_id_t request_id, const void *) { return request_id == id; }, busy_id);
+    wait_for_callback(lock, busy_id);
+    return count > 0;
+}
+
+extern "C" int api_cancel_owner(const void *owner) {
+    if (owner == nullptr) {
+        return 0;
+    }
+    std::unique_lock<std::mutex> lock(executor_mutex);
+    api_request_id_t busy_id;
+    int count = cancel_matching([owner](api_request_id_t, const void *request_owner) { return request_owner == owner; },
+                                busy_id);
+    if (count > 0) {
+        ESP_LOGD(TAG, "Cancelled %d request(s) for owner %p", count, owner);
+    }
+    wait_for_callback(lock, busy_id);
+    return count;
+}
+
+extern "C" void api_executor_get_stats(api_executor_stats_t *out) {
+    if (out == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(executor_mutex);
+    *out = stats;
+}
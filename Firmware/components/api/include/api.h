@@ -6,9 +6,20 @@ extern "C" {
 
 #include <stdint.h>
 #include <stddef.h>
+#include "sdkconfig.h"
 #include "types.h"
 
-#define API_BASE_URL "https://sc24.redactd.net"
+#define API_BASE_URL CONFIG_API_BASE_URL
+
+/**
+ * @brief Callback for battle status stream updates
+ *
+ * @param[in] result A result struct containing the latest battle status, or NULL for a keep-alive - the callback owns the result
+ * @param[in] user_data The user data passed to api_stream_battle_status
+ *
+ * @return true to keep the stream open, false to close it
+ */
+typedef bool (*api_battle_status_stream_cb_t)(api_result_t *result, void *user_data);
 
 /**
  * @brief API result data free function to free allocated memory for result data structs
@@ -128,6 +139,18 @@ api_result_t *api_get_tower_status_by_ir_code(const uint32_t ir_code);
  */
 api_result_t *api_get_all_tower_status();
 
+/**
+ * @brief Get the status of all towers if anything changed since the given ETag
+ *
+ * @note If nothing changed the result has not_modified set and no towers. The server may also answer with only the
+ * towers that changed, in which case delta is set.
+ *
+ * @param[in] etag The ETag from the previous result, or NULL to always get the full list
+ *
+ * @return A result struct containing the status of all towers or only the changed ones
+ */
+api_result_t *api_get_all_tower_status_if_changed(const char *etag);
+
 /**
  * @brief Check IR codes.
  *
@@ -157,6 +180,17 @@ api_result_t *api_equip_minibadge(const char *slot1, const char *slot2);
  */
 api_result_t *api_request_level_up(const int level);
 
+/**
+ * @brief Report step counts and active time
+ *
+ * @param[in] intervals Hourly activity, oldest first
+ * @param[in] count The number of intervals
+ * @param[in] total_steps Lifetime step count
+ *
+ * @return A result struct containing the report status
+ */
+api_result_t *api_report_activity(const api_activity_interval_t *intervals, size_t count, uint32_t total_steps);
+
 /**
  * @brief Retrieve the list of items available to purchase
  *
@@ -203,6 +237,30 @@ api_result_t *api_send_attack_fail(int battle_id);
  */
 api_result_t *api_get_battle_status(int battle_id);
 
+/**
+ * @brief Stream battle status updates, blocking until the stream closes
+ *
+ * @note The server sends one JSON object per line in the same format as api_get_battle_status. Updates after the first
+ * may only contain the fields that changed - they are merged onto the previous status before the callback is called.
+ *
+ * @param[in] battle_id The ID of the battle to stream the status for
+ * @param[in] callback The function to call for each status update and keep-alive
+ * @param[in] user_data User data to pass to the callback
+ *
+ * @return API_OK if the stream was opened and delivered at least one update, API_FAIL if streaming is unavailable or the
+ * server sent a line too long to buffer
+ */
+api_err_t api_stream_battle_status(int battle_id, api_battle_status_stream_cb_t callback, void *user_data);
+
+/**
+ * @brief Close the open battle status stream from another task
+ *
+ * @note api_stream_battle_status stops calling its callback and returns within a fraction of a second, or as soon as the
+ * connection is up if it is still opening. A stream opened after this call isn't affected, so callers still need to
+ * check in the callback whether the stream is wanted.
+ */
+void api_abort_battle_status_stream();
+
 /**
  * @brief Get the savior code if you are a savior
  *
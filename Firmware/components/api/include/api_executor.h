@@ -0,0 +1,129 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "types.h"
+
+/**
+ * @brief Priority of a request submitted to the API executor - lower values are run first
+ */
+typedef enum {
+    API_PRIORITY_HIGH,   // Time critical requests (battle attacks, savior codes, high-priority IR codes)
+    API_PRIORITY_NORMAL, // User initiated requests and battle status polling
+    API_PRIORITY_LOW,    // Background refreshes (tower info, periodic IR code checks)
+    API_PRIORITY_COUNT,
+} api_priority_t;
+
+// Identifier for a submitted request - 0 is never a valid ID
+typedef uint32_t api_request_id_t;
+
+/**
+ * @brief Function that performs a request on the executor task, normally a thin wrapper around one of the api_* calls
+ *
+ * @param[in] arg The request argument passed to api_submit()
+ *
+ * @return The API result, which is handed to the completion callback
+ */
+typedef api_result_t *(*api_request_fn_t)(void *arg);
+
+/**
+ * @brief Completion callback for a submitted request - called on the executor task, so it must not block for long
+ *
+ * @param[in] result The API result (may be NULL on failure) - ownership passes to the callback
+ * @param[in] user_data The user data passed to api_submit()
+ */
+typedef void (*api_complete_cb_t)(api_result_t *result, void *user_data);
+
+/**
+ * @brief API executor metrics
+ */
+typedef struct {
+    uint32_t queue_depth;                         // Requests currently waiting to run
+    uint32_t queue_depth_max;                     // Highest queue depth seen
+    uint32_t priority_depth[API_PRIORITY_COUNT];  // Requests currently waiting to run by priority
+    uint32_t submitted;                           // Total requests submitted
+    uint32_t completed;                           // Total requests run to completion
+    uint32_t cancelled;                           // Total requests cancelled before their callback ran
+    uint32_t wait_time_last_ms;                   // Queue wait time of the most recently started request
+    uint32_t wait_time_max_ms;                    // Longest queue wait time seen
+    uint32_t wait_time_avg_ms;                    // Average queue wait time across all started requests
+} api_executor_stats_t;
+
+/**
+ * @brief Start the API executor task
+ *
+ * @return ESP_OK on success or an error code on failure
+ */
+esp_err_t api_executor_init();
+
+/**
+ * @brief Queue a request on the API executor
+ *
+ * @param[in] priority The request priority
+ * @param[in] request The function that performs the request
+ * @param[in] request_arg Argument passed to the request function, must stay valid until it returns
+ * @param[in] callback Completion callback (may be NULL, in which case the result is freed)
+ * @param[in] user_data User data passed to the completion callback
+ * @param[in] owner Optional owner tag used to cancel every request from one owner with api_cancel_owner()
+ *
+ * @return The request ID, or 0 if the request could not be queued
+ */
+api_request_id_t api_submit(api_priority_t priority, api_request_fn_t request, void *request_arg, api_complete_cb_t callback,
+                            void *user_data, const void *owner);
+
+/**
+ * @brief Queue a request on the API executor and block until it completes
+ *
+ * @note request_arg must stay valid until the request function returns, even after this call has timed out. A request
+ * that already started keeps running on the executor task, so an argument on the caller's stack needs portMAX_DELAY.
+ *
+ * @param[in] priority The request priority
+ * @param[in] request The function that performs the request
+ * @param[in] request_arg Argument passed to the request function, must outlive the request - see the note above
+ * @param[in] owner Optional owner tag used to cancel every request from one owner with api_cancel_owner()
+ * @param[in] timeout Maximum time to wait for the request to complete
+ *
+ * @return The API result, or NULL if the request failed, was cancelled or timed out
+ */
+api_result_t *api_submit_wait(api_priority_t priority, api_request_fn_t request, void *request_arg, const void *owner,
+                              TickType_t timeout);
+
+/**
+ * @brief Cancel a request - a queued request is dropped, a running request has its result freed instead of delivered
+ *
+ * @note If the request's completion callback has already been called this waits for it to return, so no callback for the
+ * request runs after this returns. Don't call it holding a lock that callback takes.
+ *
+ * @param[in] id The request ID returned by api_submit()
+ *
+ * @return True if the request was found and cancelled
+ */
+bool api_cancel(api_request_id_t id);
+
+/**
+ * @brief Cancel every queued or running request submitted with the given owner tag
+ *
+ * @note Like api_cancel(), waits for a completion callback of the owner's that is already running to return.
+ *
+ * @param[in] owner The owner tag passed to api_submit()
+ *
+ * @return The number of requests cancelled
+ */
+int api_cancel_owner(const void *owner);
+
+/**
+ * @brief Get a snapshot of the API executor metrics
+ *
+ * @param[out] stats The metrics snapshot
+ */
+void api_executor_get_stats(api_executor_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,6 +5,7 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 enum class api_err_t {
@@ -146,6 +147,10 @@ typedef struct {
 typedef struct {
     api_tower_info_t *towers; // Array of tower status results
     int count;                // Number of tower status results
+    char *etag;               // ETag to send with the next request, or NULL if the server didn't send one
+    bool not_modified;        // Nothing changed since the ETag that was sent - towers is empty
+    bool delta;               // Only the towers that changed since the ETag that was sent are included
+    size_t body_size;         // Size of the response body in bytes
 } api_all_tower_info_t;
 
 /**
@@ -302,6 +307,19 @@ typedef struct {
     int coins_earned;
 } api_after_action_report_t;
 
+// -----------------------------------------------------------------------------
+// API request data
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief One hour of activity sent to the /badge/activity endpoint
+ */
+typedef struct {
+    uint32_t start;    // Start of the hour, unix time - 0 if the clock wasn't set yet
+    uint32_t steps;    // Steps counted during the hour
+    uint32_t active_s; // Seconds spent moving during the hour
+} api_activity_interval_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,294 @@
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+
+#include "accel.h"
+#include "activity.h"
+#include "api_executor.h"
+#include "badge.h"
+#include "nvs.h"
+
+static const char *TAG = "badge/activity";
+
+#define ACTIVITY_NVS_NAMESPACE "activity"
+#define ACTIVITY_RECORD_MAGIC  0x41435431 // "ACT1", change with the record layout
+#define ACTIVITY_CLOCK_VALID   1704067200 // 2024-01-01, anything earlier means SNTP hasn't set the clock yet
+
+// Everything that has to outlive a restart. Kept in RTC memory and written to NVS as a whole.
+typedef struct {
+    uint32_t magic;
+    uint32_t steps;    // Lifetime steps
+    uint32_t active_s; // Lifetime seconds spent moving
+    uint8_t first;     // Oldest unreported hour in intervals
+    uint8_t count;     // Unreported hours, the newest one may still be filling up
+    api_activity_interval_t intervals[ACTIVITY_MAX_INTERVALS];
+    uint32_t crc; // Over everything above
+} activity_record_t;
+
+// Not cleared on restart, so steps since the last flush aren't lost to a crash, an OTA update or deep sleep
+static RTC_NOINIT_ATTR activity_record_t record;
+static portMUX_TYPE record_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Step counter totals already folded into the record - they start from zero on every boot like the counter
+static uint32_t folded_steps          = 0;
+static uint32_t folded_active_samples = 0;
+static uint32_t folded_samples        = 0;
+static int64_t last_update_us         = 0;
+static uint32_t active_remainder_ms   = 0;
+
+// Flush and report bookkeeping, badge event task only
+static bool dirty             = false;
+static int64_t last_flush_us  = 0;
+static int64_t last_report_us = 0;
+static uint32_t flash_writes  = 0;
+static uint32_t reports       = 0;
+
+static uint32_t record_crc(const activity_record_t *r) {
+    return esp_rom_crc32_le(0, (const uint8_t *)r, offsetof(activity_record_t, crc));
+}
+
+static bool record_valid(const activity_record_t *r) {
+    return r->magic == ACTIVITY_RECORD_MAGIC && r->first < ACTIVITY_MAX_INTERVALS && r->count <= ACTIVITY_MAX_INTERVALS &&
+           r->crc == record_crc(r);
+}
+
+static void record_reset(activity_record_t *r) {
+    memset(r, 0, sizeof(*r));
+    r->magic = ACTIVITY_RECORD_MAGIC;
+    r->crc   = record_crc(r);
+}
+
+static api_activity_interval_t *record_interval(activity_record_t *r, uint8_t index) {
+    return &r->intervals[(r->first + index) % ACTIVITY_MAX_INTERVALS];
+}
+
+/**
+ * @brief Get the interval for the current hour, starting a new one if the hour changed
+ *     When the ring is full the two oldest hours are merged, so the totals reported to the API stay right.
+ */
+static api_activity_interval_t *current_interval(activity_record_t *r, uint32_t hour) {
+    if (r->count > 0) {
+        api_activity_interval_t *newest = record_interval(r, r->count - 1);
+        if (newest->start == hour) {
+            return newest;
+        }
+    }
+
+    if (r->count == ACTIVITY_MAX_INTERVALS) {
+        api_activity_interval_t *oldest = record_interval(r, 0);
+        api_activity_interval_t *next   = record_interval(r, 1);
+        next->start                     = oldest->start;
+        next->steps                    += oldest->steps;
+        next->active_s                 += oldest->active_s;
+        r->first                        = (r->first + 1) % ACTIVITY_MAX_INTERVALS;
+        r->count--;
+    }
+
+    api_activity_interval_t *interval = record_interval(r, r->count++);
+    *interval                         = (api_activity_interval_t){.start = hour};
+    return interval;
+}
+
+static esp_err_t flush_record() {
+    if (!nvs_ready()) {
+        return ESP_FAIL;
+    }
+
+    activity_record_t copy;
+    portENTER_CRITICAL(&record_lock);
+    copy = record;
+    portEXIT_CRITICAL(&record_lock);
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(ACTIVITY_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error (%s) opening NVS handle", esp_err_to_name(err));
+        return err;
+    }
+    err = nvs_set_blob(nvs_handle, "record", &copy, sizeof(copy));
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error (%s) saving activity", esp_err_to_name(err));
+        return err;
+    }
+
+    flash_writes++;
+    ESP_LOGD(TAG, "Activity saved: %lu steps, %lu active seconds, %u hours pending", copy.steps, copy.active_s, copy.count);
+    return ESP_OK;
+}
+
+static esp_err_t load_record() {
+    if (!nvs_ready()) {
+        return ESP_FAIL;
+    }
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(ACTIVITY_NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    activity_record_t stored;
+    size_t size = sizeof(stored);
+    err         = nvs_get_blob(nvs_handle, "record", &stored, &size);
+    nvs_close(nvs_handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (size != sizeof(stored) || !record_valid(&stored)) {
+        ESP_LOGW(TAG, "Stored activity is invalid, starting over");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    record = stored;
+    return ESP_OK;
+}
+
+// Arguments for report_activity_request() - lives on the caller's stack, so the report waits for the request to finish
+typedef struct {
+    const api_activity_interval_t *intervals;
+    size_t count;
+    uint32_t total_steps;
+} activity_report_t;
+
+static api_result_t *report_activity_request(void *arg) {
+    activity_report_t *report = arg;
+    return api_report_activity(report->intervals, report->count, report->total_steps);
+}
+
+/**
+ * @brief Send every finished hour to the API in one request, and drop them from the record once it's accepted
+ */
+static void report_intervals(uint32_t hour) {
+    api_activity_interval_t intervals[ACTIVITY_MAX_INTERVALS];
+    activity_report_t report = {.intervals = intervals};
+
+    portENTER_CRITICAL(&record_lock);
+    for (uint8_t i = 0; i < record.count; i++) {
+        api_activity_interval_t *interval = record_interval(&record, i);
+        if (interval->start == hour) {
+            break; // Still filling up
+        }
+        intervals[report.count++] = *interval;
+    }
+    report.total_steps = record.steps;
+    portEXIT_CRITICAL(&record_lock);
+
+    if (report.count == 0) {
+        return;
+    }
+
+    api_result_t *result = api_submit_wait(API_PRIORITY_LOW, report_activity_request, &report, NULL, portMAX_DELAY);
+    if (result == NULL || !result->status) {
+        ESP_LOGW(TAG, "Failed to report %d hours of activity", (int)report.count);
+        api_free_result(result, true);
+        return;
+    }
+    api_free_result(result, true);
+
+    // This task is the only one that adds intervals, so the reported ones are still at the front
+    portENTER_CRITICAL(&record_lock);
+    record.first  = (record.first + report.count) % ACTIVITY_MAX_INTERVALS;
+    record.count -= report.count;
+    record.crc    = record_crc(&record);
+    portEXIT_CRITICAL(&record_lock);
+    dirty = true;
+    reports++;
+    ESP_LOGD(TAG, "Reported %d hours of activity", (int)report.count);
+}
+
+esp_err_t activity_init() {
+    if (record_valid(&record)) {
+        // Restarted without losing power, RTC memory is at least as new as NVS
+        ESP_LOGI(TAG, "Activity kept across restart: %lu steps", record.steps);
+        dirty = true;
+    } else if (load_record() == ESP_OK) {
+        ESP_LOGI(TAG, "Activity loaded: %lu steps", record.steps);
+    } else {
+        record_reset(&record);
+    }
+
+    last_update_us = esp_timer_get_time();
+    last_flush_us  = last_update_us;
+    last_report_us = last_update_us - (int64_t)ACTIVITY_REPORT_INTERVAL * 1000; // Report as soon as there's a connection
+    return ESP_OK;
+}
+
+void activity_update() {
+    int64_t now_us = esp_timer_get_time();
+    time_t now     = time(NULL);
+    uint32_t hour  = now >= ACTIVITY_CLOCK_VALID ? now - now % 3600 : 0;
+
+    // Active time comes from the share of samples spent moving, so it doesn't depend on the sample rate
+    accel_steps_stats_t steps_stats;
+    accel_steps_get_stats(&steps_stats);
+    uint32_t steps          = steps_stats.steps - folded_steps;
+    uint32_t active_samples = steps_stats.active_samples - folded_active_samples;
+    uint32_t samples        = steps_stats.samples - folded_samples;
+    uint32_t elapsed_ms     = (now_us - last_update_us) / 1000;
+    folded_steps            = steps_stats.steps;
+    folded_active_samples   = steps_stats.active_samples;
+    folded_samples          = steps_stats.samples;
+    last_update_us          = now_us;
+
+    uint32_t active_ms  = samples > 0 ? (uint64_t)elapsed_ms * active_samples / samples : 0;
+    active_ms          += active_remainder_ms;
+    active_remainder_ms = active_ms % 1000;
+
+    if (steps > 0 || active_ms >= 1000) {
+        portENTER_CRITICAL(&record_lock);
+        api_activity_interval_t *interval = current_interval(&record, hour);
+        interval->steps                  += steps;
+        interval->active_s               += active_ms / 1000;
+        record.steps                     += steps;
+        record.active_s                  += active_ms / 1000;
+        record.crc                        = record_crc(&record);
+        portEXIT_CRITICAL(&record_lock);
+        dirty = true;
+    }
+
+    // Report in one batch once an hour, finished hours only so an interval is never sent twice
+    if (badge_state.wifi_status == WIFI_STATUS_CONNECTED && badge_config.registered &&
+        now_us - last_report_us >= (int64_t)ACTIVITY_REPORT_INTERVAL * 1000) {
+        last_report_us = now_us;
+        report_intervals(hour);
+    }
+
+    // Flash is only written when something changed and the last write was long enough ago. A crash or restart keeps the
+    // RTC copy, so at most one flush interval of steps is lost, and only to a power cut.
+    if (dirty && now_us - last_flush_us >= (int64_t)ACTIVITY_FLUSH_INTERVAL * 1000) {
+        last_flush_us = now_us;
+        if (flush_record() == ESP_OK) {
+            dirty = false;
+        }
+    }
+}
+
+void activity_get_stats(activity_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    accel_steps_stats_t steps_stats;
+    accel_steps_get_stats(&steps_stats);
+
+    portENTER_CRITICAL(&record_lock);
+    stats->steps             = record.steps;
+    stats->active_s          = record.active_s;
+    stats->pending_intervals = record.count;
+    portEXIT_CRITICAL(&record_lock);
+
+    // Include the steps counted since the last fold so the number moves while walking
+    int64_t uptime_us        = esp_timer_get_time();
+    stats->steps            += steps_stats.steps - folded_steps;
+    stats->reports           = reports;
+    stats->flash_writes      = flash_writes;
+    stats->flash_writes_hour = uptime_us > 0 ? (uint64_t)flash_writes * 3600 * 1000000 / uptime_us : 0;
+    stats->sample_cycles     = steps_stats.samples > 0 ? steps_stats.cycles / steps_stats.samples : 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "api.h"
+
+#define ACTIVITY_UPDATE_INTERVAL 60 * 1000      // Fold new steps into the running totals every minute (ms)
+#define ACTIVITY_FLUSH_INTERVAL  30 * 60 * 1000 // Write changed totals to flash at most this often (ms)
+#define ACTIVITY_REPORT_INTERVAL 60 * 60 * 1000 // Report finished hours to the API at most this often (ms)
+#define ACTIVITY_MAX_INTERVALS   24             // Unreported hours kept, older ones are merged together
+
+typedef struct {
+    uint32_t steps;             // Lifetime steps, including the ones not folded in yet
+    uint32_t active_s;          // Lifetime seconds spent moving
+    uint32_t pending_intervals; // Hours waiting to be reported
+    uint32_t reports;           // Successful reports since boot
+    uint32_t flash_writes;      // Writes to NVS since boot
+    uint32_t flash_writes_hour; // Writes to NVS per hour of uptime
+    uint32_t sample_cycles;     // Average CPU cycles per sample spent counting steps
+} activity_stats_t;
+
+/**
+ * @brief Restore the activity totals
+ *     The totals live in RTC memory, which survives restarts and deep sleep, and are only copied to NVS now and then to
+ *     cover power loss. After a power cycle they are loaded back from NVS.
+ *
+ * @return ESP_OK on success or an error code on failure
+ */
+esp_err_t activity_init();
+
+/**
+ * @brief Fold new steps into the totals, flush them to NVS and report finished hours to the API when due
+ *     Call every ACTIVITY_UPDATE_INTERVAL from the badge event task, the report blocks while the request runs.
+ */
+void activity_update();
+
+/**
+ * @brief Get the activity totals and counters
+ *
+ * @param[out] stats Totals and counters
+ */
+void activity_get_stats(activity_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,7 +8,9 @@
 #include "esp_spiffs.h"
 #include "esp_timer.h"
 
+#include "accel.h"
 #include "api.h"
+#include "api_executor.h"
 #include "badge.h"
 #include "display.h"
 #include "ir.h"
@@ -39,6 +41,7 @@ typedef enum {
     // BADGE_EVENT_DISPLAY,
     BADGE_EVENT_OTA,
     BADGE_EVENT_OTA_CHECK,
+    BADGE_EVENT_ACTIVITY,
 } badge_event_type_t;
 
 // Badge event data
@@ -57,10 +60,16 @@ typedef struct {
 QueueHandle_t badge_event_queue = NULL;
 
 // Screen timer
+#define SCREEN_DIM_LEVEL    20
+#define SCREEN_DIM_FADE_MS  500 // Ease down to the dimmed level
+#define SCREEN_WAKE_FADE_MS 100 // Short enough to feel immediate on touch
 esp_timer_handle_t screen_timer = NULL;
 static bool screen_off          = false;
 static void screen_timeout_callback(void *arg);
 
+// Activity timer, folds new steps into the totals from the event task
+esp_timer_handle_t activity_timer = NULL;
+
 // Badge event handling task
 void badge_event_task(void *_args);
 
@@ -77,6 +86,11 @@ void ota_state_callback(ota_state_t ota_state) {
     xQueueSend(badge_event_queue, &event, 0);
 }
 
+static void activity_timer_callback(void *arg) {
+    badge_event_t event = {.type = BADGE_EVENT_ACTIVITY};
+    xQueueSend(badge_event_queue, &event, 0);
+}
+
 void minibadge_event_callback(minibadge_event_t event) {
     ESP_LOGD(TAG, "Minibadge %s - slot %d", event.type == MINIBADGE_EVENT_INSERTED ? "inserted" : "removed", event.slot + 1);
 
@@ -91,6 +105,20 @@ void minibadge_event_callback(minibadge_event_t event) {
     xQueueSend(badge_event_queue, &badge_event, 0);
 }
 
+// API request wrappers for the executor - these run on the API executor task
+static api_result_t *equip_minibadge_request(void *arg) {
+    char (*slot_serial)[32 + 1] = arg;
+    return api_equip_minibadge(slot_serial[0], slot_serial[1]);
+}
+
+static api_result_t *get_badge_data_request(void *arg) {
+    return api_get_badge_data();
+}
+
+static api_result_t *register_request(void *arg) {
+    return api_register((const char *)arg);
+}
+
 static void send_minibadge_status() {
     // Get the serial numbers of the minibadges
     char minibadge_slot_serial[MINIBADGE_SLOT_COUNT][32 + 1] = {0}; // 16 bytes but we'll be converting to hex
@@ -107,7 +135,8 @@ static void send_minibadge_status() {
     ESP_LOGD(TAG, "Minibadge slot 2 serial: %s", minibadge_slot_serial[1]);
 
     // Send the minibadge event to the API
-    api_result_t *result = api_equip_minibadge(&minibadge_slot_serial[0], &minibadge_slot_serial[1]);
+    api_result_t *result =
+        api_submit_wait(API_PRIORITY_NORMAL, equip_minibadge_request, minibadge_slot_serial, NULL, portMAX_DELAY);
     if (result == NULL || result->status == false) {
         ESP_LOGE(TAG, "Failed to equip minibadge");
         api_free_result(result, true);
@@ -130,20 +159,45 @@ static void send_minibadge_status() {
 
 void screen_reset_timeout() {
     if (screen_off) {
-        set_backlight(badge_config.brightness);
+        fade_backlight(badge_config.brightness, SCREEN_WAKE_FADE_MS);
         screen_off = false;
     }
-    if (esp_timer_is_active(screen_timer)) {
-        ESP_ERROR_CHECK(esp_timer_stop(screen_timer));
+
+    // Called for every touch event, so push the running timer back in one call instead of a stop and start
+    uint64_t timeout_us = (uint64_t)badge_config.screen_timeout * 1000000;
+    if (esp_timer_restart(screen_timer, timeout_us) == ESP_ERR_INVALID_STATE) {
+        ESP_ERROR_CHECK(esp_timer_start_once(screen_timer, timeout_us));
     }
-    ESP_ERROR_CHECK(esp_timer_start_once(screen_timer, badge_config.screen_timeout * 1000000));
 }
 
 static void screen_timeout_callback(void *arg) {
-    set_backlight(20);
+    fade_backlight(SCREEN_DIM_LEVEL, SCREEN_DIM_FADE_MS);
     screen_off = true;
 }
 
+void screen_sleep() {
+    esp_timer_stop(screen_timer);
+    if (!screen_off) {
+        screen_timeout_callback(NULL);
+    }
+}
+
+// Raising the wrist, tapping or shaking wakes the screen like a touch would, turning the badge face down puts it to sleep
+static void gesture_callback(const accel_gesture_event_t *event) {
+    switch (event->gesture) {
+        case ACCEL_GESTURE_WRIST_RAISE:
+        case ACCEL_GESTURE_DOUBLE_TAP:
+        case ACCEL_GESTURE_SHAKE: //
+            screen_reset_timeout();
+            break;
+        case ACCEL_GESTURE_FLIP: //
+            screen_sleep();
+            break;
+        default: //
+            break;
+    }
+}
+
 esp_err_t badge_init() {
     esp_err_t err = load_badge_config();
     if (err != ESP_OK) {
@@ -163,6 +217,12 @@ esp_err_t badge_init() {
     // Create the badge event queue
     badge_event_queue = xQueueCreate(BADGE_EVENT_QUEUE_SIZE, sizeof(badge_event_t));
 
+    // Restore the activity totals before the step counter gets going
+    err = activity_init();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to restore activity: %s", esp_err_to_name(err));
+    }
+
     // Print the firmware version
     const esp_app_desc_t *app_desc = esp_app_get_description();
     ESP_LOGI(TAG,
@@ -212,6 +272,12 @@ esp_err_t badge_init() {
         }
     }
 
+    // Start the API executor before anything that makes API requests
+    err = api_executor_init();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize API executor: %s", esp_err_to_name(err));
+    }
+
     // Add wifi status callback
     add_wifi_status_callback(wifi_status_callback);
 
@@ -246,6 +312,20 @@ esp_err_t badge_init() {
         ESP_LOGE(TAG, "Failed to create screen timer: %s", esp_err_to_name(err));
     }
     screen_reset_timeout();
+    accel_add_gesture_callback(gesture_callback);
+
+    // Create the activity timer
+    const esp_timer_create_args_t activity_timer_args = {
+        .callback = &activity_timer_callback,
+        .name     = "activity_timer",
+    };
+    err = esp_timer_create(&activity_timer_args, &activity_timer);
+    if (err == ESP_OK) {
+        err = esp_timer_start_periodic(activity_timer, (uint64_t)ACTIVITY_UPDATE_INTERVAL * 1000);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start activity timer: %s", esp_err_to_name(err));
+    }
 
     // Initialize the tower tracker
     tower_tracker_init();
@@ -307,7 +387,8 @@ void badge_event_task(void *_args) {
                         if (badge_state.ready) {
                             // Sync badge data from the server
                             if (badge_config.registered) {
-                                api_result_t *result = api_get_badge_data();
+                                api_result_t *result =
+                                    api_submit_wait(API_PRIORITY_NORMAL, get_badge_data_request, NULL, NULL, portMAX_DELAY);
                                 if (result == NULL) {
                                     ESP_LOGE(TAG, "Failed to get badge data");
                                 } else {
@@ -358,7 +439,8 @@ void badge_event_task(void *_args) {
                             // Try to register the badge
                             else {
                                 if (strlen(badge_config.handle) > 0) {
-                                    api_result_t *result = api_register(badge_config.handle);
+                                    api_result_t *result = api_submit_wait(API_PRIORITY_NORMAL, register_request,
+                                                                           badge_config.handle, NULL, portMAX_DELAY);
                                     if (result == NULL) {
                                         ESP_LOGE(TAG, "Failed to register badge");
                                     } else {
@@ -390,6 +472,9 @@ void badge_event_task(void *_args) {
                 case BADGE_EVENT_OTA: //
                     ESP_LOGD(TAG, "OTA event message: %s", event.data.ota.message);
                     break;
+                case BADGE_EVENT_ACTIVITY: //
+                    activity_update();
+                    break;
                 default: //
                     ESP_LOGW(TAG, "Unknown event type: %d", event.type);
                     break;
@@ -29,7 +29,7 @@ typedef struct {
         .registered       = false,            \
         .wrist            = BADGE_WRIST_LEFT, \
         .brightness       = LCD_BACKLIGHT_ON, \
-        .screen_timeout   = 30,               \
+        .screen_timeout   = 15,               \
         .id               = 0,                \
         .handle           = "",               \
         .xp               = 0,                \
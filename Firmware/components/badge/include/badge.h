@@ -10,6 +10,7 @@ extern "C" {
 #include "wifi_manager.h"
 
 // Compmonent headers to expose externally
+#include "../activity.h"
 #include "../config.h"
 #include "../ir.h"
 #include "../ota.h"
@@ -59,6 +60,12 @@ esp_err_t set_screen_timeout(uint32_t timeout);
  */
 void screen_reset_timeout();
 
+/**
+ * @brief Dim the screen now instead of waiting for the screen timeout
+ *     The next screen_reset_timeout() wakes it again.
+ */
+void screen_sleep();
+
 #ifdef __cplusplus
 }
 #endif
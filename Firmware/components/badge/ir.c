@@ -1,13 +1,15 @@
+#include <stdatomic.h>
 #include <stdint.h>
 #include <string.h>
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
 #include "freertos/event_groups.h"
+#include "freertos/task.h"
 
 #include "api.h"
+#include "api_executor.h"
 #include "badge.h"
 #include "ir.h"
 #include "ui.h"
@@ -15,7 +17,11 @@
 static const char *TAG = "badge/ir";
 
 #define MAX_IR_CODES              16
+#define IR_RX_RING_SIZE           32 // Must be a power of two
+#define IR_CHECK_INTERVAL_MS      10000
 #define HIGH_PRIORITY_DEBOUNCE_MS 1000
+#define NORMAL_DEBOUNCE_MS        1000
+#define NORMAL_DEBOUNCE_SLOTS     8
 #define HIGH_PRIORITY_BIT         (1 << 0)
 #define MAX_IR_CALLBACKS          10
 
@@ -28,15 +34,26 @@ const ir_message_type_id_t HIGH_PRIORITY_TYPES[] = {
     IR_MTI_AUTH,    //
 };
 
-// Ring buffer for received IR codes
-static ir_code_t ir_code_buffer[MAX_IR_CODES];
-static uint8_t ir_code_head  = 0;
-static uint8_t ir_code_tail  = 0;
-static uint8_t ir_code_count = 0;
-static SemaphoreHandle_t ir_code_mutex;
+// Lock-free single-producer single-consumer ring of received IR codes. Only the IR Rx callback writes head and only
+// the consuming task writes tail, so the Rx path never waits on a consumer that is busy with an API call.
+typedef struct {
+    ir_code_t codes[IR_RX_RING_SIZE];
+    atomic_uint head;    // Next slot to write
+    atomic_uint tail;    // Next slot to read
+    atomic_uint dropped; // Codes dropped because the ring was full
+} ir_rx_ring_t;
 
-// Last high-priority code
+// Normal codes for the periodic check, and high-priority codes for the high-priority task
+static ir_rx_ring_t ir_code_ring;
+static ir_rx_ring_t ir_high_priority_ring;
+
+// Rx-side debounce state - only touched by the IR Rx callback
 static ir_code_t last_high_priority_code = {0};
+static ir_code_t recent_codes[NORMAL_DEBOUNCE_SLOTS];
+static int recent_code_next = 0;
+
+// Task to wake when the normal ring starts filling up
+static TaskHandle_t ir_code_task_handle = NULL;
 
 // Event group for high-priority IR code handling
 static EventGroupHandle_t ir_event_group;
@@ -54,13 +71,6 @@ void ir_high_priority_task(void *_arg);
 void route_high_priority_code(ir_code_t *ir_code, const char *msg);
 
 esp_err_t badge_ir_init() {
-    // Initialize mutex
-    ir_code_mutex = xSemaphoreCreateMutex();
-    if (ir_code_mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create IR code mutex");
-        return ESP_FAIL;
-    }
-
     // Initialize event group
     ir_event_group = xEventGroupCreate();
     if (ir_event_group == NULL) {
@@ -69,7 +79,7 @@ esp_err_t badge_ir_init() {
     }
 
     // Create tasks
-    xTaskCreate(ir_code_task, "ir_code_task", 5 * 1024, NULL, tskIDLE_PRIORITY + 1, NULL);
+    xTaskCreate(ir_code_task, "ir_code_task", 5 * 1024, NULL, tskIDLE_PRIORITY + 1, &ir_code_task_handle);
     xTaskCreate(ir_high_priority_task, "ir_high_priority_task", 4096, NULL, tskIDLE_PRIORITY + 2, NULL);
 
     // Initialize IR communication module with the callback
@@ -101,6 +111,48 @@ ir_code_t badge_ir_get_code(uint32_t code) {
     return ir_code;
 }
 
+// Called from the producer only
+static bool ir_ring_push(ir_rx_ring_t *ring, const ir_code_t *ir_code) {
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail >= IR_RX_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    ring->codes[head & (IR_RX_RING_SIZE - 1)] = *ir_code;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+// Called from the consumer only
+static bool ir_ring_pop(ir_rx_ring_t *ring, ir_code_t *ir_code) {
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail == head) {
+        return false;
+    }
+    *ir_code = ring->codes[tail & (IR_RX_RING_SIZE - 1)];
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+static unsigned int ir_ring_count(ir_rx_ring_t *ring) {
+    return atomic_load_explicit(&ring->head, memory_order_acquire) - atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+// Towers repeat their code continuously, so only pass on a normal code once per debounce window
+static bool debounce_normal_code(const ir_code_t *ir_code) {
+    for (int i = 0; i < NORMAL_DEBOUNCE_SLOTS; i++) {
+        if (recent_codes[i].code == ir_code->code && recent_codes[i].timestamp != 0 &&
+            ir_code->timestamp - recent_codes[i].timestamp < NORMAL_DEBOUNCE_MS * 1000) {
+            return true;
+        }
+    }
+    recent_codes[recent_code_next] = *ir_code;
+    recent_code_next               = (recent_code_next + 1) % NORMAL_DEBOUNCE_SLOTS;
+    return false;
+}
+
 void ir_rx_callback(uint16_t address, uint16_t command) {
     if (ir_rx_buffer_enabled) {
         // Initialize the IR code structure
@@ -118,62 +170,38 @@ void ir_rx_callback(uint16_t address, uint16_t command) {
                  : ir_code.message_type == IR_MTI_AUTH    ? "AUTH"
                                                           : "UNKNOWN");
 
-        // Lock the mutex to protect the buffer
-        xSemaphoreTake(ir_code_mutex, portMAX_DELAY);
-
         // Handle high-priority codes with debounce
         if (ir_code.priority == IR_CODE_PRIORITY_HIGH) {
-            int64_t current_time = esp_timer_get_time();
             if (ir_code.code != last_high_priority_code.code ||
-                current_time - last_high_priority_code.timestamp > HIGH_PRIORITY_DEBOUNCE_MS * 1000) {
+                ir_code.timestamp - last_high_priority_code.timestamp > HIGH_PRIORITY_DEBOUNCE_MS * 1000) {
                 last_high_priority_code = ir_code;
 
-                // Notify the event group
-                xEventGroupSetBits(ir_event_group, HIGH_PRIORITY_BIT);
+                // Queue the code and notify the event group
+                if (ir_ring_push(&ir_high_priority_ring, &ir_code)) {
+                    xEventGroupSetBits(ir_event_group, HIGH_PRIORITY_BIT);
+                } else {
+                    ESP_LOGW(TAG, "High-priority IR ring full, dropping code 0x%08X", (unsigned int)ir_code.code);
+                }
             }
         }
 
-        // Normal priority codes can go in the buffer for later processing
-        else {
-            // Check if the code is already in the buffer
-            bool already_in_buffer = false;
-            for (int i = 0; i < ir_code_count; i++) {
-                int index = (ir_code_tail + i) % MAX_IR_CODES;
-                if (ir_code_buffer[index].address == address && ir_code_buffer[index].command == command) {
-                    already_in_buffer = true;
-                    break;
+        // Normal priority codes go in the ring for the periodic check
+        else if (!debounce_normal_code(&ir_code)) {
+            if (ir_ring_push(&ir_code_ring, &ir_code)) {
+                // Wake the consumer early so the ring never fills up between periodic checks
+                if (ir_ring_count(&ir_code_ring) >= IR_RX_RING_SIZE / 2 && ir_code_task_handle != NULL) {
+                    xTaskNotifyGive(ir_code_task_handle);
                 }
             }
 
-            if (!already_in_buffer) {
-                // Add code to buffer
-                ir_code_buffer[ir_code_head] = ir_code;
-
-                // Advance head
-                ir_code_head = (ir_code_head + 1) % MAX_IR_CODES;
-
-                if (ir_code_count < MAX_IR_CODES) {
-                    ir_code_count++;
-                } else {
-                    // Buffer is full, advance tail
-                    ir_code_tail = (ir_code_tail + 1) % MAX_IR_CODES;
-                }
-
-                // If the tower tracker is ready, we can use it to check for tower codes for a faster UI response
-                if (tower_tracker_ready()) {
-                    for (int i = 0; i < ir_code_count; i++) {
-                        if (ir_code_buffer[i].message_type == IR_MTI_TOWER) {
-                            int tower_id = tower_ir_to_id(ir_code_buffer[i].code);
-                            if (tower_id != -1) {
-                                tower_seen(tower_id);
-                            }
-                        }
-                    }
+            // If the tower tracker is ready, we can use it to check for tower codes for a faster UI response
+            if (ir_code.message_type == IR_MTI_TOWER && tower_tracker_ready()) {
+                int tower_id = tower_ir_to_id(ir_code.code);
+                if (tower_id != -1) {
+                    tower_seen(tower_id);
                 }
             }
         }
-
-        xSemaphoreGive(ir_code_mutex);
     }
 
     // Call additional callbacks
@@ -184,53 +212,93 @@ void ir_rx_callback(uint16_t address, uint16_t command) {
     }
 }
 
+// Arguments for check_ir_codes_request() - lives on the caller's stack for the duration of api_submit_wait()
+typedef struct {
+    const uint32_t *ir_codes;
+    size_t num_codes;
+} check_ir_codes_args_t;
+
+// Runs on the API executor task
+static api_result_t *check_ir_codes_request(void *arg) {
+    check_ir_codes_args_t *args = (check_ir_codes_args_t *)arg;
+    return api_check_ir_codes(args->ir_codes, args->num_codes);
+}
+
 void ir_code_task(void *_arg) {
     (void)_arg;
+
+    // Codes waiting for the next periodic check - only this task touches them, so no lock is needed
+    uint32_t ir_codes[MAX_IR_CODES];
+    size_t num_codes      = 0;
+    int64_t next_check_us = esp_timer_get_time() + IR_CHECK_INTERVAL_MS * 1000;
+    unsigned int reported = 0;
+
     for (;;) {
-        // Wait for 10 seconds
-        vTaskDelay(pdMS_TO_TICKS(10000));
-
-        // Lock the mutex
-        xSemaphoreTake(ir_code_mutex, portMAX_DELAY);
-
-        if (ir_code_count > 0) {
-            // Collect the codes
-            uint32_t ir_codes[MAX_IR_CODES];
-            size_t num_codes = 0;
-            for (int i = 0; i < ir_code_count; i++) {
-                int index             = (ir_code_tail + i) % MAX_IR_CODES;
-                ir_codes[num_codes++] = ((uint32_t)ir_code_buffer[index].address << 16) | ir_code_buffer[index].command;
+        // Sleep until the next check is due, or until the Rx side says the ring is filling up
+        int64_t remaining_us = next_check_us - esp_timer_get_time();
+        if (remaining_us > 0) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(remaining_us / 1000) + 1);
+        }
+
+        // Drain the ring into the pending batch, dropping the oldest code if the batch is full
+        ir_code_t ir_code;
+        while (ir_ring_pop(&ir_code_ring, &ir_code)) {
+            bool already_pending = false;
+            for (size_t i = 0; i < num_codes; i++) {
+                if (ir_codes[i] == ir_code.code) {
+                    already_pending = true;
+                    break;
+                }
+            }
+            if (already_pending) {
+                continue;
             }
+            if (num_codes == MAX_IR_CODES) {
+                memmove(&ir_codes[0], &ir_codes[1], (MAX_IR_CODES - 1) * sizeof(ir_codes[0]));
+                num_codes--;
+            }
+            ir_codes[num_codes++] = ir_code.code;
+        }
 
-            // Call API
-            api_result_t *result = api_check_ir_codes(ir_codes, num_codes);
-            if (result != NULL) {
-                if (tower_tracker_ready()) {
-                    api_ir_code_result_t *ir_code_result = (api_ir_code_result_t *)result->data;
-                    for (int i = 0; i < ir_code_result->count; i++) {
-                        if (ir_code_result->ir_codes[i].is_valid && ir_code_result->ir_codes[i].type == IR_CODE_TYPE_TOWER) {
-                            int tower_id = tower_ir_to_id(ir_code_result->ir_codes[i].code);
-                            if (tower_id != -1) {
-                                tower_seen(tower_id);
-                            } else {
-                                ESP_LOGW(TAG, "Received IR code for unknown tower: 0x%08X",
-                                         (unsigned int)ir_code_result->ir_codes[i].code);
-                            }
+        unsigned int dropped = atomic_load_explicit(&ir_code_ring.dropped, memory_order_relaxed);
+        if (dropped != reported) {
+            ESP_LOGW(TAG, "IR ring overflowed, %u codes dropped so far", dropped);
+            reported = dropped;
+        }
+
+        if (esp_timer_get_time() < next_check_us) {
+            continue;
+        }
+        next_check_us = esp_timer_get_time() + IR_CHECK_INTERVAL_MS * 1000;
+        if (num_codes == 0) {
+            continue;
+        }
+
+        // Call API - periodic checks are background work so they yield to anything more urgent
+        check_ir_codes_args_t args = {.ir_codes = ir_codes, .num_codes = num_codes};
+        api_result_t *result       = api_submit_wait(API_PRIORITY_LOW, check_ir_codes_request, &args, NULL, portMAX_DELAY);
+        if (result != NULL) {
+            if (tower_tracker_ready()) {
+                api_ir_code_result_t *ir_code_result = (api_ir_code_result_t *)result->data;
+                for (int i = 0; i < ir_code_result->count; i++) {
+                    if (ir_code_result->ir_codes[i].is_valid && ir_code_result->ir_codes[i].type == IR_CODE_TYPE_TOWER) {
+                        int tower_id = tower_ir_to_id(ir_code_result->ir_codes[i].code);
+                        if (tower_id != -1) {
+                            tower_seen(tower_id);
+                        } else {
+                            ESP_LOGW(TAG, "Received IR code for unknown tower: 0x%08X",
+                                     (unsigned int)ir_code_result->ir_codes[i].code);
                         }
                     }
                 }
-                api_free_result(result, true);
-
-                // Clear the buffer
-                ir_code_head  = 0;
-                ir_code_tail  = 0;
-                ir_code_count = 0;
-            } else {
-                ESP_LOGE(TAG, "Failed periodic IR code check");
             }
-        }
+            api_free_result(result, true);
 
-        xSemaphoreGive(ir_code_mutex);
+            // Clear the batch
+            num_codes = 0;
+        } else {
+            ESP_LOGE(TAG, "Failed periodic IR code check");
+        }
     }
 }
 
@@ -240,27 +308,26 @@ void ir_high_priority_task(void *_arg) {
         // Wait indefinitely for the high-priority bit to be set
         xEventGroupWaitBits(ir_event_group, HIGH_PRIORITY_BIT, pdTRUE, pdFALSE, portMAX_DELAY);
 
-        // Handle the high-priority code
-        xSemaphoreTake(ir_code_mutex, portMAX_DELAY);
-
-        // Assuming the last high-priority code is the one to process
-        const uint32_t ir_codes[] = {last_high_priority_code.code};
-        api_result_t *result      = api_check_ir_codes(ir_codes, 1);
-        if (result != NULL) {
-            api_ir_code_result_t *ir_code_result = (api_ir_code_result_t *)result->data;
-            if (ir_code_result != NULL) {
-                for (int i = 0; i < ir_code_result->count; i++) {
-                    if (ir_code_result->ir_codes[i].is_valid) {
-                        route_high_priority_code(&last_high_priority_code, ir_code_result->ir_codes[i].response);
+        // Handle every high-priority code that has been queued since the last wake
+        ir_code_t ir_code;
+        while (ir_ring_pop(&ir_high_priority_ring, &ir_code)) {
+            const uint32_t ir_codes[]  = {ir_code.code};
+            check_ir_codes_args_t args = {.ir_codes = ir_codes, .num_codes = 1};
+            api_result_t *result       = api_submit_wait(API_PRIORITY_HIGH, check_ir_codes_request, &args, NULL, portMAX_DELAY);
+            if (result != NULL) {
+                api_ir_code_result_t *ir_code_result = (api_ir_code_result_t *)result->data;
+                if (ir_code_result != NULL) {
+                    for (int i = 0; i < ir_code_result->count; i++) {
+                        if (ir_code_result->ir_codes[i].is_valid) {
+                            route_high_priority_code(&ir_code, ir_code_result->ir_codes[i].response);
+                        }
                     }
                 }
+                api_free_result(result, true);
+            } else {
+                ESP_LOGE(TAG, "Failed to check high-priority IR codes");
             }
-            api_free_result(result, true);
-        } else {
-            ESP_LOGE(TAG, "Failed to check high-priority IR codes");
         }
-
-        xSemaphoreGive(ir_code_mutex);
     }
 }
 
@@ -289,6 +356,16 @@ esp_err_t badge_ir_enable_rx_buffer(bool enable) {
     return ESP_OK;
 }
 
+void badge_ir_get_stats(badge_ir_stats_t *stats) {
+    if (stats != NULL) {
+        // Every code that made it into a ring moved its head on
+        stats->queued                = atomic_load_explicit(&ir_code_ring.head, memory_order_relaxed);
+        stats->dropped               = atomic_load_explicit(&ir_code_ring.dropped, memory_order_relaxed);
+        stats->high_priority_queued  = atomic_load_explicit(&ir_high_priority_ring.head, memory_order_relaxed);
+        stats->high_priority_dropped = atomic_load_explicit(&ir_high_priority_ring.dropped, memory_order_relaxed);
+    }
+}
+
 void route_high_priority_code(ir_code_t *ir_code, const char *msg) {
     switch (ir_code->message_type) {
         case IR_MTI_LEVELUP: // Level up code from staff badge
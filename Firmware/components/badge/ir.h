@@ -44,6 +44,14 @@ typedef struct {
     ir_code_priority_t priority;
 } ir_code_t;
 
+// Received code counters, for checking the Rx rings keep up with the codes coming in
+typedef struct {
+    uint32_t queued;                // Normal codes put in the ring for the periodic check
+    uint32_t dropped;               // Normal codes dropped because the ring was full
+    uint32_t high_priority_queued;  // High-priority codes put in their ring
+    uint32_t high_priority_dropped; // High-priority codes dropped because their ring was full
+} badge_ir_stats_t;
+
 /**
  * @brief Initialize the IR code handling
  *
@@ -83,6 +91,13 @@ esp_err_t badge_ir_remove_rx_callback(ir_rx_callback_t callback);
  */
 esp_err_t badge_ir_enable_rx_buffer(bool enable);
 
+/**
+ * @brief Get the received code counters
+ *
+ * @param stats Counters since boot
+ */
+void badge_ir_get_stats(badge_ir_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
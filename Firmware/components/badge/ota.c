@@ -5,6 +5,7 @@
 #include "esp_timer.h"
 
 #include "api.h"
+#include "api_executor.h"
 #include "ota.h"
 #include "version.h"
 
@@ -42,6 +43,11 @@ static void ota_state_updated() {
     }
 }
 
+// Runs on the API executor task
+static api_result_t *firmware_version_request(void *arg) {
+    return api_get_firmware_version();
+}
+
 static void ota_task(void *arg) {
     while (true) {
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Block until notified
@@ -63,7 +69,7 @@ static void ota_task(void *arg) {
 
         // Check the latest firmware version from the server
         char latest_version[32]       = {0};
-        api_result_t *firmware_result = api_get_firmware_version();
+        api_result_t *firmware_result = api_submit_wait(API_PRIORITY_LOW, firmware_version_request, NULL, NULL, portMAX_DELAY);
         if (firmware_result == NULL) {
             ota_state.status  = OTA_STATUS_CHECK_FAILED;
             ota_state.message = "Failed to check for updates";
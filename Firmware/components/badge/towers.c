@@ -1,19 +1,47 @@
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "esp_log.h"
 #include "esp_timer.h"
 
 #include "api.h"
+#include "api_executor.h"
 #include "badge.h"
 #include "towers.h"
 #include "ui.h"
 
 static const char *TAG = "badge/towers";
 
-// Tower state is updated with the latest info from the API
-tower_state_t tower_state[TOTAL_TOWERS] = {0};
+// Each tower the API has ever reported gets one entry that is never freed, so tower_state_t and tower_info_t pointers
+// handed out to the UI stay valid across refreshes
+typedef struct tower_entry_t {
+    tower_state_t state;
+    tower_info_t info;
+    bool changed; // Info changed since the change callbacks were last called
+    struct tower_entry_t *next;
+} tower_entry_t;
+static tower_entry_t *tower_entries = NULL;
 
-// Tower info is refreshed from the API and cached here
-static tower_info_t tower_info[TOTAL_TOWERS] = {0};
+// Lookup index over the current towers. It is never modified once published - a refresh builds a new index and swaps
+// it in, so lookups from the IR Rx path never need a lock.
+typedef struct tower_index_t {
+    int count;                          // Number of towers
+    int bits;                           // log2 of the slot count - the slot count is at least twice the tower count
+    tower_state_t **towers;             // Towers in API order
+    int16_t *ir_slots;                  // Open-addressed indices into towers keyed by IR code, -1 if empty
+    int16_t *id_slots;                  // Open-addressed indices into towers keyed by tower ID, -1 if empty
+    struct tower_index_t *next_retired; // Next index waiting to be freed
+} tower_index_t;
+static _Atomic(tower_index_t *) tower_index = NULL;
+
+// Lookups outside the API executor task hold the index between tower_index_acquire() and tower_index_release(). A
+// replaced index is only freed once this count has been seen at zero after the swap, so no reader can still have it.
+static _Atomic uint32_t tower_index_readers = 0;
+
+// Replaced indices that may still have readers - only touched on the API executor task
+static tower_index_t *retired_indices = NULL;
 
 // Timer handle for refreshing tower info from the API
 static esp_timer_handle_t tower_info_refresh_timer;
@@ -22,9 +50,20 @@ static esp_timer_handle_t tower_info_refresh_timer;
 static bool initialized       = false;
 static bool all_towers_loaded = false;
 
+// Set while a full refresh is queued on the API executor so repeated triggers don't pile up requests
+static volatile bool refresh_all_pending = false;
+
+// Conditional refresh state - only touched on the API executor task
+static char tower_etag[64]                 = {0};
+static int64_t refresh_start_us            = 0;
+static tower_refresh_stats_t refresh_stats = {0};
+
+// Callbacks for tower info changes
+static tower_change_callback_t tower_change_callbacks[MAX_TOWER_CHANGE_CALLBACKS];
+
 // Callback function for the tower info refresh timer
 static void tower_info_refresh_callback(void *arg) {
-    tower_info_refresh((int)arg);
+    tower_info_refresh((int)(intptr_t)arg);
 }
 
 void tower_tracker_init() {
@@ -32,19 +71,13 @@ void tower_tracker_init() {
         return;
     }
 
-    // Initialize the tower state
-    for (int i = 0; i < TOTAL_TOWERS; i++) {
-        tower_state[i].info      = &tower_info[i];
-        tower_state[i].last_seen = 0;
-    }
-
     // Refresh the tower info from the API
     tower_info_refresh(REFRESH_ALL);
 
     // Set up a timer to refresh the tower info periodically
     esp_timer_create_args_t tower_info_refresh_args = {
         .callback = tower_info_refresh_callback,
-        .arg      = (void *)REFRESH_ALL,
+        .arg      = (void *)(intptr_t)REFRESH_ALL,
     };
     esp_timer_create(&tower_info_refresh_args, &tower_info_refresh_timer);
     esp_timer_start_periodic(tower_info_refresh_timer, REFRESH_INTERVAL * 1000);
@@ -73,55 +106,311 @@ static void copy_tower_info(api_tower_info_t *src, tower_info_t *dst) {
 
     // Copy string fields
     if (src->name) {
-        strncpy(dst->name, src->name, sizeof(dst->name));
+        strncpy(dst->name, src->name, sizeof(dst->name) - 1);
     } else {
         dst->name[0] = '\0';
     }
 
     if (src->location) {
-        strncpy(dst->location, src->location, sizeof(dst->location));
+        strncpy(dst->location, src->location, sizeof(dst->location) - 1);
     } else {
         dst->location[0] = '\0';
     }
 
     if (src->boot_time) {
-        strncpy(dst->boot_time, src->boot_time, sizeof(dst->boot_time));
+        strncpy(dst->boot_time, src->boot_time, sizeof(dst->boot_time) - 1);
     } else {
         dst->boot_time[0] = '\0';
     }
 }
 
-void tower_info_refresh(int tower_id) {
-    // If there are no recent towers, be sure toclear the alert count
-    if (get_recent_towers(NULL, TOWER_RECENCY_WINDOW * 1000) == 0) {
-        set_status_alert_count(0);
+// Fibonacci hashing spreads sequential tower IDs and similar IR codes across the slots
+static inline uint32_t tower_hash(uint32_t key, int bits) {
+    return (key * 2654435761u) >> (32 - bits);
+}
+
+// Find the index of the tower with the given IR code or ID, or -1 if there isn't one
+static int tower_index_find(const tower_index_t *index, uint32_t key, bool by_ir_code) {
+    if (index == NULL || index->count == 0) {
+        return -1;
     }
 
-    // Make sure we're connected to wifi
-    if (badge_state.wifi_status != WIFI_STATUS_CONNECTED) {
-        ESP_LOGW(TAG, "Not connected to wifi, skipping tower info refresh");
+    // Linear probing always reaches an empty slot since the table is at most half full
+    const int16_t *slots = by_ir_code ? index->ir_slots : index->id_slots;
+    uint32_t mask        = (1u << index->bits) - 1;
+    for (uint32_t slot = tower_hash(key, index->bits);; slot = (slot + 1) & mask) {
+        int idx = slots[slot];
+        if (idx == -1) {
+            return -1;
+        }
+        const tower_info_t *info = index->towers[idx]->info;
+        if (by_ir_code ? info->ir_code == key : (uint32_t)info->id == key) {
+            return idx;
+        }
+    }
+}
+
+static void tower_index_insert(int16_t *slots, int bits, uint32_t key, int idx) {
+    uint32_t mask = (1u << bits) - 1;
+    uint32_t slot = tower_hash(key, bits);
+    while (slots[slot] != -1) {
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = idx;
+}
+
+// Allocate an index for count towers - the caller fills in the towers and then calls tower_index_fill()
+static tower_index_t *tower_index_create(int count) {
+    int bits = 4;
+    while ((1 << bits) < count * 2) {
+        bits++;
+    }
+    size_t slot_count = 1 << bits;
+
+    // One allocation holds the index, the tower list and both slot tables
+    tower_index_t *index = malloc(sizeof(tower_index_t) + count * sizeof(tower_state_t *) + 2 * slot_count * sizeof(int16_t));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->count        = count;
+    index->bits         = bits;
+    index->towers       = (tower_state_t **)(index + 1);
+    index->ir_slots     = (int16_t *)(index->towers + count);
+    index->id_slots     = index->ir_slots + slot_count;
+    index->next_retired = NULL;
+    memset(index->ir_slots, 0xFF, 2 * slot_count * sizeof(int16_t));
+    return index;
+}
+
+static void tower_index_fill(tower_index_t *index) {
+    for (int i = 0; i < index->count; i++) {
+        tower_index_insert(index->ir_slots, index->bits, index->towers[i]->info->ir_code, i);
+        tower_index_insert(index->id_slots, index->bits, (uint32_t)index->towers[i]->info->id, i);
+    }
+}
+
+// Get the entry for a tower ID, creating it if this tower hasn't been seen before - only called on the API executor task
+static tower_entry_t *tower_entry_get(const tower_index_t *index, int tower_id) {
+    int idx = tower_index_find(index, (uint32_t)tower_id, false);
+    if (idx != -1) {
+        return (tower_entry_t *)index->towers[idx]; // state is the first member of the entry
+    }
+
+    // Towers that dropped out of the index and came back still have their old entry
+    for (tower_entry_t *entry = tower_entries; entry != NULL; entry = entry->next) {
+        if (entry->info.id == tower_id) {
+            return entry;
+        }
+    }
+
+    tower_entry_t *entry = calloc(1, sizeof(tower_entry_t));
+    if (entry == NULL) {
+        return NULL;
+    }
+    entry->state.info = &entry->info;
+    entry->info.id    = tower_id;
+    entry->next       = tower_entries;
+    tower_entries     = entry;
+    return entry;
+}
+
+// Runs on the API executor task
+static api_result_t *tower_info_request(void *arg) {
+    int tower_id = (int)(intptr_t)arg;
+    if (tower_id != REFRESH_ALL) {
+        return api_get_tower_status_by_id(tower_id);
+    }
+
+    // Full refreshes are conditional, so an unchanged tower list only costs a 304
+    refresh_start_us = esp_timer_get_time();
+    return api_get_all_tower_status_if_changed(tower_etag[0] != '\0' ? tower_etag : NULL);
+}
+
+// Copy fresh info into a tower entry and flag it for the change callbacks if anything is different
+static void tower_entry_update(tower_entry_t *entry, api_tower_info_t *src) {
+    tower_info_t updated = entry->info;
+    copy_tower_info(src, &updated);
+    if (memcmp(&updated, &entry->info, sizeof(tower_info_t)) != 0) {
+        entry->info    = updated;
+        entry->changed = true;
+    }
+}
+
+// Get the current index for a lookup, it stays allocated until the matching tower_index_release()
+static tower_index_t *tower_index_acquire() {
+    atomic_fetch_add_explicit(&tower_index_readers, 1, memory_order_seq_cst);
+    return atomic_load_explicit(&tower_index, memory_order_seq_cst);
+}
+
+static void tower_index_release() {
+    atomic_fetch_sub_explicit(&tower_index_readers, 1, memory_order_release);
+}
+
+// Publish a new index. The one it replaces is retired, and retired indices are freed once no reader is in a lookup -
+// any reader that could have picked one up started before it was replaced, so a zero count means they're all done.
+static void tower_index_publish(tower_index_t *index) {
+    tower_index_t *previous = atomic_exchange_explicit(&tower_index, index, memory_order_seq_cst);
+    if (previous != NULL) {
+        previous->next_retired = retired_indices;
+        retired_indices        = previous;
+    }
+    if (atomic_load_explicit(&tower_index_readers, memory_order_seq_cst) == 0) {
+        while (retired_indices != NULL) {
+            tower_index_t *next = retired_indices->next_retired;
+            free(retired_indices);
+            retired_indices = next;
+        }
+    }
+    all_towers_loaded = index->count > 0;
+}
+
+// Tell the change callbacks about every tower flagged by tower_entry_update(), and about the list if it changed
+static void tower_notify_changes(const tower_index_t *index, bool list_changed) {
+    for (int i = 0; i < MAX_TOWER_CHANGE_CALLBACKS; i++) {
+        if (tower_change_callbacks[i] != NULL && list_changed) {
+            tower_change_callbacks[i](NULL);
+        }
+    }
+    for (int i = 0; index != NULL && i < index->count; i++) {
+        tower_entry_t *entry = (tower_entry_t *)index->towers[i];
+        if (!entry->changed) {
+            continue;
+        }
+        entry->changed = false;
+        for (int j = 0; j < MAX_TOWER_CHANGE_CALLBACKS; j++) {
+            if (tower_change_callbacks[j] != NULL) {
+                tower_change_callbacks[j](&entry->state);
+            }
+        }
+    }
+}
+
+// Replace the tower list and rebuild the index from a full refresh
+static void tower_info_apply_all(const api_all_tower_info_t *all_tower_info) {
+    tower_index_t *current = atomic_load_explicit(&tower_index, memory_order_acquire);
+    tower_index_t *index   = tower_index_create(all_tower_info->count);
+    if (index == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate tower index for %d towers", all_tower_info->count);
         return;
     }
 
-    api_result_t *result = NULL;
+    int count = 0;
+    for (int i = 0; i < all_tower_info->count && i < INT16_MAX; i++) {
+        tower_entry_t *entry = tower_entry_get(current, all_tower_info->towers[i].id);
+        if (entry != NULL) {
+            tower_entry_update(entry, &all_tower_info->towers[i]);
+            index->towers[count++] = &entry->state;
+        }
+    }
+    index->count = count;
+    tower_index_fill(index);
+
+    // The list only changed if towers were added, removed or reordered
+    bool list_changed = current == NULL || current->count != count ||
+                        memcmp(current->towers, index->towers, count * sizeof(tower_state_t *)) != 0;
+    tower_index_publish(index);
+    tower_notify_changes(index, list_changed);
+}
+
+// Apply only the towers that changed, rebuilding the index only if a tower is new or its IR code changed
+static void tower_info_apply_delta(const api_all_tower_info_t *delta) {
+    tower_index_t *current = atomic_load_explicit(&tower_index, memory_order_acquire);
+    int current_count      = current == NULL ? 0 : current->count;
+
+    int added    = 0;
+    bool rebuild = false;
+    for (int i = 0; i < delta->count; i++) {
+        int idx = tower_index_find(current, (uint32_t)delta->towers[i].id, false);
+        if (idx == -1) {
+            added++;
+        } else if (current->towers[idx]->info->ir_code != delta->towers[i].ir_code) {
+            rebuild = true;
+        }
+    }
+
+    tower_index_t *index = NULL;
+    if (added > 0 || rebuild) {
+        index = tower_index_create(current_count + added);
+        if (index == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate tower index for %d towers", current_count + added);
+            return;
+        }
+        if (current_count > 0) {
+            memcpy(index->towers, current->towers, current_count * sizeof(tower_state_t *));
+        }
+    }
+
+    // New towers go on the end of the list
+    int count = current_count;
+    for (int i = 0; i < delta->count; i++) {
+        bool is_new          = tower_index_find(current, (uint32_t)delta->towers[i].id, false) == -1;
+        tower_entry_t *entry = tower_entry_get(current, delta->towers[i].id);
+        if (entry == NULL) {
+            continue;
+        }
+        tower_entry_update(entry, &delta->towers[i]);
+        if (is_new && index != NULL) {
+            index->towers[count++] = &entry->state;
+        }
+    }
+
+    if (index != NULL) {
+        index->count = count;
+        tower_index_fill(index);
+        tower_index_publish(index);
+        tower_notify_changes(index, added > 0);
+    } else {
+        tower_notify_changes(current, false);
+    }
+}
+
+// Update a single tower in place, falling back to a full refresh if the index would need to change
+static void tower_info_apply_one(const api_tower_info_t *info) {
+    tower_index_t *index = atomic_load_explicit(&tower_index, memory_order_acquire);
+    int idx              = tower_index_find(index, (uint32_t)info->id, false);
+    if (idx == -1 || index->towers[idx]->info->ir_code != info->ir_code) {
+        tower_info_refresh(REFRESH_ALL);
+        return;
+    }
+    tower_entry_update((tower_entry_t *)index->towers[idx], (api_tower_info_t *)info);
+    tower_notify_changes(index, false);
+}
+
+// Completion callback for tower_info_request() - also runs on the API executor task
+static void tower_info_request_done(api_result_t *result, void *arg) {
+    int tower_id = (int)(intptr_t)arg;
 
     if (tower_id == REFRESH_ALL) {
-        result = api_get_all_tower_status();
-        if (result != NULL) {
+        refresh_all_pending = false;
+        if (result != NULL && result->data != NULL) {
             api_all_tower_info_t *all_tower_info = (api_all_tower_info_t *)result->data;
-            for (int i = 0; i < all_tower_info->count; i++) {
-                copy_tower_info(&all_tower_info->towers[i], &tower_info[i]);
-                all_towers_loaded = true;
+            if (all_tower_info->not_modified) {
+                refresh_stats.not_modified++;
+            } else if (all_tower_info->delta) {
+                refresh_stats.deltas++;
+                tower_info_apply_delta(all_tower_info);
+            } else {
+                refresh_stats.full++;
+                tower_info_apply_all(all_tower_info);
             }
-        }
-    } else {
-        result = api_get_tower_status_by_id(tower_id);
-        if (result != NULL) {
-            int idx = tower_id_to_idx(tower_id);
-            if (idx != -1) {
-                copy_tower_info((api_tower_info_t *)result->data, &tower_info[idx]);
+
+            // Keep the ETag for the next conditional request
+            if (all_tower_info->etag != NULL) {
+                snprintf(tower_etag, sizeof(tower_etag), "%s", all_tower_info->etag);
+            } else if (!all_tower_info->not_modified) {
+                tower_etag[0] = '\0';
             }
+
+            refresh_stats.bytes_received += all_tower_info->body_size;
+            refresh_stats.last_refresh_ms = (esp_timer_get_time() - refresh_start_us) / 1000;
+            ESP_LOGD(TAG, "Tower refresh: %s, %u bytes in %" PRIu32 "ms",
+                     all_tower_info->not_modified ? "not modified"
+                     : all_tower_info->delta      ? "delta"
+                                                  : "full",
+                     (unsigned int)all_tower_info->body_size, refresh_stats.last_refresh_ms);
         }
+    } else if (result != NULL && result->data != NULL) {
+        tower_info_apply_one((api_tower_info_t *)result->data);
     }
 
     if (result != NULL) {
@@ -129,24 +418,62 @@ void tower_info_refresh(int tower_id) {
     }
 }
 
-int tower_ir_to_id(uint32_t ir_code) {
-    ESP_LOGD(TAG, "tower_ir_to_id: %lu", ir_code);
-    for (int i = 0; i < TOTAL_TOWERS; i++) {
-        if (tower_info[i].ir_code == ir_code) {
-            ESP_LOGD(TAG, "tower_ir_to_id: %lu -> %d", ir_code, tower_info[i].id);
-            return tower_info[i].id;
+void tower_info_refresh(int tower_id) {
+    // If there are no recent towers, be sure toclear the alert count
+    if (get_recent_towers(NULL, TOWER_RECENCY_WINDOW * 1000) == 0) {
+        set_status_alert_count(0);
+    }
+
+    // Make sure we're connected to wifi
+    if (badge_state.wifi_status != WIFI_STATUS_CONNECTED) {
+        ESP_LOGW(TAG, "Not connected to wifi, skipping tower info refresh");
+        return;
+    }
+
+    // Only keep one full refresh in flight at a time
+    if (tower_id == REFRESH_ALL) {
+        if (refresh_all_pending) {
+            return;
         }
+        refresh_all_pending = true;
     }
-    return -1;
-}
 
-int tower_id_to_idx(int tower_id) {
-    for (int i = 0; i < TOTAL_TOWERS; i++) {
-        if (tower_info[i].id == tower_id) {
-            return i;
+    // Tower info is background data, so queue it behind anything more urgent
+    void *arg = (void *)(intptr_t)tower_id;
+    if (api_submit(API_PRIORITY_LOW, tower_info_request, arg, tower_info_request_done, arg, NULL) == 0) {
+        ESP_LOGE(TAG, "Failed to queue tower info refresh");
+        if (tower_id == REFRESH_ALL) {
+            refresh_all_pending = false;
         }
     }
-    return -1;
+}
+
+int tower_ir_to_id(uint32_t ir_code) {
+    tower_index_t *index = tower_index_acquire();
+    int idx              = tower_index_find(index, ir_code, true);
+    int tower_id         = idx == -1 ? -1 : index->towers[idx]->info->id;
+    tower_index_release();
+    return tower_id;
+}
+
+int tower_id_to_idx(int tower_id) {
+    int idx = tower_index_find(tower_index_acquire(), (uint32_t)tower_id, false);
+    tower_index_release();
+    return idx;
+}
+
+int get_tower_count() {
+    tower_index_t *index = tower_index_acquire();
+    int count            = index == NULL ? 0 : index->count;
+    tower_index_release();
+    return count;
+}
+
+tower_state_t *get_tower_state(int idx) {
+    tower_index_t *index = tower_index_acquire();
+    tower_state_t *state = index == NULL || idx < 0 || idx >= index->count ? NULL : index->towers[idx];
+    tower_index_release();
+    return state;
 }
 
 void tower_seen(int tower_id) {
@@ -155,51 +482,78 @@ void tower_seen(int tower_id) {
         tower_info_refresh(REFRESH_ALL);
     }
 
-    // Try to look up the tower index
-    int idx = tower_id_to_idx(tower_id);
-    if (idx == -1) {
+    // Try to look up the tower - the state itself is never freed, only the index around it
+    tower_index_t *index = tower_index_acquire();
+    int idx              = tower_index_find(index, (uint32_t)tower_id, false);
+    tower_state_t *state = idx == -1 ? NULL : index->towers[idx];
+    tower_index_release();
+    if (state == NULL) {
         ESP_LOGE(TAG, "Tower %d not found", tower_id);
         return;
-    } else {
-        ESP_LOGD(TAG, "Tower %d found at index %d", tower_id, idx);
     }
 
-    tower_state[idx].last_seen = esp_timer_get_time();
+    int64_t now          = esp_timer_get_time();
+    int64_t prev_seen    = state->last_seen;
+    state->last_seen     = now;
 
-    if (idx != -1) {
-        int64_t now                = esp_timer_get_time();
-        int64_t prev_seen          = tower_state[idx].last_seen;
-        tower_state[idx].last_seen = now;
-
-        // Refresh the tower info if it was previously seen more than 10 minutes ago
-        if (now - prev_seen > 600 * 1000 * 1000) {
-            tower_info_refresh(tower_id);
-        }
+    // Refresh the tower info if it was previously seen more than 10 minutes ago
+    if (now - prev_seen > 600 * 1000 * 1000) {
+        tower_info_refresh(tower_id);
+    }
 
-        // Update the alert count
-        if (get_content_page() != PAGE_TOWER_BATTLE) {
-            set_status_alert_count(get_recent_towers(NULL, TOWER_RECENCY_WINDOW * 1000));
-        }
+    // The alert count can only go up when a tower becomes recent again, so skip the recount otherwise
+    if (now - prev_seen > TOWER_RECENCY_WINDOW * 1000 && get_content_page() != PAGE_TOWER_BATTLE) {
+        set_status_alert_count(get_recent_towers(NULL, TOWER_RECENCY_WINDOW * 1000));
     }
 }
 
 int get_recent_towers(tower_state_t **recent_towers, int64_t time_window) {
-    int64_t now    = esp_timer_get_time();
-    int64_t cutoff = now - time_window;
+    tower_index_t *index = tower_index_acquire();
+    if (index == NULL) {
+        tower_index_release();
+        return 0;
+    }
+
+    int64_t cutoff = esp_timer_get_time() - time_window;
     if (cutoff < 0) {
         cutoff = 0;
     }
-    ESP_LOGI(TAG, "Getting recent towers with cutoff %lld (now %lld)", cutoff, now);
     int count = 0;
-    for (int i = 0; i < TOTAL_TOWERS; i++) {
-        ESP_LOGI(TAG, "Tower %d: %s seen at %lld", tower_state[i].info->id, tower_state[i].info->name, tower_state[i].last_seen);
-        if (tower_state[i].last_seen > cutoff) {
+    for (int i = 0; i < index->count; i++) {
+        if (index->towers[i]->last_seen > cutoff) {
             if (recent_towers != NULL) {
-                recent_towers[count++] = &tower_state[i];
-            } else {
-                count++;
+                if (count == MAX_NEARBY_TOWERS) {
+                    break;
+                }
+                recent_towers[count] = index->towers[i];
             }
+            count++;
         }
     }
+    tower_index_release();
     return count;
 }
+
+esp_err_t tower_add_change_callback(tower_change_callback_t callback) {
+    for (int i = 0; i < MAX_TOWER_CHANGE_CALLBACKS; i++) {
+        if (tower_change_callbacks[i] == NULL) {
+            tower_change_callbacks[i] = callback;
+            return ESP_OK;
+        }
+    }
+    return ESP_FAIL;
+}
+
+esp_err_t tower_remove_change_callback(tower_change_callback_t callback) {
+    for (int i = 0; i < MAX_TOWER_CHANGE_CALLBACKS; i++) {
+        if (tower_change_callbacks[i] == callback) {
+            tower_change_callbacks[i] = NULL;
+            return ESP_OK;
+        }
+    }
+    return ESP_FAIL;
+}
+
+tower_refresh_stats_t get_tower_refresh_stats() {
+    return refresh_stats;
+}
@@ -7,14 +7,15 @@ extern "C" {
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "esp_err.h"
 #include "api.h"
 
-#define TOTAL_TOWERS               11           // Total number of towers - currently we have 11 total towers
-#define MAX_NEARBY_TOWERS          TOTAL_TOWERS // For now, we can just keep track of all towers if needed
-#define REFRESH_INTERVAL           120 * 1000   // Refresh interval in milliseconds
-#define REFRESH_ALL                -1           // Refresh all towers when calling tower_tracker_refresh()
-#define SEEN_AUTO_REFRESH_THROTTLE 60 * 1000    // Throttle how often we refresh tower info after a tower is seen
-#define TOWER_RECENCY_WINDOW       300 * 1000   // Check for towers seen within the last 5 minutes
+#define MAX_NEARBY_TOWERS          16         // Most towers returned by get_recent_towers() at once
+#define REFRESH_INTERVAL           120 * 1000 // Refresh interval in milliseconds
+#define REFRESH_ALL                -1         // Refresh all towers when calling tower_tracker_refresh()
+#define SEEN_AUTO_REFRESH_THROTTLE 60 * 1000  // Throttle how often we refresh tower info after a tower is seen
+#define TOWER_RECENCY_WINDOW       300 * 1000 // Check for towers seen within the last 5 minutes
+#define MAX_TOWER_CHANGE_CALLBACKS 4          // Maximum number of tower change callbacks
 
 // Very similar to api_tower_info_t, but with fixed size strings for simplicity
 typedef struct {
@@ -40,8 +41,21 @@ typedef struct {
     int64_t last_seen;
 } tower_state_t;
 
-// Current state of all towers - refreshed from API periodically or when IR code is received
-extern tower_state_t tower_state[TOTAL_TOWERS];
+/**
+ * @brief Callback for tower info changes, called on the API executor task
+ *
+ * @param tower The tower whose info changed, or NULL if towers were added, removed or reordered
+ */
+typedef void (*tower_change_callback_t)(tower_state_t *tower);
+
+// Counters for full tower list refreshes
+typedef struct {
+    uint32_t full;            // Refreshes that returned the full tower list
+    uint32_t deltas;          // Refreshes that returned only the changed towers
+    uint32_t not_modified;    // Refreshes answered with 304 Not Modified
+    uint64_t bytes_received;  // Total response body bytes across all refreshes
+    uint32_t last_refresh_ms; // Round trip plus apply time of the last refresh
+} tower_refresh_stats_t;
 
 /**
  * @brief Initialize the tower tracker
@@ -56,7 +70,7 @@ void tower_tracker_init();
 bool tower_tracker_ready();
 
 /**
- * @brief Refresh the state of a specific tower or all towers
+ * @brief Queue a refresh of the state of a specific tower or all towers on the API executor
  *
  * @param tower_id ID of the tower to refresh or REFRESH_ALL to refresh all towers
  */
@@ -78,6 +92,23 @@ int tower_ir_to_id(uint32_t ir_code);
  */
 int tower_id_to_idx(int tower_id);
 
+/**
+ * @brief Get the number of towers currently known from the API
+ *
+ * @return Number of towers
+ */
+int get_tower_count();
+
+/**
+ * @brief Get the state of a tower from its index
+ *
+ * @note The returned pointer stays valid for the lifetime of the badge, even after the tower list is refreshed
+ *
+ * @param idx Index of the tower, from 0 to get_tower_count() - 1 or from tower_id_to_idx()
+ * @return Pointer to the tower state or NULL if the index is out of range
+ */
+tower_state_t *get_tower_state(int idx);
+
 /**
  * @brief Mark a tower as seen
  *
@@ -86,14 +117,37 @@ int tower_id_to_idx(int tower_id);
 void tower_seen(int tower_id);
 
 /**
- * @brief Get the IDs of towers that have been seen within the given time window
+ * @brief Get the towers that have been seen within the given time window
  *
- * @param recent_towers Pointer to an array to store the tower IDs
+ * @param recent_towers Array of at least MAX_NEARBY_TOWERS to store the towers in, or NULL to only count them
  * @param time_window Time window in microseconds
  * @return Number of towers found
  */
 int get_recent_towers(tower_state_t **recent_towers, int64_t time_window);
 
+/**
+ * @brief Add a callback for tower info changes
+ *
+ * @param callback The callback function to add
+ * @return ESP_OK on success or ESP_FAIL if there are no free callback slots
+ */
+esp_err_t tower_add_change_callback(tower_change_callback_t callback);
+
+/**
+ * @brief Remove a callback for tower info changes
+ *
+ * @param callback The callback function to remove
+ * @return ESP_OK on success or ESP_FAIL if the callback wasn't registered
+ */
+esp_err_t tower_remove_change_callback(tower_change_callback_t callback);
+
+/**
+ * @brief Get the full tower refresh counters
+ *
+ * @return A copy of the current counters
+ */
+tower_refresh_stats_t get_tower_refresh_stats();
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,6 +5,7 @@
 #include "esp_dma_utils.h"
 #include "esp_err.h"
 #include "esp_check.h"
+#include "esp_lcd_panel_commands.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_lcd_panel_vendor.h"
@@ -15,6 +16,8 @@
 #include "lvgl_private.h"
 
 #include "display.h"
+#include "draw_sw_kernels.h"
+#include "render_profiler.h"
 #include "ui.h"
 #if CONFIG_LCD_TOUCH_ENABLED
     #include "touch.h"
@@ -22,15 +25,8 @@
 
 static const char *TAG = "display";
 
-#ifdef CONFIG_LCD_I80_COLOR_IN_PSRAM
-// #define LCD_PIXEL_CLOCK_HZ (2 * 1000 * 1000)
-// #define LCD_PIXEL_CLOCK_HZ (5 * 1000 * 1000)
-// #define LCD_PIXEL_CLOCK_HZ (7.5 * 1000 * 1000)
-    #define LCD_PIXEL_CLOCK_HZ (10 * 1000 * 1000)
-// #define LCD_PIXEL_CLOCK_HZ (20 * 1000 * 1000)
-#else
-    #define LCD_PIXEL_CLOCK_HZ (20 * 1000 * 1000)
-#endif
+// Pixel clock. Colors fetched from PSRAM can't keep up with much more than 10 MHz, internal DMA RAM can go higher
+#define LCD_PIXEL_CLOCK_HZ (CONFIG_LCD_I80_PIXEL_CLOCK_MHZ * 1000 * 1000)
 
 // ST7789 specific options
 #ifdef CONFIG_LCD_CONTROLLER_ST7789
@@ -74,7 +70,15 @@ static const char *TAG = "display";
 static esp_lcd_panel_handle_t panel_handle = NULL;
 
 // Display buffer size. Tune this for the display size, color depth, DMA/PSRAM usage, etc.
-#define LV_BUFFER_SIZE (CONFIG_LCD_WIDTH * CONFIG_LCD_HEIGHT * sizeof(lv_color16_t) / 1)
+#if CONFIG_LCD_RENDER_MODE_PARTIAL
+    // Strips as wide as the longest side so they fit any orientation
+    #define LV_BUFFER_LINE_PIXELS (CONFIG_LCD_WIDTH > CONFIG_LCD_HEIGHT ? CONFIG_LCD_WIDTH : CONFIG_LCD_HEIGHT)
+    #define LV_BUFFER_SIZE        (LV_BUFFER_LINE_PIXELS * CONFIG_LCD_RENDER_BUFFER_LINES * sizeof(lv_color16_t))
+    #define LV_RENDER_MODE        LV_DISPLAY_RENDER_MODE_PARTIAL
+#else
+    #define LV_BUFFER_SIZE (CONFIG_LCD_WIDTH * CONFIG_LCD_HEIGHT * sizeof(lv_color16_t) / 1)
+    #define LV_RENDER_MODE LV_DISPLAY_RENDER_MODE_FULL
+#endif
 
 // LVGL configuration
 #define LVGL_TICK_PERIOD_MS    2
@@ -83,12 +87,25 @@ static esp_lcd_panel_handle_t panel_handle = NULL;
 #define LVGL_TASK_STACK_SIZE   (8 * 1024)
 #define LVGL_TASK_PRIORITY     6
 
+// Frame pacing: the LVGL task refreshes the display once per frame period, woken by a periodic timer or by the panel's
+// tearing effect (vertical blank) pulse if it's wired
+#if CONFIG_LCD_FRAME_PACING
+    #define FRAME_PERIOD_US (CONFIG_LCD_FRAME_PERIOD_MS * 1000)
+    #define LCD_TE_ENABLED  (CONFIG_LCD_TE_GPIO >= 0)
+static TaskHandle_t lvgl_task_handle  = NULL;
+static volatile int64_t next_frame_us = 0; // Next frame boundary
+#endif
+
 // LVGL display object
 static lv_display_t *display = NULL;
 
 // Display initialization flag
 static bool display_initialized = false;
 
+// Render statistics, updated from the LVGL task
+static display_render_stats_t render_stats = {0};
+static int64_t render_start_us             = 0;
+
 // Determine the default display orientation
 static display_orientation_t
 #ifdef CONFIG_LCD_ORIENTATION_LANDSCAPE
@@ -132,14 +149,26 @@ int8_t get_channel(uint8_t pin) {
     return channel;
 }
 
-static uint8_t analog_resolution = 8;
+static uint8_t analog_resolution = 12; // Fine enough for fades to look smooth at low levels
 static int analog_frequency      = 1000;
+
+// LEDC channel driving the backlight, configured once by init_backlight()
+static bool backlight_ready          = false;
+static ledc_mode_t backlight_mode    = LEDC_LOW_SPEED_MODE;
+static ledc_channel_t backlight_chan = LEDC_CHANNEL_0;
+
 /**
- * @brief Set the backlight level using LEDC PWM
- *
- * @param level The backlight level (0-255)
+ * @brief Convert a backlight level (0-255) to an LEDC duty cycle
  */
-void set_backlight(uint8_t level) {
+static inline uint32_t backlight_duty(uint8_t level) {
+    return level * ((1 << analog_resolution) - 1) / 255;
+}
+
+/**
+ * @brief Configure the LEDC timer, channel and fade engine for the backlight. Only done once, level changes just update
+ * the duty cycle
+ */
+static void init_backlight() {
     // Get and validate LEDC channel
     int8_t chan = get_channel(LCD_BACKLIGHT_PIN);
     if (chan < 0 || chan >= SOC_LEDC_CHANNEL_NUM) {
@@ -170,15 +199,13 @@ void set_backlight(uint8_t level) {
         ESP_LOGE(TAG, "LEDC frequency config failed");
         return;
     }
-    uint32_t duty                      = ledc_get_duty(group, channel);
-    uint32_t max_duty                  = (1 << analog_resolution) - 1;
     ledc_channel_config_t ledc_channel = {
         .speed_mode = group,
         .channel    = channel,
         .timer_sel  = timer,
         .intr_type  = LEDC_INTR_DISABLE,
         .gpio_num   = LCD_BACKLIGHT_PIN,
-        .duty       = duty,
+        .duty       = 0,
     };
     if (ledc_channel_config(&ledc_channel) != ESP_OK) {
         ESP_LOGE(TAG, "LEDC channel config failed");
@@ -186,11 +213,60 @@ void set_backlight(uint8_t level) {
     }
     pin_channels[LCD_BACKLIGHT_PIN] = channel + 1;
 
-    // Set LEDC channel duty to write level
-    ledc_set_duty(group, channel, level * max_duty / 255);
-    ledc_update_duty(group, channel);
+    // The fade engine also makes duty updates thread safe
+    esp_err_t err = ledc_fade_func_install(0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "LEDC fade install failed: %s", esp_err_to_name(err));
+        return;
+    }
+
+    backlight_mode  = group;
+    backlight_chan  = channel;
+    backlight_ready = true;
+}
+
+/**
+ * @brief Set the backlight level using LEDC PWM
+ *
+ * @param level The backlight level (0-255)
+ */
+void set_backlight(uint8_t level) {
+    if (!backlight_ready) {
+        return;
+    }
+
+    // A fade in progress holds the channel until it finishes, so cancel it first
+    ledc_fade_stop(backlight_mode, backlight_chan);
+    ledc_set_duty_and_update(backlight_mode, backlight_chan, backlight_duty(level), 0);
+}
+
+/**
+ * @brief Fade the backlight to a level in hardware, without blocking
+ *
+ * @param level The backlight level (0-255)
+ * @param duration_ms Fade duration
+ */
+void fade_backlight(uint8_t level, uint32_t duration_ms) {
+    if (!backlight_ready) {
+        return;
+    }
+    if (duration_ms == 0) {
+        set_backlight(level);
+        return;
+    }
+
+    ledc_fade_stop(backlight_mode, backlight_chan);
+    ledc_set_fade_time_and_start(backlight_mode, backlight_chan, backlight_duty(level), duration_ms, LEDC_FADE_NO_WAIT);
 }
 #elif defined(CONFIG_LCD_BACKLIGHT_CONTROL_SIMPLE)
+/**
+ * @brief Pin reset for the backlight pin
+ */
+static void init_backlight() {
+    gpio_reset_pin(LCD_BACKLIGHT_PIN);
+    gpio_set_direction(LCD_BACKLIGHT_PIN, GPIO_MODE_OUTPUT);
+}
+
 /**
  * @brief Set the backlight level using simple GPIO high/low output
  *
@@ -199,15 +275,18 @@ void set_backlight(uint8_t level) {
 void set_backlight(bool level) {
     gpio_set_level(LCD_BACKLIGHT_PIN, level);
 }
-#endif
 
 /**
- * @brief Pin reset for the backlight pin
+ * @brief Switch the backlight, there is nothing to fade with a plain GPIO
+ *
+ * @param level Turn the backlight on or off
+ * @param duration_ms Ignored
  */
-static void init_backlight() {
-    gpio_reset_pin(LCD_BACKLIGHT_PIN);
-    gpio_set_direction(LCD_BACKLIGHT_PIN, GPIO_MODE_OUTPUT);
+void fade_backlight(bool level, uint32_t duration_ms) {
+    (void)duration_ms;
+    set_backlight(level);
 }
+#endif
 
 /**
  * @brief Notify LVGL that flush is ready (ie. panel I/O has finished transfering color data)
@@ -218,6 +297,7 @@ static void init_backlight() {
  * @return Whether a high priority task has been woken up by this function
  */
 static bool notify_lvgl_flush_ready(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *event, void *user_ctx) {
+    render_profiler_flush_done();
     lv_display_flush_ready((lv_display_t *)user_ctx);
     return false;
 }
@@ -230,15 +310,53 @@ static bool notify_lvgl_flush_ready(esp_lcd_panel_io_handle_t panel_io, esp_lcd_
  * @param px_map Pixel map
  */
 static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
+    render_stats.flush_count++;
+    render_stats.flush_bytes += lv_area_get_size(area) * sizeof(lv_color16_t);
+    render_profiler_flush_start();
 #if (CONFIG_LCD_SWAP_COLOR_LVGL && LCD_BUS_WIDTH == 8)
-    // For 8-bit interfaces we need to swap the color bytes. Use LVGL (slower) to do it if we aren't doing it in DMA
-    lv_draw_sw_rgb565_swap(px_map, (area->x2 - area->x1 + 1) * (area->y2 - area->y1 + 1));
+    // For 8-bit interfaces we need to swap the color bytes. Do it on the CPU (slower) if we aren't doing it in DMA
+    draw_sw_rgb565_swap(px_map, lv_area_get_size(area));
 #endif
     // Copy the buffer content to the display at the specified area
     esp_lcd_panel_draw_bitmap((esp_lcd_panel_handle_t)lv_display_get_user_data(disp), area->x1, area->y1, area->x2 + 1,
                               area->y2 + 1, px_map);
 }
 
+/**
+ * @brief Track how long LVGL spends rendering each frame
+ *
+ * @param e LVGL event
+ */
+static void lvgl_render_event_cb(lv_event_t *e) {
+    int64_t now = esp_timer_get_time();
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        render_start_us = now;
+
+        // Areas merged into others are flagged as joined and don't get rendered on their own
+        uint32_t invalidated_px = 0;
+        for (uint32_t i = 0; i < display->inv_p; i++) {
+            if (!display->inv_area_joined[i]) {
+                invalidated_px += lv_area_get_size(&display->inv_areas[i]);
+            }
+        }
+        render_profiler_render_start(invalidated_px);
+        return;
+    }
+    render_profiler_render_ready();
+    if (render_start_us == 0) {
+        return;
+    }
+
+    uint32_t frame_us = now - render_start_us;
+    render_start_us   = 0;
+    render_stats.frames++;
+    render_stats.frame_time_last_us   = frame_us;
+    render_stats.frame_time_total_us += frame_us;
+    if (frame_us > render_stats.frame_time_max_us) {
+        render_stats.frame_time_max_us = frame_us;
+    }
+}
+
 /**
  * @brief LVGL tick task
  */
@@ -302,6 +420,102 @@ bool lvgl_unlock(const char *file, int line) {
     return ret;
 }
 
+#if CONFIG_LCD_FRAME_PACING
+    #if LCD_TE_ENABLED
+/**
+ * @brief Panel TE pulse (start of vertical blank). Wakes the LVGL task on the first pulse at or after the frame
+ * boundary so a refresh never races the panel's scan out
+ */
+static void IRAM_ATTR lcd_te_isr_handler(void *_arg) {
+    (void)_arg;
+    if (lvgl_task_handle == NULL || esp_timer_get_time() < next_frame_us) {
+        return;
+    }
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(lvgl_task_handle, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+/**
+ * @brief Turn on the panel's TE output (vertical blank only) and listen for its pulses
+ *
+ * @param io_handle Panel I/O handle
+ */
+static void init_lcd_te(esp_lcd_panel_io_handle_t io_handle) {
+    ESP_ERROR_CHECK(esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_TEON, (uint8_t[]){0}, 1));
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << CONFIG_LCD_TE_GPIO,
+        .mode         = GPIO_MODE_INPUT,
+        .pull_up_en   = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type    = GPIO_INTR_POSEDGE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+    ESP_ERROR_CHECK(gpio_isr_handler_add(CONFIG_LCD_TE_GPIO, lcd_te_isr_handler, NULL));
+}
+    #else
+/**
+ * @brief Frame timer, wakes the LVGL task at every frame boundary
+ */
+static void frame_timer_cb(void *_arg) {
+    (void)_arg;
+    xTaskNotifyGive(lvgl_task_handle);
+}
+    #endif
+
+/**
+ * @brief Paced LVGL loop: run LVGL timers and refresh the display once per frame period
+ */
+static void lvgl_paced_loop() {
+    #if !LCD_TE_ENABLED
+    esp_timer_handle_t frame_timer                 = NULL;
+    const esp_timer_create_args_t frame_timer_args = {
+        .callback = &frame_timer_cb,
+        .name     = "lvgl_frame",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&frame_timer_args, &frame_timer));
+    #endif
+
+    // LVGL's own refresh timer would refresh whenever lv_timer_handler() runs, the loop below drives refreshes instead
+    lv_display_delete_refr_timer(display);
+    lvgl_task_handle = xTaskGetCurrentTaskHandle();
+    next_frame_us    = esp_timer_get_time() + FRAME_PERIOD_US;
+    #if !LCD_TE_ENABLED
+    ESP_ERROR_CHECK(esp_timer_start_periodic(frame_timer, FRAME_PERIOD_US));
+    #endif
+
+    while (1) {
+        // The timeout keeps LVGL running if the TE line stops pulsing
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LVGL_TASK_MAX_DELAY_MS));
+
+        // Count the boundaries that went by while the previous frame was still being worked on
+        int64_t frame_start_us = esp_timer_get_time();
+        int64_t behind_us      = frame_start_us - next_frame_us;
+        if (behind_us >= FRAME_PERIOD_US) {
+            render_stats.frames_dropped += behind_us / FRAME_PERIOD_US;
+        }
+        next_frame_us += (behind_us > 0 ? behind_us / FRAME_PERIOD_US + 1 : 1) * FRAME_PERIOD_US;
+
+        lv_timer_handler();
+        if (lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+            if (display->inv_p > 0) {
+                lv_display_refr_timer(NULL);
+            } else {
+                render_stats.frames_skipped++;
+            }
+            lvgl_unlock(__FILE__, __LINE__);
+        }
+
+        int64_t frame_end_us = esp_timer_get_time();
+        render_profiler_handler_done(frame_end_us - frame_start_us);
+        if (frame_end_us > next_frame_us) {
+            render_stats.frames_late++;
+        }
+    }
+}
+#endif // CONFIG_LCD_FRAME_PACING
+
 /**
  * @brief LVGL main task
  */
@@ -318,9 +532,14 @@ static void lvgl_task(void *_arg) {
     }
 
     ESP_LOGI(TAG, "Starting LVGL task");
+#if CONFIG_LCD_FRAME_PACING
+    lvgl_paced_loop();
+#else
     uint32_t task_delay_ms = LVGL_TASK_MAX_DELAY_MS;
     while (1) {
-        task_delay_ms = lv_timer_handler();
+        int64_t handler_start_us = esp_timer_get_time();
+        task_delay_ms            = lv_timer_handler();
+        render_profiler_handler_done(esp_timer_get_time() - handler_start_us);
         if (task_delay_ms > LVGL_TASK_MAX_DELAY_MS) {
             task_delay_ms = LVGL_TASK_MAX_DELAY_MS;
         } else if (task_delay_ms < LVGL_TASK_MIN_DELAY_MS) {
@@ -328,6 +547,7 @@ static void lvgl_task(void *_arg) {
         }
         vTaskDelay(pdMS_TO_TICKS(task_delay_ms));
     }
+#endif
 }
 
 /**
@@ -367,7 +587,7 @@ static void init_lcd_bus(esp_lcd_panel_io_handle_t *io_handle, void *user_ctx) {
             },
         // clang-format on
         .bus_width          = LCD_BUS_WIDTH,
-        .max_transfer_bytes = CONFIG_LCD_WIDTH * CONFIG_LCD_HEIGHT * sizeof(uint16_t),
+        .max_transfer_bytes = LV_BUFFER_SIZE,
         .dma_burst_size     = 64,
     };
     ESP_ERROR_CHECK(esp_lcd_new_i80_bus(&bus_config, &i80_bus));
@@ -548,6 +768,9 @@ void lvgl_display_setup() {
     // Initialize LCD panel
     ESP_LOGI(TAG, "Initialize LCD panel");
     init_lcd_panel(&io_handle, &panel_handle);
+#if CONFIG_LCD_FRAME_PACING && LCD_TE_ENABLED
+    init_lcd_te(io_handle);
+#endif
 
 #if CONFIG_LCD_TOUCH_ENABLED
     // Initialize and configure touch interface
@@ -572,7 +795,8 @@ void lvgl_display_setup() {
     // Register the display driver to LVGL
     lv_display_set_user_data(display, panel_handle);
 
-    // Allocate the draw buffers for LVGL (2 for double buffering)
+    // Allocate the draw buffers for LVGL (2 for double buffering). In partial mode LVGL renders into one strip while
+    // the other is being pushed out over DMA
     lv_color_t *buf1 = NULL;
     lv_color_t *buf2 = NULL;
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
@@ -596,19 +820,19 @@ void lvgl_display_setup() {
     ESP_ERROR_CHECK(esp_dma_malloc(LV_BUFFER_SIZE, malloc_flags, (void **)&buf2, NULL));
 #endif
     assert(buf1 && buf2);
-    ESP_LOGI(TAG, "LVGL draw buffers allocated at %p and %p", buf1, buf2);
+    ESP_LOGI(TAG, "LVGL draw buffers (%u bytes) allocated at %p and %p", (unsigned int)LV_BUFFER_SIZE, buf1, buf2);
 
-    // Initialize LVGL draw buffers
+    // Initialize LVGL draw buffers. In partial mode LVGL merges overlapping invalidated areas before rendering, so only
+    // the dirty rectangles are pushed to the panel
     lv_display_set_flush_cb(display, lvgl_flush_cb);
     lv_display_set_buffers(display,        // Display handle
                            buf1,           // Buffer 1
                            buf2,           // Buffer 2
                            LV_BUFFER_SIZE, // Buffer size in bytes
-                           //    LV_DISPLAY_RENDER_MODE_PARTIAL // Render mode: partial allows buffers to be smaller than display
-                           //    size
-                           LV_DISPLAY_RENDER_MODE_FULL
-                           // to save RAM
+                           LV_RENDER_MODE  // Render mode: partial allows buffers to be smaller than display size
     );
+    lv_display_add_event_cb(display, lvgl_render_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(display, lvgl_render_event_cb, LV_EVENT_RENDER_READY, NULL);
 
     // Install LVGL tick timer
     // ESP_LOGI(TAG, "Install LVGL tick timer");
@@ -631,3 +855,10 @@ void lvgl_display_setup() {
 bool display_ready() {
     return display_initialized;
 }
+
+void display_get_render_stats(display_render_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    *stats = render_stats;
+}
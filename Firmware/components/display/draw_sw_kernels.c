@@ -0,0 +1,163 @@
+#include <string.h>
+#include "sdkconfig.h"
+#include "lvgl.h"
+
+#include "draw_sw_kernels.h"
+
+#if CONFIG_LCD_DRAW_SW_PIE
+// PIE kernels (draw_sw_kernels_esp32s3.S). Both require a 16 byte aligned destination (and source for the copy) and work
+// in whole 16 byte blocks
+extern void draw_sw_pie_fill_16b(void *dest, uint32_t blocks, const uint32_t *pattern);
+extern void draw_sw_pie_copy_16b(void *dest, const void *src, uint32_t blocks);
+
+    // Rows shorter than this aren't worth the alignment prologue
+    #define PIE_MIN_ROW_BYTES 64
+#endif
+
+/**
+ * @brief Swap the bytes of each RGB565 pixel, two pixels per 32-bit word
+ *
+ * @param buf Pixel buffer
+ * @param count Number of pixels
+ */
+void draw_sw_rgb565_swap(void *buf, uint32_t count) {
+    uint16_t *buf16 = buf;
+    if (((uintptr_t)buf16 & 0x3) && count) {
+        *buf16 = (*buf16 >> 8) | (*buf16 << 8);
+        buf16++;
+        count--;
+    }
+
+    uint32_t *buf32 = (uint32_t *)buf16;
+    uint32_t words  = count / 2;
+    while (words >= 4) {
+        buf32[0]  = ((buf32[0] & 0xff00ff00) >> 8) | ((buf32[0] & 0x00ff00ff) << 8);
+        buf32[1]  = ((buf32[1] & 0xff00ff00) >> 8) | ((buf32[1] & 0x00ff00ff) << 8);
+        buf32[2]  = ((buf32[2] & 0xff00ff00) >> 8) | ((buf32[2] & 0x00ff00ff) << 8);
+        buf32[3]  = ((buf32[3] & 0xff00ff00) >> 8) | ((buf32[3] & 0x00ff00ff) << 8);
+        buf32    += 4;
+        words    -= 4;
+    }
+    while (words--) {
+        *buf32 = ((*buf32 & 0xff00ff00) >> 8) | ((*buf32 & 0x00ff00ff) << 8);
+        buf32++;
+    }
+
+    if (count & 1) {
+        buf16  = (uint16_t *)buf32;
+        *buf16 = (*buf16 >> 8) | (*buf16 << 8);
+    }
+}
+
+/**
+ * @brief Fill one row with a color
+ *
+ * @param row Row start
+ * @param w Row width in pixels
+ * @param color RGB565 color
+ */
+static inline void fill_row(uint16_t *row, int32_t w, uint16_t color) {
+    uint32_t pattern = color | ((uint32_t)color << 16);
+#if CONFIG_LCD_DRAW_SW_PIE
+    if (w * 2 >= PIE_MIN_ROW_BYTES) {
+        // Align to 16 bytes with scalar stores, then let PIE do the bulk
+        while ((uintptr_t)row & 0xf) {
+            *row++ = color;
+            w--;
+        }
+        uint32_t blocks = w / 8;
+        draw_sw_pie_fill_16b(row, blocks, &pattern);
+        row += blocks * 8;
+        w   -= blocks * 8;
+    }
+#endif
+    if (((uintptr_t)row & 0x3) && w > 0) {
+        *row++ = color;
+        w--;
+    }
+    uint32_t *row32 = (uint32_t *)row;
+    for (; w >= 2; w -= 2) {
+        *row32++ = pattern;
+    }
+    if (w > 0) {
+        *(uint16_t *)row32 = color;
+    }
+}
+
+void draw_sw_rgb565_fill(void *dest, int32_t w, int32_t h, int32_t dest_stride, uint16_t color) {
+    uint8_t *row = dest;
+    for (int32_t y = 0; y < h; y++) {
+        fill_row((uint16_t *)row, w, color);
+        row += dest_stride;
+    }
+}
+
+void draw_sw_rgb565_copy(void *dest, int32_t w, int32_t h, int32_t dest_stride, const void *src, int32_t src_stride) {
+    uint8_t *dest_row      = dest;
+    const uint8_t *src_row = src;
+    size_t row_bytes       = w * sizeof(uint16_t);
+    for (int32_t y = 0; y < h; y++) {
+#if CONFIG_LCD_DRAW_SW_PIE
+        // PIE loads and stores need both sides on the same 16 byte alignment
+        uintptr_t head = (16 - ((uintptr_t)dest_row & 0xf)) & 0xf;
+        if (row_bytes >= PIE_MIN_ROW_BYTES && (((uintptr_t)dest_row ^ (uintptr_t)src_row) & 0xf) == 0) {
+            uint32_t blocks = (row_bytes - head) / 16;
+            memcpy(dest_row, src_row, head);
+            draw_sw_pie_copy_16b(dest_row + head, src_row + head, blocks);
+            size_t done = head + blocks * 16;
+            memcpy(dest_row + done, src_row + done, row_bytes - done);
+        } else {
+            memcpy(dest_row, src_row, row_bytes);
+        }
+#else
+        memcpy(dest_row, src_row, row_bytes);
+#endif
+        dest_row += dest_stride;
+        src_row  += src_stride;
+    }
+}
+
+void draw_sw_rgb565_blend(void *dest, int32_t w, int32_t h, int32_t dest_stride, const void *src, int32_t src_stride,
+                          uint8_t opa, const uint8_t *mask, int32_t mask_stride) {
+    uint8_t *dest_row      = dest;
+    const uint8_t *src_row = src;
+    for (int32_t y = 0; y < h; y++) {
+        uint16_t *d       = (uint16_t *)dest_row;
+        const uint16_t *s = (const uint16_t *)src_row;
+        if (mask == NULL) {
+            for (int32_t x = 0; x < w; x++) {
+                d[x] = lv_color_16_16_mix(s[x], d[x], opa);
+            }
+        } else if (opa >= LV_OPA_MAX) {
+            int32_t x = 0;
+            while (x < w) {
+                // RGB565A8 assets are mostly fully transparent or fully opaque, so skip or copy four pixels at a time
+                // when the mask allows it. Only the exact 0 and 255 cases are short-circuited, matching LVGL's mix
+                if (x + 4 <= w) {
+                    uint32_t m;
+                    memcpy(&m, &mask[x], sizeof(m));
+                    if (m == 0) {
+                        x += 4;
+                        continue;
+                    }
+                    if (m == 0xffffffff) {
+                        memcpy(&d[x], &s[x], 4 * sizeof(uint16_t));
+                        x += 4;
+                        continue;
+                    }
+                }
+                d[x] = lv_color_16_16_mix(s[x], d[x], mask[x]);
+                x++;
+            }
+            mask += mask_stride;
+        } else {
+            // Keep the opacity test out of the pixel loop, a faded mask has no runs worth looking for
+            for (int32_t x = 0; x < w; x++) {
+                d[x] = lv_color_16_16_mix(s[x], d[x], LV_OPA_MIX2(mask[x], opa));
+            }
+            mask += mask_stride;
+        }
+        dest_row += dest_stride;
+        src_row  += src_stride;
+    }
+}
@@ -15,13 +15,17 @@ extern "C" {
 #if defined(CONFIG_LCD_BACKLIGHT_CONTROL_PWM)
     #define LCD_BACKLIGHT_ON  128
     #define LCD_BACKLIGHT_OFF 0
-// Set the backlight level (0-255).
+// Set the backlight level (0-255), cancelling any fade in progress.
 void set_backlight(uint8_t level);
+// Fade the backlight to a level (0-255) over `duration_ms` using the LEDC fade engine. Returns immediately.
+void fade_backlight(uint8_t level, uint32_t duration_ms);
 #elif defined(CONFIG_LCD_BACKLIGHT_CONTROL_SIMPLE)
     #define LCD_BACKLIGHT_ON  1
     #define LCD_BACKLIGHT_OFF !LCD_BACKLIGHT_ON
 // Turn the backlight on or off.
 void set_backlight(bool on);
+// Same as set_backlight(), the GPIO backlight can't fade.
+void fade_backlight(bool on, uint32_t duration_ms);
 #endif
 
 // LVGL mutex lock
@@ -36,6 +40,22 @@ void display_init();
 // Return whether or not the display is initialized.
 bool display_ready();
 
+// Rendering counters, useful for comparing render modes and pixel clocks
+typedef struct {
+    uint32_t frames;              // Frames rendered
+    uint32_t frame_time_last_us;  // Render time of the most recent frame
+    uint32_t frame_time_max_us;   // Longest frame render time
+    uint64_t frame_time_total_us; // Sum of all frame render times, divide by frames for the average
+    uint32_t flush_count;         // Areas flushed to the panel
+    uint64_t flush_bytes;         // Color bytes flushed to the panel
+    uint32_t frames_skipped;      // Paced refreshes skipped because nothing was invalidated (CONFIG_LCD_FRAME_PACING)
+    uint32_t frames_late;         // Paced frames whose work ran past the next frame boundary
+    uint32_t frames_dropped;      // Frame boundaries missed entirely because of late frames
+} display_render_stats_t;
+
+// Get a snapshot of the render statistics.
+void display_get_render_stats(display_render_stats_t *stats);
+
 // Get the display orientation parameters.
 display_orientation_params_t get_params_for_display_orientation(display_orientation_t orientation);
 
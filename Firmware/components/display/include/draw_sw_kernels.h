@@ -0,0 +1,57 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// RGB565 kernels for the LVGL software renderer. On the ESP32-S3 the fill and opaque copy paths use PIE (SIMD) 128-bit
+// stores, everything else is portable C. Blends go through lv_color_16_16_mix so results match LVGL bit for bit.
+//
+// This header is also LVGL's LV_DRAW_SW_ASM_CUSTOM_INCLUDE, so the macros below replace LVGL's scalar loops when
+// CONFIG_LV_DRAW_SW_ASM_CUSTOM is selected. Strides are in bytes, as in LVGL's blend descriptors.
+
+// Swap the bytes of `count` RGB565 pixels in place.
+void draw_sw_rgb565_swap(void *buf, uint32_t count);
+
+// Fill a `w` x `h` area with a single RGB565 color.
+void draw_sw_rgb565_fill(void *dest, int32_t w, int32_t h, int32_t dest_stride, uint16_t color);
+
+// Copy a `w` x `h` RGB565 area.
+void draw_sw_rgb565_copy(void *dest, int32_t w, int32_t h, int32_t dest_stride, const void *src, int32_t src_stride);
+
+// Blend a `w` x `h` RGB565 area onto dest with an overall opacity and an optional A8 mask (NULL for none).
+void draw_sw_rgb565_blend(void *dest, int32_t w, int32_t h, int32_t dest_stride, const void *src, int32_t src_stride,
+                          uint8_t opa, const uint8_t *mask, int32_t mask_stride);
+
+// LVGL software draw hooks
+#define LV_DRAW_SW_RGB565_SWAP(buf, buf_size_px) (draw_sw_rgb565_swap((buf), (buf_size_px)), LV_RESULT_OK)
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc)                                                                                 \
+    (draw_sw_rgb565_fill((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, lv_color_to_u16((dsc)->color)), \
+     LV_RESULT_OK)
+
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc)                                                                         \
+    (draw_sw_rgb565_copy((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, (dsc)->src_buf,                  \
+                         (dsc)->src_stride),                                                                                  \
+     LV_RESULT_OK)
+
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_OPA(dsc)                                                                \
+    (draw_sw_rgb565_blend((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, (dsc)->src_buf,                 \
+                          (dsc)->src_stride, (dsc)->opa, NULL, 0),                                                            \
+     LV_RESULT_OK)
+
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_MASK(dsc)                                                               \
+    (draw_sw_rgb565_blend((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, (dsc)->src_buf,                 \
+                          (dsc)->src_stride, LV_OPA_COVER, (dsc)->mask_buf, (dsc)->mask_stride),                              \
+     LV_RESULT_OK)
+
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_MIX_MASK_OPA(dsc)                                                            \
+    (draw_sw_rgb565_blend((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride, (dsc)->src_buf,                 \
+                          (dsc)->src_stride, (dsc)->opa, (dsc)->mask_buf, (dsc)->mask_stride),                                \
+     LV_RESULT_OK)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+// One rendered frame
+typedef struct {
+    uint32_t timestamp_ms;       // When the frame finished rendering
+    uint32_t handler_us;         // Time spent in the lv_timer_handler() pass that rendered the frame
+    uint32_t render_us;          // Render time (LV_EVENT_RENDER_START to LV_EVENT_RENDER_READY)
+    uint32_t flush_us;           // Time the panel bus spent transferring color data for the frame
+    uint32_t invalidated_px;     // Invalidated pixels after LVGL merged overlapping areas
+    uint16_t flush_count;        // Areas flushed to the panel
+    uint16_t ui_queue_depth;     // Events waiting in the UI task queue
+    uint32_t heap_free_internal; // Free internal RAM
+    uint32_t heap_free_psram;    // Free PSRAM
+} render_profile_sample_t;
+
+// Aggregates over the samples currently in the ring buffer
+typedef struct {
+    uint32_t samples;            // Number of samples aggregated
+    uint32_t fps;                // Frames per second over the sampled time span
+    uint32_t handler_avg_us;     // Average lv_timer_handler() time per frame
+    uint32_t handler_max_us;     // Longest lv_timer_handler() time
+    uint32_t render_avg_us;      // Average render time
+    uint32_t render_max_us;      // Longest render time
+    uint32_t flush_avg_us;       // Average bus time per frame
+    uint32_t invalidated_avg_px; // Average invalidated pixels per frame
+    uint16_t ui_queue_depth_max; // Deepest UI task queue seen
+    uint32_t heap_free_internal; // Free internal RAM at the latest sample
+    uint32_t heap_free_psram;    // Free PSRAM at the latest sample
+} render_profile_summary_t;
+
+// Returns the number of pending events in a queue the profiler should track
+typedef uint32_t (*render_profiler_depth_fn_t)(void);
+
+// Set the function used to sample the UI task queue depth.
+void render_profiler_set_queue_depth_source(render_profiler_depth_fn_t fn);
+
+// Copy up to `max` of the most recent samples, oldest first. Returns the number copied.
+size_t render_profiler_get_samples(render_profile_sample_t *samples, size_t max);
+
+// Summarize the samples currently in the ring buffer.
+void render_profiler_get_summary(render_profile_summary_t *summary);
+
+// Log the summary and every sample in the ring buffer as CSV.
+void render_profiler_dump();
+
+// Display driver hooks
+void render_profiler_render_start(uint32_t invalidated_px);
+void render_profiler_render_ready();
+void render_profiler_flush_start();
+void render_profiler_flush_done(); // Safe to call from an ISR
+void render_profiler_handler_done(uint32_t handler_us);
+
+#ifdef __cplusplus
+}
+#endif
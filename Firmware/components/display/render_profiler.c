@@ -0,0 +1,185 @@
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "render_profiler.h"
+
+static const char *TAG = "render_profiler";
+
+#define PROFILER_SAMPLES CONFIG_LCD_RENDER_PROFILER_SAMPLES
+
+// Ring buffer of completed frames - written by the LVGL task, read from anywhere under ring_lock
+static render_profile_sample_t ring[PROFILER_SAMPLES] = {0};
+static size_t ring_head                               = 0; // Next slot to write
+static size_t ring_count                              = 0;
+static portMUX_TYPE ring_lock                         = portMUX_INITIALIZER_UNLOCKED;
+
+// Frame being built by the current lv_timer_handler() pass - LVGL task only
+static render_profile_sample_t frame = {0};
+static bool frame_open               = false;
+static int64_t render_start_us       = 0;
+
+// Bus time, accumulated from the color transfer done ISR
+static int64_t flush_start_us     = 0;
+static atomic_uint flush_accum_us = 0;
+
+static render_profiler_depth_fn_t queue_depth_fn = NULL;
+
+void render_profiler_set_queue_depth_source(render_profiler_depth_fn_t fn) {
+    queue_depth_fn = fn;
+}
+
+void render_profiler_render_start(uint32_t invalidated_px) {
+    memset(&frame, 0, sizeof(frame));
+    frame.invalidated_px = invalidated_px;
+    frame_open           = true;
+    render_start_us      = esp_timer_get_time();
+}
+
+void render_profiler_render_ready() {
+    if (!frame_open) {
+        return;
+    }
+    int64_t now        = esp_timer_get_time();
+    frame.render_us    = now - render_start_us;
+    frame.timestamp_ms = now / 1000;
+}
+
+void render_profiler_flush_start() {
+    flush_start_us = esp_timer_get_time();
+    if (frame_open) {
+        frame.flush_count++;
+    }
+}
+
+void render_profiler_flush_done() {
+    // LVGL waits for each flush to finish before starting the next, so there is only ever one in flight
+    atomic_fetch_add(&flush_accum_us, (unsigned int)(esp_timer_get_time() - flush_start_us));
+}
+
+void render_profiler_handler_done(uint32_t handler_us) {
+    if (!frame_open) {
+        return;
+    }
+    frame_open = false;
+
+    // The last strip of a frame may still be on the bus, in which case its time counts towards the next frame
+    frame.handler_us         = handler_us;
+    frame.flush_us           = atomic_exchange(&flush_accum_us, 0);
+    frame.heap_free_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    frame.heap_free_psram    = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    frame.ui_queue_depth     = queue_depth_fn != NULL ? queue_depth_fn() : 0;
+
+    portENTER_CRITICAL(&ring_lock);
+    ring[ring_head] = frame;
+    ring_head       = (ring_head + 1) % PROFILER_SAMPLES;
+    if (ring_count < PROFILER_SAMPLES) {
+        ring_count++;
+    }
+    portEXIT_CRITICAL(&ring_lock);
+}
+
+size_t render_profiler_get_samples(render_profile_sample_t *samples, size_t max) {
+    if (samples == NULL || max == 0) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&ring_lock);
+    size_t count = ring_count < max ? ring_count : max;
+    size_t start = (ring_head + PROFILER_SAMPLES - count) % PROFILER_SAMPLES;
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = ring[(start + i) % PROFILER_SAMPLES];
+    }
+    portEXIT_CRITICAL(&ring_lock);
+
+    return count;
+}
+
+/**
+ * @brief Aggregate a set of samples
+ *
+ * @param samples Samples, oldest first
+ * @param count Number of samples
+ * @param[out] summary Summary to fill in
+ */
+static void summarize(const render_profile_sample_t *samples, size_t count, render_profile_summary_t *summary) {
+    memset(summary, 0, sizeof(*summary));
+    if (count == 0) {
+        return;
+    }
+
+    uint64_t handler_total = 0, render_total = 0, flush_total = 0, invalidated_total = 0;
+    for (size_t i = 0; i < count; i++) {
+        const render_profile_sample_t *s  = &samples[i];
+        handler_total                    += s->handler_us;
+        render_total                     += s->render_us;
+        flush_total                      += s->flush_us;
+        invalidated_total                += s->invalidated_px;
+        if (s->handler_us > summary->handler_max_us) {
+            summary->handler_max_us = s->handler_us;
+        }
+        if (s->render_us > summary->render_max_us) {
+            summary->render_max_us = s->render_us;
+        }
+        if (s->ui_queue_depth > summary->ui_queue_depth_max) {
+            summary->ui_queue_depth_max = s->ui_queue_depth;
+        }
+    }
+
+    uint32_t span_ms            = samples[count - 1].timestamp_ms - samples[0].timestamp_ms;
+    summary->samples            = count;
+    summary->fps                = span_ms > 0 ? (count - 1) * 1000 / span_ms : 0;
+    summary->handler_avg_us     = handler_total / count;
+    summary->render_avg_us      = render_total / count;
+    summary->flush_avg_us       = flush_total / count;
+    summary->invalidated_avg_px = invalidated_total / count;
+    summary->heap_free_internal = samples[count - 1].heap_free_internal;
+    summary->heap_free_psram    = samples[count - 1].heap_free_psram;
+}
+
+void render_profiler_get_summary(render_profile_summary_t *summary) {
+    if (summary == NULL) {
+        return;
+    }
+
+    render_profile_sample_t *samples = malloc(sizeof(render_profile_sample_t) * PROFILER_SAMPLES);
+    if (samples == NULL) {
+        memset(summary, 0, sizeof(*summary));
+        return;
+    }
+    size_t count = render_profiler_get_samples(samples, PROFILER_SAMPLES);
+    summarize(samples, count, summary);
+    free(samples);
+}
+
+void render_profiler_dump() {
+    render_profile_sample_t *samples = malloc(sizeof(render_profile_sample_t) * PROFILER_SAMPLES);
+    if (samples == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate memory for the profiler dump");
+        return;
+    }
+    size_t count = render_profiler_get_samples(samples, PROFILER_SAMPLES);
+
+    render_profile_summary_t summary;
+    summarize(samples, count, &summary);
+    ESP_LOGI(TAG, "%lu frames, %lu fps, handler avg/max: %lu/%lu us, render avg/max: %lu/%lu us, flush avg: %lu us",
+             summary.samples, summary.fps, summary.handler_avg_us, summary.handler_max_us, summary.render_avg_us,
+             summary.render_max_us, summary.flush_avg_us);
+    ESP_LOGI(TAG, "Invalidated avg: %lu px, UI queue max: %u, free internal: %lu, free PSRAM: %lu", summary.invalidated_avg_px,
+             summary.ui_queue_depth_max, summary.heap_free_internal, summary.heap_free_psram);
+
+    printf("timestamp_ms,handler_us,render_us,flush_us,invalidated_px,flush_count,ui_queue_depth,heap_free_internal,"
+           "heap_free_psram\n");
+    for (size_t i = 0; i < count; i++) {
+        const render_profile_sample_t *s = &samples[i];
+        printf("%lu,%lu,%lu,%lu,%lu,%u,%u,%lu,%lu\n", s->timestamp_ms, s->handler_us, s->render_us, s->flush_us,
+               s->invalidated_px, s->flush_count, s->ui_queue_depth, s->heap_free_internal, s->heap_free_psram);
+    }
+
+    free(samples);
+}
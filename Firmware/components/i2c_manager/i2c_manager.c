@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "i2c_manager.h"
 #include "driver/gpio.h"
@@ -12,6 +13,17 @@ i2c_manager_bus_t i2c_bus[SOC_I2C_NUM] = {0};
 i2c_manager_known_device_t i2c_devices[MAX_I2C_DEVICES];
 uint8_t i2c_device_count = 0;
 
+// Channel of a device on the I2C switch, 0 without one
+#ifdef CONFIG_I2C_SWITCH_ENABLED
+    #define DEVICE_CHANNEL(device) ((device)->channel)
+#else
+    #define DEVICE_CHANNEL(device) 0
+#endif
+
+static SemaphoreHandle_t i2c_devices_lock = NULL; // Guards i2c_devices and i2c_device_count
+static uint32_t switch_select_count       = 0;
+static uint32_t device_add_count          = 0;
+
 // Use 100 kHz as the default I2C bus speed
 #define I2C_DEFAULT_BUS_SPEED 100000
 
@@ -155,7 +167,8 @@ esp_err_t i2c_switch_init() {
     uint8_t control = 0;
     ESP_GOTO_ON_ERROR(i2c_master_receive(i2c_switch, &control, 1, portMAX_DELAY), cleanup, TAG,
                       "Failed to read I2C switch control register");
-    i2c_switch_channel = control & TCA9544A_CTRL_REG_CHANNEL_BITS;
+    // The switch comes out of reset with no channel enabled, which mustn't pass for channel 0 being selected
+    i2c_switch_channel = control & TCA9544A_CTRL_REG_ENABLE ? control & TCA9544A_CTRL_REG_CHANNEL_BITS : I2C_SWITCH_CHANNELS;
     ESP_LOGD(TAG, "I2C switch control register: 0x%02X", control);
 
 cleanup:
@@ -206,6 +219,7 @@ esp_err_t i2c_switch_select(uint8_t channel) {
     uint8_t command = TCA9544A_CTRL_REG_ENABLE | (channel & TCA9544A_CTRL_REG_CHANNEL_BITS);
     if (i2c_master_transmit(i2c_switch, &command, 1, portMAX_DELAY) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to select I2C switch channel %d", channel);
+        xSemaphoreGive(i2c_switch_lock);
         return ESP_FAIL;
     }
 
@@ -225,6 +239,7 @@ esp_err_t i2c_switch_select(uint8_t channel) {
 
     // Update the selected channel
     i2c_switch_channel = channel;
+    switch_select_count++;
     xSemaphoreGive(i2c_switch_lock);
 
     return ESP_OK;
@@ -312,6 +327,13 @@ esp_err_t i2c_manager_init(i2c_manager_pin_config_t *i2c_pins, uint8_t i2c_bus_c
         ESP_LOGE(TAG, "I2C buses already initialized");
         return ESP_ERR_INVALID_STATE;
     }
+    if (i2c_devices_lock == NULL) {
+        i2c_devices_lock = xSemaphoreCreateMutex();
+        if (i2c_devices_lock == NULL) {
+            ESP_LOGE(TAG, "Failed to create I2C device list lock");
+            return ESP_FAIL;
+        }
+    }
     for (uint8_t i = 0; i < i2c_bus_count; i++) {
         i2c_master_bus_config_t config = {
             .i2c_port                     = i,
@@ -505,26 +527,46 @@ uint8_t i2c_manager_discover(i2c_manager_device_criteria_t criteria, i2c_manager
     return device_count;
 }
 
-esp_err_t i2c_manager_add_device(i2c_manager_device_config_t *device, i2c_master_dev_handle_t *handle) {
-    ESP_RETURN_ON_ERROR(check_device_config(device), TAG, "Invalid I2C device configuration");
-
-    // Make sure we don't already have this device added
+/**
+ * @brief Find a known device. The caller must hold i2c_devices_lock.
+ *
+ * @param bus_index I2C bus index
+ * @param channel I2C switch channel, ignored without a switch
+ * @param address 7-bit I2C address
+ * @return Index into i2c_devices, or -1 if the device isn't known
+ */
+static int find_known_device(uint8_t bus_index, uint8_t channel, uint16_t address) {
     for (uint8_t i = 0; i < i2c_device_count; i++) {
-        if (i2c_devices[i].bus_index == device->bus_index && i2c_devices[i].address == device->config.device_address) {
+        if (i2c_devices[i].bus_index == bus_index && i2c_devices[i].address == address) {
 #ifdef CONFIG_I2C_SWITCH_ENABLED
-            if (i2c_devices[i].channel == device->channel) {
+            if (i2c_devices[i].channel == channel) {
 #endif
-                ESP_LOGE(TAG, "I2C device already added to bus %d", device->bus_index);
-                return ESP_ERR_INVALID_STATE;
+                return i;
 #ifdef CONFIG_I2C_SWITCH_ENABLED
             }
 #endif
         }
     }
+    return -1;
+}
+
+/**
+ * @brief Add a device to its bus and track it. The caller must hold i2c_devices_lock.
+ *
+ * @param device Device configuration
+ * @param[out] handle Device handle
+ * @return esp_err_t
+ */
+static esp_err_t add_known_device(i2c_manager_device_config_t *device, i2c_master_dev_handle_t *handle) {
+    if (i2c_device_count >= MAX_I2C_DEVICES) {
+        ESP_LOGE(TAG, "Too many I2C devices, max is %d", MAX_I2C_DEVICES);
+        return ESP_ERR_NO_MEM;
+    }
 
     // Add the device to the bus to get a handle
     ESP_RETURN_ON_ERROR(i2c_master_bus_add_device(i2c_bus[device->bus_index].handle, &device->config, handle), TAG,
                         "Failed to add I2C device to bus %d", device->bus_index);
+    device_add_count++;
 
     // Add the device to the list of known devices we're tracking
     i2c_manager_known_device_t known_device = {
@@ -540,146 +582,223 @@ esp_err_t i2c_manager_add_device(i2c_manager_device_config_t *device, i2c_master
     return ESP_OK;
 }
 
+esp_err_t i2c_manager_add_device(i2c_manager_device_config_t *device, i2c_master_dev_handle_t *handle) {
+    ESP_RETURN_ON_ERROR(check_device_config(device), TAG, "Invalid I2C device configuration");
+
+    xSemaphoreTake(i2c_devices_lock, portMAX_DELAY);
+    esp_err_t ret = ESP_OK;
+    int index     = find_known_device(device->bus_index, DEVICE_CHANNEL(device), device->config.device_address);
+    if (index >= 0) {
+        // Already in use by the transfer helpers, hand out the existing handle
+        *handle = i2c_devices[index].handle;
+    } else {
+        ret = add_known_device(device, handle);
+    }
+    xSemaphoreGive(i2c_devices_lock);
+
+    return ret;
+}
+
 esp_err_t i2c_manager_remove_device(i2c_manager_known_device_t *device) {
-    for (uint8_t i = 0; i < i2c_device_count; i++) {
-        if (i2c_devices[i].bus_index == device->bus_index && i2c_devices[i].address == device->address) {
-#ifdef CONFIG_I2C_SWITCH_ENABLED
-            if (i2c_devices[i].channel == device->channel) {
-#endif
-                i2c_master_bus_rm_device(i2c_devices[i].handle);
-                i2c_device_count--;
-                for (uint8_t j = i; j < i2c_device_count; j++) {
-                    i2c_devices[j] = i2c_devices[j + 1];
-                }
-                return ESP_OK;
-#ifdef CONFIG_I2C_SWITCH_ENABLED
-            }
-#endif
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+
+    xSemaphoreTake(i2c_devices_lock, portMAX_DELAY);
+    int index = find_known_device(device->bus_index, DEVICE_CHANNEL(device), device->address);
+    if (index >= 0) {
+        i2c_master_bus_rm_device(i2c_devices[index].handle);
+        i2c_device_count--;
+        for (uint8_t j = index; j < i2c_device_count; j++) {
+            i2c_devices[j] = i2c_devices[j + 1];
         }
+        ret = ESP_OK;
     }
+    xSemaphoreGive(i2c_devices_lock);
 
-    return ESP_ERR_NOT_FOUND;
+    return ret;
 }
 
 esp_err_t i2c_manager_find_device(i2c_manager_known_device_t *device, i2c_master_dev_handle_t *handle) {
-    for (uint8_t i = 0; i < i2c_device_count; i++) {
-        if (i2c_devices[i].bus_index == device->bus_index && i2c_devices[i].address == device->address) {
-#ifdef CONFIG_I2C_SWITCH_ENABLED
-            if (i2c_devices[i].channel == device->channel) {
-#endif
-                *handle = i2c_devices[i].handle;
-                return ESP_OK;
-#ifdef CONFIG_I2C_SWITCH_ENABLED
-            }
-#endif
-        }
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+
+    xSemaphoreTake(i2c_devices_lock, portMAX_DELAY);
+    int index = find_known_device(device->bus_index, DEVICE_CHANNEL(device), device->address);
+    if (index >= 0) {
+        *handle = i2c_devices[index].handle;
+        ret     = ESP_OK;
     }
+    xSemaphoreGive(i2c_devices_lock);
 
-    return ESP_ERR_NOT_FOUND;
+    return ret;
 }
 
 esp_err_t i2c_manager_get_device(i2c_manager_device_config_t *device, i2c_master_dev_handle_t *handle, bool *added) {
     ESP_RETURN_ON_ERROR(check_device_config(device), TAG, "Invalid I2C device configuration");
-    i2c_manager_known_device_t known_device = {
-        .bus_index = device->bus_index,
-#ifdef CONFIG_I2C_SWITCH_ENABLED
-        .channel = device->channel,
-#endif
-        .address = device->config.device_address,
-    };
-    if (i2c_manager_find_device(&known_device, handle) != ESP_OK) {
-        ESP_RETURN_ON_ERROR(i2c_master_bus_add_device(i2c_bus[device->bus_index].handle, &device->config, handle), TAG,
-                            "Failed to add I2C device to bus");
+    *added = false;
+
+    xSemaphoreTake(i2c_devices_lock, portMAX_DELAY);
+    esp_err_t ret = ESP_OK;
+    int index     = find_known_device(device->bus_index, DEVICE_CHANNEL(device), device->config.device_address);
+    if (index >= 0) {
+        *handle = i2c_devices[index].handle;
+    } else if (i2c_device_count < MAX_I2C_DEVICES) {
+        // Keep the handle so later transfers don't have to add the device again
+        ret = add_known_device(device, handle);
+    } else {
+        // No room to track it, the caller removes it again after the transfer
+        ret = i2c_master_bus_add_device(i2c_bus[device->bus_index].handle, &device->config, handle);
+        if (ret == ESP_OK) {
+            device_add_count++;
+            *added = true;
+        }
     }
-    return ESP_OK;
+    xSemaphoreGive(i2c_devices_lock);
+
+    return ret;
 }
 
-esp_err_t i2c_manager_transmit(i2c_manager_device_config_t *device, uint8_t *data, size_t size, TickType_t timeout_ms) {
-    esp_err_t ret                      = ESP_OK;
+/**
+ * @brief Run a single operation of a batch
+ *
+ * @param op Operation
+ * @param[in,out] locked_bus Bus held by the batch, -1 for none
+ * @param[in,out] selected_channel I2C switch channel selected during the batch, -1 for none
+ * @param timeout_ms Timeout in milliseconds
+ * @return esp_err_t
+ */
+static esp_err_t execute_op(i2c_manager_op_t *op, int *locked_bus, int *selected_channel, TickType_t timeout_ms) {
+    ESP_RETURN_ON_ERROR(check_device_config(op->device), TAG, "Invalid I2C device configuration");
+
+    // Hold the bus across consecutive operations on it
+    if (*locked_bus != op->device->bus_index) {
+        if (*locked_bus >= 0) {
+            I2C_BUS_UNLOCK(*locked_bus);
+            *locked_bus = -1;
+        }
+        I2C_BUS_LOCK(op->device->bus_index, ESP_FAIL)
+        *locked_bus       = op->device->bus_index;
+        *selected_channel = -1;
+    }
+
     i2c_master_dev_handle_t dev_handle = NULL;
     bool transient                     = false;
+    ESP_RETURN_ON_ERROR(i2c_manager_get_device(op->device, &dev_handle, &transient), TAG, "Failed to get I2C device 0x%X",
+                        op->device->config.device_address);
 
-    // Get the device handle
-    ESP_RETURN_ON_ERROR(i2c_manager_get_device(device, &dev_handle, &transient), TAG, "Failed to get I2C device");
-    I2C_BUS_LOCK(device->bus_index, ESP_FAIL)
-
-// Select the I2C switch channel if needed
+    esp_err_t ret = ESP_OK;
+// Select the I2C switch channel only when it changes
 #ifdef CONFIG_I2C_SWITCH_ENABLED
-    i2c_switch_select(device->channel);
+    if (*selected_channel != op->device->channel) {
+        ret = i2c_switch_select(op->device->channel);
+        if (ret == ESP_OK) {
+            *selected_channel = op->device->channel;
+        }
+    }
 #endif
 
-    // Transmit the data
-    if (i2c_master_transmit(dev_handle, data, size, timeout_ms) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to transmit I2C data: %s", esp_err_to_name(ret));
-        ret = ESP_FAIL;
+    if (ret == ESP_OK) {
+        i2c_bus[op->device->bus_index].transfer_count++;
+        switch (op->type) {
+            case I2C_MANAGER_OP_TRANSMIT:
+                ret = i2c_master_transmit(dev_handle, op->tx_data, op->tx_size, timeout_ms);
+                break;
+            case I2C_MANAGER_OP_RECEIVE:
+                ret = i2c_master_receive(dev_handle, op->rx_data, op->rx_size, timeout_ms);
+                break;
+            case I2C_MANAGER_OP_TRANSMIT_RECEIVE:
+                ret = i2c_master_transmit_receive(dev_handle, op->tx_data, op->tx_size, op->rx_data, op->rx_size, timeout_ms);
+                break;
+            default:
+                ret = ESP_ERR_INVALID_ARG;
+                break;
+        }
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "I2C transfer with device 0x%X on bus %d failed: %s", op->device->config.device_address,
+                 op->device->bus_index, esp_err_to_name(ret));
     }
 
-    // Cleanup
-    I2C_BUS_UNLOCK(device->bus_index);
     if (transient) {
         i2c_master_bus_rm_device(dev_handle);
     }
-
     return ret;
 }
 
-esp_err_t i2c_manager_receive(i2c_manager_device_config_t *device, uint8_t *data, size_t size, TickType_t timeout_ms) {
-    esp_err_t ret                      = ESP_OK;
-    i2c_master_dev_handle_t dev_handle = NULL;
-    bool transient                     = false;
-
-    // Get the device handle
-    ESP_RETURN_ON_ERROR(i2c_manager_get_device(device, &dev_handle, &transient), TAG, "Failed to get I2C device");
-    I2C_BUS_LOCK(device->bus_index, ESP_FAIL)
+esp_err_t i2c_manager_execute(i2c_manager_op_t *ops, size_t count, bool stop_on_error, TickType_t timeout_ms) {
+    if (ops == NULL && count > 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-// Select the I2C switch channel if needed
-#ifdef CONFIG_I2C_SWITCH_ENABLED
-    i2c_switch_select(device->channel);
-#endif
+    for (size_t i = 0; i < count; i++) {
+        ops[i].err = ESP_ERR_NOT_FINISHED;
+    }
 
-    // Receive the data
-    if (i2c_master_receive(dev_handle, data, size, timeout_ms) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to transmit I2C data: %s", esp_err_to_name(ret));
-        ret = ESP_FAIL;
+    esp_err_t ret        = ESP_OK;
+    int locked_bus       = -1;
+    int selected_channel = -1;
+    for (size_t i = 0; i < count; i++) {
+        ops[i].err = execute_op(&ops[i], &locked_bus, &selected_channel, timeout_ms);
+        if (ops[i].err != ESP_OK) {
+            if (ret == ESP_OK) {
+                ret = ops[i].err;
+            }
+            if (stop_on_error) {
+                break;
+            }
+        }
     }
 
-    // Cleanup
-    I2C_BUS_UNLOCK(device->bus_index);
-    if (transient) {
-        i2c_master_bus_rm_device(dev_handle);
+    if (locked_bus >= 0) {
+        I2C_BUS_UNLOCK(locked_bus);
     }
 
     return ret;
 }
 
-esp_err_t i2c_manager_transmit_receive(i2c_manager_device_config_t *device, uint8_t *tx_data, size_t tx_size, uint8_t *rx_data,
-                                       size_t rx_size, TickType_t timeout_ms) {
-    esp_err_t ret                      = ESP_OK;
-    i2c_master_dev_handle_t dev_handle = NULL;
-    bool transient                     = false;
-
-    // Get the device handle
-    ESP_RETURN_ON_ERROR(i2c_manager_get_device(device, &dev_handle, &transient), TAG, "Failed to get I2C device");
-    I2C_BUS_LOCK(device->bus_index, ESP_FAIL)
-
-// Select the I2C switch channel if needed
-#ifdef CONFIG_I2C_SWITCH_ENABLED
-    i2c_switch_select(device->channel);
-#endif
-
-    // Transmit and receive the data
-    if (i2c_master_transmit_receive(dev_handle, tx_data, tx_size, rx_data, rx_size, timeout_ms) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to transmit/receive I2C data: %s", esp_err_to_name(ret));
-        ret = ESP_FAIL;
+void i2c_manager_get_stats(i2c_manager_stats_t *stats) {
+    if (stats == NULL) {
+        return;
     }
 
-    // Cleanup
-    I2C_BUS_UNLOCK(device->bus_index);
-    if (transient) {
-        i2c_master_bus_rm_device(dev_handle);
+    memset(stats, 0, sizeof(*stats));
+    for (uint8_t i = 0; i < SOC_I2C_NUM; i++) {
+        stats->transfers += i2c_bus[i].transfer_count;
+        stats->bus_locks += i2c_bus[i].lock_count;
     }
+    stats->switch_selects = switch_select_count;
+    stats->device_adds    = device_add_count;
+}
 
-    return ret;
+esp_err_t i2c_manager_transmit(i2c_manager_device_config_t *device, uint8_t *data, size_t size, TickType_t timeout_ms) {
+    i2c_manager_op_t op = {
+        .device  = device,
+        .type    = I2C_MANAGER_OP_TRANSMIT,
+        .tx_data = data,
+        .tx_size = size,
+    };
+    return i2c_manager_execute(&op, 1, true, timeout_ms);
+}
+
+esp_err_t i2c_manager_receive(i2c_manager_device_config_t *device, uint8_t *data, size_t size, TickType_t timeout_ms) {
+    i2c_manager_op_t op = {
+        .device  = device,
+        .type    = I2C_MANAGER_OP_RECEIVE,
+        .rx_data = data,
+        .rx_size = size,
+    };
+    return i2c_manager_execute(&op, 1, true, timeout_ms);
+}
+
+esp_err_t i2c_manager_transmit_receive(i2c_manager_device_config_t *device, uint8_t *tx_data, size_t tx_size, uint8_t *rx_data,
+                                       size_t rx_size, TickType_t timeout_ms) {
+    i2c_manager_op_t op = {
+        .device  = device,
+        .type    = I2C_MANAGER_OP_TRANSMIT_RECEIVE,
+        .tx_data = tx_data,
+        .tx_size = tx_size,
+        .rx_data = rx_data,
+        .rx_size = rx_size,
+    };
+    return i2c_manager_execute(&op, 1, true, timeout_ms);
 }
 
 esp_err_t i2c_manager_read_eeprom(i2c_manager_device_config_t *device, uint32_t address, uint8_t *data, size_t size) {
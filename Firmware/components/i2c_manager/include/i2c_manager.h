@@ -34,6 +34,8 @@ typedef struct {
     i2c_master_bus_config_t config;
     i2c_master_bus_handle_t handle;
     SemaphoreHandle_t lock;
+    uint32_t lock_count;     // Times the bus lock has been taken
+    uint32_t transfer_count; // Transfers issued through i2c_manager_execute()
 } i2c_manager_bus_t;
 
 // I2C device config tracking structure
@@ -53,6 +55,32 @@ typedef struct {
     uint8_t address; // 7-bit I2C address. 0 for any address
 } i2c_manager_device_criteria_t;
 
+// Operation types for i2c_manager_execute()
+typedef enum {
+    I2C_MANAGER_OP_TRANSMIT,         // Write tx_data
+    I2C_MANAGER_OP_RECEIVE,          // Read into rx_data
+    I2C_MANAGER_OP_TRANSMIT_RECEIVE, // Write tx_data then read into rx_data with a repeated start
+} i2c_manager_op_type_t;
+
+// One operation in a batch for i2c_manager_execute()
+typedef struct {
+    i2c_manager_device_config_t *device; // Device to talk to
+    i2c_manager_op_type_t type;
+    const uint8_t *tx_data;
+    size_t tx_size;
+    uint8_t *rx_data;
+    size_t rx_size;
+    esp_err_t err; // Result of the operation, ESP_ERR_NOT_FINISHED if it was skipped
+} i2c_manager_op_t;
+
+// I2C manager counters, for measuring how much bus traffic and locking a workload causes
+typedef struct {
+    uint32_t transfers;      // Device transfers issued (switch traffic not included)
+    uint32_t bus_locks;      // Bus lock acquisitions
+    uint32_t switch_selects; // I2C switch channel changes written to the switch
+    uint32_t device_adds;    // Devices added to a bus driver
+} i2c_manager_stats_t;
+
 // I2C master bus configurations
 extern i2c_manager_bus_t i2c_bus[SOC_I2C_NUM];
 
@@ -63,7 +91,8 @@ extern i2c_manager_bus_t i2c_bus[SOC_I2C_NUM];
     if (xSemaphoreTake(i2c_bus[bus_index].lock, portMAX_DELAY) != pdTRUE) { \
         ESP_LOGE(TAG, "Failed to lock I2C bus %d", bus_index);              \
         return err_code;                                                    \
-    }
+    }                                                                       \
+    i2c_bus[bus_index].lock_count++;
 // Macro to handle unlocking a given I2C bus
 #define I2C_BUS_UNLOCK(bus_index) xSemaphoreGive(i2c_bus[bus_index].lock)
 
@@ -231,9 +260,34 @@ esp_err_t i2c_manager_remove_device(i2c_manager_known_device_t *device);
  */
 esp_err_t i2c_manager_find_device(i2c_manager_known_device_t *device, i2c_master_dev_handle_t *handle);
 
+/**
+ * @brief Run a batch of operations
+ *     Devices are added to the bus the first time they're used and their handles are kept for later batches. Each bus is
+ *     locked once for every run of consecutive operations on it, and the I2C switch is only selected when the channel
+ *     changes between operations, so ordering operations by bus and channel keeps the overhead down.
+ *
+ * @param[in,out] ops Operations to run, in order. The result of each is stored in its err field.
+ * @param[in] count Number of operations
+ * @param[in] stop_on_error Skip the remaining operations after the first failure
+ * @param[in] timeout_ms Timeout in milliseconds for each transfer
+ *
+ * @return esp_err_t
+ *     - ESP_OK: All operations succeeded
+ *     - ESP_ERR_INVALID_ARG: Invalid operation list
+ *     - Otherwise the error of the first operation that failed
+ */
+esp_err_t i2c_manager_execute(i2c_manager_op_t *ops, size_t count, bool stop_on_error, TickType_t timeout_ms);
+
+/**
+ * @brief Get the I2C manager counters
+ *
+ * @param[out] stats Counters since boot
+ */
+void i2c_manager_get_stats(i2c_manager_stats_t *stats);
+
 /**
  * @brief Helper to transmit data to an I2C device using an i2c_manager_device_config_t structure
- *     This function will lock the I2C bus, switch the mux if necessary, transmit the data, and unlock the bus.
+ *     This is a single operation batch, see i2c_manager_execute().
  *
  * @param[in] device Device configuration
  * @param[in] data Data buffer to transmit
@@ -246,7 +300,7 @@ esp_err_t i2c_manager_transmit(i2c_manager_device_config_t *device, uint8_t *dat
 
 /**
  * @brief Helper to receive data from an I2C device using an i2c_manager_device_config_t structure
- *     This function will lock the I2C bus, switch the mux if necessary, receive the data, and unlock the bus.
+ *     This is a single operation batch, see i2c_manager_execute().
  *
  * @param[in] device Device configuration
  * @param[out] data Data buffer to receive into
@@ -259,7 +313,7 @@ esp_err_t i2c_manager_receive(i2c_manager_device_config_t *device, uint8_t *data
 
 /**
  * @brief Helper to transmit and receive data from an I2C device using an i2c_manager_device_config_t structure
- *    This function will lock the I2C bus, switch the mux if necessary, transmit/receive the data, and unlock the bus.
+ *    This is a single operation batch, see i2c_manager_execute().
  *
  * @param[in] device Device configuration
  * @param[in] tx_data Data buffer to transmit
@@ -56,6 +56,17 @@ typedef struct {
     minibadge_slot_t slot;
 } minibadge_event_t;
 
+// Presence monitor counters, for measuring hotplug detection latency and how much of the bus it uses
+typedef struct {
+    uint32_t presence_checks;        // Monitor passes over the slots
+    uint32_t pings;                  // Presence pings sent
+    uint32_t eeprom_reads;           // EEPROM reads (name or serial number)
+    uint32_t cache_hits;             // Inserted minibadges identified from the metadata cache
+    uint32_t changes;                // Slot changes reported to the event callbacks
+    uint32_t detect_latency_last_us; // Time from the start of a pass to reporting the latest change
+    uint32_t detect_latency_max_us;  // Longest detection latency
+} minibadge_stats_t;
+
 // Minibadge event callback
 typedef void (*minibadge_event_cb_t)(minibadge_event_t e);
 
@@ -76,6 +87,7 @@ typedef enum {
 typedef struct {
     minibadge_slot_t slot;
     minibadge_dpad_state_t state;
+    int64_t timestamp_us; // When the new state was read, for measuring input latency
 } minibadge_dpad_event_t;
 extern esp_event_loop_handle_t minibadge_event_loop_handle;
 
@@ -109,8 +121,16 @@ esp_err_t minibadge_remove_event_callback(minibadge_event_cb_t callback);
  */
 uint8_t minibadge_get_count();
 
+/**
+ * @brief Get the presence monitor counters
+ *
+ * @param[out] stats Counters since boot
+ */
+void minibadge_get_stats(minibadge_stats_t *stats);
+
 /**
  * @brief Scan for minibadge devices and update the minibadge_devices array
+ *    This reads the EEPROM of every slot. The presence monitor keeps the array up to date on its own.
  *
  * @return The number of minibadge devices found
  */
@@ -118,8 +138,11 @@ int8_t check_minibadges();
 
 /**
  * @brief Start/stop polling the D-pad minibadge
+ *    State changes are posted to minibadge_event_loop_handle as MINIBADGE_DPAD_EVENT_PRESS, or
+ *    MINIBADGE_DPAD_EVENT_RELEASE when the D-pad goes back to MINIBADGE_DPAD_NONE.
  *
  * @param enable Whether to start polling the D-pad minibadge
+ * @param slot Slot the D-pad minibadge is in
  */
 void minibadge_dpad_poll(bool enable, minibadge_slot_t slot);
 
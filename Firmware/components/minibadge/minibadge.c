@@ -14,16 +14,29 @@ static const char *TAG = "minibadge";
 ESP_EVENT_DEFINE_BASE(MINIBADGE_DPAD_EVENT);
 
 #define MINIBADGE_MAX_CALLBACKS       5
-#define MINIBADGE_I2C_SCAN_PERIOD_MS  2000       // How often to scan for minibadges
+#define MINIBADGE_PRESENCE_PERIOD_MS  1000       // How often to ping the slots for inserted or removed minibadges
+#define MINIBADGE_CACHE_SIZE          8          // Serialized minibadges to remember the metadata of
 #define MINIBADGE_CLK_PERIOD_MS       1000       // How often to toggle the minibadge CLK line
 #define MINIBADGE_CLK_PIN             GPIO_NUM_4 // The GPIO pin to toggle the minibadge CLK line
-#define MINIBADGE_DPAD_POLL_PERIOD_MS 100        // How often to poll the D-pad minibadge
+#define MINIBADGE_DPAD_POLL_FAST_MS   10         // How often to poll the D-pad minibadge while it's in use
+#define MINIBADGE_DPAD_POLL_PERIOD_MS 50         // How often to poll the D-pad minibadge once it's been idle for a while
+#define MINIBADGE_DPAD_IDLE_MS        2000       // How long after the last D-pad change to keep polling fast
 
 // Callbacks for minibadge events
 static minibadge_event_cb_t minibadge_callbacks[MINIBADGE_MAX_CALLBACKS] = {0};
 
-// Scan timer
-static esp_timer_handle_t minibadge_scan_timer;
+// Presence monitor task, the slots have no interrupt lines so it pings them periodically
+static TaskHandle_t minibadge_monitor_task_handle = NULL;
+static minibadge_stats_t minibadge_stats          = {0};
+
+// Metadata of serialized minibadges seen since boot, so reinserting one only costs a serial number read
+typedef struct {
+    uint8_t serial[16];
+    uint8_t data[8];
+} minibadge_cache_entry_t;
+static minibadge_cache_entry_t minibadge_cache[MINIBADGE_CACHE_SIZE] = {0};
+static uint8_t minibadge_cache_count                                 = 0;
+static uint8_t minibadge_cache_next                                  = 0; // Entry to replace once the cache is full
 
 // Timer for toggling the minibadge CLK line every second
 static esp_timer_handle_t minibadge_clk_timer;
@@ -35,33 +48,25 @@ minibadge_device_t minibadge_devices[MINIBADGE_SLOT_COUNT] = {0};
 // The number of minibadges from the last scan
 static uint8_t minibadge_count = 0;
 
-// D-pad polling task
+// D-pad polling task, exits on its own once no slot is being polled
 static TaskHandle_t minibadge_dpad_task_handle                  = NULL;
+static bool minibadge_dpad_task_running                         = false;
+static portMUX_TYPE minibadge_dpad_lock                         = portMUX_INITIALIZER_UNLOCKED;
 static minibadge_device_t *minibadge_dpad[MINIBADGE_SLOT_COUNT] = {0};
 esp_event_loop_handle_t minibadge_event_loop_handle             = NULL;
 
 // Function prototypes
-static void check_minibadges_periodic(void *arg);
+static void minibadge_monitor_task(void *arg);
 static void minibadge_clk_toggle(void *arg);
 static void minibadge_dpad_task(void *arg);
 
 esp_err_t minibadge_init() {
-    // Set up a timer to scan for minibadges and update the minibadge_devices array
-    esp_timer_create_args_t timer_args = {
-        .callback = &check_minibadges_periodic,
-        .name     = "minibadge_monitor",
-    };
-    esp_err_t err = esp_timer_create(&timer_args, &minibadge_scan_timer);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create minibadge scan timer: %s", esp_err_to_name(err));
-        return err;
-    }
+    esp_err_t err = ESP_OK;
 
-    // Start the minibadge scan timer
-    err = esp_timer_start_periodic(minibadge_scan_timer, MINIBADGE_I2C_SCAN_PERIOD_MS * 1000);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start minibadge scan timer: %s", esp_err_to_name(err));
-        return err;
+    // Start the presence monitor that keeps the minibadge_devices array up to date
+    if (xTaskCreate(minibadge_monitor_task, "minibadge_monitor", 4096, NULL, 5, &minibadge_monitor_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create minibadge monitor task");
+        return ESP_ERR_NO_MEM;
     }
 
     // Initialize the minibadge CLK pin
@@ -142,13 +147,157 @@ static bool serial_is_valid(const uint8_t *serial) {
     return false;
 }
 
-static void check_minibadges_periodic(void *arg) {
-    // Copy the minibadge devices array to compare later
+/**
+ * @brief Find a serialized minibadge in the metadata cache
+ *
+ * @param serial Serial number
+ * @return The cache entry or NULL if it hasn't been seen before
+ */
+static const minibadge_cache_entry_t *cache_find(const uint8_t *serial) {
+    for (uint8_t i = 0; i < minibadge_cache_count; i++) {
+        if (memcmp(minibadge_cache[i].serial, serial, sizeof(minibadge_cache[i].serial)) == 0) {
+            return &minibadge_cache[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Remember the metadata of a serialized minibadge
+ *
+ * @param device Serialized minibadge
+ */
+static void cache_add(const minibadge_device_t *device) {
+    minibadge_cache_entry_t *entry;
+    if (minibadge_cache_count < MINIBADGE_CACHE_SIZE) {
+        entry = &minibadge_cache[minibadge_cache_count++];
+    } else {
+        entry                = &minibadge_cache[minibadge_cache_next];
+        minibadge_cache_next = (minibadge_cache_next + 1) % MINIBADGE_CACHE_SIZE;
+    }
+    memcpy(entry->serial, device->serial, sizeof(entry->serial));
+    memcpy(entry->data, device->data, sizeof(entry->data));
+}
+
+/**
+ * @brief Device configuration for the EEPROM of a minibadge slot
+ */
+static i2c_manager_device_config_t slot_eeprom(uint8_t slot) {
+    return (i2c_manager_device_config_t){
+        .bus_index = I2C_BUS_OTHER,
+        .channel   = I2C_SWITCH_CHANNEL_0 + slot,
+        .config    = {.dev_addr_length = I2C_ADDR_BIT_LEN_7,
+                      .device_address  = MINIBADGE_I2C_ADDR_EEPROM,
+                      .scl_speed_hz    = 100000},
+    };
+}
+
+/**
+ * @brief Check whether a minibadge EEPROM answers in a slot
+ */
+static bool slot_present(uint8_t slot) {
+    i2c_manager_device_config_t device = slot_eeprom(slot);
+    minibadge_stats.pings++;
+    return i2c_manager_ping(&device) == ESP_OK;
+}
+
+/**
+ * @brief Read the metadata of the minibadge in a slot
+ *
+ * @param slot Slot to read
+ * @param[out] device What's in the slot, type MINIBADGE_TYPE_NONE if nothing could be read
+ */
+static void identify_slot(uint8_t slot, minibadge_device_t *device) {
+    memset(device, 0, sizeof(*device));
+    device->slot = slot;
+
+    // A serialized minibadge that's been seen before is identified by its serial number alone
+    uint8_t mb_serial[16]              = {0};
+    i2c_manager_device_config_t eeprom = slot_eeprom(slot);
+    eeprom.config.device_address       = MINIBADGE_I2C_ADDR_EEPROM + 0x08; // EEPROM serial is at 0x58
+    minibadge_stats.eeprom_reads++;
+    bool serialized = i2c_manager_read_eeprom(&eeprom, MINIBADGE_EEPROM_ADDR_SERIAL, mb_serial, sizeof(mb_serial)) == ESP_OK &&
+                      serial_is_valid(mb_serial);
+    if (serialized) {
+        const minibadge_cache_entry_t *cached = cache_find(mb_serial);
+        if (cached != NULL) {
+            device->type    = MINIBADGE_TYPE_EEPROM_SERIALIZED;
+            device->address = MINIBADGE_I2C_ADDR_EEPROM;
+            memcpy(device->data, cached->data, sizeof(device->data));
+            memcpy(device->serial, mb_serial, sizeof(device->serial));
+            minibadge_stats.cache_hits++;
+            return;
+        }
+    }
+
+    // Read the name from the EEPROM
+    uint8_t mb_name[8]           = {0};
+    eeprom.config.device_address = MINIBADGE_I2C_ADDR_EEPROM;
+    minibadge_stats.eeprom_reads++;
+    if (i2c_manager_read_eeprom(&eeprom, MINIBADGE_EEPROM_ADDR_DATA, mb_name, sizeof(mb_name)) != ESP_OK) {
+        return;
+    }
+
+    // It's at least a basic type
+    device->type    = MINIBADGE_TYPE_EEPROM_BASIC;
+    device->address = MINIBADGE_I2C_ADDR_EEPROM;
+    memcpy(device->data, mb_name, sizeof(mb_name));
+    if (serialized) {
+        device->type = MINIBADGE_TYPE_EEPROM_SERIALIZED;
+        memcpy(device->serial, mb_serial, sizeof(mb_serial));
+        cache_add(device);
+    }
+}
+
+/**
+ * @brief Update the minibadge_devices array and count
+ *
+ * @param devices New contents of every slot
+ * @return The number of minibadges
+ */
+static int8_t set_minibadges(const minibadge_device_t *devices) {
+    int8_t device_count = 0;
+    for (uint8_t i = 0; i < MINIBADGE_SLOT_COUNT; i++) {
+        minibadge_devices[i] = devices[i];
+        if (devices[i].type != MINIBADGE_TYPE_NONE) {
+            device_count++;
+        }
+    }
+    minibadge_count = device_count;
+    return device_count;
+}
+
+/**
+ * @brief Ping every slot and read the EEPROM of the ones whose presence changed, then report the changes
+ *
+ * @param start_us When the pass started, for the detection latency
+ */
+static void check_minibadge_presence(int64_t start_us) {
     minibadge_device_t prev_minibadge_devices[MINIBADGE_SLOT_COUNT];
+    minibadge_device_t next_minibadge_devices[MINIBADGE_SLOT_COUNT];
     memcpy(prev_minibadge_devices, minibadge_devices, sizeof(minibadge_devices));
+    memcpy(next_minibadge_devices, minibadge_devices, sizeof(minibadge_devices));
+
+    bool changed = false;
+    for (uint8_t i = 0; i < MINIBADGE_SLOT_COUNT; i++) {
+        bool present     = slot_present(i);
+        bool was_present = prev_minibadge_devices[i].type != MINIBADGE_TYPE_NONE;
+        if (present == was_present) {
+            continue;
+        }
+        if (present) {
+            identify_slot(i, &next_minibadge_devices[i]);
+        } else {
+            memset(&next_minibadge_devices[i], 0, sizeof(next_minibadge_devices[i]));
+            next_minibadge_devices[i].slot = i;
+        }
+        changed = true;
+    }
+    if (!changed) {
+        return;
+    }
+    set_minibadges(next_minibadge_devices);
 
-    // Scan for minibadge devices
-    int8_t device_count = check_minibadges();
     for (uint8_t i = 0; i < MINIBADGE_SLOT_COUNT; i++) {
         if (!minibadge_device_equals(&minibadge_devices[i], &prev_minibadge_devices[i])) {
             bool swapped =
@@ -162,6 +311,13 @@ static void check_minibadges_periodic(void *arg) {
                 .slot = minibadge_devices[i].slot,
             };
 
+            minibadge_stats.changes++;
+            uint32_t latency_us                    = esp_timer_get_time() - start_us;
+            minibadge_stats.detect_latency_last_us = latency_us;
+            if (latency_us > minibadge_stats.detect_latency_max_us) {
+                minibadge_stats.detect_latency_max_us = latency_us;
+            }
+
             // Call the minibadge event callbacks
             for (uint8_t j = 0; j < MINIBADGE_MAX_CALLBACKS; j++) {
                 if (minibadge_callbacks[j] != NULL) {
@@ -172,10 +328,29 @@ static void check_minibadges_periodic(void *arg) {
     }
 }
 
+static void minibadge_monitor_task(void *arg) {
+    (void)arg;
+
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(MINIBADGE_PRESENCE_PERIOD_MS));
+        if (!i2c_manager_initialized) {
+            continue;
+        }
+        minibadge_stats.presence_checks++;
+        check_minibadge_presence(esp_timer_get_time());
+    }
+}
+
 uint8_t minibadge_get_count() {
     return minibadge_count;
 }
 
+void minibadge_get_stats(minibadge_stats_t *stats) {
+    if (stats != NULL) {
+        *stats = minibadge_stats;
+    }
+}
+
 // Scan for minibadge devices and update the minibadge_devices array
 int8_t check_minibadges() {
     // Ensure I2C manager is initialized
@@ -184,55 +359,18 @@ int8_t check_minibadges() {
         return 0;
     }
 
-    // Clear the minibadge devices array
-    memset(minibadge_devices, 0, sizeof(minibadge_devices));
-
-    // Scan for minibadge devices
-    esp_err_t err;
-    int8_t device_count = 0;
+    // Read every slot that answers, regardless of what was there before
+    minibadge_device_t devices[MINIBADGE_SLOT_COUNT];
     for (uint8_t i = 0; i < MINIBADGE_SLOT_COUNT; i++) {
-        // Set the slot number
-        minibadge_devices[i].slot = i;
-
-        // Construct a device configuration assuming it's an EEPROM
-        i2c_manager_device_config_t device = {
-            .bus_index = I2C_BUS_OTHER,
-            .channel   = I2C_SWITCH_CHANNEL_0 + i,
-            .config    = {.dev_addr_length = I2C_ADDR_BIT_LEN_7,
-                          .device_address  = MINIBADGE_I2C_ADDR_EEPROM,
-                          .scl_speed_hz    = 100000},
-        };
-
-        // Try to ping the device first to see if it actually exists and responds
-        err = i2c_manager_ping(&device);
-        if (err != ESP_OK) {
-            continue;
-        }
-
-        // We have a device, try to read the name from the EEPROM
-        uint8_t mb_name[8] = {0};
-        err                = i2c_manager_read_eeprom(&device, MINIBADGE_EEPROM_ADDR_DATA, mb_name, sizeof(mb_name));
-        if (err == ESP_OK) {
-            // It's at least a basic type
-            minibadge_devices[i].type    = MINIBADGE_TYPE_EEPROM_BASIC;
-            minibadge_devices[i].address = MINIBADGE_I2C_ADDR_EEPROM;
-            memcpy(minibadge_devices[i].data, mb_name, sizeof(mb_name));
-
-            // Try to read a serial number from the EEPROM
-            uint8_t mb_serial[16]        = {0};
-            device.config.device_address = MINIBADGE_I2C_ADDR_EEPROM + 0x08; // EEPROM serial is at 0x58
-            err = i2c_manager_read_eeprom(&device, MINIBADGE_EEPROM_ADDR_SERIAL, mb_serial, sizeof(mb_serial));
-            if (err == ESP_OK && serial_is_valid(mb_serial)) {
-                minibadge_devices[i].type = MINIBADGE_TYPE_EEPROM_SERIALIZED;
-                memcpy(minibadge_devices[i].serial, mb_serial, sizeof(mb_serial));
-            }
-
-            device_count++;
+        if (slot_present(i)) {
+            identify_slot(i, &devices[i]);
+        } else {
+            memset(&devices[i], 0, sizeof(devices[i]));
+            devices[i].slot = i;
         }
     }
 
-    minibadge_count = device_count;
-    return device_count;
+    return set_minibadges(devices);
 }
 
 static void minibadge_clk_toggle(void *arg) {
@@ -241,23 +379,41 @@ static void minibadge_clk_toggle(void *arg) {
 }
 
 void minibadge_dpad_poll(bool enable, minibadge_slot_t slot) {
+    bool start_task = false;
+    portENTER_CRITICAL(&minibadge_dpad_lock);
     minibadge_dpad[slot] = enable ? &minibadge_devices[slot] : NULL;
-    int slots_enabled    = 0;
+    if (enable && !minibadge_dpad_task_running) {
+        minibadge_dpad_task_running = true;
+        start_task                  = true;
+    }
+    portEXIT_CRITICAL(&minibadge_dpad_lock);
+
+    if (start_task &&
+        xTaskCreate(minibadge_dpad_task, "minibadge_dpad", 4096, NULL, 5, &minibadge_dpad_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create D-pad minibadge task");
+        minibadge_dpad_task_running = false;
+    }
+}
+
+/**
+ * @brief Stop the D-pad task if no slot is being polled anymore. Deleting it from outside could leave the I2C bus locked.
+ *
+ * @return Whether the task should exit
+ */
+static bool dpad_task_should_exit() {
+    bool exit = true;
+    portENTER_CRITICAL(&minibadge_dpad_lock);
     for (uint8_t i = 0; i < MINIBADGE_SLOT_COUNT; i++) {
         if (minibadge_dpad[i] != NULL) {
-            slots_enabled++;
+            exit = false;
         }
     }
-
-    if (slots_enabled > 0) {
-        if (minibadge_dpad_task_handle != NULL) {
-            return;
-        }
-        xTaskCreate(minibadge_dpad_task, "minibadge_dpad", 4096, NULL, 5, &minibadge_dpad_task_handle);
-    } else {
-        vTaskDelete(minibadge_dpad_task_handle);
-        minibadge_dpad_task_handle = NULL;
+    if (exit) {
+        minibadge_dpad_task_running = false;
+        minibadge_dpad_task_handle  = NULL;
     }
+    portEXIT_CRITICAL(&minibadge_dpad_lock);
+    return exit;
 }
 
 static void minibadge_dpad_task(void *arg) {
@@ -276,38 +432,66 @@ static void minibadge_dpad_task(void *arg) {
                 },
         };
     }
-    esp_err_t err;
 
-    // Continually read the D-pad minibadge until the task is deleted
-    while (true) {
-        vTaskDelay(pdMS_TO_TICKS(MINIBADGE_DPAD_POLL_PERIOD_MS));
-
-        // Read the D-pad minibadge
+    // Continually read the D-pad minibadges until no slot is being polled
+    int64_t last_change_us = esp_timer_get_time();
+    while (!dpad_task_should_exit()) {
+        // The slots have no interrupt lines, so poll fast while the D-pad is in use and back off once it's been idle a while
+        bool fast         = esp_timer_get_time() - last_change_us < MINIBADGE_DPAD_IDLE_MS * 1000;
+        TickType_t period = pdMS_TO_TICKS(fast ? MINIBADGE_DPAD_POLL_FAST_MS : MINIBADGE_DPAD_POLL_PERIOD_MS);
+        vTaskDelay(period > 0 ? period : 1);
+        int64_t read_us = esp_timer_get_time();
+
+        // Read every D-pad minibadge in one batch so the bus is only locked once per poll
+        i2c_manager_op_t ops[MINIBADGE_SLOT_COUNT];
+        uint8_t op_slots[MINIBADGE_SLOT_COUNT];
+        uint8_t dpad_state[MINIBADGE_SLOT_COUNT] = {0};
+        size_t op_count                          = 0;
         for (uint8_t i = 0; i < MINIBADGE_SLOT_COUNT; i++) {
             if (devices[i].config.device_address != 0 && minibadge_dpad[i] != NULL) {
-                uint8_t dpad_state = 0;
-                err                = i2c_manager_receive(&devices[i], &dpad_state, sizeof(dpad_state), 100);
-                if (err != ESP_OK) {
-                    ESP_LOGE(TAG, "Failed to read D-pad minibadge: %s", esp_err_to_name(err));
-                    continue;
-                }
-
-                // If the D-pad state has changed, post an event
-                if (dpad_state != prev_state[i]) {
-                    minibadge_dpad_event_t event_data = {
-                        .slot  = minibadge_dpad[i]->slot,
-                        .state = dpad_state,
-                    };
-                    esp_event_post_to(minibadge_event_loop_handle, MINIBADGE_DPAD_EVENT, MINIBADGE_DPAD_EVENT_PRESS, &event_data,
-                                      sizeof(event_data), portMAX_DELAY);
-                    prev_state[i] = dpad_state;
+                ops[op_count] = (i2c_manager_op_t){
+                    .device  = &devices[i],
+                    .type    = I2C_MANAGER_OP_RECEIVE,
+                    .rx_data = &dpad_state[i],
+                    .rx_size = sizeof(dpad_state[i]),
+                };
+                op_slots[op_count++] = i;
+            }
+        }
+        if (op_count == 0) {
+            continue;
+        }
+        i2c_manager_execute(ops, op_count, false, 100);
 
-                    // Reset the screen timeout like we do for the touch events
-                    screen_reset_timeout();
+        for (size_t op = 0; op < op_count; op++) {
+            uint8_t i = op_slots[op];
+            if (ops[op].err != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to read D-pad minibadge: %s", esp_err_to_name(ops[op].err));
+                continue;
+            }
 
-                    ESP_LOGD(TAG, "D-pad state[slot %d]: %08X", i + 1, dpad_state);
-                }
+            // If the D-pad state has changed, post an event
+            minibadge_device_t *dpad = minibadge_dpad[i];
+            if (dpad_state[i] != prev_state[i] && dpad != NULL) {
+                minibadge_dpad_event_t event_data = {
+                    .slot         = dpad->slot,
+                    .state        = dpad_state[i],
+                    .timestamp_us = read_us,
+                };
+                int32_t event_id =
+                    dpad_state[i] == MINIBADGE_DPAD_NONE ? MINIBADGE_DPAD_EVENT_RELEASE : MINIBADGE_DPAD_EVENT_PRESS;
+                esp_event_post_to(minibadge_event_loop_handle, MINIBADGE_DPAD_EVENT, event_id, &event_data, sizeof(event_data),
+                                  portMAX_DELAY);
+                prev_state[i]  = dpad_state[i];
+                last_change_us = read_us;
+
+                // Reset the screen timeout like we do for the touch events
+                screen_reset_timeout();
+
+                ESP_LOGD(TAG, "D-pad state[slot %d]: %08X", i + 1, dpad_state[i]);
             }
         }
     }
+
+    vTaskDelete(NULL);
 }
@@ -0,0 +1,151 @@
+#include <string.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+#include "asset_pack.h"
+
+static const char *TAG = "asset_pack";
+
+#define ASSET_MAGIC          0x31545341 // 'AST1'
+#define ASSET_PARTITION      "assets"
+#define ASSET_NAME_LEN       24
+#define ASSET_BIN_HEADER_LEN 12 // lv_image_header_t as stored in an LVGL .bin file
+
+// Asset pack header and index, see tools/assetpack.py
+typedef struct {
+    uint32_t magic;
+    uint32_t count;
+    uint32_t total_size;
+    uint32_t index_crc;
+} asset_pack_header_t;
+
+typedef struct {
+    char name[ASSET_NAME_LEN];
+    uint32_t offset;
+    uint32_t size;
+} asset_pack_entry_t;
+
+static const uint8_t *pack                = NULL;
+static const asset_pack_entry_t *entries  = NULL; // Sorted by name
+static uint32_t entry_count               = 0;
+static esp_partition_mmap_handle_t handle = 0;
+
+/**
+ * @brief Check the index against the header and the partition
+ *
+ * @param header Mapped pack header
+ * @param partition_size Size of the assets partition
+ * @return Whether every entry lies inside the pack
+ */
+static bool validate_index(const asset_pack_header_t *header, uint32_t partition_size) {
+    const asset_pack_entry_t *list = (const asset_pack_entry_t *)(header + 1);
+    uint32_t index_size            = header->count * sizeof(asset_pack_entry_t);
+    if (header->total_size > partition_size || header->count > partition_size / sizeof(asset_pack_entry_t) ||
+        sizeof(*header) + index_size > header->total_size) {
+        ESP_LOGE(TAG, "Asset pack size %lu doesn't fit the %lu byte partition", header->total_size, partition_size);
+        return false;
+    }
+    // The ROM CRC32 does its own pre and post inversion, so a zero seed matches zlib.crc32()
+    if (esp_rom_crc32_le(0, (const uint8_t *)list, index_size) != header->index_crc) {
+        ESP_LOGE(TAG, "Asset pack index CRC mismatch");
+        return false;
+    }
+    for (uint32_t i = 0; i < header->count; i++) {
+        const asset_pack_entry_t *entry = &list[i];
+        if (entry->name[ASSET_NAME_LEN - 1] != '\0' || entry->offset > header->total_size ||
+            entry->size > header->total_size - entry->offset) {
+            ESP_LOGE(TAG, "Asset pack entry %lu is invalid", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+esp_err_t asset_pack_init() {
+    if (pack != NULL) {
+        return ESP_OK;
+    }
+
+    const esp_partition_t *partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, ASSET_PARTITION);
+    if (partition == NULL) {
+        ESP_LOGW(TAG, "No %s partition", ASSET_PARTITION);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Read the header first so only the used part of the partition takes up MMU pages
+    asset_pack_header_t header;
+    esp_err_t err = esp_partition_read(partition, 0, &header, sizeof(header));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to read the asset pack header: %s", esp_err_to_name(err));
+        return err;
+    }
+    if (header.magic != ASSET_MAGIC || header.total_size < sizeof(header) || header.total_size > partition->size) {
+        ESP_LOGW(TAG, "The %s partition doesn't hold an asset pack", ASSET_PARTITION);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const void *mapped = NULL;
+    err = esp_partition_mmap(partition, 0, header.total_size, ESP_PARTITION_MMAP_DATA, &mapped, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map the asset pack: %s", esp_err_to_name(err));
+        return err;
+    }
+    if (!validate_index(mapped, partition->size)) {
+        esp_partition_munmap(handle);
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    pack        = mapped;
+    entries     = (const asset_pack_entry_t *)(pack + sizeof(asset_pack_header_t));
+    entry_count = header.count;
+    ESP_LOGI(TAG, "Mapped %lu assets (%lu bytes) from the %s partition", entry_count, header.total_size, ASSET_PARTITION);
+    return ESP_OK;
+}
+
+const void *asset_pack_find(const char *name, size_t *size) {
+    if (pack == NULL || name == NULL) {
+        return NULL;
+    }
+
+    uint32_t low = 0, high = entry_count;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        int cmp      = strncmp(name, entries[mid].name, ASSET_NAME_LEN);
+        if (cmp == 0) {
+            if (size != NULL) {
+                *size = entries[mid].size;
+            }
+            return pack + entries[mid].offset;
+        } else if (cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t asset_pack_get_image(const char *name, lv_image_dsc_t *dsc) {
+    if (dsc == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t size         = 0;
+    const uint8_t *data = asset_pack_find(name, &size);
+    if (data == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (size < ASSET_BIN_HEADER_LEN || data[0] != LV_IMAGE_HEADER_MAGIC) {
+        ESP_LOGE(TAG, "%s is not an LVGL image", name);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    // Same layout as the file header LVGL's bin decoder reads, compressed images keep their compression header in data
+    memset(dsc, 0, sizeof(*dsc));
+    memcpy(&dsc->header, data, ASSET_BIN_HEADER_LEN);
+    dsc->data_size = size - ASSET_BIN_HEADER_LEN;
+    dsc->data      = data + ASSET_BIN_HEADER_LEN;
+    return ESP_OK;
+}
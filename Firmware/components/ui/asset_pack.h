@@ -0,0 +1,23 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+// Memory-map the assets partition (written by tools/assetpack.py) and validate its index.
+esp_err_t asset_pack_init();
+
+// Find an asset by file name. Returns a pointer into flash-mapped memory and its size, or NULL if not found.
+const void *asset_pack_find(const char *name, size_t *size);
+
+// Point an image descriptor at an LVGL .bin image in the asset pack. The pixel data is not copied.
+esp_err_t asset_pack_get_image(const char *name, lv_image_dsc_t *dsc);
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,6 +6,7 @@
 #include "api.h"
 #include "attack.h"
 #include "display.h"
+#include "dpad_input.h"
 #include "minibadge.h"
 #include "theme.h"
 
@@ -62,6 +63,7 @@ typedef struct {
     uint16_t failed_stratagems;
     int64_t start_time;
     bool dpad_enabled;
+    lv_group_t *dpad_group; // Routes D-pad minibadge keys to current_screen
 } attack_t;
 
 typedef struct {
@@ -76,7 +78,7 @@ static void update_stratagem(attack_t *attack);
 static void check_input(attack_t *attack, arrow_t arrow);
 static void attack_end(attack_t *attack, bool success);
 static void attack_cleanup_event_cb(lv_event_t *e);
-static void on_minibadge_dpad_event(void *arg, esp_event_base_t base, int32_t id, void *event_data);
+static void attack_key_event_cb(lv_event_t *e);
 
 // Map arrow to symbol
 static const char *arrow_to_symbol(arrow_t arrow) {
@@ -370,9 +372,12 @@ lv_obj_t *attack_create(const attack_config_t *config) {
             minibadge_dpad_poll(true, minibadge_dpad_slots[i]);
         }
 
-        // Add an event handler to listen for D-pad events
-        esp_event_handler_register_with(minibadge_event_loop_handle, MINIBADGE_DPAD_EVENT, MINIBADGE_DPAD_EVENT_PRESS,
-                                        on_minibadge_dpad_event, attack);
+        // Take the D-pad keys on the attack screen, they arrive through the LVGL keypad input device
+        attack->dpad_group = lv_group_create();
+        lv_group_add_obj(attack->dpad_group, attack->current_screen);
+        lv_obj_set_style_outline_width(attack->current_screen, 0, LV_STATE_FOCUS_KEY);
+        lv_obj_add_event_cb(attack->current_screen, attack_key_event_cb, LV_EVENT_KEY, attack);
+        dpad_input_set_group(attack->dpad_group);
 
         // Set the flag to indicate that the D-pad is enabled
         attack->dpad_enabled = true;
@@ -533,14 +538,14 @@ static void attack_cleanup_event_cb(lv_event_t *e) {
         return;
     }
 
-    if (minibadge_event_loop_handle != NULL && attack->dpad_enabled) {
+    if (attack->dpad_enabled) {
         // Disable polling for the D-pad minibadges
         minibadge_dpad_poll(false, MINIBADGE_SLOT_1);
         minibadge_dpad_poll(false, MINIBADGE_SLOT_2);
 
-        // Unregister the D-pad event handler
-        esp_event_handler_unregister_with(minibadge_event_loop_handle, MINIBADGE_DPAD_EVENT, MINIBADGE_DPAD_EVENT_PRESS,
-                                          on_minibadge_dpad_event);
+        // Stop sending D-pad keys to the attack screen
+        dpad_input_set_group(NULL);
+        lv_group_delete(attack->dpad_group);
     }
 
     free(attack);
@@ -570,37 +575,13 @@ void attack_update_status(lv_obj_t *attack_obj, int16_t tower_health, int16_t pl
     }
 }
 
-static arrow_t dpad_state_to_arrow(minibadge_dpad_state_t state) {
-    switch (state) {
-        case MINIBADGE_DPAD_UP: return ARROW_UP;
-        case MINIBADGE_DPAD_DOWN: return ARROW_DOWN;
-        case MINIBADGE_DPAD_LEFT: return ARROW_LEFT;
-        case MINIBADGE_DPAD_RIGHT: return ARROW_RIGHT;
-        default: return -1;
-    }
-}
-
-typedef struct {
-    attack_t *attack;
-    arrow_t arrow;
-} check_input_args_t;
-
-static void check_input_async(check_input_args_t *args) {
-    check_input(args->attack, args->arrow);
-    free(args);
-}
-
-static void on_minibadge_dpad_event(void *arg, esp_event_base_t base, int32_t id, void *event_data) {
-    attack_t *attack = (attack_t *)arg;
-    if (attack == NULL) {
-        ESP_LOGE(TAG, "on_minibadge_dpad_event: attack object is NULL");
-        return;
-    }
-    minibadge_dpad_event_t *event = (minibadge_dpad_event_t *)event_data;
-    if (id == MINIBADGE_DPAD_EVENT_PRESS && event->state != MINIBADGE_DPAD_NONE && event->state != MINIBADGE_DPAD_PRESS) {
-        check_input_args_t *args = (check_input_args_t *)malloc(sizeof(check_input_args_t));
-        args->attack             = attack;
-        args->arrow              = dpad_state_to_arrow(event->state);
-        lv_async_call(check_input_async, args);
+static void attack_key_event_cb(lv_event_t *e) {
+    attack_t *attack = lv_event_get_user_data(e);
+    switch (lv_event_get_key(e)) {
+        case LV_KEY_UP: check_input(attack, ARROW_UP); break;
+        case LV_KEY_DOWN: check_input(attack, ARROW_DOWN); break;
+        case LV_KEY_LEFT: check_input(attack, ARROW_LEFT); break;
+        case LV_KEY_RIGHT: check_input(attack, ARROW_RIGHT); break;
+        default: break;
     }
 }
@@ -1,6 +1,8 @@
 #include "content.h"
 #include "display.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "theme.h"
 
@@ -30,6 +32,124 @@ lv_obj_t *content_area = NULL;
 // Content state
 static content_state_t content_state = {0};
 
+// Page lifecycle: each page is built into its own container under the content area, then shown, hidden and destroyed
+typedef struct {
+    void (*create)(lv_obj_t *parent);
+    void (*show)(); // Optional, called when a cached page is shown again
+    void (*hide)(); // Optional, called when the page is hidden and kept in the cache
+    bool cacheable; // Whether the page can be kept hidden. Pages with live state (timers, tasks, IR) are rebuilt each time
+} content_page_def_t;
+
+static const content_page_def_t page_defs[] = {
+    [PAGE_HOME]         = {home_page_create, home_page_show, home_page_hide, true},
+    [PAGE_SETTINGS]     = {settings_page_create, NULL, NULL, false},
+    [PAGE_MAP]          = {map_page_create, NULL, NULL, true},
+    [PAGE_TOWER_BATTLE] = {tower_battle_page_create, NULL, NULL, false},
+    [PAGE_SHOP]         = {shop_page_create, NULL, NULL, false},
+    [PAGE_LEVELUP]      = {levelup_page_create, NULL, NULL, false},
+    [PAGE_SECRET]       = {secret_page_create, NULL, NULL, false},
+    [PAGE_STATS]        = {stats_page_create, NULL, NULL, false},
+};
+#define PAGE_COUNT        (sizeof(page_defs) / sizeof(page_defs[0]))
+#define PAGE_CACHE_BUDGET (CONFIG_UI_PAGE_CACHE_SIZE_KB * 1024)
+
+typedef struct {
+    lv_obj_t *container; // NULL if the page isn't built
+    uint32_t size;       // Heap taken by the page when it was built
+    uint32_t last_used;  // use_counter value when the page was last hidden, for LRU eviction
+} content_page_entry_t;
+
+// Only touched from the LVGL context
+static content_page_entry_t page_entries[PAGE_COUNT] = {0};
+static int shown_page                                = -1;
+static uint32_t use_counter                          = 0;
+static content_page_stats_t page_stats               = {0};
+
+/**
+ * @brief Clear a page's cache entry when its container goes away, whether it was destroyed here or along with the
+ *      main screen
+ */
+static void page_container_delete_cb(lv_event_t *e) {
+    content_page_entry_t *entry = lv_event_get_user_data(e);
+    int page                    = entry - page_entries;
+    entry->container            = NULL;
+    entry->size                 = 0;
+    if (shown_page == page) {
+        shown_page = -1;
+    }
+}
+
+/**
+ * @brief Build a page into a new container
+ *
+ * @param page Page to build
+ */
+static void create_page(content_page_t page) {
+    content_page_entry_t *entry = &page_entries[page];
+    size_t free_before          = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    entry->container = lv_obj_create(content_area);
+    lv_obj_set_size(entry->container, lv_pct(100), lv_pct(100));
+    lv_obj_set_style_bg_opa(entry->container, LV_OPA_TRANSP, LV_PART_MAIN);
+    lv_obj_set_style_border_width(entry->container, 0, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(entry->container, 0, LV_PART_MAIN);
+    lv_obj_set_style_radius(entry->container, 0, LV_PART_MAIN);
+    lv_obj_add_event_cb(entry->container, page_container_delete_cb, LV_EVENT_DELETE, entry);
+    page_defs[page].create(entry->container);
+
+    // Other tasks allocate too, so this is an estimate - good enough to keep the cache within its budget
+    size_t free_after       = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    entry->size             = free_before > free_after ? free_before - free_after : 0;
+    page_stats.built_bytes += entry->size;
+}
+
+/**
+ * @brief Destroy pages that aren't shown, least recently used first, until the cache fits its budget
+ */
+static void evict_pages() {
+    while (true) {
+        uint32_t cached = 0;
+        int lru         = -1;
+        for (int i = 0; i < PAGE_COUNT; i++) {
+            if (page_entries[i].container == NULL || i == shown_page) {
+                continue;
+            }
+            cached += page_entries[i].size;
+            if (lru < 0 || page_entries[i].last_used < page_entries[lru].last_used) {
+                lru = i;
+            }
+        }
+        page_stats.cached_bytes = cached;
+        if (lru < 0 || cached <= PAGE_CACHE_BUDGET) {
+            return;
+        }
+        ESP_LOGD(TAG, "Evicting %s page (%lu bytes)", content_labels[lru], page_entries[lru].size);
+        lv_obj_delete(page_entries[lru].container);
+        page_stats.evictions++;
+    }
+}
+
+/**
+ * @brief Hide the page being navigated away from, keeping it built if it can be cached
+ *
+ * @param page Page to hide
+ */
+static void hide_page(content_page_t page) {
+    content_page_entry_t *entry = &page_entries[page];
+    if (entry->container == NULL) {
+        return;
+    }
+    if (!page_defs[page].cacheable || PAGE_CACHE_BUDGET == 0) {
+        lv_obj_delete(entry->container);
+        return;
+    }
+    if (page_defs[page].hide != NULL) {
+        page_defs[page].hide();
+    }
+    lv_obj_add_flag(entry->container, LV_OBJ_FLAG_HIDDEN);
+    entry->last_used = ++use_counter;
+}
+
 lv_obj_t *create_content_area(lv_obj_t *parent) {
     content_area = lv_obj_create(parent);
     lv_obj_set_size(content_area, LV_HOR_RES - 40, LV_VER_RES);
@@ -66,36 +186,44 @@ void render_content() {
         set_status_label(content_labels[content_state.page]);
     }
 
-    lv_obj_clean(content_area);
-
-    // Render the appropriate content
-    switch (content_state.page) {
-        case PAGE_HOME: //
-            home_page_create(content_area);
-            break;
-        case PAGE_SETTINGS: //
-            settings_page_create(content_area);
-            break;
-        case PAGE_MAP: //
-            map_page_create(content_area);
-            break;
-        case PAGE_TOWER_BATTLE: //
-            tower_battle_page_create(content_area);
-            break;
-        case PAGE_SHOP: //
-            shop_page_create(content_area);
-            break;
-        case PAGE_LEVELUP: //
-            levelup_page_create(content_area);
-            break;
-        case PAGE_SECRET: //
-            secret_page_create(content_area);
-            break;
-        case PAGE_STATS: //
-            stats_page_create(content_area);
-            break;
-        default: //
-            ESP_LOGW(TAG, "Unknown content page: %d", content_state.page);
-            break;
+    int64_t start = esp_timer_get_time();
+    if (content_state.page >= PAGE_COUNT) {
+        ESP_LOGW(TAG, "Unknown content page: %d", content_state.page);
+        return;
+    }
+
+    // Put away the page being left
+    content_page_t page = content_state.page;
+    if (shown_page >= 0 && shown_page != page) {
+        content_page_t previous = shown_page;
+        shown_page              = -1;
+        hide_page(previous);
+    }
+
+    // Show the cached page or build it
+    content_page_entry_t *entry = &page_entries[page];
+    if (entry->container != NULL) {
+        lv_obj_remove_flag(entry->container, LV_OBJ_FLAG_HIDDEN);
+        if (shown_page != page && page_defs[page].show != NULL) {
+            page_defs[page].show();
+        }
+        page_stats.hits++;
+    } else {
+        create_page(page);
+        page_stats.misses++;
     }
-}
\ No newline at end of file
+    shown_page = page;
+    evict_pages();
+
+    page_stats.switch_time_last_us = esp_timer_get_time() - start;
+    if (page_stats.switch_time_last_us > page_stats.switch_time_max_us) {
+        page_stats.switch_time_max_us = page_stats.switch_time_last_us;
+    }
+    ESP_LOGD(TAG, "Showing %s page took %lu us", content_labels[page], page_stats.switch_time_last_us);
+}
+
+void content_get_page_stats(content_page_stats_t *stats) {
+    if (stats != NULL) {
+        *stats = page_stats;
+    }
+}
@@ -36,6 +36,20 @@ content_page_t get_content_page();
 // Content rendering
 void render_content();
 
+// Page cache counters
+typedef struct {
+    uint32_t hits;                // Page switches served by un-hiding a cached page
+    uint32_t misses;              // Page switches that had to build the page
+    uint32_t evictions;           // Cached pages destroyed to stay within the budget
+    uint32_t cached_bytes;        // Estimated heap held by hidden pages
+    uint32_t built_bytes;         // Estimated heap allocated building pages since boot (LVGL heap churn)
+    uint32_t switch_time_last_us; // Duration of the most recent page switch
+    uint32_t switch_time_max_us;  // Longest page switch
+} content_page_stats_t;
+
+// Get a snapshot of the page cache counters.
+void content_get_page_stats(content_page_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
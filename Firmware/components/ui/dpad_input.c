@@ -0,0 +1,173 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "display.h"
+#include "dpad_input.h"
+#include "minibadge.h"
+
+static const char *TAG = "dpad_input";
+
+#define DPAD_QUEUE_SIZE 8
+
+// Key transition waiting for LVGL to read it
+typedef struct {
+    uint32_t key;
+    lv_indev_state_t state;
+    int64_t timestamp_us; // When the minibadge task read the D-pad
+} dpad_key_event_t;
+
+static lv_indev_t *indev       = NULL;
+static QueueHandle_t key_queue = NULL;
+
+// Last key sent to the queue - minibadge event loop only
+static uint32_t queued_key = 0;
+
+// Last key reported to LVGL and the press waiting for its first render - LVGL lock held
+static uint32_t indev_key           = 0;
+static lv_indev_state_t indev_state = LV_INDEV_STATE_RELEASED;
+static int64_t pending_press_us     = 0;
+
+static dpad_input_stats_t stats = {0};
+static portMUX_TYPE stats_lock  = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t dpad_state_to_key(minibadge_dpad_state_t state) {
+    switch (state) {
+        case MINIBADGE_DPAD_UP: return LV_KEY_UP;
+        case MINIBADGE_DPAD_DOWN: return LV_KEY_DOWN;
+        case MINIBADGE_DPAD_LEFT: return LV_KEY_LEFT;
+        case MINIBADGE_DPAD_RIGHT: return LV_KEY_RIGHT;
+        case MINIBADGE_DPAD_PRESS: return LV_KEY_ENTER;
+        default: return 0;
+    }
+}
+
+static void queue_key(uint32_t key, lv_indev_state_t state, int64_t timestamp_us) {
+    dpad_key_event_t event = {
+        .key          = key,
+        .state        = state,
+        .timestamp_us = timestamp_us,
+    };
+    if (xQueueSend(key_queue, &event, 0) != pdTRUE) {
+        portENTER_CRITICAL(&stats_lock);
+        stats.dropped++;
+        portEXIT_CRITICAL(&stats_lock);
+    }
+}
+
+static void on_minibadge_dpad_event(void *arg, esp_event_base_t base, int32_t id, void *event_data) {
+    const minibadge_dpad_event_t *event = event_data;
+    uint32_t key                        = dpad_state_to_key(event->state);
+    if (key == queued_key) {
+        return;
+    }
+
+    // The D-pad can roll straight from one direction to the next, so release the old key before pressing the new one
+    if (queued_key != 0) {
+        queue_key(queued_key, LV_INDEV_STATE_RELEASED, event->timestamp_us);
+    }
+    if (key != 0) {
+        queue_key(key, LV_INDEV_STATE_PRESSED, event->timestamp_us);
+    }
+    queued_key = key;
+
+    // Read the indev right away instead of waiting for the next LVGL timer pass
+    if (lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+        lv_indev_read(indev);
+        lvgl_unlock(__FILE__, __LINE__);
+    }
+}
+
+static void dpad_read_cb(lv_indev_t *_indev, lv_indev_data_t *data) {
+    dpad_key_event_t event;
+    if (xQueueReceive(key_queue, &event, 0) == pdTRUE) {
+        indev_key   = event.key;
+        indev_state = event.state;
+        if (event.state == LV_INDEV_STATE_PRESSED) {
+            // LVGL sends LV_EVENT_KEY to the focused object as soon as this returns
+            uint32_t deliver_us = esp_timer_get_time() - event.timestamp_us;
+            pending_press_us    = event.timestamp_us;
+            portENTER_CRITICAL(&stats_lock);
+            stats.presses++;
+            stats.deliver_time_last_us = deliver_us;
+            if (deliver_us > stats.deliver_time_max_us) {
+                stats.deliver_time_max_us = deliver_us;
+            }
+            portEXIT_CRITICAL(&stats_lock);
+        }
+    }
+
+    data->key              = indev_key;
+    data->state            = indev_state;
+    data->continue_reading = uxQueueMessagesWaiting(key_queue) > 0;
+}
+
+static void render_ready_cb(lv_event_t *e) {
+    if (pending_press_us == 0) {
+        return;
+    }
+
+    // The last strip may still be on the bus, so this is the end of rendering rather than the panel update
+    uint32_t pixel_us = esp_timer_get_time() - pending_press_us;
+    pending_press_us  = 0;
+    portENTER_CRITICAL(&stats_lock);
+    stats.pixel_time_last_us   = pixel_us;
+    stats.pixel_time_total_us += pixel_us;
+    stats.pixel_samples++;
+    if (pixel_us > stats.pixel_time_max_us) {
+        stats.pixel_time_max_us = pixel_us;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+esp_err_t dpad_input_init() {
+    if (indev != NULL) {
+        return ESP_OK;
+    }
+    if (minibadge_event_loop_handle == NULL) {
+        ESP_LOGW(TAG, "Minibadge event loop not running, D-pad input disabled");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (key_queue == NULL && (key_queue = xQueueCreate(DPAD_QUEUE_SIZE, sizeof(dpad_key_event_t))) == NULL) {
+        ESP_LOGE(TAG, "Failed to create the D-pad key queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (!lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    indev = lv_indev_create();
+    lv_indev_set_type(indev, LV_INDEV_TYPE_KEYPAD);
+    lv_indev_set_read_cb(indev, dpad_read_cb);
+    // Only read when the minibadge task reports a change instead of polling on the indev timer
+    lv_indev_set_mode(indev, LV_INDEV_MODE_EVENT);
+    lv_display_add_event_cb(lv_display_get_default(), render_ready_cb, LV_EVENT_RENDER_READY, NULL);
+    lvgl_unlock(__FILE__, __LINE__);
+
+    esp_err_t err = esp_event_handler_register_with(minibadge_event_loop_handle, MINIBADGE_DPAD_EVENT, ESP_EVENT_ANY_ID,
+                                                    on_minibadge_dpad_event, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register the D-pad event handler: %s", esp_err_to_name(err));
+        return err;
+    }
+    return ESP_OK;
+}
+
+void dpad_input_set_group(lv_group_t *group) {
+    if (indev != NULL) {
+        lv_indev_set_group(indev, group);
+    }
+}
+
+void dpad_input_get_stats(dpad_input_stats_t *out) {
+    if (out == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&stats_lock);
+    memcpy(out, &stats, sizeof(stats));
+    portEXIT_CRITICAL(&stats_lock);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+typedef struct {
+    uint32_t presses;              // D-pad presses delivered to LVGL
+    uint32_t dropped;              // Key transitions lost because the input queue was full
+    uint32_t deliver_time_last_us; // D-pad read to LV_EVENT_KEY for the most recent press
+    uint32_t deliver_time_max_us;  // Longest D-pad read to LV_EVENT_KEY time
+    uint32_t pixel_time_last_us;   // D-pad read to the end of the first render after the press
+    uint32_t pixel_time_max_us;    // Longest D-pad read to render time
+    uint64_t pixel_time_total_us;  // Sum of all read to render times, divide by pixel_samples for the average
+    uint32_t pixel_samples;        // Presses that were followed by a render
+} dpad_input_stats_t;
+
+// Create the LVGL keypad input device for the D-pad minibadge. The D-pad sends LV_KEY_UP/DOWN/LEFT/RIGHT to the focused
+// object of the group set with dpad_input_set_group(). Must be called after the display and minibadge are initialized.
+esp_err_t dpad_input_init();
+
+// Set the group that receives D-pad keys, NULL to ignore the D-pad. Call with the LVGL lock held.
+void dpad_input_set_group(lv_group_t *group);
+
+// Get a snapshot of the D-pad input latency statistics.
+void dpad_input_get_stats(dpad_input_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
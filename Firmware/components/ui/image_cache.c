@@ -0,0 +1,247 @@
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "image_cache.h"
+
+static const char *TAG = "image_cache";
+
+#define PACK_MAGIC        0x31524B50 // 'PKR1'
+#define CACHE_MAX_ENTRIES 16
+#define CACHE_BUDGET      (CONFIG_UI_IMAGE_CACHE_SIZE_KB * 1024)
+
+// Packed image data header, see tools/imgpack.py
+typedef struct {
+    uint32_t magic;
+    uint32_t unpacked_size;
+    uint32_t color_size;
+    uint32_t alpha_size;
+} image_pack_header_t;
+
+typedef struct {
+    const lv_image_dsc_t *src; // Cache key, NULL if the slot is free
+    lv_draw_buf_t buf;         // Unpacked image handed to LVGL
+    uint8_t *data;             // PSRAM backing buf
+    uint32_t size;             // Size of data in bytes
+    uint32_t last_used;        // use_counter value at the last draw, for LRU eviction
+    uint16_t refs;             // Open decoder sessions, entries in use are never evicted
+} image_cache_entry_t;
+
+// Only touched from LVGL draw context
+static image_cache_entry_t cache[CACHE_MAX_ENTRIES] = {0};
+static uint32_t use_counter                         = 0;
+static image_cache_stats_t stats                    = {0};
+static lv_image_decoder_t *decoder                  = NULL;
+
+/**
+ * @brief Expand a run-length encoded plane
+ *
+ * @param in Packed data
+ * @param in_size Packed size in bytes
+ * @param out Output buffer
+ * @param out_size Expected unpacked size in bytes
+ * @param block Block size in bytes (2 for RGB565, 1 for A8)
+ * @return Whether the plane unpacked to exactly `out_size` bytes
+ */
+static bool rle_decode(const uint8_t *in, uint32_t in_size, uint8_t *out, uint32_t out_size, uint32_t block) {
+    const uint8_t *in_end = in + in_size;
+    uint8_t *out_end      = out + out_size;
+    while (in < in_end) {
+        uint8_t ctrl = *in++;
+        if (ctrl & 0x80) {
+            uint32_t len = ((ctrl & 0x7f) + 1) * block;
+            if (in + len > in_end || out + len > out_end) {
+                return false;
+            }
+            memcpy(out, in, len);
+            in  += len;
+            out += len;
+        } else {
+            uint32_t count = ctrl + 1;
+            if (in + block > in_end || out + count * block > out_end) {
+                return false;
+            }
+            if (block == 1) {
+                memset(out, *in, count);
+                out += count;
+            } else {
+                for (uint32_t i = 0; i < count; i++) {
+                    memcpy(out, in, block);
+                    out += block;
+                }
+            }
+            in += block;
+        }
+    }
+    return out == out_end;
+}
+
+/**
+ * @brief Release an entry's memory and free its slot
+ */
+static void cache_entry_free(image_cache_entry_t *entry) {
+    stats.bytes_used -= entry->size;
+    stats.entries--;
+    heap_caps_free(entry->data);
+    memset(entry, 0, sizeof(*entry));
+}
+
+/**
+ * @brief Evict least recently used, unreferenced entries until `needed` more bytes fit in the budget
+ *
+ * @return A free slot, or NULL if every slot is in use
+ */
+static image_cache_entry_t *cache_make_room(uint32_t needed) {
+    while (true) {
+        image_cache_entry_t *free_slot = NULL;
+        image_cache_entry_t *oldest    = NULL;
+        for (int i = 0; i < CACHE_MAX_ENTRIES; i++) {
+            image_cache_entry_t *entry = &cache[i];
+            if (entry->src == NULL) {
+                free_slot = free_slot ? free_slot : entry;
+            } else if (entry->refs == 0 && (oldest == NULL || entry->last_used < oldest->last_used)) {
+                oldest = entry;
+            }
+        }
+
+        bool fits = stats.bytes_used + needed <= CACHE_BUDGET;
+        if (free_slot != NULL && (fits || oldest == NULL)) {
+            // An image larger than the whole budget still gets cached on its own rather than failing to draw
+            return free_slot;
+        }
+        if (oldest == NULL) {
+            return NULL;
+        }
+        cache_entry_free(oldest);
+        stats.evictions++;
+    }
+}
+
+static image_cache_entry_t *cache_find(const lv_image_dsc_t *src) {
+    for (int i = 0; i < CACHE_MAX_ENTRIES; i++) {
+        if (cache[i].src == src) {
+            return &cache[i];
+        }
+    }
+    return NULL;
+}
+
+static bool is_packed(lv_image_decoder_dsc_t *dsc) {
+    if (dsc->src_type != LV_IMAGE_SRC_VARIABLE) {
+        return false;
+    }
+    const lv_image_dsc_t *image = dsc->src;
+    return image->header.magic == LV_IMAGE_HEADER_MAGIC && (image->header.flags & IMAGE_FLAGS_PACKED) &&
+           image->data_size >= sizeof(image_pack_header_t);
+}
+
+static lv_result_t packed_decoder_info(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc, lv_image_header_t *header) {
+    if (!is_packed(dsc)) {
+        return LV_RESULT_INVALID;
+    }
+    const lv_image_dsc_t *image = dsc->src;
+    *header                     = image->header;
+    header->flags               = 0;
+    header->stride              = image->header.w * 2;
+    return LV_RESULT_OK;
+}
+
+static lv_result_t packed_decoder_open(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc) {
+    if (!is_packed(dsc)) {
+        return LV_RESULT_INVALID;
+    }
+    const lv_image_dsc_t *image = dsc->src;
+
+    image_cache_entry_t *entry = cache_find(image);
+    if (entry != NULL) {
+        stats.hits++;
+    } else {
+        image_pack_header_t pack;
+        memcpy(&pack, image->data, sizeof(pack));
+        uint32_t color_len = image->header.w * image->header.h * 2;
+        if (pack.magic != PACK_MAGIC || pack.unpacked_size < color_len ||
+            sizeof(pack) + pack.color_size + pack.alpha_size > image->data_size) {
+            ESP_LOGE(TAG, "Invalid packed image %p", image);
+            return LV_RESULT_INVALID;
+        }
+
+        entry = cache_make_room(pack.unpacked_size);
+        if (entry == NULL) {
+            ESP_LOGE(TAG, "No free image cache slots");
+            return LV_RESULT_INVALID;
+        }
+        uint8_t *data = heap_caps_malloc(pack.unpacked_size, MALLOC_CAP_SPIRAM);
+        if (data == NULL) {
+            data = heap_caps_malloc(pack.unpacked_size, MALLOC_CAP_DEFAULT);
+        }
+        if (data == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate %lu bytes for image %p", pack.unpacked_size, image);
+            return LV_RESULT_INVALID;
+        }
+
+        int64_t start_us    = esp_timer_get_time();
+        const uint8_t *body = image->data + sizeof(pack);
+        bool ok             = rle_decode(body, pack.color_size, data, color_len, 2) &&
+                  rle_decode(body + pack.color_size, pack.alpha_size, data + color_len, pack.unpacked_size - color_len, 1);
+        if (!ok || lv_draw_buf_init(&entry->buf, image->header.w, image->header.h, image->header.cf, image->header.w * 2,
+                                    data, pack.unpacked_size) != LV_RESULT_OK) {
+            ESP_LOGE(TAG, "Failed to unpack image %p", image);
+            heap_caps_free(data);
+            return LV_RESULT_INVALID;
+        }
+
+        uint32_t decode_us        = esp_timer_get_time() - start_us;
+        stats.decode_time_last_us = decode_us;
+        if (decode_us > stats.decode_time_max_us) {
+            stats.decode_time_max_us = decode_us;
+        }
+        ESP_LOGD(TAG, "Unpacked image %p (%lux%lu, %lu -> %lu bytes) in %lu us", image, (uint32_t)image->header.w,
+                 (uint32_t)image->header.h, image->data_size, pack.unpacked_size, decode_us);
+
+        entry->src  = image;
+        entry->data = data;
+        entry->size = pack.unpacked_size;
+        stats.misses++;
+        stats.entries++;
+        stats.bytes_used += entry->size;
+    }
+
+    entry->refs++;
+    entry->last_used = ++use_counter;
+    dsc->decoded     = &entry->buf;
+    dsc->user_data   = entry;
+    return LV_RESULT_OK;
+}
+
+static void packed_decoder_close(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc) {
+    image_cache_entry_t *entry = dsc->user_data;
+    if (entry != NULL && entry->refs > 0) {
+        entry->refs--;
+    }
+}
+
+esp_err_t image_cache_init() {
+    if (decoder != NULL) {
+        return ESP_OK;
+    }
+
+    // New decoders are tried first, so this claims packed images before the built in binary decoder sees them
+    decoder = lv_image_decoder_create();
+    if (decoder == NULL) {
+        ESP_LOGE(TAG, "Failed to create packed image decoder");
+        return ESP_FAIL;
+    }
+    lv_image_decoder_set_info_cb(decoder, packed_decoder_info);
+    lv_image_decoder_set_open_cb(decoder, packed_decoder_open);
+    lv_image_decoder_set_close_cb(decoder, packed_decoder_close);
+    return ESP_OK;
+}
+
+void image_cache_get_stats(image_cache_stats_t *out) {
+    if (out == NULL) {
+        return;
+    }
+    *out = stats;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+// Header flag marking an image descriptor whose data was run-length packed by tools/imgpack.py
+#define IMAGE_FLAGS_PACKED LV_IMAGE_FLAGS_USER1
+
+typedef struct {
+    uint32_t hits;                // Draws served from the cache
+    uint32_t misses;              // Draws that had to unpack the image first
+    uint32_t evictions;           // Images dropped to make room
+    uint32_t entries;             // Images currently cached
+    uint32_t bytes_used;          // PSRAM held by cached images
+    uint32_t decode_time_last_us; // Unpack time of the most recent miss (first-draw latency)
+    uint32_t decode_time_max_us;  // Longest unpack time
+} image_cache_stats_t;
+
+// Register the packed image decoder. Must be called after LVGL and its built in decoders are initialized.
+esp_err_t image_cache_init();
+
+// Get a snapshot of the image cache statistics.
+void image_cache_get_stats(image_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -17,6 +17,7 @@ extern "C" {
 #include "../onboarding.h"
 #include "../pages/levelup.h"
 #include "../pages/tower_battle.h"
+#include "../ui_bench.h"
 
 typedef enum {
     SCREEN_NONE,   // No screen
@@ -57,6 +58,15 @@ void set_status_label(const char *label);
 void set_status_minibadge_update();
 void set_status_alert_count(uint8_t count);
 
+// Status bar render counters
+typedef struct {
+    uint32_t updates; // Status changes published by the UI task
+    uint32_t renders; // Status bar renders, a burst of updates within a frame is rendered once
+} ui_status_stats_t;
+
+// Get a snapshot of the status bar render counters.
+void ui_get_status_stats(ui_status_stats_t *stats);
+
 // Content
 void set_screen(ui_screen_t screen);
 ui_screen_t get_screen();
@@ -109,3 +109,16 @@ void home_page_create(lv_obj_t *parent) {
     // Create a timer to update the clock every second
     clock_timer = lv_timer_create(clock_timer_cb, 1000, NULL);
 }
+
+void home_page_show() {
+    if (clock_timer != NULL) {
+        lv_label_set_text(clock_label, get_formatted_time());
+        lv_timer_resume(clock_timer);
+    }
+}
+
+void home_page_hide() {
+    if (clock_timer != NULL) {
+        lv_timer_pause(clock_timer);
+    }
+}
@@ -8,6 +8,10 @@ extern "C" {
 
 void home_page_create(lv_obj_t *parent);
 
+// Resume or pause the clock while the page is cached.
+void home_page_show();
+void home_page_hide();
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
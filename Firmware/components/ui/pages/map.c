@@ -3,6 +3,7 @@
 #include "lvgl.h"
 #include "lvgl_private.h"
 
+#include "asset_pack.h"
 #include "map.h"
 #include "theme.h"
 
@@ -15,13 +16,28 @@ typedef enum {
     MAP_LEVEL_3,
 } map_level_t;
 
-// Map files to load for each level
-static const char *map_files[] = {
-    "/spiffs/LVL1.bin",
-    "/spiffs/LVL2.bin",
-    "/spiffs/LVL3.bin",
+// Map images for each level, in the asset pack or on SPIFFS on badges that don't have the assets partition yet
+static const char *map_files[MAP_LEVEL_COUNT] = {
+    "LVL1.bin",
+    "LVL2.bin",
+    "LVL3.bin",
 };
 
+// Descriptors pointing into the memory-mapped asset pack
+static lv_image_dsc_t map_images[MAP_LEVEL_COUNT] = {0};
+
+void map_image_path(int level, char *path, size_t path_size) {
+    snprintf(path, path_size, "S:/spiffs/%s", map_files[level]);
+}
+
+const void *map_image_src(int level, char *path, size_t path_size) {
+    if (map_images[level].data != NULL || asset_pack_get_image(map_files[level], &map_images[level]) == ESP_OK) {
+        return &map_images[level];
+    }
+    map_image_path(level, path, path_size);
+    return path;
+}
+
 static void level_click_event_cb(lv_event_t *e);
 static void close_button_event_cb(lv_event_t *e);
 static void show_map(map_level_t level);
@@ -54,13 +70,10 @@ static void show_map(map_level_t level) {
     lv_obj_remove_flag(overlay, LV_OBJ_FLAG_SCROLLABLE);
     lv_obj_set_scrollbar_mode(overlay, LV_SCROLLBAR_MODE_OFF);
 
-    // Path (including FS driver letter) to the map image
-    char path[32] = {0};
-    snprintf(path, sizeof(path), "S:%s", map_files[level]);
-
     // Create the map image object
+    char path[32]     = {0};
     lv_obj_t *map_img = lv_image_create(overlay);
-    lv_image_set_src(map_img, path);
+    lv_image_set_src(map_img, map_image_src(level, path, sizeof(path)));
     lv_image_set_antialias(map_img, false);
     lv_obj_align(map_img, LV_ALIGN_CENTER, 0, 0);
 
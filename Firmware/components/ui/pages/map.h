@@ -6,8 +6,16 @@ extern "C" {
 
 #include "lvgl.h"
 
+#define MAP_LEVEL_COUNT 3
+
 void map_page_create(lv_obj_t *parent);
 
+// Write the SPIFFS path (including FS driver letter) of a level's map image to `path`.
+void map_image_path(int level, char *path, size_t path_size);
+
+// Image source for a level's map: its descriptor in the asset pack, or the SPIFFS path (written to `path`) as a fallback.
+const void *map_image_src(int level, char *path, size_t path_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,7 @@
 #include "esp_log.h"
 
 #include "badge.h"
+#include "render_profiler.h"
 #include "secret.h"
 #include "theme.h"
 #include "ui.h"
@@ -14,9 +15,11 @@ ESP_EVENT_DEFINE_BASE(SECRET_EVENT);
 
 typedef enum {
     SECRET_MENU_ITEM_TOWER_IR_SIMULATOR,
+    SECRET_MENU_ITEM_PERFORMANCE_HUD,
 } secret_menu_item_t;
 static const char *secret_menu_item_str[] = {
     "Tower IR Simulator",
+    "Performance HUD",
 };
 static const int secret_menu_item_count = sizeof(secret_menu_item_str) / sizeof(secret_menu_item_str[0]);
 
@@ -36,6 +39,11 @@ typedef struct {
 
 static secret_page_t page = {0};
 
+// Performance HUD overlay - lives on the top layer so it stays up while navigating to other pages
+#define PERF_HUD_UPDATE_MS 500
+static lv_obj_t *perf_hud         = NULL;
+static lv_timer_t *perf_hud_timer = NULL;
+
 // Function prototypes
 static void secret_menu_item_event_handler(lv_event_t *event);
 static void secret_page_cleanup(lv_event_t *event);
@@ -44,6 +52,7 @@ static void on_secret_event(void *context, esp_event_base_t base, int32_t id, vo
 
 static void render_state_menu();
 static void render_state_tower_ir_simulator();
+static void toggle_perf_hud();
 
 void secret_page_create(lv_obj_t *parent) {
     page.container = lv_obj_create(parent);
@@ -78,6 +87,9 @@ static void secret_menu_item_event_handler(lv_event_t *event) {
             case SECRET_MENU_ITEM_TOWER_IR_SIMULATOR:
                 esp_event_post_to(page.event_loop, SECRET_EVENT, SECRET_EVENT_TOWER_SHOW_IR_SIMULATOR, NULL, 0, 0);
                 break;
+            case SECRET_MENU_ITEM_PERFORMANCE_HUD: //
+                toggle_perf_hud();
+                break;
         }
     }
 }
@@ -122,7 +134,7 @@ static void render_state_menu() {
         lv_obj_set_style_text_font(item, &cyberphont3b_16, LV_PART_MAIN);
         lv_obj_set_style_text_color(item, lv_color_hex(WHITE), LV_PART_MAIN);
 
-        lv_obj_add_event_cb(item, secret_menu_item_event_handler, LV_EVENT_CLICKED, NULL);
+        lv_obj_add_event_cb(item, secret_menu_item_event_handler, LV_EVENT_CLICKED, (void *)i);
     }
 }
 
@@ -131,10 +143,10 @@ static void tower_ir_button_event_handler(lv_event_t *event) {
     if (code == LV_EVENT_CLICKED) {
         int tower_id = lv_event_get_user_data(event);
         ESP_LOGI(TAG, "Tower IR button clicked: %d", tower_id);
-        int idx = tower_id_to_idx(tower_id);
-        if (idx != -1) {
-            ESP_LOGI(TAG, "Tower IR code: %lu", tower_state[idx].info->ir_code);
-            ir_transmit(tower_state[idx].info->ir_code >> 16, tower_state[idx].info->ir_code & 0xFFFF);
+        tower_state_t *tower = get_tower_state(tower_id_to_idx(tower_id));
+        if (tower != NULL) {
+            ESP_LOGI(TAG, "Tower IR code: %lu", tower->info->ir_code);
+            ir_transmit(tower->info->ir_code >> 16, tower->info->ir_code & 0xFFFF);
         }
     }
 }
@@ -150,7 +162,7 @@ static void render_state_tower_ir_simulator() {
     lv_obj_set_flex_grow(container, 1);
 
     // If we haven't refreshed the towers yet, try to do that now
-    if (tower_state[0].info == NULL) {
+    if (get_tower_count() == 0) {
         tower_info_refresh(REFRESH_ALL);
     }
 
@@ -168,17 +180,81 @@ static void render_state_tower_ir_simulator() {
     lv_style_t *button_styles[] = {
         &button_red, &button_orange, &button_yellow, &button_green, &button_blue, &button_purple, &button_bluegrey, &button_grey,
     };
-    for (int i = 0; i < TOTAL_TOWERS; i++) {
+    for (int i = 0; i < get_tower_count(); i++) {
+        tower_state_t *tower = get_tower_state(i);
+        if (tower == NULL) {
+            break;
+        }
+
         lv_obj_t *button = lv_btn_create(buttons);
         lv_obj_set_width(button, lv_pct(100));
         lv_obj_add_style(button, &button_style, LV_PART_MAIN);
         lv_obj_add_style(button, button_styles[i % (sizeof(button_styles) / sizeof(button_styles[0]))], LV_PART_MAIN);
 
         lv_obj_t *label = lv_label_create(button);
-        lv_label_set_text_fmt(label, "%s", tower_state[i].info->name);
+        lv_label_set_text_fmt(label, "%s", tower->info->name);
         lv_obj_set_style_text_font(label, &cyberphont3b_16, LV_PART_MAIN);
         lv_obj_set_style_text_color(label, lv_color_hex(WHITE), LV_PART_MAIN);
 
-        lv_obj_add_event_cb(button, tower_ir_button_event_handler, LV_EVENT_CLICKED, tower_state[i].info->id);
+        lv_obj_add_event_cb(button, tower_ir_button_event_handler, LV_EVENT_CLICKED, tower->info->id);
     }
 }
+
+/**
+ * @brief Refresh the performance HUD text from the render profiler
+ *
+ * @param timer LVGL timer
+ */
+static void perf_hud_update(lv_timer_t *timer) {
+    render_profile_summary_t summary;
+    render_profiler_get_summary(&summary);
+    lv_label_set_text_fmt(perf_hud,
+                          "%lu fps\n"
+                          "handler %lu/%lu us\n"
+                          "render %lu/%lu us\n"
+                          "flush %lu us\n"
+                          "inval %lu px\n"
+                          "ui queue %u\n"
+                          "int %lu KB\n"
+                          "psram %lu KB",
+                          summary.fps, summary.handler_avg_us, summary.handler_max_us, summary.render_avg_us,
+                          summary.render_max_us, summary.flush_avg_us, summary.invalidated_avg_px, summary.ui_queue_depth_max,
+                          summary.heap_free_internal / 1024, summary.heap_free_psram / 1024);
+}
+
+/**
+ * @brief Dump the profiler ring buffer to the console when the HUD is tapped
+ *
+ * @param event LVGL event
+ */
+static void perf_hud_event_handler(lv_event_t *event) {
+    if (lv_event_get_code(event) == LV_EVENT_CLICKED) {
+        render_profiler_dump();
+    }
+}
+
+/**
+ * @brief Show or hide the performance HUD overlay
+ */
+static void toggle_perf_hud() {
+    if (perf_hud != NULL) {
+        lv_timer_delete(perf_hud_timer);
+        lv_obj_delete(perf_hud);
+        perf_hud       = NULL;
+        perf_hud_timer = NULL;
+        return;
+    }
+
+    perf_hud = lv_label_create(lv_layer_top());
+    lv_obj_set_style_bg_color(perf_hud, lv_color_hex(BLACK), LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(perf_hud, LV_OPA_70, LV_PART_MAIN);
+    lv_obj_set_style_text_color(perf_hud, lv_color_hex(WHITE), LV_PART_MAIN);
+    lv_obj_set_style_text_font(perf_hud, &lv_font_montserrat_10, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(perf_hud, 3, LV_PART_MAIN);
+    lv_obj_align(perf_hud, LV_ALIGN_TOP_RIGHT, 0, 0);
+    lv_obj_add_flag(perf_hud, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(perf_hud, perf_hud_event_handler, LV_EVENT_CLICKED, NULL);
+
+    perf_hud_timer = lv_timer_create(perf_hud_update, PERF_HUD_UPDATE_MS, NULL);
+    perf_hud_update(perf_hud_timer);
+}
@@ -2,6 +2,28 @@
 #include "stats.h"
 #include "theme.h"
 
+// Activity keeps counting while the page is open
+static lv_timer_t *activity_timer = NULL;
+static lv_obj_t *steps_value      = NULL;
+static lv_obj_t *active_value     = NULL;
+
+static void activity_timer_cb(lv_timer_t *timer) {
+    activity_stats_t stats;
+    activity_get_stats(&stats);
+    lv_label_set_text_fmt(steps_value, "%lu", stats.steps);
+    lv_label_set_text_fmt(active_value, "%lu min", stats.active_s / 60);
+}
+
+static void activity_cleanup(lv_event_t *e) {
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_DELETE) {
+        if (activity_timer != NULL) {
+            lv_timer_delete(activity_timer);
+            activity_timer = NULL;
+        }
+    }
+}
+
 void stats_page_create(lv_obj_t *parent) {
     // Clear the content area
     lv_obj_clean(parent);
@@ -28,10 +50,11 @@ void stats_page_create(lv_obj_t *parent) {
 
     // Create a grid layout
     static lv_coord_t column_dsc[] = {LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_TEMPLATE_LAST};
-    static lv_coord_t row_dsc[]    = {LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_TEMPLATE_LAST};
+    static lv_coord_t row_dsc[]    = {LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_FR(1),
+                                      LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_FR(1), LV_GRID_TEMPLATE_LAST};
     lv_obj_set_grid_dsc_array(grid, column_dsc, row_dsc);
 
-    // Stats: Player ID, XP, Level, Coins
+    // Stats: Player ID, XP, Level, Coins, Steps, Active time
     lv_obj_t *id_label = lv_label_create(grid);
     lv_label_set_text(id_label, "Player ID");
     lv_obj_set_style_text_font(id_label, &clarity_16, LV_PART_MAIN);
@@ -79,4 +102,33 @@ void stats_page_create(lv_obj_t *parent) {
     lv_obj_set_style_text_font(coins_value, &cyberphont3b_16, LV_PART_MAIN);
     lv_obj_set_style_text_color(coins_value, lv_color_hex(GRAY_TINT_5), LV_PART_MAIN);
     lv_obj_set_grid_cell(coins_value, LV_GRID_ALIGN_END, 1, 1, LV_GRID_ALIGN_CENTER, 3, 1);
+
+    lv_obj_t *steps_label = lv_label_create(grid);
+    lv_label_set_text(steps_label, "Steps");
+    lv_obj_set_style_text_font(steps_label, &clarity_16, LV_PART_MAIN);
+    lv_obj_set_style_text_color(steps_label, lv_color_hex(WHITE), LV_PART_MAIN);
+    lv_obj_set_grid_cell(steps_label, LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_CENTER, 4, 1);
+
+    steps_value = lv_label_create(grid);
+    lv_obj_set_style_text_font(steps_value, &cyberphont3b_16, LV_PART_MAIN);
+    lv_obj_set_style_text_color(steps_value, lv_color_hex(GRAY_TINT_5), LV_PART_MAIN);
+    lv_obj_set_grid_cell(steps_value, LV_GRID_ALIGN_END, 1, 1, LV_GRID_ALIGN_CENTER, 4, 1);
+
+    lv_obj_t *active_label = lv_label_create(grid);
+    lv_label_set_text(active_label, "Active");
+    lv_obj_set_style_text_font(active_label, &clarity_16, LV_PART_MAIN);
+    lv_obj_set_style_text_color(active_label, lv_color_hex(WHITE), LV_PART_MAIN);
+    lv_obj_set_grid_cell(active_label, LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_CENTER, 5, 1);
+
+    active_value = lv_label_create(grid);
+    lv_obj_set_style_text_font(active_value, &cyberphont3b_16, LV_PART_MAIN);
+    lv_obj_set_style_text_color(active_value, lv_color_hex(GRAY_TINT_5), LV_PART_MAIN);
+    lv_obj_set_grid_cell(active_value, LV_GRID_ALIGN_END, 1, 1, LV_GRID_ALIGN_CENTER, 5, 1);
+
+    // Fill in the activity now and refresh it every second
+    activity_timer_cb(NULL);
+    if (activity_timer == NULL) {
+        activity_timer = lv_timer_create(activity_timer_cb, 1000, NULL);
+    }
+    lv_obj_add_event_cb(container, activity_cleanup, LV_EVENT_DELETE, NULL);
 }
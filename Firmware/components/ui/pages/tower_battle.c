@@ -3,9 +3,13 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #include "api.h"
+#include "api_executor.h"
 #include "badge.h"
+#include "display.h"
 #include "loadanim.h"
 #include "theme.h"
 #include "tower_battle.h"
@@ -15,10 +19,13 @@
 
 static const char *TAG = "pages/tower_battle";
 
-#define TOWER_REFRESH_INTERVAL 5 * 1000 * 1000 // 5 seconds
-#define BATTLE_STATUS_INTERVAL 5 * 1000 * 1000 // 1 second
-#define REVIVAL_SECONDS        10              // 10 seconds
-#define REVIVAL_TX_UPDATE_MS   500             // Update the revival countdown and send the IR code every 500ms
+#define TOWER_REFRESH_INTERVAL         5 * 1000 * 1000 // 5 seconds
+#define BATTLE_STATUS_FAST_INTERVAL_MS 1000            // Poll every second while attacking
+#define BATTLE_STATUS_SLOW_INTERVAL_MS 5000            // Poll every 5 seconds in every other battle state
+#define BATTLE_STATUS_TASK_STACK_SIZE  4096
+#define BATTLE_STATUS_TASK_PRIORITY    4
+#define REVIVAL_SECONDS                10  // 10 seconds
+#define REVIVAL_TX_UPDATE_MS           500 // Update the revival countdown and send the IR code every 500ms
 typedef enum {
     TOWER_BATTLE_PAGE_INIT,    // Initial state
     TOWER_BATTLE_PAGE_LOADING, // Searching for towers on a timer (every 5 seconds)
@@ -56,6 +63,14 @@ typedef struct {
     int use_count;
 } battle_buff_t;
 
+// How late a periodic callback fired compared to when it was due
+typedef struct {
+    int64_t due_us;    // When the callback is next due
+    uint32_t samples;  // Number of intervals measured
+    uint32_t max_us;   // Worst lateness seen
+    uint64_t total_us; // Sum of lateness, for the average
+} jitter_stats_t;
+
 typedef struct {
     lv_obj_t *container;
     lv_obj_t *check_towers_label;
@@ -64,9 +79,15 @@ typedef struct {
     lv_obj_t *attack_modal;
     esp_event_loop_handle_t battle_async_events; // Event loop to deal with UI transitions after API calls
     esp_timer_handle_t tower_refresh_timer;
-    esp_timer_handle_t status_timer;
+    volatile bool status_polling;        // Whether the battle status task should be polling
+    bool status_stream_unavailable;      // Set when the server can't stream this battle's status, so it is polled instead
+    jitter_stats_t tower_refresh_jitter; // Lateness of the tower refresh esp_timer
+    jitter_stats_t status_poll_jitter;   // Lateness of the battle status polls
     tower_state_t *towers[MAX_NEARBY_TOWERS];
     int nearby_count;
+    tower_state_t *listed_towers[MAX_NEARBY_TOWERS]; // Towers currently shown in tower_list
+    lv_obj_t *tower_rows[MAX_NEARBY_TOWERS];         // List button for each listed tower
+    int listed_count;
     tower_battle_page_state_t state;
     battle_state_t battle_state;
     int post_attack_percentage;
@@ -94,11 +115,18 @@ typedef struct {
 } modal_list_t;
 static modal_list_t modal_list = {0};
 
+// The battle status task outlives the page - it is created on the first battle and sleeps while there isn't one. It only
+// reads or writes the page under the LVGL lock, which the page's cleanup also runs under, so it never sees the page half
+// torn down and never replaces the battle status while the UI is reading it.
+static TaskHandle_t battle_status_task_handle = NULL;
+
 // Function prototypes
 static void render_state();
 static void render_state_loading(const char *label_text, bool loadanim);
 static void tower_item_event_cb(lv_event_t *event);
 static void render_state_listing();
+static void update_tower_row(void *data);
+static void tower_changed_callback(tower_state_t *tower);
 static void render_state_battle();
 static void tower_battle_page_cleanup(lv_event_t *event);
 
@@ -114,12 +142,21 @@ static void render_battle_self_save();
 static void render_battle_post_revival();
 static void render_battle_result();
 static void status_updated();
+static bool apply_player_status(api_result_t *badge_result);
+static bool apply_battle_status(api_result_t *battle_result);
 static bool sync_player_status();
 static bool sync_battle_status();
 static bool sync_status();
+static void update_attack_status();
+static void start_status_polling();
+static void stop_status_polling();
+static void battle_status_task(void *arg);
+static bool status_stream_callback(api_result_t *result, void *arg);
+static bool deliver_battle_status(api_result_t *result, uint32_t battle_id);
+static void record_jitter(jitter_stats_t *stats, int64_t now_us, int64_t expected_interval_us);
+static void log_jitter(const char *name, const jitter_stats_t *stats);
 
 static void tower_refresh_timer_callback(void *arg);
-static void status_timer_callback(void *arg);
 static bool stratagem_callback(uint32_t battle_id, uint16_t stratagem_index, uint16_t stratagem_length, uint16_t score,
                                uint16_t failures, int32_t time_elapsed);
 static void attack_result_callback(uint32_t battle_id, bool success, uint16_t stratagem_length, uint16_t stratagem_count,
@@ -135,6 +172,52 @@ static void add_modal(lv_obj_t *modal);
 static void remove_modal(lv_obj_t *modal);
 static void cleanup_modals();
 
+// API executor request wrappers - these run on the API executor task
+typedef struct {
+    uint32_t battle_id;
+    uint16_t stratagem_length;
+    uint16_t stratagem_count;
+    int32_t attack_duration;
+} send_attack_args_t;
+
+static api_result_t *join_tower_request(void *arg) {
+    return api_join_tower((uint32_t)arg);
+}
+
+static api_result_t *leave_tower_request(void *arg) {
+    api_leave_tower();
+    return NULL;
+}
+
+static api_result_t *join_battle_request(void *arg) {
+    return api_join_battle();
+}
+
+static api_result_t *savior_code_request(void *arg) {
+    return api_get_savior_code();
+}
+
+static api_result_t *self_save_request(void *arg) {
+    return api_self_save((int)arg);
+}
+
+static api_result_t *send_attack_request(void *arg) {
+    send_attack_args_t *args = (send_attack_args_t *)arg;
+    return api_send_attack(args->battle_id, args->stratagem_length, args->stratagem_count, args->attack_duration);
+}
+
+static api_result_t *send_attack_fail_request(void *arg) {
+    return api_send_attack_fail((int)arg);
+}
+
+static api_result_t *badge_data_request(void *arg) {
+    return api_get_badge_data();
+}
+
+static api_result_t *battle_status_request(void *arg) {
+    return api_get_battle_status((int)arg);
+}
+
 void tower_battle_page_create(lv_obj_t *parent) {
     // Create a parent container
     page.container = lv_obj_create(parent);
@@ -152,11 +235,6 @@ void tower_battle_page_create(lv_obj_t *parent) {
         .arg      = NULL,
     };
     esp_timer_create(&tower_refresh_timer_args, &page.tower_refresh_timer);
-    esp_timer_create_args_t status_timer_args = {
-        .callback = status_timer_callback,
-        .arg      = NULL,
-    };
-    esp_timer_create(&status_timer_args, &page.status_timer);
 
     // Create an event loop for handling async events
     esp_event_loop_args_t loop_args = {
@@ -172,6 +250,9 @@ void tower_battle_page_create(lv_obj_t *parent) {
     esp_event_handler_register_with(page.battle_async_events, TOWER_BATTLE_API_EVENT, ESP_EVENT_ANY_ID, on_battle_api_event,
                                     NULL);
 
+    // Update listed towers in place when the tracker gets new info for them
+    tower_add_change_callback(tower_changed_callback);
+
     // Render the current state
     render_state();
 
@@ -186,14 +267,17 @@ static void tower_battle_page_cleanup(lv_event_t *event) {
             esp_timer_stop(page.tower_refresh_timer);
         }
         esp_timer_delete(page.tower_refresh_timer);
-        if (esp_timer_is_active(page.status_timer)) {
-            esp_timer_stop(page.status_timer);
-        }
-        esp_timer_delete(page.status_timer);
+        tower_remove_change_callback(tower_changed_callback);
+        stop_status_polling();
+        log_jitter("Tower refresh timer", &page.tower_refresh_jitter);
+        log_jitter("Battle status poll", &page.status_poll_jitter);
 
-        // Stop any ongoing battle
+        // Drop any requests this page still has queued or in flight so their results aren't applied to a dead page
+        api_cancel_owner(&page);
+
+        // Stop any ongoing battle - this isn't owned by the page so it still goes out after the page is gone
         if (page.battle_state != BATTLE_STATE_NONE && page.battle_id != 0) {
-            api_leave_tower();
+            api_submit(API_PRIORITY_HIGH, leave_tower_request, NULL, NULL, NULL, NULL);
         }
 
         // Delete the event loop
@@ -233,6 +317,7 @@ static void render_state() {
         page.check_towers_label = NULL;
         page.loading_dots       = NULL;
         page.tower_list         = NULL;
+        page.listed_count       = 0;
         lv_refr_now(NULL);
         if (page.state == TOWER_BATTLE_PAGE_LOADING) {
             render_state_loading("Searching for towers...", true);
@@ -247,21 +332,18 @@ static void render_state() {
     }
 
     if (page.state == TOWER_BATTLE_PAGE_BATTLE) {
-        // Start the battle status timer
+        // Start polling the battle status
         if (esp_timer_is_active(page.tower_refresh_timer)) {
             esp_timer_stop(page.tower_refresh_timer);
         }
-        if (!esp_timer_is_active(page.status_timer)) {
-            esp_timer_start_periodic(page.status_timer, BATTLE_STATUS_INTERVAL);
-        }
+        start_status_polling();
     } else {
         // Start the tower refresh timer
         if (!esp_timer_is_active(page.tower_refresh_timer)) {
+            page.tower_refresh_jitter.due_us = 0;
             esp_timer_start_periodic(page.tower_refresh_timer, TOWER_REFRESH_INTERVAL);
         }
-        if (esp_timer_is_active(page.status_timer)) {
-            esp_timer_stop(page.status_timer);
-        }
+        stop_status_polling();
     }
 }
 
@@ -298,6 +380,12 @@ static void tower_item_event_cb(lv_event_t *event) {
 }
 
 static void render_state_listing() {
+    // Only rebuild the list when the set of nearby towers changed - info changes are handled by update_tower_row()
+    if (page.tower_list != NULL && page.listed_count == page.nearby_count &&
+        memcmp(page.listed_towers, page.towers, page.nearby_count * sizeof(tower_state_t *)) == 0) {
+        return;
+    }
+
     if (page.tower_list != NULL) {
         lv_obj_delete(page.tower_list);
     }
@@ -329,11 +417,45 @@ static void render_state_listing() {
 
         // Add an event handler
         lv_obj_add_event_cb(button, tower_item_event_cb, LV_EVENT_CLICKED, page.towers[i]->info);
+
+        page.listed_towers[i] = page.towers[i];
+        page.tower_rows[i]    = button;
     }
+    page.listed_count = page.nearby_count;
 
     lv_refr_now(NULL);
 }
 
+static void update_tower_row(void *data) {
+    tower_state_t *tower = (tower_state_t *)data;
+    if (page.tower_list == NULL) {
+        return;
+    }
+
+    // Towers were added or removed, so let render_state() work out the new list
+    if (tower == NULL) {
+        render_state();
+        return;
+    }
+
+    for (int i = 0; i < page.listed_count; i++) {
+        if (page.listed_towers[i] == tower) {
+            lv_obj_t *label = lv_obj_get_child_by_type(page.tower_rows[i], 0, &lv_label_class);
+            if (label != NULL) {
+                lv_label_set_text(label, tower->info->name);
+            }
+            break;
+        }
+    }
+}
+
+// Called on the API executor task when the tower tracker gets new info
+static void tower_changed_callback(tower_state_t *tower) {
+    if (page.state == TOWER_BATTLE_PAGE_LISTING) {
+        lv_async_call(update_tower_row, tower);
+    }
+}
+
 static void render_state_battle() {
     // Just have a centered label indicating the battle state
     lv_obj_t *label = lv_label_create(page.container);
@@ -470,6 +592,11 @@ static void set_battle_state(battle_state_t state) {
     // Cleanup the modals if we are transitioning to a different state
     if (state_changed) {
         cleanup_modals();
+
+        // Wake the status task so it picks up the poll interval for the new state
+        if (page.status_polling && battle_status_task_handle != NULL) {
+            xTaskNotifyGive(battle_status_task_handle);
+        }
     }
 
     // Handle the battle state
@@ -480,7 +607,8 @@ static void on_battle_event(void *event_handler_arg, esp_event_base_t event_base
     switch (event_id) {
         case BATTLE_EVENT_JOIN_TOWER: {
             // Make the API calls and close the loading modal
-            api_result_t *result = api_join_tower(page.selected_tower->ir_code);
+            api_result_t *result = api_submit_wait(API_PRIORITY_NORMAL, join_tower_request,
+                                                   (void *)page.selected_tower->ir_code, &page, portMAX_DELAY);
             if (result != NULL && result->status == true) {
                 tower_info_refresh(page.selected_tower->id);
             }
@@ -510,7 +638,7 @@ static void on_battle_event(void *event_handler_arg, esp_event_base_t event_base
         }
         case BATTLE_EVENT_LEAVE_TOWER: {
             // Make the API call and close the loading modal
-            api_err_t res   = api_leave_tower();
+            api_submit_wait(API_PRIORITY_NORMAL, leave_tower_request, NULL, &page, portMAX_DELAY);
             lv_obj_t *modal = *(lv_obj_t **)event_data;
             if (modal != NULL && lv_obj_is_valid(modal)) {
                 lv_obj_delete_async(modal);
@@ -523,7 +651,7 @@ static void on_battle_event(void *event_handler_arg, esp_event_base_t event_base
         }
         case BATTLE_EVENT_JOIN_BATTLE: {
             // Make the API call and close the loading modal
-            api_result_t *result = api_join_battle();
+            api_result_t *result = api_submit_wait(API_PRIORITY_NORMAL, join_battle_request, NULL, &page, portMAX_DELAY);
             lv_obj_t *modal      = *(lv_obj_t **)event_data;
 
             // See if we joined the battle successfully
@@ -555,13 +683,17 @@ static void on_battle_event(void *event_handler_arg, esp_event_base_t event_base
                     remove_modal(modal);
                 }
 
-                // Make sure the player isn't disconnected
-                if (page.battle_status != NULL && page.battle_status->player_status == PLAYER_STATUS_DISCONNECTED) {
-                    if (page.battle_status->is_savior) {
-                        lv_async_call(set_battle_state, (void *)BATTLE_STATE_SAVIOR);
-                    } else {
-                        lv_async_call(set_battle_state, (void *)BATTLE_STATE_DISCONNECTED);
+                // Make sure the player isn't disconnected. The battle status task replaces the status under the LVGL lock, so
+                // it is read under it too.
+                battle_state_t disconnected_state = BATTLE_STATE_NONE;
+                if (lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+                    if (page.battle_status != NULL && page.battle_status->player_status == PLAYER_STATUS_DISCONNECTED) {
+                        disconnected_state = page.battle_status->is_savior ? BATTLE_STATE_SAVIOR : BATTLE_STATE_DISCONNECTED;
                     }
+                    lvgl_unlock(__FILE__, __LINE__);
+                }
+                if (disconnected_state != BATTLE_STATE_NONE) {
+                    lv_async_call(set_battle_state, (void *)disconnected_state);
                 } else {
                     // Post the API response event
                     esp_event_post_to(page.battle_async_events, TOWER_BATTLE_API_EVENT, API_EVENT_BATTLE_JOIN_BATTLE_SUCCESS,
@@ -595,8 +727,16 @@ static void on_battle_event(void *event_handler_arg, esp_event_base_t event_base
             // Fetch the battle status
             sync_status();
 
+            // The battle status task replaces the status under the LVGL lock, so hold it from here until the attack modal has
+            // been set up from the status
+            if (!lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+                ESP_LOGE(TAG, "Failed to create attack modal - LVGL lock failed");
+                break;
+            }
+
             // If the battle ID is 0, we don't have a valid battle to join
             if (page.battle_id == 0 || page.battle_status == NULL) {
+                lvgl_unlock(__FILE__, __LINE__);
                 lv_async_call(set_battle_state, (void *)BATTLE_STATE_NONE);
                 esp_event_post_to(page.battle_async_events, TOWER_BATTLE_API_EVENT, API_EVENT_BATTLE_START_ATTACK_FAILED,
                                   "Battle ID is 0", 17, 0);
@@ -647,12 +787,8 @@ static void on_battle_event(void *event_handler_arg, esp_event_base_t event_base
             }
 
             // Create the attack modal
-            if (lvgl_lock(pdMS_TO_TICKS(100), __FILE__, __LINE__)) {
-                page.attack_modal = attack_create(&config);
-                lvgl_unlock(__FILE__, __LINE__);
-            } else {
-                ESP_LOGE(TAG, "Failed to create attack modal - LVGL lock failed");
-            }
+            page.attack_modal = attack_create(&config);
+            lvgl_unlock(__FILE__, __LINE__);
 
             // Post a failure event
             esp_event_post_to(page.battle_async_events, TOWER_BATTLE_API_EVENT, API_EVENT_BATTLE_START_ATTACK_SUCCESS, NULL, 0,
@@ -660,7 +796,7 @@ static void on_battle_event(void *event_handler_arg, esp_event_base_t event_base
             break;
         }
         case BATTLE_EVENT_SAVIOR_START: {
-            api_result_t *result = api_get_savior_code();
+            api_result_t *result = api_submit_wait(API_PRIORITY_HIGH, savior_code_request, NULL, &page, portMAX_DELAY);
             lv_obj_t *modal      = *(lv_obj_t **)event_data;
 
             // Close the loading modal
@@ -681,9 +817,12 @@ static void on_battle_event(void *event_handler_arg, esp_event_base_t event_base
 
                 esp_event_post_to(page.battle_async_events, TOWER_BATTLE_API_EVENT, API_EVENT_BATTLE_SAVIOR_START_SUCCESS, NULL,
                                   0, 0);
-            } else {
+            } else if (result != NULL && result->detail != NULL) {
                 esp_event_post_to(page.battle_async_events, TOWER_BATTLE_API_EVENT, API_EVENT_BATTLE_SAVIOR_START_FAILED,
                                   result->detail, strlen(result->detail) + 1, 0);
+            } else {
+                esp_event_post_to(page.battle_async_events, TOWER_BATTLE_API_EVENT, API_EVENT_BATTLE_SAVIOR_START_FAILED, NULL,
+                                  0, 0);
             }
 
             // Free the result
@@ -699,7 +838,8 @@ static void on_battle_event(void *event_handler_arg, esp_event_base_t event_base
                 break;
             }
 
-            api_result_t *result = api_self_save(page.battle_id);
+            api_result_t *result =
+                api_submit_wait(API_PRIORITY_HIGH, self_save_request, (void *)page.battle_id, &page, portMAX_DELAY);
 
             if (result != NULL && result->status == true) {
                 if (modal != NULL && lv_obj_is_valid(modal)) {
@@ -1487,11 +1627,9 @@ static void status_updated() {
     // TODO: Update the UI with the new status info based on what is currently being displayed
 }
 
-static bool sync_player_status() {
+static bool apply_player_status(api_result_t *badge_result) {
     bool player_updated = false;
 
-    // Get the current player status from the API
-    api_result_t *badge_result = api_get_badge_data();
     if (badge_result != NULL && badge_result->status == true) {
         if (page.player_status != NULL) {
             api_free_result_data(page.player_status, API_BADGE_DATA);
@@ -1504,16 +1642,9 @@ static bool sync_player_status() {
     return player_updated;
 }
 
-static bool sync_battle_status() {
-    // If the battle ID is not set, return false
-    if (page.battle_id == 0) {
-        return false;
-    }
-
+static bool apply_battle_status(api_result_t *battle_result) {
     bool battle_updated = false;
 
-    // Get the current battle status from the API
-    api_result_t *battle_result = api_get_battle_status(page.battle_id);
     if (battle_result != NULL && battle_result->status == true) {
         if (page.battle_status != NULL) {
             api_free_result_data(page.battle_status, API_BATTLE_STATUS);
@@ -1526,6 +1657,42 @@ static bool sync_battle_status() {
     return battle_updated;
 }
 
+static bool sync_player_status() {
+    // Get the current player status from the API
+    api_result_t *result = api_submit_wait(API_PRIORITY_NORMAL, badge_data_request, NULL, &page, portMAX_DELAY);
+
+    // Applied under the LVGL lock, the same as the battle status task's updates
+    bool updated = false;
+    if (lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+        updated = apply_player_status(result);
+        lvgl_unlock(__FILE__, __LINE__);
+    } else {
+        api_free_result(result, true);
+    }
+    return updated;
+}
+
+static bool sync_battle_status() {
+    // If the battle ID is not set, return false
+    if (page.battle_id == 0) {
+        return false;
+    }
+
+    // Get the current battle status from the API
+    api_result_t *result =
+        api_submit_wait(API_PRIORITY_NORMAL, battle_status_request, (void *)page.battle_id, &page, portMAX_DELAY);
+
+    // Applied under the LVGL lock, the same as the battle status task's updates
+    bool updated = false;
+    if (lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+        updated = apply_battle_status(result);
+        lvgl_unlock(__FILE__, __LINE__);
+    } else {
+        api_free_result(result, true);
+    }
+    return updated;
+}
+
 static bool sync_status() {
     // Call the status updated callback if the battle or player data has updated
     if (sync_battle_status() || sync_player_status()) {
@@ -1535,15 +1702,8 @@ static bool sync_status() {
     return false;
 }
 
-static void tower_refresh_timer_callback(void *arg) {
-    lv_async_call(render_state, NULL);
-    vTaskDelay(1); // Delay 1 tick to make sure it is actually run async
-}
-
-static void status_timer_callback(void *arg) {
-    sync_status();
-
-    if (page.battle_state == BATTLE_STATE_ATTACKING && page.attack_modal != NULL) {
+static void update_attack_status() {
+    if (page.battle_state == BATTLE_STATE_ATTACKING && page.attack_modal != NULL && page.battle_status != NULL) {
         int16_t tower_health =
             (int16_t)roundf((float)page.battle_status->tower_health / page.battle_status->tower_max_health * 100);
         int16_t connection_strength =
@@ -1553,6 +1713,159 @@ static void status_timer_callback(void *arg) {
     }
 }
 
+static void record_jitter(jitter_stats_t *stats, int64_t now_us, int64_t next_interval_us) {
+    if (stats->due_us != 0) {
+        int64_t late_us = now_us > stats->due_us ? now_us - stats->due_us : 0;
+        if (late_us > stats->max_us) {
+            stats->max_us = late_us;
+        }
+        stats->total_us += late_us;
+        stats->samples++;
+    }
+    stats->due_us = now_us + next_interval_us;
+}
+
+static void log_jitter(const char *name, const jitter_stats_t *stats) {
+    if (stats->samples == 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "%s jitter: avg %lluus, max %luus over %lu intervals", name, stats->total_us / stats->samples,
+             stats->max_us, stats->samples);
+}
+
+static void tower_refresh_timer_callback(void *arg) {
+    record_jitter(&page.tower_refresh_jitter, esp_timer_get_time(), TOWER_REFRESH_INTERVAL);
+    lv_async_call(render_state, NULL);
+    vTaskDelay(1); // Delay 1 tick to make sure it is actually run async
+}
+
+static void start_status_polling() {
+    if (page.status_polling) {
+        return;
+    }
+
+    // Create the status task the first time a battle starts
+    if (battle_status_task_handle == NULL &&
+        xTaskCreate(battle_status_task, "battle_status_task", BATTLE_STATUS_TASK_STACK_SIZE, NULL, BATTLE_STATUS_TASK_PRIORITY,
+                    &battle_status_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create battle status task");
+        battle_status_task_handle = NULL;
+        return;
+    }
+
+    page.status_poll_jitter.due_us = 0;
+    page.status_stream_unavailable = false;
+    page.status_polling            = true;
+    xTaskNotifyGive(battle_status_task_handle);
+}
+
+static void stop_status_polling() {
+    // Anything the task fetches from here on is dropped by deliver_battle_status. An in-flight poll is cancelled with the
+    // rest of the page's requests and an open stream is closed rather than left until the server sends something.
+    page.status_polling = false;
+#if CONFIG_API_BATTLE_STATUS_STREAM
+    api_abort_battle_status_stream();
+#endif
+}
+
+// Apply a status the battle status task fetched, or drop it if the page has stopped polling or moved on to a different
+// battle since. Returns whether the page still wants updates for the battle.
+static bool deliver_battle_status(api_result_t *result, uint32_t battle_id) {
+    if (!lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+        api_free_result(result, true);
+        return false;
+    }
+
+    bool wanted = page.status_polling && page.battle_id == battle_id;
+    if (!wanted) {
+        api_free_result(result, true);
+    } else if (apply_battle_status(result)) {
+        lv_async_call(status_updated, NULL);
+        update_attack_status();
+    }
+
+    lvgl_unlock(__FILE__, __LINE__);
+    return wanted;
+}
+
+// Called for every update and keep-alive on the battle status stream - runs on the battle status task
+static bool status_stream_callback(api_result_t *result, void *arg) {
+    // Close the stream once the page no longer wants it
+    return deliver_battle_status(result, (uint32_t)arg);
+}
+
+static void battle_status_task(void *arg) {
+    TickType_t wait = portMAX_DELAY;
+    while (true) {
+        // Sleep until the next poll is due, or until the page wakes us because the battle state changed
+        bool woken = ulTaskNotifyTake(pdTRUE, wait) > 0;
+
+        // Take what this poll needs from the page in one go
+        if (!lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+            wait = portMAX_DELAY;
+            continue;
+        }
+        bool polling       = page.status_polling;
+        uint32_t battle_id = page.battle_id;
+        int64_t start_us   = esp_timer_get_time();
+#if CONFIG_API_BATTLE_STATUS_STREAM
+        bool stream = !page.status_stream_unavailable;
+#endif
+
+        // Poll fast while attacking so the attack screen's tower health stays current, slowly otherwise
+        uint32_t interval_ms =
+            page.battle_state == BATTLE_STATE_ATTACKING ? BATTLE_STATUS_FAST_INTERVAL_MS : BATTLE_STATUS_SLOW_INTERVAL_MS;
+        if (polling) {
+            if (woken) {
+                page.status_poll_jitter.due_us = 0; // Early wakes are on purpose, so they don't count as jitter
+            }
+            record_jitter(&page.status_poll_jitter, start_us, (int64_t)interval_ms * 1000);
+        }
+        lvgl_unlock(__FILE__, __LINE__);
+
+        if (!polling) {
+            wait = portMAX_DELAY;
+            continue;
+        }
+        wait = pdMS_TO_TICKS(interval_ms);
+
+        // Nothing to poll until the battle has been joined
+        if (battle_id == 0) {
+            continue;
+        }
+
+#if CONFIG_API_BATTLE_STATUS_STREAM
+        // Prefer having the server push updates - this only returns once the stream closes
+        if (stream) {
+            bool streamed = api_stream_battle_status(battle_id, status_stream_callback, (void *)battle_id) == API_OK;
+            if (lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+                if (page.status_polling && page.battle_id == battle_id) {
+                    if (!streamed) {
+                        ESP_LOGI(TAG, "Battle status stream unavailable, falling back to polling");
+                        page.status_stream_unavailable = true;
+                        wait                           = 0;
+                    }
+                    page.status_poll_jitter.due_us = 0; // Time spent streaming isn't poll jitter
+                }
+                lvgl_unlock(__FILE__, __LINE__);
+            }
+            continue;
+        }
+#endif
+
+        // The battle status already carries the player's own status, so the poll is a single request
+        api_result_t *result =
+            api_submit_wait(API_PRIORITY_NORMAL, battle_status_request, (void *)battle_id, &page, portMAX_DELAY);
+        if (!deliver_battle_status(result, battle_id)) {
+            continue;
+        }
+
+        // Keep the interval measured from the start of the poll rather than the end of it
+        uint32_t elapsed_ms = (esp_timer_get_time() - start_us) / 1000;
+        wait                = pdMS_TO_TICKS(elapsed_ms < interval_ms ? interval_ms - elapsed_ms : 0);
+    }
+}
+
 static bool stratagem_callback(uint32_t battle_id, uint16_t stratagem_index, uint16_t stratagem_length, uint16_t score,
                                uint16_t failures, int32_t time_elapsed) {
     ESP_LOGI(TAG, "[Battle:%lu] Stratagem %d (length: %d) with %d failures in %ldms", battle_id, stratagem_index,
@@ -1604,7 +1917,13 @@ static void attack_result_callback(uint32_t battle_id, bool success, uint16_t st
 
     // Send the attack to the API otherwise
     if (success) {
-        api_result_t *result = api_send_attack(battle_id, stratagem_length, stratagem_count, attack_duration);
+        send_attack_args_t args = {
+            .battle_id        = battle_id,
+            .stratagem_length = stratagem_length,
+            .stratagem_count  = stratagem_count,
+            .attack_duration  = attack_duration,
+        };
+        api_result_t *result = api_submit_wait(API_PRIORITY_HIGH, send_attack_request, &args, &page, portMAX_DELAY);
         if (result != NULL) {
             if (result->status == true && result->data != NULL) {
                 page.post_attack_percentage = (((api_send_attack_t *)result->data)->percent);
@@ -1613,7 +1932,8 @@ static void attack_result_callback(uint32_t battle_id, bool success, uint16_t st
         }
     } else {
         bool battle_updated  = false;
-        api_result_t *result = api_send_attack_fail(battle_id);
+        api_result_t *result =
+            api_submit_wait(API_PRIORITY_HIGH, send_attack_fail_request, (void *)battle_id, &page, portMAX_DELAY);
         if (result != NULL && result->status == true) {
             // Save the updated battle status that is returned from the API
             if (page.battle_status != NULL) {
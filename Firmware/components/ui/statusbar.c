@@ -208,33 +208,37 @@ void status_bar_shutdown() {
     }
 }
 
-void render_status(ui_state_t *state) {
-    ESP_LOGD(TAG, "Updating status bar");
+void render_status(const ui_state_t *state, uint32_t dirty) {
+    ESP_LOGD(TAG, "Updating status bar (dirty: 0x%02lx)", dirty);
 
-    update_wifi_icon(state->wifi_state);
+    if (dirty & STATUS_DIRTY_WIFI) {
+        update_wifi_icon(state->wifi_state);
+    }
 
     // Update the battery icon
-    const char *battery_symbol = NULL;
-    if (state->battery_charging) {
-        battery_symbol = LV_SYMBOL_CHARGE;
-    } else {
-        switch (state->battery_level) {
-            case BATTERY_LEVEL_FULL: battery_symbol = LV_SYMBOL_BATTERY_FULL; break;
-            case BATTERY_LEVEL_3: battery_symbol = LV_SYMBOL_BATTERY_3; break;
-            case BATTERY_LEVEL_2: battery_symbol = LV_SYMBOL_BATTERY_2; break;
-            case BATTERY_LEVEL_1: battery_symbol = LV_SYMBOL_BATTERY_1; break;
-            default: battery_symbol = LV_SYMBOL_BATTERY_EMPTY; break;
+    if (dirty & STATUS_DIRTY_BATTERY) {
+        const char *battery_symbol = NULL;
+        if (state->battery_charging) {
+            battery_symbol = LV_SYMBOL_CHARGE;
+        } else {
+            switch (state->battery_level) {
+                case BATTERY_LEVEL_FULL: battery_symbol = LV_SYMBOL_BATTERY_FULL; break;
+                case BATTERY_LEVEL_3: battery_symbol = LV_SYMBOL_BATTERY_3; break;
+                case BATTERY_LEVEL_2: battery_symbol = LV_SYMBOL_BATTERY_2; break;
+                case BATTERY_LEVEL_1: battery_symbol = LV_SYMBOL_BATTERY_1; break;
+                default: battery_symbol = LV_SYMBOL_BATTERY_EMPTY; break;
+            }
+        }
+        lv_label_set_text_static(battery_icon, battery_symbol);
+        if (state->power_connected) {
+            lv_obj_set_style_text_color(battery_icon, lv_color_hex(STATUS_GOOD), LV_PART_MAIN);
+        } else {
+            lv_obj_set_style_text_color(battery_icon, lv_color_hex(STATUS_BRIGHT), LV_PART_MAIN);
         }
-    }
-    lv_label_set_text(battery_icon, battery_symbol);
-    if (state->power_connected) {
-        lv_obj_set_style_text_color(battery_icon, lv_color_hex(STATUS_GOOD), LV_PART_MAIN);
-    } else {
-        lv_obj_set_style_text_color(battery_icon, lv_color_hex(STATUS_BRIGHT), LV_PART_MAIN);
     }
 
     // Update the minibadge icon visibility
-    if (state->minibadge_count > 0) {
+    if ((dirty & STATUS_DIRTY_MINIBADGE) && state->minibadge_count > 0) {
         if (badge_state.minibadges->slot1.valid || badge_state.minibadges->slot2.valid) {
             lv_obj_set_style_text_color(minibadge_icon, lv_color_hex(STATUS_BRIGHT), LV_PART_MAIN);
         } else {
@@ -243,33 +247,37 @@ void render_status(ui_state_t *state) {
     }
 
     // Update the alert icon visibility
-    if (state->alert_count > 0) {
-        lv_obj_set_style_text_color(alert_icon, lv_color_hex(BLUE_LIGHTER), LV_PART_MAIN);
-        lv_obj_add_flag(alert_icon_container, LV_OBJ_FLAG_CLICKABLE);
-        lv_obj_add_flag(alert_icon, LV_OBJ_FLAG_CLICKABLE);
-        if (alert_flash_timer == NULL) {
-            alert_flash_timer = lv_timer_create(alert_flash_timer_cb, 500, NULL);
-            lv_timer_ready(alert_flash_timer);
-        }
-        if (alert_icon_visible) {
-            lv_obj_remove_flag(alert_icon, LV_OBJ_FLAG_HIDDEN);
+    if (dirty & STATUS_DIRTY_ALERT) {
+        if (state->alert_count > 0) {
+            lv_obj_set_style_text_color(alert_icon, lv_color_hex(BLUE_LIGHTER), LV_PART_MAIN);
+            lv_obj_add_flag(alert_icon_container, LV_OBJ_FLAG_CLICKABLE);
+            lv_obj_add_flag(alert_icon, LV_OBJ_FLAG_CLICKABLE);
+            if (alert_flash_timer == NULL) {
+                alert_flash_timer = lv_timer_create(alert_flash_timer_cb, 500, NULL);
+                lv_timer_ready(alert_flash_timer);
+            }
+            if (alert_icon_visible) {
+                lv_obj_remove_flag(alert_icon, LV_OBJ_FLAG_HIDDEN);
+            } else {
+                lv_obj_add_flag(alert_icon, LV_OBJ_FLAG_HIDDEN);
+            }
         } else {
-            lv_obj_add_flag(alert_icon, LV_OBJ_FLAG_HIDDEN);
-        }
-    } else {
-        lv_obj_set_style_text_color(alert_icon, lv_color_hex(STATUS_DIM), LV_PART_MAIN);
-        lv_obj_remove_flag(alert_icon, LV_OBJ_FLAG_HIDDEN);
-        lv_obj_remove_flag(alert_icon, LV_OBJ_FLAG_CLICKABLE);
-        lv_obj_remove_flag(alert_icon_container, LV_OBJ_FLAG_CLICKABLE);
-        if (alert_flash_timer != NULL) {
-            lv_timer_delete(alert_flash_timer);
-            alert_flash_timer = NULL;
+            lv_obj_set_style_text_color(alert_icon, lv_color_hex(STATUS_DIM), LV_PART_MAIN);
+            lv_obj_remove_flag(alert_icon, LV_OBJ_FLAG_HIDDEN);
+            lv_obj_remove_flag(alert_icon, LV_OBJ_FLAG_CLICKABLE);
+            lv_obj_remove_flag(alert_icon_container, LV_OBJ_FLAG_CLICKABLE);
+            if (alert_flash_timer != NULL) {
+                lv_timer_delete(alert_flash_timer);
+                alert_flash_timer = NULL;
+            }
+            alert_icon_visible = true;
         }
-        alert_icon_visible = true;
     }
 
     // Update the status label
-    lv_label_set_text(status_label, state->label);
+    if (dirty & STATUS_DIRTY_LABEL) {
+        lv_label_set_text(status_label, state->label);
+    }
 
     ESP_LOGD(TAG, "Status bar updated");
 }
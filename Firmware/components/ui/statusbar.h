@@ -7,6 +7,16 @@ extern "C" {
 #include "lvgl.h"
 #include "ui.h"
 
+// Parts of the status bar that need to be re-rendered
+typedef enum {
+    STATUS_DIRTY_WIFI      = 1 << 0,
+    STATUS_DIRTY_BATTERY   = 1 << 1, // Battery level, charging and power connected
+    STATUS_DIRTY_MINIBADGE = 1 << 2,
+    STATUS_DIRTY_ALERT     = 1 << 3,
+    STATUS_DIRTY_LABEL     = 1 << 4,
+    STATUS_DIRTY_ALL       = 0x1f,
+} status_dirty_t;
+
 void create_status_bar(lv_obj_t *parent);
 void status_bar_shutdown(); // Clean up timers
 
@@ -15,8 +25,9 @@ void status_bar_shutdown(); // Clean up timers
  *       This function should be called within the LVGL context
  *
  * @param state The current UI state
+ * @param dirty The parts of the status bar to update (status_dirty_t flags)
  */
-void render_status(ui_state_t *state);
+void render_status(const ui_state_t *state, uint32_t dirty);
 
 #ifdef __cplusplus
 }
@@ -18,6 +18,7 @@
 #include "charger.h"
 #include "display.h"
 #include "minibadge.h"
+#include "render_profiler.h"
 
 // UI screens
 #include "screens/hwtest.h"
@@ -26,7 +27,10 @@
 #include "screens/update.h"
 
 // UI main content screens
+#include "asset_pack.h"
 #include "content.h"
+#include "dpad_input.h"
+#include "image_cache.h"
 #include "loadanim.h"
 #include "statusbar.h"
 
@@ -46,14 +50,29 @@ static ui_screen_t screen_next      = SCREEN_NONE; // The next screen to transit
 static QueueHandle_t ui_event_queue = NULL;
 static TaskHandle_t ui_task_handle  = NULL;
 
+// Status bar updates from ui_task accumulate here and are rendered at most once per LVGL frame by status_timer
+static ui_state_t status_state        = {0};
+static uint32_t status_dirty          = 0; // status_dirty_t flags
+static portMUX_TYPE status_lock       = portMUX_INITIALIZER_UNLOCKED;
+static lv_timer_t *status_timer       = NULL;
+static ui_status_stats_t status_stats = {0};
+
 // Function prototypes
 static void ui_task(void *_arg);
 static void render_main();
+static void update_status(uint32_t dirty);
 
 bool ui_ready() {
     return ui_initialized;
 }
 
+/**
+ * @brief Number of events waiting for the UI task, sampled by the render profiler
+ */
+static uint32_t ui_event_queue_depth() {
+    return ui_event_queue != NULL ? uxQueueMessagesWaiting(ui_event_queue) : 0;
+}
+
 void ui_init() {
     if (ui_initialized) {
         ESP_LOGW(TAG, "UI already initialized");
@@ -65,6 +84,11 @@ void ui_init() {
     lv_lodepng_init();
     lv_fs_stdio_init();
     lv_fs_posix_init();
+#if CONFIG_UI_IMAGE_PACKING
+    image_cache_init();
+#endif
+    asset_pack_init();
+    dpad_input_init();
 
     // Initialize styles
     style_init();
@@ -74,6 +98,7 @@ void ui_init() {
         ESP_LOGE(TAG, "Failed to create UI event queue");
         return;
     }
+    render_profiler_set_queue_depth_source(ui_event_queue_depth);
 
     // Try to get current battery and charging status
     battery_status_t battery_status        = battery_get_status();
@@ -82,6 +107,7 @@ void ui_init() {
     state.battery_charging =
         charger_status.chrg_stat == CHRG_STAT_PRE_CHARGING || charger_status.chrg_stat == CHRG_STAT_FAST_CHARGING;
     state.power_connected = charger_status.pg_stat;
+    update_status(STATUS_DIRTY_ALL);
 
     // Create the UI task
     if (xTaskCreate(ui_task, "ui_task", 8192, NULL, 6, &ui_task_handle) != pdPASS) {
@@ -327,11 +353,55 @@ void set_ota_state(ota_state_t state) {
     enqueue_ui_event(&event);
 }
 
-static void update_status() {
-    if (state.screen == SCREEN_MAIN) {
-        ESP_LOGD(TAG, "Updating status bar");
-        lv_async_call(render_status, &state);
-        vTaskDelay(2);
+/**
+ * @brief Publish the current state to the status bar and mark parts of it for re-rendering. Doesn't touch LVGL, the
+ *      status timer picks the changes up on its next run
+ *
+ * @param dirty The parts of the status bar that changed (status_dirty_t flags)
+ */
+static void update_status(uint32_t dirty) {
+    portENTER_CRITICAL(&status_lock);
+    status_state  = state;
+    status_dirty |= dirty;
+    portEXIT_CRITICAL(&status_lock);
+    status_stats.updates++;
+}
+
+/**
+ * @brief Render whatever changed in the status bar since the last run
+ *      This function should be called from within the LVGL context
+ *
+ * @param force Parts of the status bar to render even if they haven't changed (status_dirty_t flags)
+ */
+static void render_status_dirty(uint32_t force) {
+    // The status bar objects are being torn down or rebuilt, keep the changes until the main screen is up again
+    if (state.screen != SCREEN_MAIN || screen_trans_to != SCREEN_NONE) {
+        return;
+    }
+
+    ui_state_t snapshot;
+    portENTER_CRITICAL(&status_lock);
+    uint32_t dirty = status_dirty | force;
+    status_dirty   = 0;
+    if (dirty) {
+        snapshot = status_state;
+    }
+    portEXIT_CRITICAL(&status_lock);
+
+    if (dirty) {
+        render_status(&snapshot, dirty);
+        status_stats.renders++;
+    }
+}
+
+static void status_timer_cb(lv_timer_t *_timer) {
+    (void)_timer;
+    render_status_dirty(0);
+}
+
+void ui_get_status_stats(ui_status_stats_t *stats) {
+    if (stats != NULL) {
+        *stats = status_stats;
     }
 }
 
@@ -343,7 +413,10 @@ static void render_main() {
     if (state.screen == SCREEN_MAIN) {
         ESP_LOGD(TAG, "Rendering main screen content");
         render_content();
-        render_status(&state);
+        render_status_dirty(STATUS_DIRTY_ALL);
+        if (status_timer == NULL) {
+            status_timer = lv_timer_create(status_timer_cb, LV_DEF_REFR_PERIOD, NULL);
+        }
 
         // Start onboarding if not registered
         if (strlen(badge_config.handle) == 0) {
@@ -364,37 +437,37 @@ static void ui_task(void *_arg) {
                 case UI_EVENT_SET_WIFI_STATE: //
                     ESP_LOGD(TAG, "Setting wifi state to: %d", event.data.wifi_state);
                     state.wifi_state = event.data.wifi_state;
-                    update_status();
+                    update_status(STATUS_DIRTY_WIFI);
                     break;
                 case UI_EVENT_SET_BATTERY_CHARGING: //
                     ESP_LOGD(TAG, "Setting battery charging state to: %d", event.data.battery_charging);
                     state.battery_charging = event.data.battery_charging;
-                    update_status();
+                    update_status(STATUS_DIRTY_BATTERY);
                     break;
                 case UI_EVENT_SET_BATTERY_LEVEL: //
                     ESP_LOGD(TAG, "Setting battery level to: %d", event.data.battery_level);
                     state.battery_level = event.data.battery_level;
-                    update_status();
+                    update_status(STATUS_DIRTY_BATTERY);
                     break;
                 case UI_EVENT_SET_POWER_CONNECTED: //
                     ESP_LOGD(TAG, "Setting power connected state to: %d", event.data.power_connected);
                     state.power_connected = event.data.power_connected;
-                    update_status();
+                    update_status(STATUS_DIRTY_BATTERY);
                     break;
                 case UI_EVENT_SET_LABEL: //
                     ESP_LOGD(TAG, "Setting status label to: %s", event.data.label);
                     strncpy(state.label, event.data.label, sizeof(state.label));
-                    update_status();
+                    update_status(STATUS_DIRTY_LABEL);
                     break;
                 case UI_EVENT_SET_MINIBADGE_UPDATE: //
                     ESP_LOGD(TAG, "Minibadge update event received");
                     state.minibadge_count = event.data.minibadge_count;
-                    update_status();
+                    update_status(STATUS_DIRTY_MINIBADGE);
                     break;
                 case UI_EVENT_SET_ALERT_COUNT: //
                     ESP_LOGD(TAG, "Setting alert count to: %d", event.data.alert_count);
                     state.alert_count = event.data.alert_count;
-                    update_status();
+                    update_status(STATUS_DIRTY_ALERT);
                     break;
                 case UI_EVENT_SET_SCREEN: //
                     ESP_LOGD(TAG, "Event type: %d, screen: %d", event.type, event.data.screen);
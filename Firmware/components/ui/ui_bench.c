@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+
+#include "content.h"
+#include "display.h"
+#include "dpad_input.h"
+#include "ui.h"
+#include "ui_bench.h"
+#include "pages/map.h"
+
+static const char *TAG = "ui_bench";
+
+#define UI_BENCH_TASK_STACK_SIZE 4096
+#define UI_BENCH_TASK_PRIORITY   3
+#define UI_BENCH_SETTLE_MS       1000 // Time for the page to build and any load animations to finish before sampling
+
+// A single step of the playback script: show a page and let it run for a while
+typedef struct {
+    content_page_t page;
+    uint32_t dwell_ms;
+} ui_bench_step_t;
+
+// Pages with the most render activity: status bar blink on home, attack arrows and tower list on the battle page
+static const ui_bench_step_t script[] = {
+    {PAGE_HOME, 5000},
+    {PAGE_TOWER_BATTLE, 10000},
+    {PAGE_SETTINGS, 5000},
+    {PAGE_MAP, 5000},
+    {PAGE_STATS, 5000},
+    {PAGE_HOME, 5000},
+};
+
+static TaskHandle_t bench_task_handle = NULL;
+
+#if CONFIG_UI_BENCHMARK_FRAME_DUMP
+/**
+ * @brief Write a little-endian integer of `bytes` bytes
+ */
+static void write_le(FILE *f, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        fputc((value >> (8 * i)) & 0xff, f);
+    }
+}
+
+/**
+ * @brief Snapshot the active screen and save it as a 16-bit (RGB565) BMP
+ *
+ * @param label Page label used for the file name
+ */
+static void dump_frame(const char *label) {
+    lv_draw_buf_t *snapshot = NULL;
+    if (lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+        snapshot = lv_snapshot_take(lv_screen_active(), LV_COLOR_FORMAT_RGB565);
+        lvgl_unlock(__FILE__, __LINE__);
+    }
+    if (snapshot == NULL) {
+        ESP_LOGE(TAG, "Failed to take snapshot of %s", label);
+        return;
+    }
+
+    char path[64];
+    snprintf(path, sizeof(path), "/spiffs/bench_%s.bmp", label);
+    for (char *c = path; *c; c++) {
+        if (*c == ' ') {
+            *c = '_';
+        }
+    }
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Failed to open %s", path);
+        lv_draw_buf_destroy(snapshot);
+        return;
+    }
+
+    uint32_t w         = snapshot->header.w;
+    uint32_t h         = snapshot->header.h;
+    uint32_t row_bytes = (w * 2 + 3) & ~3;
+    uint32_t offset    = 14 + 40 + 12;
+
+    // File header, info header (top-down) and the RGB565 channel masks
+    fputc('B', f);
+    fputc('M', f);
+    write_le(f, offset + row_bytes * h, 4);
+    write_le(f, 0, 4);
+    write_le(f, offset, 4);
+    write_le(f, 40, 4);
+    write_le(f, w, 4);
+    write_le(f, (uint32_t)-(int32_t)h, 4);
+    write_le(f, 1, 2);
+    write_le(f, 16, 2);
+    write_le(f, 3, 4); // BI_BITFIELDS
+    write_le(f, row_bytes * h, 4);
+    write_le(f, 2835, 4);
+    write_le(f, 2835, 4);
+    write_le(f, 0, 4);
+    write_le(f, 0, 4);
+    write_le(f, 0xf800, 4);
+    write_le(f, 0x07e0, 4);
+    write_le(f, 0x001f, 4);
+
+    static const uint8_t padding[3] = {0};
+    for (uint32_t y = 0; y < h; y++) {
+        fwrite(snapshot->data + y * snapshot->header.stride, 1, w * 2, f);
+        fwrite(padding, 1, row_bytes - w * 2, f);
+    }
+    fclose(f);
+    lv_draw_buf_destroy(snapshot);
+    ESP_LOGI(TAG, "Saved frame to %s", path);
+}
+#endif // CONFIG_UI_BENCHMARK_FRAME_DUMP
+
+/**
+ * @brief Time a cold open (header, data and decode) of an image
+ *
+ * @param src Image source
+ * @return Open time in microseconds, or -1 if the image failed to open
+ */
+static int64_t time_image_open(const void *src) {
+    int64_t elapsed = -1;
+    if (lvgl_lock(portMAX_DELAY, __FILE__, __LINE__)) {
+        lv_image_header_cache_drop(src);
+        lv_image_cache_drop(src);
+
+        lv_image_decoder_dsc_t dsc;
+        int64_t start = esp_timer_get_time();
+        if (lv_image_decoder_open(&dsc, src, NULL) == LV_RESULT_OK) {
+            elapsed = esp_timer_get_time() - start;
+            lv_image_decoder_close(&dsc);
+        }
+
+        lv_image_header_cache_drop(src);
+        lv_image_cache_drop(src);
+        lvgl_unlock(__FILE__, __LINE__);
+    }
+    return elapsed;
+}
+
+/**
+ * @brief Compare map image open times from the memory-mapped asset pack and from SPIFFS
+ */
+static void bench_map_open() {
+    for (int level = 0; level < MAP_LEVEL_COUNT; level++) {
+        char path[32];
+        const void *src = map_image_src(level, path, sizeof(path));
+        int64_t mmap_us = src != path ? time_image_open(src) : -1;
+        map_image_path(level, path, sizeof(path));
+        int64_t spiffs_us = time_image_open(path);
+        ESP_LOGI(TAG, "Map level %d open, asset pack: %lld us, SPIFFS: %lld us (-1: not available)", level + 1, mmap_us,
+                 spiffs_us);
+    }
+}
+
+static void ui_bench_task(void *_arg) {
+    (void)_arg;
+
+    // Wait for the main screen, the content pages only exist there
+    while (get_screen() != SCREEN_MAIN) {
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+    vTaskDelay(pdMS_TO_TICKS(UI_BENCH_SETTLE_MS));
+
+    ESP_LOGI(TAG, "Starting UI benchmark playback (%d steps)", (int)(sizeof(script) / sizeof(script[0])));
+    for (int i = 0; i < sizeof(script) / sizeof(script[0]); i++) {
+        const ui_bench_step_t *step = &script[i];
+        const char *label           = content_labels[step->page];
+
+        set_content_page(step->page);
+        vTaskDelay(pdMS_TO_TICKS(UI_BENCH_SETTLE_MS));
+
+        display_render_stats_t before, after;
+        display_get_render_stats(&before);
+        vTaskDelay(pdMS_TO_TICKS(step->dwell_ms));
+        display_get_render_stats(&after);
+
+        uint32_t frames      = after.frames - before.frames;
+        uint64_t frame_us    = after.frame_time_total_us - before.frame_time_total_us;
+        uint64_t flush_bytes = after.flush_bytes - before.flush_bytes;
+        ESP_LOGI(TAG, "%-10s frames: %4lu, fps: %5.1f, avg frame: %6lu us, last frame: %6lu us, flushed: %8llu bytes", label,
+                 frames, frames * 1000.0f / step->dwell_ms, frames ? (uint32_t)(frame_us / frames) : 0,
+                 after.frame_time_last_us, flush_bytes);
+
+#if CONFIG_UI_BENCHMARK_FRAME_DUMP
+        dump_frame(label);
+#endif
+    }
+
+    bench_map_open();
+
+    display_render_stats_t total;
+    display_get_render_stats(&total);
+    ui_status_stats_t status;
+    ui_get_status_stats(&status);
+    ESP_LOGI(TAG, "UI benchmark done, max frame time since boot: %lu us, status bar: %lu updates in %lu renders",
+             total.frame_time_max_us, status.updates, status.renders);
+    ESP_LOGI(TAG, "Frame pacing: %lu late, %lu dropped, %lu idle frames skipped", total.frames_late, total.frames_dropped,
+             total.frames_skipped);
+    content_page_stats_t pages;
+    content_get_page_stats(&pages);
+    ESP_LOGI(TAG, "Page switches: %lu cached, %lu built (%lu bytes), max switch time: %lu us, %lu evictions",
+             pages.hits, pages.misses, pages.built_bytes, pages.switch_time_max_us, pages.evictions);
+    dpad_input_stats_t dpad;
+    dpad_input_get_stats(&dpad);
+    if (dpad.presses > 0) {
+        ESP_LOGI(TAG, "D-pad: %lu presses (%lu dropped), key event last/max: %lu/%lu us, render avg/max: %llu/%lu us",
+                 dpad.presses, dpad.dropped, dpad.deliver_time_last_us, dpad.deliver_time_max_us,
+                 dpad.pixel_samples > 0 ? dpad.pixel_time_total_us / dpad.pixel_samples : 0, dpad.pixel_time_max_us);
+    }
+
+    bench_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t ui_bench_start() {
+    if (bench_task_handle != NULL) {
+        ESP_LOGW(TAG, "UI benchmark already running");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xTaskCreate(ui_bench_task, "ui_bench_task", UI_BENCH_TASK_STACK_SIZE, NULL, UI_BENCH_TASK_PRIORITY,
+                    &bench_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create UI benchmark task");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+
+// Play back the scripted page walk and log per-page render statistics (CONFIG_UI_BENCHMARK)
+esp_err_t ui_bench_start();
+
+#ifdef __cplusplus
+}
+#endif
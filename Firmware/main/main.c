@@ -121,4 +121,9 @@ void app_main(void) {
     } else {
         set_screen(SCREEN_MAIN);
     }
+
+#if CONFIG_UI_BENCHMARK
+    // Walk through the content pages and log render statistics for each
+    ui_bench_start();
+#endif
 }
\ No newline at end of file
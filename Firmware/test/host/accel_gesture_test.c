@@ -0,0 +1,207 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "accel_gesture.h"
+#include "host_test.h"
+
+// Runs the gesture engine over a synthetic trace at 100Hz: walking and a raise to look at the badge, a fast walk with big
+// arm swings, reaching to a desk, double taps, single taps, shakes from 2.8 to 4.6Hz, flips face down and typing-like
+// knocks, 40 rounds of it. Checks every gesture is found every time without false shakes, taps or flips, and reports the
+// cost of the front end and each detector.
+//
+// Wrist raise also fires when a hanging arm is laid on the desk and when the badge is turned face up again, both fair times
+// to wake the screen, so those two are expected on top of the real one.
+
+#define PERIOD_US    10000
+#define RATE_HZ      (1000000 / PERIOD_US)
+#define BLOCK        16
+#define ROUNDS       40
+#define MAX_SAMPLES  (RATE_HZ * 4000)
+#define MATCH_WINDOW 200 // Samples from the start of a gesture to its event
+
+// Budget for all detectors together, in host clock ticks per sample. Generous, it's there to catch a detector that
+// accidentally went quadratic rather than to benchmark.
+#define TICKS_PER_SAMPLE_MAX 1000
+
+// Trace in g, and the gesture starting at each sample plus one
+static float trace[MAX_SAMPLES][3];
+static uint8_t truth[MAX_SAMPLES];
+static uint32_t length;
+static uint32_t expected[ACCEL_GESTURE_COUNT];
+
+static uint32_t rng_state = 1;
+
+static float noise(float scale) {
+    rng_state = rng_state * 1103515245 + 12345;
+    return scale * (((rng_state >> 8) & 0xffff) / 32768.0f - 1.0f);
+}
+
+static void push(float x, float y, float z) {
+    trace[length][0] = x;
+    trace[length][1] = y;
+    trace[length][2] = z;
+    length++;
+}
+
+static void mark(accel_gesture_t gesture) {
+    truth[length] = gesture + 1;
+    expected[gesture]++;
+}
+
+/**
+ * @brief Hold an orientation, with an optional slow wobble on X
+ */
+static void hold(float x, float y, float z, uint32_t samples, float wobble) {
+    for (uint32_t i = 0; i < samples; i++) {
+        push(x + noise(0.01f) + wobble * sinf(length * 0.05f), y + noise(0.01f), z + noise(0.01f));
+    }
+}
+
+/**
+ * @brief Turn smoothly from one orientation to another
+ */
+static void move(float x0, float y0, float z0, float x1, float y1, float z1, uint32_t samples) {
+    for (uint32_t i = 0; i < samples; i++) {
+        float t = (float)i / samples;
+        float s = t * t * (3 - 2 * t);
+        push(x0 + (x1 - x0) * s + noise(0.03f), y0 + (y1 - y0) * s + noise(0.03f), z0 + (z1 - z0) * s + noise(0.03f));
+    }
+}
+
+/**
+ * @brief Walk with the arm hanging, gravity along -X, swinging at 1.8Hz
+ */
+static void walk(uint32_t samples, float swing) {
+    for (uint32_t i = 0; i < samples; i++) {
+        float phase = 2 * (float)M_PI * 1.8f * length / RATE_HZ;
+        push(-0.95f + swing * 0.3f * sinf(2 * phase) + noise(0.05f), swing * sinf(phase) + noise(0.05f),
+             0.2f * sinf(phase) + noise(0.05f));
+    }
+}
+
+static void shake(uint32_t samples, float frequency_hz, float amplitude, float z) {
+    for (uint32_t i = 0; i < samples; i++) {
+        float phase = 2 * (float)M_PI * frequency_hz * i / RATE_HZ;
+        push(amplitude * sinf(phase) + noise(0.1f), noise(0.1f), z + noise(0.1f));
+    }
+}
+
+/**
+ * @brief A knock on Z, a short spike that rings down
+ */
+static void tap(float z, float amplitude) {
+    static const float ring[] = {1.0f, -0.6f, 0.3f};
+    for (size_t i = 0; i < sizeof(ring) / sizeof(ring[0]); i++) {
+        push(noise(0.01f), noise(0.01f), z + amplitude * ring[i]);
+    }
+    push(noise(0.01f), noise(0.01f), z - 0.1f);
+}
+
+static void build_trace(void) {
+    hold(0, 0, 1, 300, 0);
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        // Walk, raise the badge to look at it, hold it there and let it drop again
+        walk(600, 0.6f);
+        mark(ACCEL_GESTURE_WRIST_RAISE);
+        move(-0.95f, 0, 0, -0.3f, 0.1f, 0.9f, 40);
+        hold(-0.3f, 0.1f, 0.9f, 300, 0.02f);
+        move(-0.3f, 0.1f, 0.9f, -0.95f, 0, 0, 40);
+
+        // Distractors: arm swing while walking fast, reaching to a desk
+        walk(400, 1.0f);
+        move(-0.95f, 0, 0, 0, 0, 1, 80);
+        hold(0, 0, 1, 200, 0);
+
+        // Double tap on the desk, then two single taps too far apart to count
+        mark(ACCEL_GESTURE_DOUBLE_TAP);
+        tap(1, 1.5f);
+        hold(0, 0, 1, 20, 0);
+        tap(1, 1.5f);
+        hold(0, 0, 1, 200, 0);
+        tap(1, 1.5f);
+        hold(0, 0, 1, 150, 0);
+        tap(1, 1.2f);
+        hold(0, 0, 1, 200, 0);
+
+        mark(ACCEL_GESTURE_SHAKE);
+        shake(150, 2.8f + (round % 4) * 0.6f, 1.1f + (round % 3) * 0.3f, 1);
+        hold(0, 0, 1, 200, 0);
+
+        // Face down for a while and back
+        mark(ACCEL_GESTURE_FLIP);
+        move(0, 0, 1, 0, 0, -1, 60);
+        hold(0, 0, -1, 300, 0);
+        move(0, 0, -1, 0, 0, 1, 60);
+        hold(0, 0, 1, 200, 0);
+
+        // Typing: small knocks
+        for (int i = 0; i < 20; i++) {
+            tap(1, 0.4f);
+            hold(0, 0, 1, 12, 0);
+        }
+        hold(0, 0, 1, 100, 0);
+    }
+}
+
+static int16_t to_raw(float g) {
+    float raw = g * 16384; // ±2g range
+    return raw > INT16_MAX ? INT16_MAX : raw < INT16_MIN ? INT16_MIN : (int16_t)raw;
+}
+
+int main(void) {
+    build_trace();
+
+    accel_gesture_engine_t engine;
+    accel_gesture_init(&engine, PERIOD_US, host_test_cycles);
+
+    uint32_t detected[ACCEL_GESTURE_COUNT] = {0};
+    uint32_t hits[ACCEL_GESTURE_COUNT]     = {0};
+    int pending                            = -1; // Gesture started last and not matched yet
+    uint32_t pending_at                    = 0;
+    accel_block_t block                    = {.sample_period_us = PERIOD_US, .range = RANGE_2G, .count = BLOCK};
+
+    for (uint32_t start = 0; start + BLOCK <= length; start += BLOCK) {
+        block.timestamp_us = (int64_t)start * PERIOD_US;
+        for (uint32_t i = 0; i < BLOCK; i++) {
+            block.samples[i].x.value = to_raw(trace[start + i][0]);
+            block.samples[i].y.value = to_raw(trace[start + i][1]);
+            block.samples[i].z.value = to_raw(trace[start + i][2]);
+            if (truth[start + i]) {
+                pending    = truth[start + i] - 1;
+                pending_at = start + i;
+            }
+        }
+
+        accel_gesture_event_t events[8];
+        size_t count = accel_gesture_process(&engine, &block, events, 8);
+        for (size_t i = 0; i < count; i++) {
+            uint32_t at = events[i].timestamp_us / PERIOD_US;
+            detected[events[i].gesture]++;
+            if ((int)events[i].gesture == pending && at - pending_at < MATCH_WINDOW) {
+                hits[events[i].gesture]++;
+                pending = -1;
+            }
+        }
+    }
+
+    uint64_t cycles = engine.stats.front_end_cycles;
+    printf("%" PRIu32 " samples, front end %.1f ticks/sample\n", engine.stats.samples,
+           (double)engine.stats.front_end_cycles / engine.stats.samples);
+    for (int g = 0; g < ACCEL_GESTURE_COUNT; g++) {
+        printf("%-12s %2" PRIu32 "/%2" PRIu32 " found, %2" PRIu32 " false, %5.1f ticks/sample\n", accel_gesture_name(g),
+               hits[g], expected[g], detected[g] - hits[g], (double)engine.stats.detector_cycles[g] / engine.stats.samples);
+        cycles += engine.stats.detector_cycles[g];
+        CHECK_EQ(hits[g], ROUNDS);
+        CHECK_EQ(engine.stats.detections[g], detected[g]);
+    }
+    printf("all detectors %.1f ticks/sample\n", (double)cycles / engine.stats.samples);
+
+    // The desk and turning face up again are the two raises per round on top of the real one
+    CHECK_EQ(detected[ACCEL_GESTURE_WRIST_RAISE], 3 * ROUNDS);
+    CHECK_EQ(detected[ACCEL_GESTURE_SHAKE], ROUNDS);
+    CHECK_EQ(detected[ACCEL_GESTURE_DOUBLE_TAP], ROUNDS);
+    CHECK_EQ(detected[ACCEL_GESTURE_FLIP], ROUNDS);
+    CHECK_EQ(engine.stats.samples, length / BLOCK * BLOCK);
+    CHECK(cycles / engine.stats.samples < TICKS_PER_SAMPLE_MAX);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,152 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "accel_steps.h"
+#include "host_test.h"
+
+// Runs the step counter over synthetic traces at 100Hz: two minute walks from a slow stroll to a brisk pace and a crowd
+// shuffle, each followed by standing still, then five minutes each of sitting at a desk, fidgeting and typing, and waving
+// the arms about. Checks walks are counted to within 2% and the desk and fidget traces count nothing, and reports the cost.
+//
+// The waving trace swings the arm on a steady ~1.5s beat, which is as regular as a slow walk and does get counted in part.
+// It's reported rather than checked.
+
+#define PERIOD_US 10000
+#define RATE_HZ   (1000000 / PERIOD_US)
+#define BLOCK     16
+
+// Budget in host clock ticks per sample, to catch the counter blowing up rather than to benchmark
+#define TICKS_PER_SAMPLE_MAX 500
+
+static accel_steps_t counter;
+static accel_block_t block = {.sample_period_us = PERIOD_US, .range = RANGE_2G};
+static uint64_t cycles;
+static uint32_t counted;
+
+static uint32_t rng_state = 7;
+
+static float noise(float scale) {
+    rng_state = rng_state * 1103515245 + 12345;
+    return scale * (((rng_state >> 8) & 0xffff) / 32768.0f - 1.0f);
+}
+
+static int16_t to_raw(float g) {
+    float raw = g * 16384; // ±2g range
+    return raw > INT16_MAX ? INT16_MAX : raw < INT16_MIN ? INT16_MIN : (int16_t)raw;
+}
+
+/**
+ * @brief Add a sample in g, and run the counter once a block is full
+ */
+static void push(float x, float y, float z) {
+    block.samples[block.count].x.value = to_raw(x);
+    block.samples[block.count].y.value = to_raw(y);
+    block.samples[block.count].z.value = to_raw(z);
+    if (++block.count == BLOCK) {
+        uint32_t start  = host_test_cycles();
+        counted        += accel_steps_process(&counter, &block);
+        cycles         += (uint32_t)(host_test_cycles() - start);
+        block.count     = 0;
+    }
+}
+
+/**
+ * @brief Walk with the badge on a hanging arm that swings at half the step rate
+ *
+ * @param seconds Length of the walk
+ * @param step_hz Steps per second, each step jitters by 5%
+ * @param bounce Vertical bounce per step in g
+ * @param swing Arm swing in radians
+ * @return Steps taken
+ */
+static uint32_t walk(float seconds, float step_hz, float bounce, float swing) {
+    float phase = 0;
+    for (int i = 0; i < seconds * RATE_HZ; i++) {
+        phase          += 2 * (float)M_PI * step_hz / RATE_HZ * (1 + noise(0.05f));
+        float arm       = swing * sinf(phase / 2);
+        float vertical  = bounce * sinf(phase) + noise(0.03f);
+        push(-0.9f * cosf(arm) + vertical * 0.8f, 0.9f * sinf(arm) + noise(0.05f),
+             0.3f + vertical * 0.5f + swing * 0.2f * sinf(phase));
+    }
+    return (uint32_t)(phase / (2 * (float)M_PI));
+}
+
+static void still(float seconds, float z) {
+    for (int i = 0; i < seconds * RATE_HZ; i++) {
+        push(noise(0.01f), noise(0.01f), z + noise(0.01f));
+    }
+}
+
+/**
+ * @brief Slow arm moves at a desk with typing knocks every 230ms
+ */
+static void fidget(float seconds) {
+    for (int i = 0; i < seconds * RATE_HZ; i++) {
+        float t = (float)i / RATE_HZ;
+        push(0.3f * sinf(t * 0.7f) + noise(0.05f), 0.2f * sinf(t * 1.3f) + noise(0.05f),
+             0.9f + (i % 23 == 0 ? 0.4f : 0) + noise(0.05f));
+    }
+}
+
+/**
+ * @brief Big arm moves, reaching and waving
+ */
+static void wave(float seconds) {
+    for (int i = 0; i < seconds * RATE_HZ; i++) {
+        float t        = (float)i / RATE_HZ;
+        float envelope = sinf(t * 2.1f) * sinf(t * 0.37f);
+        push(0.8f * envelope + noise(0.1f), 0.6f * sinf(t * 3.3f + 1) * envelope,
+             0.7f + 0.5f * envelope * envelope + noise(0.1f));
+    }
+}
+
+int main(void) {
+    static const struct {
+        const char *name;
+        float step_hz;
+        float bounce;
+        float swing;
+    } walks[] = {
+        {"slow", 1.4f, 0.12f, 0.3f},
+        {"normal", 1.8f, 0.2f, 0.5f},
+        {"brisk", 2.2f, 0.3f, 0.7f},
+        {"crowd shuffle", 1.5f, 0.08f, 0.1f},
+    };
+
+    accel_steps_init(&counter, PERIOD_US);
+
+    for (size_t i = 0; i < sizeof(walks) / sizeof(walks[0]); i++) {
+        uint32_t before = counted;
+        uint32_t steps  = walk(120, walks[i].step_hz, walks[i].bounce, walks[i].swing);
+        uint32_t seen   = counted - before;
+        double error    = 100.0 * ((double)seen - steps) / steps;
+        printf("%-14s %4" PRIu32 " steps, %4" PRIu32 " counted (%+.1f%%)\n", walks[i].name, steps, seen, error);
+        CHECK(fabs(error) <= 2.0);
+
+        // The rhythm is held back until it's confirmed, standing still afterwards mustn't add any more
+        before = counted;
+        still(20, 1);
+        CHECK_EQ(counted, before);
+    }
+
+    uint32_t before = counted;
+    still(300, 1);
+    printf("%-14s %4" PRIu32 " counted\n", "desk", counted - before);
+    CHECK_EQ(counted, before);
+
+    before = counted;
+    fidget(300);
+    printf("%-14s %4" PRIu32 " counted\n", "fidget", counted - before);
+    CHECK_EQ(counted, before);
+
+    before = counted;
+    wave(300);
+    printf("%-14s %4" PRIu32 " counted\n", "waving", counted - before);
+
+    printf("%.1f ticks/sample, %" PRIu32 " peaks rejected, active %" PRIu32 "s of %" PRIu32 "s\n",
+           (double)cycles / counter.stats.samples, counter.stats.rejected, counter.stats.active_samples / RATE_HZ,
+           counter.stats.samples / RATE_HZ);
+    CHECK_EQ(counter.stats.steps, counted);
+    CHECK(cycles / counter.stats.samples < TICKS_PER_SAMPLE_MAX);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,138 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "accel_stream.h"
+#include "host_test.h"
+
+// Checks the sample block ring and the timeline on their own: readers falling behind, a reader racing the producer, and
+// how closely block timestamps follow a sample clock that drifts while the reads that place them jitter.
+
+#define PERIOD_US 10000
+#define BLOCK     16
+
+static void publish(accel_ring_t *ring, uint32_t first) {
+    accel_block_t *block = accel_ring_claim(ring);
+    block->count         = BLOCK;
+    for (int i = 0; i < BLOCK; i++) {
+        block->samples[i].x.value = first + i;
+    }
+    accel_ring_commit(ring);
+}
+
+static void check_ring(void) {
+    static accel_ring_t ring;
+    accel_reader_t reader;
+    accel_block_t block;
+
+    CHECK(!accel_ring_latest(&ring, &block));
+    accel_ring_reader_init(&ring, &reader);
+    CHECK(!accel_ring_read(&ring, &reader, &block));
+
+    // In order, one at a time
+    for (uint32_t i = 0; i < 3; i++) {
+        publish(&ring, i * BLOCK);
+        CHECK(accel_ring_read(&ring, &reader, &block));
+        CHECK_EQ(block.sequence, i);
+        CHECK_EQ(block.samples[0].x.value, i * BLOCK);
+    }
+    CHECK(!accel_ring_read(&ring, &reader, &block));
+    CHECK_EQ(reader.dropped, 0);
+
+    // A reader that falls more than a ring behind loses the oldest blocks and picks up with the oldest one left
+    for (uint32_t i = 3; i < 3 + ACCEL_RING_SIZE + 5; i++) {
+        publish(&ring, i * BLOCK);
+    }
+    CHECK(accel_ring_read(&ring, &reader, &block));
+    CHECK_EQ(reader.dropped, 5);
+    CHECK_EQ(block.sequence, 3 + 5);
+    uint32_t read = 1;
+    while (accel_ring_read(&ring, &reader, &block)) {
+        read++;
+    }
+    CHECK_EQ(read, ACCEL_RING_SIZE);
+    CHECK_EQ(block.sequence, 3 + ACCEL_RING_SIZE + 5 - 1);
+
+    // The newest block doesn't depend on any reader
+    CHECK(accel_ring_latest(&ring, &block));
+    CHECK_EQ(block.sequence, 3 + ACCEL_RING_SIZE + 5 - 1);
+
+    // A block the producer started overwriting while it was being copied counts as dropped, not as data
+    accel_reader_t slow = {.next = atomic_load(&ring.head) - ACCEL_RING_SIZE};
+    accel_ring_claim(&ring);
+    CHECK(accel_ring_read(&ring, &slow, &block));
+    CHECK_EQ(slow.dropped, 1);
+    CHECK_EQ(block.sequence, atomic_load(&ring.head) - ACCEL_RING_SIZE + 1);
+    accel_ring_commit(&ring);
+}
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1103515245 + 12345;
+    return rng_state >> 8;
+}
+
+/**
+ * @brief Feed the timeline with watermark reads of a sample clock that runs off nominal, each read landing up to jitter_us
+ *     late, and return the worst timestamp error once it has settled
+ *
+ * @param drift_ppm How fast the sample clock runs compared to nominal
+ * @param jitter_us Longest delay between the watermark and the read
+ * @param[out] period_us Sample period the timeline learned
+ */
+static int64_t timeline_error(int32_t drift_ppm, uint32_t jitter_us, uint32_t *period_us) {
+    accel_timeline_t timeline = {.period_us = PERIOD_US};
+    double true_period        = PERIOD_US / (1 + drift_ppm / 1e6);
+    double start              = 1000000;
+    int64_t worst             = 0;
+
+    for (uint32_t n = 0; n < 600; n++) {
+        // The watermark interrupt comes with the block's last sample, the read some time after it
+        double first      = start + (double)n * BLOCK * true_period;
+        double newest     = first + (BLOCK - 1) * true_period;
+        int64_t read_us   = (int64_t)newest + (jitter_us ? rng() % jitter_us : 0);
+        int64_t placed_us = accel_timeline_place(&timeline, read_us, BLOCK, 0, false);
+        int64_t error     = llabs(placed_us - (int64_t)first);
+        if (n >= 60 && error > worst) {
+            worst = error;
+        }
+    }
+    *period_us = (timeline.period_q8 + 128) >> 8;
+    CHECK_EQ(timeline.resyncs, 0);
+    return worst;
+}
+
+static void check_timeline(void) {
+    static const struct {
+        int32_t drift_ppm;
+        uint32_t jitter_us;
+    } cases[] = {{0, 0}, {0, 3000}, {20000, 0}, {20000, 3000}, {-20000, 3000}};
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint32_t period_us;
+        int64_t error = timeline_error(cases[i].drift_ppm, cases[i].jitter_us, &period_us);
+        printf("drift %+3d%%  jitter %4" PRIu32 " us: worst error %5lld us, learned period %" PRIu32 " us\n",
+               (int)(cases[i].drift_ppm / 10000), cases[i].jitter_us, (long long)error, period_us);
+        CHECK(error < 3000);
+        uint32_t expected = (uint32_t)(PERIOD_US / (1 + cases[i].drift_ppm / 1e6) + 0.5);
+        CHECK(period_us + 20 >= expected && period_us <= expected + 20);
+    }
+
+    // Lost samples jump the timeline to the new estimate instead of drifting over to it
+    accel_timeline_t timeline = {.period_us = PERIOD_US};
+    accel_timeline_place(&timeline, 1000000, BLOCK, 0, false);
+    accel_timeline_place(&timeline, 1000000 + BLOCK * PERIOD_US, BLOCK, 0, false);
+    int64_t first = accel_timeline_place(&timeline, 1000000 + 5 * BLOCK * PERIOD_US, BLOCK, 0, true);
+    CHECK_EQ(timeline.resyncs, 1);
+    CHECK_EQ(first, 1000000 + 4 * BLOCK * PERIOD_US + PERIOD_US);
+
+    // Samples left behind in the FIFO move the block back by as many periods
+    timeline = (accel_timeline_t){.period_us = PERIOD_US};
+    CHECK_EQ(accel_timeline_place(&timeline, 1000000, BLOCK, 4, false), 1000000 - (BLOCK + 4 - 1) * PERIOD_US);
+}
+
+int main(void) {
+    check_ring();
+    check_timeline();
+    return HOST_TEST_RESULT();
+}
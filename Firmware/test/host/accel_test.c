@@ -0,0 +1,261 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "accel.h"
+#include "esp_timer.h"
+#include "host_test.h"
+#include "i2c_manager.h"
+#include "mock.h"
+#include "sdkconfig.h"
+
+// Runs the accelerometer sample stream against a simulated MC3419 whose FIFO fills off its own oscillator, 2% fast, and whose
+// watermark interrupt reaches the stream task up to 3ms late. Counts the bus transfers per second with the watermark
+// interrupt and with the shared switch interrupt held low by another line, checks no sample is lost or repeated, and
+// measures how far block timestamps are from when the samples were really taken.
+
+#define PERIOD_US      10000
+#define DRIFT_PPM      20000
+#define JITTER_US      3000
+#define FIFO_SIZE      32
+#define PHASE_US       10000000
+#define SETTLE_US      2000000
+#define SAMPLE_HISTORY 4096
+
+#define SWITCH_LINE_ACCEL_FIFO 0x01 // INTN2 of the MC3419 on INT0
+#define SWITCH_LINE_USB        0x02 // USB on INT1
+
+// Simulated MC3419: the FIFO holds sample sequence numbers, samples carry theirs in X and Y
+static mock_i2c_device_t mc3419;
+static uint32_t fifo[FIFO_SIZE];
+static uint32_t fifo_rd, fifo_wr; // Pointers with the wrap bit, like FIFO_RD_P and FIFO_WR_P
+static uint32_t next_sequence;
+static double next_sample_us = -1;
+static int64_t sample_times_us[SAMPLE_HISTORY];
+static uint32_t samples_dropped; // Samples that found the FIFO full
+
+// Switch interrupt lines and the ISR delivery still to come
+static uint8_t lines_held;
+static int64_t isr_at_us = -1;
+static uint32_t rng_state = 1;
+
+// What the subscriber saw
+static struct {
+    bool measuring;
+    uint32_t blocks;
+    uint32_t next_sequence;
+    uint32_t gaps;       // Sample sequence jumps in blocks not marked as a discontinuity
+    uint32_t duplicates; // Samples seen twice
+    int64_t worst_error_us;
+} seen;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1103515245 + 12345;
+    return rng_state >> 8;
+}
+
+static uint32_t fifo_level(void) {
+    return (fifo_wr - fifo_rd) & 0x3F;
+}
+
+static bool fifo_enabled(void) {
+    mc3419_fifo_ctrl_t ctrl = {.raw = mc3419.regs[MC3419_REG_FIFO_CTRL]};
+    mc3419_mode_t mode      = {.raw = mc3419.regs[MC3419_REG_MODE]};
+    return ctrl.fifo_en && mode.state == MODE_WAKE;
+}
+
+/**
+ * @brief Update the switch interrupt lines, and start an interrupt on the switch output going from released to asserted
+ */
+static void update_lines(int64_t now_us) {
+    static uint8_t active;
+    mc3419_fifo_ctrl_t ctrl = {.raw = mc3419.regs[MC3419_REG_FIFO_CTRL]};
+    uint8_t lines           = lines_held;
+    if (ctrl.fifo_th_int_en && fifo_level() >= mc3419.regs[MC3419_REG_FIFO_TH]) {
+        lines |= SWITCH_LINE_ACCEL_FIFO;
+    }
+    mock_i2c_set_switch_interrupts(lines);
+    if (active == 0 && lines != 0) {
+        isr_at_us = now_us + rng() % JITTER_US;
+    }
+    active = lines;
+}
+
+static bool mc3419_read(mock_i2c_device_t *device, uint8_t reg, uint8_t *data, size_t size) {
+    if (reg == MC3419_REG_FIFO_RD_P && size == 2) {
+        data[0] = fifo_rd & 0x3F;
+        data[1] = fifo_wr & 0x3F;
+        return true;
+    }
+    if (reg != MC3419_REG_XOUT_EX_L || !fifo_enabled()) {
+        return false;
+    }
+
+    // Reading the output registers pops the FIFO a sample at a time, an empty FIFO gives the last sample again
+    for (size_t i = 0; i + sizeof(mc3419_accel_data_t) <= size; i += sizeof(mc3419_accel_data_t)) {
+        uint32_t sequence = fifo[(fifo_rd - 1) % FIFO_SIZE];
+        if (fifo_level() > 0) {
+            sequence = fifo[fifo_rd % FIFO_SIZE];
+            fifo_rd  = (fifo_rd + 1) & 0x3F;
+        }
+        mc3419_accel_data_t sample = {
+            .x.value = (int16_t)(sequence & 0x7FFF),
+            .y.value = (int16_t)(sequence >> 15),
+            .z.value = 16384,
+        };
+        memcpy(data + i, &sample, sizeof(sample));
+    }
+    update_lines(esp_timer_get_time());
+    return true;
+}
+
+static bool mc3419_write(mock_i2c_device_t *device, uint8_t reg, const uint8_t *data, size_t size) {
+    mc3419_fifo_ctrl_t ctrl = {.raw = size > 0 ? data[0] : 0};
+    if (reg == MC3419_REG_FIFO_CTRL && ctrl.fifo_reset) {
+        fifo_rd = fifo_wr = 0;
+    }
+    return false;
+}
+
+/**
+ * @brief Take samples on the MC3419 clock and deliver the switch interrupt once its latency is up
+ */
+static void mc3419_ticker(int64_t now_us, void *arg) {
+    if (!fifo_enabled()) {
+        next_sample_us = -1;
+        return;
+    }
+    if (next_sample_us < 0) {
+        next_sample_us = now_us;
+    }
+    while (now_us >= next_sample_us) {
+        sample_times_us[next_sequence % SAMPLE_HISTORY] = (int64_t)next_sample_us;
+        if (fifo_level() < FIFO_SIZE) {
+            fifo[fifo_wr % FIFO_SIZE] = next_sequence;
+            fifo_wr                   = (fifo_wr + 1) & 0x3F;
+        } else {
+            samples_dropped++;
+        }
+        next_sequence++;
+        next_sample_us += PERIOD_US / (1 + DRIFT_PPM / 1e6);
+    }
+    update_lines(now_us);
+
+    if (isr_at_us >= 0 && now_us >= isr_at_us) {
+        isr_at_us = -1;
+        mock_gpio_interrupt(CONFIG_I2C_SWITCH_INT_GPIO);
+    }
+}
+
+static void subscriber_task(void *arg) {
+    accel_reader_t reader;
+    accel_block_t block;
+    CHECK_EQ(accel_stream_subscribe(&reader, xTaskGetCurrentTaskHandle()), ESP_OK);
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (accel_stream_read(&reader, &block)) {
+            CHECK_EQ(block.count, 16);
+            for (uint8_t i = 0; i < block.count; i++) {
+                uint32_t sequence = (uint16_t)block.samples[i].x.value | (uint32_t)block.samples[i].y.value << 15;
+                if (seen.blocks > 0 && sequence < seen.next_sequence) {
+                    seen.duplicates++;
+                } else if (seen.blocks > 0 && sequence != seen.next_sequence && !(i == 0 && block.discontinuity)) {
+                    seen.gaps++;
+                }
+                seen.next_sequence = sequence + 1;
+            }
+
+            uint32_t first = (uint16_t)block.samples[0].x.value | (uint32_t)block.samples[0].y.value << 15;
+            int64_t error  = llabs(block.timestamp_us - sample_times_us[first % SAMPLE_HISTORY]);
+            if (seen.measuring && error > seen.worst_error_us) {
+                seen.worst_error_us = error;
+            }
+            seen.blocks++;
+        }
+    }
+}
+
+/**
+ * @brief Run the stream for a phase and report what it cost
+ *
+ * @param name Printed with the results
+ * @param[out] stats Stream counters over the phase
+ * @return Bus transactions per second, the switch included
+ */
+static double run_phase(const char *name, accel_stream_stats_t *stats) {
+    accel_stream_stats_t before;
+    seen.measuring = false;
+    mock_run(SETTLE_US);
+
+    accel_stream_get_stats(&before);
+    uint32_t transactions = mock_i2c_stats.transactions;
+    uint32_t switch_reads = mock_i2c_stats.switch_transactions;
+    seen.measuring        = true;
+    seen.worst_error_us   = 0;
+    mock_run(PHASE_US);
+
+    accel_stream_get_stats(stats);
+    stats->blocks            -= before.blocks;
+    stats->transfers         -= before.transfers;
+    stats->wakeups_interrupt -= before.wakeups_interrupt;
+    stats->wakeups_timeout   -= before.wakeups_timeout;
+    stats->overflows         -= before.overflows;
+    stats->errors            -= before.errors;
+    transactions              = mock_i2c_stats.transactions - transactions;
+    switch_reads              = mock_i2c_stats.switch_transactions - switch_reads;
+
+    double seconds = PHASE_US / 1e6;
+    printf("%-9s %5.1f blocks/s, %5.1f accel transfers/s + %4.1f switch reads/s, %" PRIu32 " overflows, "
+           "worst timestamp error %lld us\n",
+           name, stats->blocks / seconds, stats->transfers / seconds, switch_reads / seconds, stats->overflows,
+           (long long)seen.worst_error_us);
+    return transactions / seconds;
+}
+
+int main(void) {
+    mc3419 = (mock_i2c_device_t){
+        .port    = I2C_BUS_OTHER,
+        .channel = 2,
+        .address = MC3419_I2C_ADDR,
+        .present = true,
+        .read    = mc3419_read,
+        .write   = mc3419_write,
+    };
+    mock_i2c_attach(&mc3419);
+    mock_time_add_ticker(mc3419_ticker, NULL);
+
+    CHECK_EQ(i2c_manager_init_auto(), ESP_OK);
+    CHECK_EQ(accel_init(), ESP_OK);
+    CHECK(fifo_enabled());
+    CHECK(xTaskCreate(subscriber_task, "subscriber", 4096, NULL, 3, NULL) == pdPASS);
+
+    // The watermark interrupt wakes the stream once per 16 samples, each wakeup is a switch read and one burst
+    accel_stream_stats_t stats;
+    double rate = run_phase("interrupt", &stats);
+    CHECK_EQ(stats.wakeups_timeout, 0);
+    CHECK(stats.transfers == stats.blocks && stats.blocks >= 62 && stats.blocks <= 65);
+    CHECK(rate < 14);
+    CHECK_EQ(stats.overflows, 0);
+    CHECK(seen.worst_error_us < JITTER_US + 500); // The simulated clock steps add a little on top of the jitter
+
+    // With USB holding the shared interrupt low there's no edge for the FIFO, the stream polls without letting it fill up
+    lines_held = SWITCH_LINE_USB;
+    rate       = run_phase("polling", &stats);
+    CHECK_EQ(stats.wakeups_interrupt, 0);
+    CHECK(stats.blocks >= 62 && stats.blocks <= 65);
+    CHECK_EQ(stats.transfers, stats.blocks + stats.wakeups_timeout);
+    CHECK(rate < 14);
+    CHECK_EQ(stats.overflows, 0);
+    CHECK(seen.worst_error_us < PERIOD_US);
+
+    // And back to the interrupt once the line is released
+    lines_held = 0;
+    run_phase("interrupt", &stats);
+    CHECK_EQ(stats.wakeups_timeout, 0);
+    CHECK_EQ(stats.overflows, 0);
+
+    CHECK_EQ(samples_dropped, 0);
+    CHECK_EQ(seen.gaps, 0);
+    CHECK_EQ(seen.duplicates, 0);
+    CHECK_EQ(stats.errors, 0);
+    return HOST_TEST_RESULT();
+}
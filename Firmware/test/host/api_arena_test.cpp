@@ -0,0 +1,312 @@
+#include <csignal>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "api_arena.h"
+#include "esp_heap_caps.h"
+#include "host_test.h"
+#include "types.h"
+
+// Checks the API result arenas: allocations that don't fit chain on overflow blocks, everything handed out is aligned
+// and zeroed, pointers that aren't arena roots are caught, and a free costs one heap call per block however much was
+// allocated. Then counts the heap calls for a big tower list and a battle status with many saviors against the layout
+// before arenas, where every struct, array and string was a malloc of its own.
+
+#define TOWER_COUNT     40
+#define TOWER_JSON_SIZE 320 // Roughly what one tower takes up in the all_tower_status body
+#define SAVIOR_COUNT    32
+#define STATUS_JSON     512 // Battle status body without the savior handles
+
+// The heap both layouts allocate from, counted
+static struct {
+    int allocs;
+    int frees;
+    int live;     // Blocks allocated and not yet freed
+    size_t bytes; // Bytes asked for
+} heap;
+
+static void *counted_malloc(size_t size) {
+    heap.allocs++;
+    heap.live++;
+    heap.bytes += size;
+    return malloc(size);
+}
+
+static void counted_free(void *ptr) {
+    if (ptr != nullptr) {
+        heap.frees++;
+        heap.live--;
+    }
+    free(ptr);
+}
+
+static char *counted_strdup(const char *str) {
+    char *copy = static_cast<char *>(counted_malloc(strlen(str) + 1));
+    strcpy(copy, str);
+    return copy;
+}
+
+extern "C" void *heap_caps_malloc_prefer(size_t size, size_t num, ...) {
+    return counted_malloc(size);
+}
+
+extern "C" void heap_caps_free(void *ptr) {
+    counted_free(ptr);
+}
+
+static bool aligned(const void *ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t) == 0;
+}
+
+static bool zeroed(const void *ptr, size_t size) {
+    auto bytes = static_cast<const uint8_t *>(ptr);
+    for (size_t i = 0; i < size; i++) {
+        if (bytes[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void check_overflow_chain() {
+    heap = {};
+
+    // The head block has the root plus 64 bytes to spare
+    void *root = api_arena_create(16, 64);
+    CHECK(root != nullptr);
+    CHECK_EQ(heap.allocs, 1);
+
+    CHECK(api_arena_alloc(root, 48) != nullptr);
+    CHECK_EQ(heap.allocs, 1);
+
+    // Too big for what's left in the head block, so an overflow block is chained on
+    CHECK(api_arena_alloc(root, 100) != nullptr);
+    CHECK_EQ(heap.allocs, 2);
+
+    // Small enough for the rest of the head block, then for the rest of the overflow block
+    CHECK(api_arena_alloc(root, 8) != nullptr);
+    CHECK(api_arena_alloc(root, 100) != nullptr);
+    CHECK_EQ(heap.allocs, 2);
+
+    // Bigger than the minimum block size gets a block of its own size
+    void *big = api_arena_alloc(root, 1000);
+    CHECK(big != nullptr);
+    CHECK(zeroed(big, 1000));
+    CHECK_EQ(heap.allocs, 3);
+
+    api_arena_free(root);
+    CHECK_EQ(heap.frees, 3);
+    CHECK_EQ(heap.live, 0);
+}
+
+static void check_alignment_and_zeroing() {
+    heap = {};
+
+    // Leave garbage behind in freed memory for the next arena to be handed
+    for (int i = 0; i < 8; i++) {
+        void *junk = counted_malloc(512);
+        memset(junk, 0xa5, 512);
+        counted_free(junk);
+    }
+
+    void *root = api_arena_create(3, 16);
+    CHECK(aligned(root));
+    CHECK(zeroed(root, 3));
+    uint8_t *previous    = static_cast<uint8_t *>(root);
+    size_t previous_size = 3;
+    memset(root, 0xff, 3);
+    for (size_t size = 1; size <= 65; size += 4) {
+        auto ptr = static_cast<uint8_t *>(api_arena_alloc(root, size));
+        CHECK(ptr != nullptr);
+        CHECK(aligned(ptr));
+        CHECK(zeroed(ptr, size));
+        // Nothing written to the previous allocation spills over into this one
+        CHECK(ptr >= previous + previous_size || ptr + size <= previous);
+        memset(ptr, 0xff, size);
+        previous      = ptr;
+        previous_size = size;
+    }
+    api_arena_free(root);
+    CHECK_EQ(heap.live, 0);
+
+    // Arrays and strings come out the same
+    auto *status = api_arena_new<api_battle_status_t>(0);
+    CHECK(zeroed(status, sizeof(*status)));
+    auto handles = api_arena_array<char *>(status, 3);
+    CHECK(aligned(handles));
+    CHECK(zeroed(handles, 3 * sizeof(char *)));
+    char *handle = api_arena_strdup(status, "savior");
+    CHECK(strcmp(handle, "savior") == 0);
+    api_arena_free(status);
+    CHECK_EQ(heap.live, 0);
+}
+
+static void check_foreign_pointer() {
+    // A pointer that isn't an arena root is caught by the head block magic before anything is freed
+    pid_t child = fork();
+    if (child == 0) {
+        alignas(std::max_align_t) static uint8_t not_an_arena[256] = {0};
+        freopen("/dev/null", "w", stderr); // The assert message is expected
+        api_arena_free(not_an_arena + 128);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT);
+}
+
+static void check_free_cost() {
+    heap = {};
+
+    // However many strings are in it, an arena that fits in its head block is one free
+    void *root = api_arena_create(16, 1000 * 16);
+    for (int i = 0; i < 1000; i++) {
+        CHECK(api_arena_strdup(root, "tower") != nullptr);
+    }
+    CHECK_EQ(heap.allocs, 1);
+    api_arena_free(root);
+    CHECK_EQ(heap.frees, 1);
+
+    // Overflowing costs a free per block, not per allocation
+    heap = {};
+    root = api_arena_create(16, 0);
+    for (int i = 0; i < 1000; i++) {
+        CHECK(api_arena_strdup(root, "tower") != nullptr);
+    }
+    int blocks = heap.allocs;
+    CHECK(blocks < 1000 / 8);
+    api_arena_free(root);
+    CHECK_EQ(heap.frees, blocks);
+    CHECK_EQ(heap.live, 0);
+}
+
+/**
+ * @brief Build the tower list the way api_get_all_tower_status did before arenas
+ */
+static api_result_t *towers_per_field(int count) {
+    auto result    = static_cast<api_result_t *>(counted_malloc(sizeof(api_result_t)));
+    auto towers    = static_cast<api_all_tower_info_t *>(counted_malloc(sizeof(api_all_tower_info_t)));
+    *result        = {};
+    *towers        = {};
+    result->data   = towers;
+    towers->count  = count;
+    towers->towers = static_cast<api_tower_info_t *>(counted_malloc(sizeof(api_tower_info_t) * count));
+    for (int i = 0; i < count; i++) {
+        towers->towers[i]           = {};
+        towers->towers[i].name      = counted_strdup("Tower of Unreasonable Length");
+        towers->towers[i].location  = counted_strdup("Expo Hall, next to the vending machine");
+        towers->towers[i].boot_time = counted_strdup("2026-10-17T09:00:00Z");
+    }
+    return result;
+}
+
+static void free_towers_per_field(api_result_t *result) {
+    auto towers = static_cast<api_all_tower_info_t *>(result->data);
+    for (int i = 0; i < towers->count; i++) {
+        counted_free(towers->towers[i].name);
+        counted_free(towers->towers[i].location);
+        counted_free(towers->towers[i].boot_time);
+    }
+    counted_free(towers->towers);
+    counted_free(towers);
+    counted_free(result);
+}
+
+/**
+ * @brief Build the tower list the way api_get_all_tower_status does now, with the arena sized from the body
+ */
+static api_result_t *towers_arena(int count) {
+    size_t body_size = (size_t)count * TOWER_JSON_SIZE;
+    auto result      = api_arena_new<api_result_t>(0);
+    auto towers      = api_arena_new<api_all_tower_info_t>(body_size + sizeof(api_tower_info_t) * count);
+    result->data     = towers;
+    towers->count    = count;
+    towers->towers   = api_arena_array<api_tower_info_t>(towers, count);
+    for (int i = 0; i < count; i++) {
+        towers->towers[i].name      = api_arena_strdup(towers, "Tower of Unreasonable Length");
+        towers->towers[i].location  = api_arena_strdup(towers, "Expo Hall, next to the vending machine");
+        towers->towers[i].boot_time = api_arena_strdup(towers, "2026-10-17T09:00:00Z");
+    }
+    return result;
+}
+
+static api_result_t *battle_status_per_field(int saviors) {
+    auto result                 = static_cast<api_result_t *>(counted_malloc(sizeof(api_result_t)));
+    auto status                 = static_cast<api_battle_status_t *>(counted_malloc(sizeof(api_battle_status_t)));
+    *result                     = {};
+    *status                     = {};
+    result->data                = status;
+    status->savior_handle_count = saviors;
+    status->savior_handle       = static_cast<char **>(counted_malloc(sizeof(char *) * saviors));
+    for (int i = 0; i < saviors; i++) {
+        status->savior_handle[i] = counted_strdup("a_savior_handle");
+    }
+    return result;
+}
+
+static void free_battle_status_per_field(api_result_t *result) {
+    auto status = static_cast<api_battle_status_t *>(result->data);
+    for (int i = 0; i < status->savior_handle_count; i++) {
+        counted_free(status->savior_handle[i]);
+    }
+    counted_free(status->savior_handle);
+    counted_free(status);
+    counted_free(result);
+}
+
+static api_result_t *battle_status_arena(int saviors) {
+    size_t body_size            = STATUS_JSON + (size_t)saviors * sizeof("\"a_savior_handle\",");
+    auto result                 = api_arena_new<api_result_t>(0);
+    auto status                 = api_arena_new<api_battle_status_t>(body_size);
+    result->data                = status;
+    status->savior_handle_count = saviors;
+    status->savior_handle       = api_arena_array<char *>(status, saviors);
+    for (int i = 0; i < saviors; i++) {
+        status->savior_handle[i] = api_arena_strdup(status, "a_savior_handle");
+    }
+    return result;
+}
+
+static void free_arena_result(api_result_t *result) {
+    api_arena_free(result->data);
+    api_arena_free(result);
+}
+
+/**
+ * @brief Print and return the heap calls it takes to build and free a result
+ *
+ * @return Heap blocks the result was made of
+ */
+static int measure(const char *name, api_result_t *(*build)(int), void (*release)(api_result_t *), int count) {
+    heap                 = {};
+    api_result_t *result = build(count);
+    int blocks           = heap.live;
+    size_t bytes         = heap.bytes;
+    release(result);
+    printf("%-28s %4d mallocs, %4d frees, %6zu bytes\n", name, heap.allocs, heap.frees, bytes);
+    CHECK_EQ(heap.live, 0);
+    return blocks;
+}
+
+int main() {
+    check_overflow_chain();
+    check_alignment_and_zeroing();
+    check_foreign_pointer();
+    check_free_cost();
+
+    int old_towers = measure("towers, per field:", towers_per_field, free_towers_per_field, TOWER_COUNT);
+    int new_towers = measure("towers, arena:", towers_arena, free_arena_result, TOWER_COUNT);
+    CHECK_EQ(old_towers, 3 + 3 * TOWER_COUNT);
+    CHECK_EQ(new_towers, 2);
+
+    int old_status = measure("battle status, per field:", battle_status_per_field, free_battle_status_per_field,
+                             SAVIOR_COUNT);
+    int new_status = measure("battle status, arena:", battle_status_arena, free_arena_result, SAVIOR_COUNT);
+    CHECK_EQ(old_status, 3 + SAVIOR_COUNT);
+    CHECK_EQ(new_status, 2);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,333 @@
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include "api.h"
+#include "esp_heap_caps.h"
+#include "host_test.h"
+#include "mock_api.h"
+
+// Decodes a big all_tower_status body and a battle status with many saviors through the real api.cpp, against the
+// decoding it replaced: json::accept() followed by two full parses, with the result and every tower copied out of the DOM
+// and every string a malloc of its own. Reports the time per decode and the heap calls on both sides, JSON DOM included.
+// The bodies are built to the server's schema since the host has no server to record from.
+
+#define TOWER_COUNT  40
+#define SAVIOR_COUNT 32
+#define ITERATIONS   500
+
+// Every heap call the decoding makes, through malloc for the result structs and operator new for the JSON DOM
+static struct {
+    bool counting;
+    int allocs;
+    int frees;
+} heap;
+
+static void *counted_malloc(size_t size) {
+    if (heap.counting) {
+        heap.allocs++;
+    }
+    return malloc(size);
+}
+
+static void counted_free(void *ptr) {
+    if (heap.counting && ptr != nullptr) {
+        heap.frees++;
+    }
+    free(ptr);
+}
+
+void *operator new(size_t size) {
+    if (void *ptr = counted_malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    abort();
+}
+
+void operator delete(void *ptr) noexcept {
+    counted_free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept {
+    counted_free(ptr);
+}
+
+extern "C" void *heap_caps_malloc_prefer(size_t size, size_t num, ...) {
+    return counted_malloc(size);
+}
+
+extern "C" void heap_caps_free(void *ptr) {
+    counted_free(ptr);
+}
+
+// The API server, as far as the decoding is concerned
+
+static std::string tower_body;
+static std::string battle_status_body;
+
+static ApiClient::ApiResponse ok(const std::string &body) {
+    ApiClient::ApiResponse response;
+    response.body        = body;
+    response.status_code = 200;
+    return response;
+}
+
+static std::string make_tower_body() {
+    json towers = json::array();
+    for (int i = 0; i < TOWER_COUNT; i++) {
+        towers.push_back({
+            {"id", i + 1},
+            {"name", "Tower of Unreasonable Length " + std::to_string(i + 1)},
+            {"location", "Expo Hall, next to the vending machine"},
+            {"level", 1 + i % 5},
+            {"health", 800 + i},
+            {"max_health", 1000},
+            {"boot_time", "2026-10-17T09:00:00Z"},
+            {"ir_code", 0x00001000 + i},
+            {"enabled", true},
+            {"status", i % 3 == 0 ? "INVULNERABLE" : "VULNERABLE"},
+            {"players_in_range", i % 7},
+            {"players_in_battle", i % 4},
+            {"players_joined_tower", i % 5},
+            {"players_disconnected", i % 2},
+        });
+    }
+    return json{{"status", true}, {"detail", nullptr}, {"result", towers}, {"delta", false}}.dump();
+}
+
+static std::string make_battle_status_body() {
+    json saviors = json::array();
+    for (int i = 0; i < SAVIOR_COUNT; i++) {
+        saviors.push_back("savior_handle_" + std::to_string(i));
+    }
+    json status = {
+        {"battle_active", true},
+        {"player_level", 3},
+        {"player_hp", 42},
+        {"player_status", "BATTLE"},
+        {"is_savior", false},
+        {"tower_ir_code", 0x00001003},
+        {"tower_level", 4},
+        {"tower_health", 640},
+        {"tower_max_health", 1000},
+        {"players_in_range", 12},
+        {"players_joined_tower", 9},
+        {"players_in_battle", 8},
+        {"strategem_min", 4},
+        {"strategem_max", 8},
+        {"strategem_amount", 3},
+        {"players_disconnected", 1},
+        {"savior_handle", saviors},
+    };
+    return json{{"status", true}, {"detail", nullptr}, {"result", status}}.dump();
+}
+
+// The decoding api.cpp did before, validating the body, parsing it for the base result and again for the data, copying
+// the result out of the DOM and every string into a malloc of its own
+
+static char *old_getstr(const json &json, const char *key) {
+    if (json.contains(key) && !json[key].is_null()) {
+        std::string value = json[key];
+        char *copy        = static_cast<char *>(counted_malloc(value.size() + 1));
+        memcpy(copy, value.c_str(), value.size() + 1);
+        return copy;
+    }
+    return nullptr;
+}
+
+static api_result_t *old_base_result(const ApiClient::ApiResponse &response) {
+    if (response.body.empty() || !json::accept(response.body)) {
+        return nullptr;
+    }
+    json response_json = response.body_json();
+    if (response_json.is_null() || !response_json.is_object()) {
+        return nullptr;
+    }
+    auto result    = static_cast<api_result_t *>(counted_malloc(sizeof(api_result_t)));
+    result->type   = api_result_type_t::API_BASE;
+    result->status = response_json.contains("status") ? (bool)response_json["status"] : true;
+    result->detail = nullptr;
+    result->data   = nullptr;
+    return result;
+}
+
+static api_result_t *old_get_all_tower_status() {
+    auto response           = ok(tower_body);
+    auto result             = old_base_result(response);
+    auto result_json        = response.body_json()["result"];
+    result->type            = api_result_type_t::API_ALL_TOWER_STATUS;
+    result->data            = counted_malloc(sizeof(api_all_tower_info_t));
+    auto all_tower_status   = static_cast<api_all_tower_info_t *>(result->data);
+    *all_tower_status       = {};
+    all_tower_status->count = result_json.size();
+    all_tower_status->towers = static_cast<api_tower_info_t *>(counted_malloc(sizeof(api_tower_info_t) * result_json.size()));
+    for (size_t i = 0; i < all_tower_status->count; i++) {
+        auto tower_json                                  = result_json[i];
+        all_tower_status->towers[i].id                   = tower_json["id"];
+        all_tower_status->towers[i].name                 = old_getstr(tower_json, "name");
+        all_tower_status->towers[i].location             = old_getstr(tower_json, "location");
+        all_tower_status->towers[i].level                = tower_json["level"];
+        all_tower_status->towers[i].health               = tower_json["health"];
+        all_tower_status->towers[i].max_health           = tower_json["max_health"];
+        all_tower_status->towers[i].boot_time            = old_getstr(tower_json, "boot_time");
+        all_tower_status->towers[i].ir_code              = tower_json["ir_code"];
+        all_tower_status->towers[i].enabled              = tower_json["enabled"];
+        all_tower_status->towers[i].status               = get_tower_status(tower_json["status"].get<std::string>().c_str());
+        all_tower_status->towers[i].players_in_range     = tower_json["players_in_range"];
+        all_tower_status->towers[i].players_in_battle    = tower_json["players_in_battle"];
+        all_tower_status->towers[i].players_joined_tower = tower_json["players_joined_tower"];
+        all_tower_status->towers[i].players_disconnected = tower_json["players_disconnected"];
+    }
+    return result;
+}
+
+static void old_free_all_tower_status(api_result_t *result) {
+    auto all_tower_status = static_cast<api_all_tower_info_t *>(result->data);
+    for (size_t i = 0; i < all_tower_status->count; i++) {
+        counted_free(all_tower_status->towers[i].name);
+        counted_free(all_tower_status->towers[i].location);
+        counted_free(all_tower_status->towers[i].boot_time);
+    }
+    counted_free(all_tower_status->towers);
+    counted_free(all_tower_status);
+    counted_free(result);
+}
+
+static api_result_t *old_get_battle_status() {
+    auto response                   = ok(battle_status_body);
+    auto result                     = old_base_result(response);
+    auto result_json                = response.body_json()["result"];
+    result->type                    = api_result_type_t::API_BATTLE_STATUS;
+    result->data                    = counted_malloc(sizeof(api_battle_status_t));
+    auto battle_status              = static_cast<api_battle_status_t *>(result->data);
+    *battle_status                  = {};
+    battle_status->battle_active    = result_json["battle_active"];
+    battle_status->player_level     = result_json["player_level"];
+    battle_status->player_hp        = result_json["player_hp"];
+    battle_status->player_status    = get_player_status(result_json["player_status"].get<std::string>().c_str());
+    battle_status->is_savior        = result_json["is_savior"];
+    battle_status->tower_ir_code    = result_json["tower_ir_code"];
+    battle_status->tower_level      = result_json["tower_level"];
+    battle_status->tower_health     = result_json["tower_health"];
+    battle_status->tower_max_health = result_json["tower_max_health"];
+    battle_status->players_in_range = result_json["players_in_range"];
+    auto saviors                       = result_json["savior_handle"];
+    battle_status->savior_handle_count = saviors.size();
+    battle_status->savior_handle       = static_cast<char **>(counted_malloc(sizeof(char *) * saviors.size()));
+    for (size_t i = 0; i < battle_status->savior_handle_count; i++) {
+        std::string handle              = saviors[i];
+        battle_status->savior_handle[i] = static_cast<char *>(counted_malloc(handle.size() + 1));
+        memcpy(battle_status->savior_handle[i], handle.c_str(), handle.size() + 1);
+    }
+    return result;
+}
+
+static void old_free_battle_status(api_result_t *result) {
+    auto battle_status = static_cast<api_battle_status_t *>(result->data);
+    for (size_t i = 0; i < battle_status->savior_handle_count; i++) {
+        counted_free(battle_status->savior_handle[i]);
+    }
+    counted_free(battle_status->savior_handle);
+    counted_free(battle_status);
+    counted_free(result);
+}
+
+static api_result_t *new_get_all_tower_status() {
+    return api_get_all_tower_status();
+}
+
+static api_result_t *new_get_battle_status() {
+    return api_get_battle_status(1);
+}
+
+static void new_free(api_result_t *result) {
+    api_free_result(result, true);
+}
+
+struct cost {
+    double us;  // Time to decode and free one body
+    int allocs; // Heap calls for one decode
+};
+
+/**
+ * @brief Decode the body over and over, then once more counting the heap calls
+ */
+static cost measure(const char *name, api_result_t *(*decode)(), void (*release)(api_result_t *)) {
+    uint64_t start = host_test_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        release(decode());
+    }
+    double us = (host_test_ns() - start) / 1000.0 / ITERATIONS;
+
+    heap.counting = true;
+    heap.allocs   = 0;
+    heap.frees    = 0;
+    release(decode());
+    heap.counting = false;
+    CHECK_EQ(heap.frees, heap.allocs);
+
+    printf("%-28s %8.1f us, %5d heap allocations\n", name, us, heap.allocs);
+    return {us, heap.allocs};
+}
+
+static void check_towers(api_result_t *result) {
+    CHECK(result != nullptr && result->status && result->type == api_result_type_t::API_ALL_TOWER_STATUS);
+    auto all_tower_status = static_cast<api_all_tower_info_t *>(result->data);
+    CHECK_EQ(all_tower_status->count, TOWER_COUNT);
+    CHECK(!all_tower_status->delta);
+    for (int i = 0; i < TOWER_COUNT; i++) {
+        auto &tower = all_tower_status->towers[i];
+        CHECK_EQ(tower.id, i + 1);
+        CHECK(strcmp(tower.name, ("Tower of Unreasonable Length " + std::to_string(i + 1)).c_str()) == 0);
+        CHECK(strcmp(tower.boot_time, "2026-10-17T09:00:00Z") == 0);
+        CHECK_EQ(tower.ir_code, 0x00001000 + i);
+        CHECK_EQ(tower.status, i % 3 == 0 ? TOWER_STATUS_INVULNERABLE : TOWER_STATUS_VULNERABLE);
+        CHECK_EQ(tower.players_disconnected, i % 2);
+    }
+}
+
+static void check_battle_status(api_result_t *result) {
+    CHECK(result != nullptr && result->status && result->type == api_result_type_t::API_BATTLE_STATUS);
+    auto battle_status = static_cast<api_battle_status_t *>(result->data);
+    CHECK(battle_status->battle_active);
+    CHECK_EQ(battle_status->player_status, PLAYER_STATUS_BATTLE);
+    CHECK_EQ(battle_status->tower_ir_code, 0x00001003);
+    CHECK_EQ(battle_status->stratagem_amount, 3);
+    CHECK_EQ(battle_status->savior_handle_count, SAVIOR_COUNT);
+    for (int i = 0; i < SAVIOR_COUNT; i++) {
+        CHECK(strcmp(battle_status->savior_handle[i], ("savior_handle_" + std::to_string(i)).c_str()) == 0);
+    }
+}
+
+int main() {
+    tower_body         = make_tower_body();
+    battle_status_body = make_battle_status_body();
+    mock_api_server    = [](std::string_view method, std::string_view endpoint, std::string_view if_none_match) {
+        return ok(endpoint == "/badge/all_tower_status" ? tower_body : battle_status_body);
+    };
+    printf("all_tower_status body: %zu bytes, %d towers\n", tower_body.size(), TOWER_COUNT);
+    printf("battle status body:    %zu bytes, %d saviors\n", battle_status_body.size(), SAVIOR_COUNT);
+
+    // Both sides decode the same thing
+    api_result_t *result = api_get_all_tower_status();
+    check_towers(result);
+    CHECK_EQ(static_cast<api_all_tower_info_t *>(result->data)->body_size, tower_body.size());
+    api_free_result(result, true);
+    result = old_get_all_tower_status();
+    check_towers(result);
+    old_free_all_tower_status(result);
+    result = api_get_battle_status(1);
+    check_battle_status(result);
+    api_free_result(result, true);
+
+    cost old_towers = measure("towers, parsed three times:", old_get_all_tower_status, old_free_all_tower_status);
+    cost new_towers = measure("towers, parsed once:", new_get_all_tower_status, new_free);
+    CHECK(new_towers.allocs < old_towers.allocs);
+
+    cost old_status = measure("battle status, three times:", old_get_battle_status, old_free_battle_status);
+    cost new_status = measure("battle status, once:", new_get_battle_status, new_free);
+    CHECK(new_status.allocs < old_status.allocs);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,246 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "draw_sw_kernels.h"
+#include "host_test.h"
+#include "lvgl.h"
+
+// Checks the RGB565 draw kernels bit for bit against LVGL's scalar loops and compares their throughput. The host build
+// runs the portable C paths, the PIE fill and copy only exist on the ESP32-S3.
+
+#define FRAME_W     320
+#define FRAME_H     240
+#define BENCH_ITERS 200
+
+// Room around every area, so writes outside it show up as differences
+#define GUARD_BYTES 64
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void) {
+    rng_state = rng_state * 1103515245 + 12345;
+    return rng_state >> 8;
+}
+
+static void fill_random(void *buf, size_t size) {
+    uint8_t *bytes = buf;
+    for (size_t i = 0; i < size; i++) {
+        bytes[i] = rng();
+    }
+}
+
+/**
+ * @brief Fill a mask the way the RGB565A8 UI images look - long fully transparent and fully opaque runs with a couple of
+ *     antialiased pixels between them
+ */
+static void fill_icon_mask(uint8_t *mask, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        uint8_t value = rng() & 1 ? 0xff : 0x00;
+        size_t run    = 4 + rng() % 24;
+        for (size_t j = 0; j < run && i < size; j++) {
+            mask[i++] = value;
+        }
+        for (size_t j = 0; j < 2 && i < size; j++) {
+            mask[i++] = rng();
+        }
+    }
+}
+
+// LVGL's scalar loops (lv_draw_sw_rgb565_swap() and lv_draw_sw_blend_to_rgb565.c), one pixel at a time. Not inlined, so
+// the compiler can't fold them into the benchmark loop.
+
+__attribute__((noinline)) static void ref_swap(void *buf, uint32_t count) {
+    uint16_t *buf16 = buf;
+    for (uint32_t i = 0; i < count; i++) {
+        buf16[i] = ((buf16[i] & 0xff00) >> 8) + ((buf16[i] & 0x00ff) << 8);
+    }
+}
+
+__attribute__((noinline)) static void ref_fill(void *dest, int32_t w, int32_t h, int32_t dest_stride, uint16_t color) {
+    uint8_t *row = dest;
+    for (int32_t y = 0; y < h; y++, row += dest_stride) {
+        for (int32_t x = 0; x < w; x++) {
+            ((uint16_t *)row)[x] = color;
+        }
+    }
+}
+
+__attribute__((noinline)) static void ref_copy(void *dest, int32_t w, int32_t h, int32_t dest_stride, const void *src,
+                                               int32_t src_stride) {
+    uint8_t *dest_row      = dest;
+    const uint8_t *src_row = src;
+    for (int32_t y = 0; y < h; y++, dest_row += dest_stride, src_row += src_stride) {
+        for (int32_t x = 0; x < w; x++) {
+            ((uint16_t *)dest_row)[x] = ((const uint16_t *)src_row)[x];
+        }
+    }
+}
+
+__attribute__((noinline)) static void ref_blend(void *dest, int32_t w, int32_t h, int32_t dest_stride, const void *src,
+                                                int32_t src_stride, uint8_t opa, const uint8_t *mask, int32_t mask_stride) {
+    uint8_t *dest_row      = dest;
+    const uint8_t *src_row = src;
+    for (int32_t y = 0; y < h; y++, dest_row += dest_stride, src_row += src_stride) {
+        uint16_t *d       = (uint16_t *)dest_row;
+        const uint16_t *s = (const uint16_t *)src_row;
+        for (int32_t x = 0; x < w; x++) {
+            if (mask == NULL) {
+                d[x] = lv_color_16_16_mix(s[x], d[x], opa);
+            } else if (opa >= LV_OPA_MAX) {
+                d[x] = lv_color_16_16_mix(s[x], d[x], mask[x]);
+            } else {
+                d[x] = lv_color_16_16_mix(s[x], d[x], LV_OPA_MIX2(mask[x], opa));
+            }
+        }
+        if (mask != NULL) {
+            mask += mask_stride;
+        }
+    }
+}
+
+// Scratch areas - the kernel and the reference each get an identical copy of the destination
+static uint8_t dest_ref[GUARD_BYTES + FRAME_W * FRAME_H * 2 + GUARD_BYTES];
+static uint8_t dest_kernel[sizeof(dest_ref)];
+static uint8_t src_buf[sizeof(dest_ref)];
+static uint8_t mask_buf[FRAME_W * FRAME_H + GUARD_BYTES];
+
+static void check_swap(void) {
+    for (uint32_t offset = 0; offset < 4; offset += 2) {
+        for (uint32_t count = 0; count < 70; count++) {
+            fill_random(dest_ref, 256);
+            memcpy(dest_kernel, dest_ref, 256);
+            ref_swap(dest_ref + GUARD_BYTES + offset, count);
+            draw_sw_rgb565_swap(dest_kernel + GUARD_BYTES + offset, count);
+            CHECK(memcmp(dest_ref, dest_kernel, 256) == 0);
+        }
+    }
+}
+
+static void check_fill(void) {
+    for (int32_t offset = 0; offset < 4; offset += 2) {
+        for (int32_t pad = 0; pad <= 6; pad += 2) {
+            for (int32_t w = 1; w < 70; w++) {
+                int32_t stride = w * 2 + pad;
+                size_t size    = GUARD_BYTES * 2 + stride * 3;
+                uint16_t color = rng();
+                fill_random(dest_ref, size);
+                memcpy(dest_kernel, dest_ref, size);
+                ref_fill(dest_ref + GUARD_BYTES + offset, w, 3, stride, color);
+                draw_sw_rgb565_fill(dest_kernel + GUARD_BYTES + offset, w, 3, stride, color);
+                CHECK(memcmp(dest_ref, dest_kernel, size) == 0);
+            }
+        }
+    }
+}
+
+static void check_copy(void) {
+    for (int32_t offset = 0; offset < 4; offset += 2) {
+        for (int32_t src_offset = 0; src_offset < 4; src_offset += 2) {
+            for (int32_t w = 1; w < 70; w++) {
+                int32_t stride = w * 2 + 4;
+                size_t size    = GUARD_BYTES * 2 + stride * 3;
+                fill_random(src_buf, size);
+                fill_random(dest_ref, size);
+                memcpy(dest_kernel, dest_ref, size);
+                ref_copy(dest_ref + GUARD_BYTES + offset, w, 3, stride, src_buf + src_offset, w * 2 + 2);
+                draw_sw_rgb565_copy(dest_kernel + GUARD_BYTES + offset, w, 3, stride, src_buf + src_offset, w * 2 + 2);
+                CHECK(memcmp(dest_ref, dest_kernel, size) == 0);
+            }
+        }
+    }
+}
+
+static void check_blend(void) {
+    static const uint8_t opas[] = {0, 1, 2, 64, 127, 200, 252, 253, 254, 255};
+    for (size_t o = 0; o < sizeof(opas); o++) {
+        for (int mask_kind = 0; mask_kind < 3; mask_kind++) {
+            for (int32_t w = 1; w < 70; w++) {
+                int32_t stride      = w * 2 + 2;
+                int32_t mask_stride = w + 3;
+                size_t size         = GUARD_BYTES * 2 + stride * 3;
+                const uint8_t *mask = NULL;
+                if (mask_kind == 1) {
+                    fill_random(mask_buf, mask_stride * 3);
+                    mask = mask_buf;
+                } else if (mask_kind == 2) {
+                    fill_icon_mask(mask_buf, mask_stride * 3);
+                    mask = mask_buf;
+                }
+                fill_random(src_buf, size);
+                fill_random(dest_ref, size);
+                memcpy(dest_kernel, dest_ref, size);
+                ref_blend(dest_ref + GUARD_BYTES, w, 3, stride, src_buf, stride, opas[o], mask, mask_stride);
+                draw_sw_rgb565_blend(dest_kernel + GUARD_BYTES, w, 3, stride, src_buf, stride, opas[o], mask, mask_stride);
+                CHECK(memcmp(dest_ref, dest_kernel, size) == 0);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Report how many megapixels per second the kernel and the reference loop manage on full frames
+ *
+ * @param name Operation name
+ * @param kernel_ns Total time spent in the kernel
+ * @param ref_ns Total time spent in the reference loop
+ */
+static void report(const char *name, uint64_t kernel_ns, uint64_t ref_ns) {
+    double mpx = (double)FRAME_W * FRAME_H * BENCH_ITERS / 1e6;
+    printf("%-20s kernel %8.1f Mpx/s  reference %8.1f Mpx/s  %.2fx\n", name, mpx / (kernel_ns / 1e9), mpx / (ref_ns / 1e9),
+           (double)ref_ns / kernel_ns);
+}
+
+#define BENCH(total_ns, call)                                                                                             \
+    do {                                                                                                                  \
+        uint64_t start_ = host_test_ns();                                                                                 \
+        for (int i_ = 0; i_ < BENCH_ITERS; i_++) {                                                                        \
+            call;                                                                                                         \
+            __asm__ volatile("" ::: "memory");                                                                            \
+        }                                                                                                                 \
+        total_ns = host_test_ns() - start_;                                                                               \
+    } while (0)
+
+static void bench(void) {
+    int32_t stride  = FRAME_W * 2;
+    uint8_t *dest   = dest_kernel + GUARD_BYTES;
+    uint8_t *src    = src_buf + GUARD_BYTES;
+    uint64_t kernel = 0;
+    uint64_t ref    = 0;
+
+    fill_random(src_buf, sizeof(src_buf));
+    fill_icon_mask(mask_buf, sizeof(mask_buf));
+
+    BENCH(kernel, draw_sw_rgb565_swap(dest, FRAME_W * FRAME_H));
+    BENCH(ref, ref_swap(dest, FRAME_W * FRAME_H));
+    report("swap", kernel, ref);
+
+    BENCH(kernel, draw_sw_rgb565_fill(dest, FRAME_W, FRAME_H, stride, 0x1234));
+    BENCH(ref, ref_fill(dest, FRAME_W, FRAME_H, stride, 0x1234));
+    report("fill", kernel, ref);
+
+    BENCH(kernel, draw_sw_rgb565_copy(dest, FRAME_W, FRAME_H, stride, src, stride));
+    BENCH(ref, ref_copy(dest, FRAME_W, FRAME_H, stride, src, stride));
+    report("copy", kernel, ref);
+
+    BENCH(kernel, draw_sw_rgb565_blend(dest, FRAME_W, FRAME_H, stride, src, stride, LV_OPA_50, NULL, 0));
+    BENCH(ref, ref_blend(dest, FRAME_W, FRAME_H, stride, src, stride, LV_OPA_50, NULL, 0));
+    report("blend opa", kernel, ref);
+
+    BENCH(kernel, draw_sw_rgb565_blend(dest, FRAME_W, FRAME_H, stride, src, stride, LV_OPA_COVER, mask_buf, FRAME_W));
+    BENCH(ref, ref_blend(dest, FRAME_W, FRAME_H, stride, src, stride, LV_OPA_COVER, mask_buf, FRAME_W));
+    report("blend icon mask", kernel, ref);
+
+    BENCH(kernel, draw_sw_rgb565_blend(dest, FRAME_W, FRAME_H, stride, src, stride, LV_OPA_50, mask_buf, FRAME_W));
+    BENCH(ref, ref_blend(dest, FRAME_W, FRAME_H, stride, src, stride, LV_OPA_50, mask_buf, FRAME_W));
+    report("blend mask and opa", kernel, ref);
+}
+
+int main(void) {
+    check_swap();
+    check_fill();
+    check_copy();
+    check_blend();
+    bench();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+// Checks for the host tests. A failed check is reported and the test carries on, HOST_TEST_RESULT() turns the failures
+// into the exit code ctest looks at.
+
+static int host_test_failures __attribute__((unused));
+
+#define CHECK(cond)                                                                                                       \
+    do {                                                                                                                  \
+        if (!(cond)) {                                                                                                    \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                                               \
+            host_test_failures++;                                                                                         \
+        }                                                                                                                 \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                                        \
+    do {                                                                                                                  \
+        long long actual_   = (long long)(actual);                                                                        \
+        long long expected_ = (long long)(expected);                                                                      \
+        if (actual_ != expected_) {                                                                                       \
+            printf("%s:%d: check failed: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, actual_, expected_);  \
+            host_test_failures++;                                                                                         \
+        }                                                                                                                 \
+    } while (0)
+
+#define HOST_TEST_RESULT() (host_test_failures == 0 ? 0 : (printf("%d check(s) failed\n", host_test_failures), 1))
+
+/**
+ * @brief Free running cycle counter, the host stand-in for esp_cpu_get_cycle_count()
+ *     Uses the TSC where there is one, so the costs are in TSC ticks, and nanoseconds everywhere else.
+ *
+ * @return Counter value, only differences are meaningful
+ */
+static inline uint32_t host_test_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000 + now.tv_nsec);
+#endif
+}
+
+/**
+ * @brief Monotonic wall clock for throughput numbers
+ *
+ * @return Time in nanoseconds
+ */
+static inline uint64_t host_test_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
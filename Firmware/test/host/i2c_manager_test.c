@@ -0,0 +1,208 @@
+#include <string.h>
+
+#include "host_test.h"
+#include "i2c_manager.h"
+#include "mock.h"
+
+// Runs the I2C manager against the simulated bus: one EEPROM-like device behind each switch channel, polled the way the
+// minibadge and accel code poll them. Compares one call per transfer with batches on bus transactions, lock traffic and
+// device adds, and checks the batch error handling.
+
+#define DEVICE_ADDR 0x50
+#define POLLS       10
+
+static mock_i2c_device_t slots[4];
+static i2c_manager_device_config_t configs[4];
+
+// Counter snapshot, so each workload can be measured on its own
+typedef struct {
+    uint32_t transactions;
+    uint32_t switch_transactions;
+    uint32_t mutex_takes;
+    uint32_t bus_locks;
+    uint32_t device_adds;
+} counts_t;
+
+static counts_t snapshot(void) {
+    i2c_manager_stats_t stats;
+    i2c_manager_get_stats(&stats);
+    return (counts_t){
+        .transactions        = mock_i2c_stats.transactions,
+        .switch_transactions = mock_i2c_stats.switch_transactions,
+        .mutex_takes         = mock_freertos_stats.mutex_takes,
+        .bus_locks           = stats.bus_locks,
+        .device_adds         = mock_i2c_stats.device_adds,
+    };
+}
+
+static counts_t since(counts_t start) {
+    counts_t now = snapshot();
+    return (counts_t){
+        .transactions        = now.transactions - start.transactions,
+        .switch_transactions = now.switch_transactions - start.switch_transactions,
+        .mutex_takes         = now.mutex_takes - start.mutex_takes,
+        .bus_locks           = now.bus_locks - start.bus_locks,
+        .device_adds         = now.device_adds - start.device_adds,
+    };
+}
+
+static void report(const char *name, counts_t counts) {
+    printf("%-12s %3" PRIu32 " transactions (%3" PRIu32 " switch)  %3" PRIu32 " mutex takes  %3" PRIu32 " bus locks  %" PRIu32
+           " device adds\n",
+           name, counts.transactions, counts.switch_transactions, counts.mutex_takes, counts.bus_locks, counts.device_adds);
+}
+
+static void setup(void) {
+    CHECK_EQ(i2c_manager_init_auto(), ESP_OK);
+    for (int i = 0; i < 4; i++) {
+        slots[i] = (mock_i2c_device_t){.port = I2C_BUS_OTHER, .channel = i, .address = DEVICE_ADDR, .present = true};
+        for (int reg = 0; reg < 256; reg++) {
+            slots[i].regs[reg] = i << 4 | (reg & 0x0F);
+        }
+        mock_i2c_attach(&slots[i]);
+        configs[i] = (i2c_manager_device_config_t){
+            .bus_index = I2C_BUS_OTHER,
+            .channel   = i,
+            .config    = {.dev_addr_length = I2C_ADDR_BIT_LEN_7, .device_address = DEVICE_ADDR, .scl_speed_hz = 100000},
+        };
+    }
+}
+
+/**
+ * @brief Poll every slot with one helper call per read, the way the callers did before batching
+ */
+static void check_per_call(void) {
+    counts_t start = snapshot();
+    for (int poll = 0; poll < POLLS; poll++) {
+        for (int i = 0; i < 4; i++) {
+            uint8_t data[2] = {0};
+            CHECK_EQ(i2c_manager_read_eeprom(&configs[i], 0x03, data, sizeof(data)), ESP_OK);
+            CHECK_EQ(data[0], i << 4 | 0x03);
+            CHECK_EQ(data[1], i << 4 | 0x04);
+        }
+    }
+    counts_t counts = since(start);
+    report("per call", counts);
+
+    // Every read is a transfer plus a channel change, a select being a write and a read back
+    CHECK_EQ(counts.transactions, POLLS * 4 * 3);
+    CHECK_EQ(counts.switch_transactions, POLLS * 4 * 2);
+    CHECK_EQ(counts.bus_locks, POLLS * 4);
+    // Bus, device list and switch lock for every read
+    CHECK_EQ(counts.mutex_takes, POLLS * 4 * 3);
+    // Handles are added on first use and kept
+    CHECK_EQ(counts.device_adds, 4);
+}
+
+/**
+ * @brief Poll every slot with one batch per pass
+ */
+static void check_batched(void) {
+    counts_t start = snapshot();
+    for (int poll = 0; poll < POLLS; poll++) {
+        uint8_t reg        = 0x05;
+        uint8_t data[4][2] = {0};
+        i2c_manager_op_t ops[4];
+        for (int i = 0; i < 4; i++) {
+            ops[i] = (i2c_manager_op_t){
+                .device  = &configs[i],
+                .type    = I2C_MANAGER_OP_TRANSMIT_RECEIVE,
+                .tx_data = &reg,
+                .tx_size = 1,
+                .rx_data = data[i],
+                .rx_size = sizeof(data[i]),
+            };
+        }
+        CHECK_EQ(i2c_manager_execute(ops, 4, false, 100), ESP_OK);
+        for (int i = 0; i < 4; i++) {
+            CHECK_EQ(ops[i].err, ESP_OK);
+            CHECK_EQ(data[i][0], i << 4 | 0x05);
+        }
+    }
+    counts_t counts = since(start);
+    report("batched", counts);
+
+    CHECK_EQ(counts.transactions, POLLS * 4 * 3);
+    CHECK_EQ(counts.bus_locks, POLLS);
+    CHECK_EQ(counts.mutex_takes, POLLS * (1 + 4 * 2));
+    CHECK_EQ(counts.device_adds, 0);
+    CHECK_EQ(mock_i2c_stats.live_handles, i2c_device_count + 1); // The switch handle isn't in the list
+}
+
+/**
+ * @brief Consecutive operations on one channel select it once
+ */
+static void check_same_channel(void) {
+    uint8_t reg        = 0x00;
+    uint8_t data[4][1] = {0};
+    i2c_manager_op_t ops[4];
+    for (int i = 0; i < 4; i++) {
+        ops[i] = (i2c_manager_op_t){
+            .device  = &configs[i / 2],
+            .type    = I2C_MANAGER_OP_TRANSMIT_RECEIVE,
+            .tx_data = &reg,
+            .tx_size = 1,
+            .rx_data = data[i],
+            .rx_size = 1,
+        };
+    }
+    // Start from another channel, so both channels the batch uses need selecting
+    uint8_t other[1];
+    CHECK_EQ(i2c_manager_read_eeprom(&configs[3], 0x00, other, sizeof(other)), ESP_OK);
+
+    counts_t start = snapshot();
+    CHECK_EQ(i2c_manager_execute(ops, 4, true, 100), ESP_OK);
+    counts_t counts = since(start);
+    report("2 channels", counts);
+    CHECK_EQ(counts.switch_transactions, 2 * 2);
+    CHECK_EQ(counts.transactions, 4 + 2 * 2);
+    CHECK_EQ(data[1][0], 0x00);
+    CHECK_EQ(data[2][0], 0x10);
+}
+
+/**
+ * @brief A missing device fails its operation, and with stop_on_error the rest of the batch is skipped
+ */
+static void check_errors(void) {
+    slots[2].present = false;
+
+    uint8_t reg        = 0x00;
+    uint8_t data[4][1] = {0};
+    i2c_manager_op_t ops[4];
+    for (int i = 0; i < 4; i++) {
+        ops[i] = (i2c_manager_op_t){
+            .device  = &configs[i],
+            .type    = I2C_MANAGER_OP_TRANSMIT_RECEIVE,
+            .tx_data = &reg,
+            .tx_size = 1,
+            .rx_data = data[i],
+            .rx_size = 1,
+        };
+    }
+
+    CHECK_EQ(i2c_manager_execute(ops, 4, true, 100), ESP_FAIL);
+    CHECK_EQ(ops[0].err, ESP_OK);
+    CHECK_EQ(ops[1].err, ESP_OK);
+    CHECK_EQ(ops[2].err, ESP_FAIL);
+    CHECK_EQ(ops[3].err, ESP_ERR_NOT_FINISHED);
+    CHECK(!i2c_manager_bus_locked(I2C_BUS_OTHER));
+
+    CHECK_EQ(i2c_manager_execute(ops, 4, false, 100), ESP_FAIL);
+    CHECK_EQ(ops[2].err, ESP_FAIL);
+    CHECK_EQ(ops[3].err, ESP_OK);
+    CHECK_EQ(data[3][0], 0x30);
+    CHECK(!i2c_manager_bus_locked(I2C_BUS_OTHER));
+
+    slots[2].present = true;
+    CHECK_EQ(i2c_manager_ping(&configs[2]), ESP_OK);
+    CHECK_EQ(mock_i2c_stats.live_handles, i2c_device_count + 1); // The switch handle isn't in the list
+}
+
+int main(void) {
+    setup();
+    check_per_call();
+    check_batched();
+    check_same_channel();
+    check_errors();
+    return HOST_TEST_RESULT();
+}
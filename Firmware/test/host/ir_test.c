@@ -0,0 +1,216 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "api.h"
+#include "api_executor.h"
+#include "esp_timer.h"
+#include "host_test.h"
+#include "ir.h"
+#include "mock.h"
+
+// Runs the IR Rx rings and the periodic batch check against codes injected faster than the consumers can take them while
+// the API is slow to answer. At the rate the rings are sized for nothing is dropped and every tower gets checked; past it
+// every code is either queued or counted as dropped. High-priority codes are checked one at a time and reach their
+// handler once each.
+
+#define TOWER_COUNT      8    // Towers in range, more than this and the debounce can't keep their repeats out
+#define TOWER_REPEAT_MS  100  // How often a tower sends its code
+#define API_LATENCY_MS   2000 // Slow network, but the ring still holds what comes in meanwhile
+#define FLOOD_LATENCY_MS 5000 // A check that hangs while the flood comes in
+#define FLOOD_RATE_HZ    40   // Distinct codes a second, nothing to debounce
+#define BURST_COUNT      40   // Distinct level-up codes in one go, more than their ring holds
+#define MAX_CHECKED      256
+
+// Defined in ir.c, called from the IR Rx path on the badge
+void ir_rx_callback(uint16_t address, uint16_t command);
+
+// What the injector sends
+static enum {
+    INJECT_NONE,
+    INJECT_TOWERS,
+    INJECT_FLOOD,
+} inject_mode;
+static int64_t inject_next_us[TOWER_COUNT];
+static uint32_t flood_sent;
+
+// The API as the IR code checks see it
+static int api_latency_ms = API_LATENCY_MS;
+static uint32_t checked[MAX_CHECKED];
+static int checked_count;
+static int batches;
+static int largest_batch;
+static int levelups;
+
+static uint32_t encode(uint32_t decoded) {
+    return decoded ^ IR_KEY;
+}
+
+static void send(uint32_t code) {
+    ir_rx_callback(code >> 16, code & 0xffff);
+}
+
+static void inject(int64_t now_us, void *arg) {
+    (void)arg;
+    if (inject_mode == INJECT_TOWERS) {
+        for (int i = 0; i < TOWER_COUNT; i++) {
+            if (now_us >= inject_next_us[i]) {
+                send(encode(0x00001000 + i)); // MTI 0, a tower
+                // Spread the towers out so they don't all send on the same step
+                inject_next_us[i] = now_us + TOWER_REPEAT_MS * 1000 + i * 1000;
+            }
+        }
+    } else if (inject_mode == INJECT_FLOOD) {
+        if (now_us >= inject_next_us[0]) {
+            send(encode(0x00100000 + flood_sent++));
+            inject_next_us[0] = now_us + 1000000 / FLOOD_RATE_HZ;
+        }
+    }
+}
+
+// Badge side of the IR code handling
+
+esp_err_t ir_init(ir_rx_callback_t rx_callback) {
+    return ESP_OK;
+}
+
+esp_err_t ir_enable_rx() {
+    return ESP_OK;
+}
+
+esp_err_t ir_enable_tx() {
+    return ESP_OK;
+}
+
+bool tower_tracker_ready(void) {
+    return false;
+}
+
+int tower_ir_to_id(uint32_t ir_code) {
+    return -1;
+}
+
+void tower_seen(int tower_id) {
+}
+
+void handle_levelup_code(ir_code_t *ir_code) {
+    levelups++;
+}
+
+void handle_savior_code(ir_code_t *ir_code, const char *msg) {
+}
+
+// The API executor, running the request on the caller's task once the network has taken its time
+
+api_result_t *api_submit_wait(api_priority_t priority, api_request_fn_t request, void *request_arg, const void *owner,
+                              TickType_t timeout) {
+    vTaskDelay(pdMS_TO_TICKS(api_latency_ms));
+    return request(request_arg);
+}
+
+api_result_t *api_check_ir_codes(const uint32_t *ir_codes, size_t num_codes) {
+    batches++;
+    if ((int)num_codes > largest_batch) {
+        largest_batch = num_codes;
+    }
+    for (size_t i = 0; i < num_codes && checked_count < MAX_CHECKED; i++) {
+        checked[checked_count++] = ir_codes[i];
+    }
+
+    // Every code checks out
+    api_result_t *result       = calloc(1, sizeof(api_result_t));
+    api_ir_code_result_t *data = calloc(1, sizeof(api_ir_code_result_t));
+    data->ir_codes             = calloc(num_codes, sizeof(api_ir_code_t));
+    data->count                = num_codes;
+    for (size_t i = 0; i < num_codes; i++) {
+        data->ir_codes[i].code     = ir_codes[i];
+        data->ir_codes[i].is_valid = true;
+    }
+    result->type   = API_IR_CODE;
+    result->status = true;
+    result->data   = data;
+    return result;
+}
+
+void api_free_result(api_result_t *result, bool free_data) {
+    if (result == NULL) {
+        return;
+    }
+    if (free_data && result->data != NULL) {
+        free(((api_ir_code_result_t *)result->data)->ir_codes);
+        free(result->data);
+    }
+    free(result);
+}
+
+static bool was_checked(uint32_t code) {
+    for (int i = 0; i < checked_count; i++) {
+        if (checked[i] == code) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void start_injecting(int mode) {
+    int64_t now_us = esp_timer_get_time();
+    for (int i = 0; i < TOWER_COUNT; i++) {
+        inject_next_us[i] = now_us;
+    }
+    inject_mode = mode;
+}
+
+int main(void) {
+    badge_ir_init();
+    mock_time_add_ticker(inject, NULL);
+    badge_ir_stats_t stats;
+
+    // Towers in range, repeating their codes, with every periodic check taking two seconds: the debounce lets each tower
+    // through once a second and the ring holds more than what comes in during a check
+    start_injecting(INJECT_TOWERS);
+    mock_run(60 * 1000000);
+    inject_mode = INJECT_NONE;
+    mock_run(15 * 1000000);
+    badge_ir_get_stats(&stats);
+    printf("towers:    %3" PRIu32 " queued, %3" PRIu32 " dropped, %d batches of up to %d codes\n", stats.queued,
+           stats.dropped, batches, largest_batch);
+    CHECK_EQ(stats.dropped, 0);
+    CHECK(stats.queued >= TOWER_COUNT * 50);
+    CHECK(batches >= 5);
+    CHECK(largest_batch <= TOWER_COUNT);
+    for (int i = 0; i < TOWER_COUNT; i++) {
+        CHECK(was_checked(encode(0x00001000 + i)));
+    }
+
+    // A flood of distinct codes while a check hangs for five seconds: the ring fills, and every code is either queued or
+    // counted as dropped
+    badge_ir_stats_t before = stats;
+    api_latency_ms          = FLOOD_LATENCY_MS;
+    start_injecting(INJECT_FLOOD);
+    mock_run(30 * 1000000);
+    inject_mode = INJECT_NONE;
+    mock_run(30 * 1000000);
+    badge_ir_get_stats(&stats);
+    uint32_t queued  = stats.queued - before.queued;
+    uint32_t dropped = stats.dropped - before.dropped;
+    printf("flood:     %3" PRIu32 " queued, %3" PRIu32 " dropped of %" PRIu32 " sent\n", queued, dropped, flood_sent);
+    CHECK(dropped > 0);
+    CHECK_EQ(queued + dropped, flood_sent);
+    CHECK(largest_batch <= 16);
+
+    // A burst of level-up codes, each checked on its own: what fits in the ring reaches the handler once, the rest is
+    // counted as dropped. Repeats of the same code inside the debounce window don't count at all.
+    api_latency_ms = 500;
+    for (int i = 0; i < BURST_COUNT; i++) {
+        send(encode(0x10000000 + i));
+        send(encode(0x10000000 + i));
+    }
+    mock_run(30 * 1000000);
+    badge_ir_get_stats(&stats);
+    printf("level-ups: %3" PRIu32 " queued, %3" PRIu32 " dropped, %d handled\n", stats.high_priority_queued,
+           stats.high_priority_dropped, levelups);
+    CHECK(stats.high_priority_dropped > 0);
+    CHECK_EQ(stats.high_priority_queued + stats.high_priority_dropped, BURST_COUNT);
+    CHECK_EQ(levelups, stats.high_priority_queued);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,177 @@
+#include <string.h>
+
+#include "esp_timer.h"
+#include "host_test.h"
+#include "i2c_manager.h"
+#include "minibadge.h"
+#include "mock.h"
+
+// Runs the minibadge presence monitor against the simulated bus with minibadges going in and out of the slots. Measures
+// the bus traffic of idle passes against full scans with check_minibadges(), the time from an insert to its event, and
+// checks the EEPROM is only read on changes.
+
+#define PERIOD_US   1000000
+#define IDLE_PASSES 10
+
+// Slot 1 takes a serialized minibadge (name EEPROM plus the serial number part at 0x58), slot 2 a basic one
+static mock_i2c_device_t slot1_name;
+static mock_i2c_device_t slot1_serial;
+static mock_i2c_device_t slot2_name;
+
+static const uint8_t serial[16] = {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 1, 2, 3, 4, 5, 6, 7, 8};
+
+// Slot change the ticker applies once the clock gets to it
+static struct {
+    int64_t at_us;
+    mock_i2c_device_t *devices[2];
+    bool present;
+} pending = {.at_us = -1};
+
+// Events seen by the callback
+static minibadge_event_t events[8];
+static int64_t event_times_us[8];
+static int event_count;
+
+static void apply_pending(int64_t now_us, void *arg) {
+    (void)arg;
+    if (pending.at_us >= 0 && now_us >= pending.at_us) {
+        for (int i = 0; i < 2; i++) {
+            if (pending.devices[i] != NULL) {
+                pending.devices[i]->present = pending.present;
+            }
+        }
+        pending.at_us = -1;
+    }
+}
+
+static void on_event(minibadge_event_t event) {
+    if (event_count < 8) {
+        events[event_count]         = event;
+        event_times_us[event_count] = esp_timer_get_time();
+    }
+    event_count++;
+}
+
+/**
+ * @brief Change a slot partway into the next monitor pass and run the monitor until it's had a chance to see it
+ *
+ * @param offset_us When in the period the change happens
+ * @param name Name EEPROM of the minibadge
+ * @param serial_part Serial number part, NULL for a basic minibadge
+ * @param present Inserted or removed
+ * @return Time from the change to the event, -1 if there was none
+ */
+static int64_t change_slot(int64_t offset_us, mock_i2c_device_t *name, mock_i2c_device_t *serial_part, bool present) {
+    int first_event    = event_count;
+    int64_t change_us  = esp_timer_get_time() + offset_us;
+    pending.at_us      = change_us;
+    pending.devices[0] = name;
+    pending.devices[1] = serial_part;
+    pending.present    = present;
+    mock_run(PERIOD_US + MOCK_TIME_STEP_US);
+    return event_count > first_event ? event_times_us[first_event] - change_us : -1;
+}
+
+/**
+ * @brief Run the monitor over idle passes and return the bus transactions it took
+ */
+static uint32_t idle_transactions(int passes) {
+    uint32_t start = mock_i2c_stats.transactions;
+    mock_run((int64_t)passes * PERIOD_US + MOCK_TIME_STEP_US);
+    return mock_i2c_stats.transactions - start;
+}
+
+static void setup(void) {
+    slot1_name   = (mock_i2c_device_t){.port = I2C_BUS_OTHER, .channel = 0, .address = MINIBADGE_I2C_ADDR_EEPROM};
+    slot1_serial = (mock_i2c_device_t){.port = I2C_BUS_OTHER, .channel = 0, .address = MINIBADGE_I2C_ADDR_EEPROM + 0x08};
+    slot2_name   = (mock_i2c_device_t){.port = I2C_BUS_OTHER, .channel = 1, .address = MINIBADGE_I2C_ADDR_EEPROM};
+    memcpy(slot1_name.regs, "SERIALZD", 8);
+    memcpy(&slot1_serial.regs[MINIBADGE_EEPROM_ADDR_SERIAL], serial, sizeof(serial));
+    memcpy(slot2_name.regs, "BASIC!!!", 8);
+    mock_i2c_attach(&slot1_name);
+    mock_i2c_attach(&slot1_serial);
+    mock_i2c_attach(&slot2_name);
+    mock_time_add_ticker(apply_pending, NULL);
+
+    CHECK_EQ(i2c_manager_init_auto(), ESP_OK);
+    CHECK_EQ(minibadge_init(), ESP_OK);
+    CHECK_EQ(minibadge_add_event_callback(on_event), ESP_OK);
+}
+
+int main(void) {
+    minibadge_stats_t stats;
+    setup();
+
+    // Empty slots
+    uint32_t empty = idle_transactions(IDLE_PASSES);
+    minibadge_get_stats(&stats);
+    CHECK_EQ(stats.presence_checks, IDLE_PASSES);
+    CHECK_EQ(stats.eeprom_reads, 0);
+    CHECK_EQ(event_count, 0);
+
+    // Insert the serialized minibadge partway into a period, it's reported by the end of the next pass
+    int64_t latency = change_slot(350000, &slot1_name, &slot1_serial, true);
+    CHECK(latency >= 0 && latency <= PERIOD_US);
+    CHECK_EQ(event_count, 1);
+    CHECK_EQ(events[0].type, MINIBADGE_EVENT_INSERTED);
+    CHECK_EQ(events[0].slot, MINIBADGE_SLOT_1);
+    CHECK_EQ(minibadge_get_count(), 1);
+    CHECK_EQ(minibadge_devices[0].type, MINIBADGE_TYPE_EEPROM_SERIALIZED);
+    CHECK(memcmp(minibadge_devices[0].data, "SERIALZD", 8) == 0);
+    CHECK(memcmp(minibadge_devices[0].serial, serial, sizeof(serial)) == 0);
+    minibadge_get_stats(&stats);
+    CHECK_EQ(stats.eeprom_reads, 2);
+    printf("insert detected after %lld ms\n", (long long)latency / 1000);
+
+    // Idle passes with a minibadge in don't read its EEPROM again, where full scans read it every time
+    uint32_t monitor = idle_transactions(IDLE_PASSES);
+    minibadge_get_stats(&stats);
+    CHECK_EQ(stats.eeprom_reads, 2);
+    CHECK_EQ(event_count, 1);
+
+    uint32_t start = mock_i2c_stats.transactions;
+    for (int i = 0; i < IDLE_PASSES; i++) {
+        CHECK_EQ(check_minibadges(), 1);
+    }
+    uint32_t scans = mock_i2c_stats.transactions - start;
+    minibadge_get_stats(&stats);
+    CHECK_EQ(stats.eeprom_reads, 2 + IDLE_PASSES);
+    CHECK_EQ(stats.cache_hits, IDLE_PASSES);
+
+    printf("%d passes, empty slots:    %3" PRIu32 " transactions\n", IDLE_PASSES, empty);
+    printf("%d passes, one minibadge:  %3" PRIu32 " transactions\n", IDLE_PASSES, monitor);
+    printf("%d full scans:             %3" PRIu32 " transactions\n", IDLE_PASSES, scans);
+    CHECK(monitor < scans);
+
+    // Pull it out and put it back in, it's recognized from the cache by its serial number alone
+    latency = change_slot(900000, &slot1_name, &slot1_serial, false);
+    CHECK(latency >= 0 && latency <= PERIOD_US);
+    CHECK_EQ(events[1].type, MINIBADGE_EVENT_REMOVED);
+    CHECK_EQ(minibadge_get_count(), 0);
+
+    minibadge_get_stats(&stats);
+    uint32_t reads = stats.eeprom_reads;
+    latency        = change_slot(0, &slot1_name, &slot1_serial, true);
+    CHECK(latency >= 0 && latency <= PERIOD_US);
+    CHECK_EQ(events[2].type, MINIBADGE_EVENT_INSERTED);
+    minibadge_get_stats(&stats);
+    CHECK_EQ(stats.eeprom_reads, reads + 1);
+    CHECK_EQ(stats.cache_hits, IDLE_PASSES + 1);
+    CHECK(memcmp(minibadge_devices[0].data, "SERIALZD", 8) == 0);
+
+    // A basic minibadge in the other slot has no serial number to read
+    latency = change_slot(500000, &slot2_name, NULL, true);
+    CHECK(latency >= 0 && latency <= PERIOD_US);
+    CHECK_EQ(events[3].type, MINIBADGE_EVENT_INSERTED);
+    CHECK_EQ(events[3].slot, MINIBADGE_SLOT_2);
+    CHECK_EQ(minibadge_get_count(), 2);
+    CHECK_EQ(minibadge_devices[1].type, MINIBADGE_TYPE_EEPROM_BASIC);
+    CHECK(memcmp(minibadge_devices[1].data, "BASIC!!!", 8) == 0);
+
+    minibadge_get_stats(&stats);
+    CHECK_EQ(stats.changes, 4);
+    CHECK(stats.detect_latency_max_us < PERIOD_US);
+    CHECK_EQ(event_count, 4);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Simulated environment behind the stand-in IDF headers in stubs/. Tasks take turns on one thread and there is a simulated
+// clock: time only moves once every task is waiting, and whatever happens meanwhile is modelled by tickers that see every
+// step.
+
+// Clock steps are at most this long, it's also the granularity of anything a ticker triggers
+#define MOCK_TIME_STEP_US 100
+
+typedef void (*mock_ticker_t)(int64_t now_us, void *arg);
+
+/**
+ * @brief Call a ticker every time the simulated clock moves
+ *
+ * @param ticker Ticker to add
+ * @param arg Passed to the ticker
+ */
+void mock_time_add_ticker(mock_ticker_t ticker, void *arg);
+
+/**
+ * @brief Move the simulated clock forward, running the tickers along the way but not the tasks
+ *
+ * @param us Microseconds to advance
+ */
+void mock_time_advance(int64_t us);
+
+/**
+ * @brief Run the tasks created with xTaskCreate() while the simulated clock moves on by duration_us
+ *     Tasks carry on from where they were blocked on the next call.
+ *
+ * @param duration_us Simulated time to run for
+ */
+void mock_run(int64_t duration_us);
+
+// FreeRTOS counters
+typedef struct {
+    uint32_t mutex_takes;   // Successful mutex acquisitions
+    uint32_t notifications; // xTaskNotifyGive() calls
+    uint32_t tasks_created; // xTaskCreate() calls
+    uint32_t events_posted; // esp_event_post_to() calls
+    uint32_t screen_resets; // screen_reset_timeout() calls
+} mock_freertos_stats_t;
+
+extern mock_freertos_stats_t mock_freertos_stats;
+
+/**
+ * @brief Run the ISR handler registered for a GPIO, as if the pin saw its interrupt edge
+ *
+ * @param gpio_num GPIO number
+ */
+void mock_gpio_interrupt(int gpio_num);
+
+// A device on the simulated I2C bus. Writes set the register pointer from their first byte and store the rest, reads
+// return registers from the pointer on, and both advance it. Hooks can take over registers with side effects.
+typedef struct mock_i2c_device mock_i2c_device_t;
+struct mock_i2c_device {
+    int port;         // I2C port the device is on
+    int channel;      // I2C switch channel, -1 for a device that's not behind the switch
+    uint16_t address; // 7-bit address
+    bool present;     // Whether the device answers
+    uint8_t regs[256];
+    uint8_t pointer;
+
+    // Return true if the hook handled the access, false to fall back to the register file
+    bool (*read)(mock_i2c_device_t *device, uint8_t reg, uint8_t *data, size_t size);
+    bool (*write)(mock_i2c_device_t *device, uint8_t reg, const uint8_t *data, size_t size);
+    void *context;
+    mock_i2c_device_t *next;
+};
+
+// Bus counters
+typedef struct {
+    uint32_t transactions;        // Transactions of any kind, including the switch and probes
+    uint32_t switch_transactions; // Transactions with the I2C switch
+    uint32_t probes;              // Address probes
+    uint32_t nacks;               // Transactions nobody answered
+    uint32_t device_adds;         // i2c_master_bus_add_device() calls
+    int32_t live_handles;         // Device handles added and not removed yet
+    uint64_t busy_us;             // Time the bus spent on transactions
+} mock_i2c_stats_t;
+
+extern mock_i2c_stats_t mock_i2c_stats;
+
+// Address of the TCA9544A switch on the simulated bus
+#define MOCK_I2C_SWITCH_ADDR 0x70
+
+/**
+ * @brief Put a device on the simulated bus
+ *
+ * @param device Device to add, must stay valid while the test runs
+ */
+void mock_i2c_attach(mock_i2c_device_t *device);
+
+/**
+ * @brief Set the interrupt inputs reported in the switch control register
+ *
+ * @param lines INT3..INT0 as bits 3..0
+ */
+void mock_i2c_set_switch_interrupts(uint8_t lines);
+
+#ifdef __cplusplus
+}
+#endif
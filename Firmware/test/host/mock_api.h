@@ -0,0 +1,27 @@
+#pragma once
+
+#include <functional>
+#include <string_view>
+
+#include "api_client.h"
+
+// Stand-in for the API server behind the C++ API component. mock_api_client.cpp replaces ApiClient with one that hands
+// every request to mock_api_server instead of going out over HTTPS, so api.cpp decodes whatever the test answers. Request
+// payloads aren't built, the endpoint and the If-None-Match ETag are what the tests go on.
+
+/**
+ * @brief Answers a request from the stand-in ApiClient
+ *
+ * @param method "GET" or "POST"
+ * @param endpoint Path and query, as the real client puts it after API_BASE_URL
+ * @param if_none_match ETag sent with a conditional request, empty otherwise
+ * @return The response, a default constructed one for a request that never got an answer
+ */
+using mock_api_server_t = std::function<ApiClient::ApiResponse(std::string_view method, std::string_view endpoint,
+                                                               std::string_view if_none_match)>;
+
+// Unset, every request fails as if there were no network
+extern mock_api_server_t mock_api_server;
+
+// Requests the stand-in ApiClient has made
+extern int mock_api_requests;
@@ -0,0 +1,130 @@
+#include <format>
+
+#include "mock_api.h"
+
+mock_api_server_t mock_api_server;
+int mock_api_requests;
+
+ApiClient::ApiResponse ApiClient::doRequest(const std::string_view endpoint, const std::string_view method,
+                                            const std::string_view payload, const std::string_view ifNoneMatch) {
+    mock_api_requests++;
+    if (!mock_api_server) {
+        return ApiResponse();
+    }
+    return mock_api_server(method, endpoint, ifNoneMatch);
+}
+
+// Same endpoints as api_client.cpp
+
+ApiClient::ApiResponse ApiClient::requestAuthCode() {
+    return doRequest("/auth/request_auth_code", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::authLevelUpCode() {
+    return doRequest("/auth/request_levelup_code", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::authStatus(const uint32_t irCode) {
+    return doRequest("/auth/auth_status", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::getBadgeData() {
+    return doRequest("/badge", "GET");
+}
+
+ApiClient::ApiResponse ApiClient::registerBadge(const std::string_view handle) {
+    return doRequest("/badge/register", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::getFirmwareVersion() {
+    return doRequest("/badge/firmware_version", "GET");
+}
+
+api_err_t ApiClient::doFirmwareUpdate() {
+    // There's no firmware image to serve
+    return api_err_t::API_FAIL;
+}
+
+ApiClient::ApiResponse ApiClient::joinTower(const uint32_t towerIrCode) {
+    return doRequest("/badge/join_tower", "POST");
+}
+
+api_err_t ApiClient::leaveTower() {
+    ApiResponse response = doRequest("/badge/leave_tower", "POST");
+    return response.status_code == 200 ? api_err_t::API_OK : api_err_t::API_FAIL;
+}
+
+ApiClient::ApiResponse ApiClient::joinBattle() {
+    return doRequest("/badge/join_battle", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::getTowerStatus(const int towerId) {
+    return doRequest(std::format("/badge/tower_status?tower_id={}", towerId), "GET");
+}
+
+ApiClient::ApiResponse ApiClient::getTowerStatus(const uint32_t towerIrCode) {
+    return doRequest(std::format("/badge/tower_status?ir_code={}", towerIrCode), "GET");
+}
+
+ApiClient::ApiResponse ApiClient::getAllTowerStatus(const std::string_view etag) {
+    return doRequest("/badge/all_tower_status", "GET", "", etag);
+}
+
+ApiClient::ApiResponse ApiClient::checkIrCodes(const std::vector<uint32_t> &irCodes) {
+    return doRequest("/badge/ir_code", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::equipMinibadge(const std::string_view slot1, const std::string_view slot2) {
+    return doRequest("/badge/equip", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::requestLevelUp(const int level) {
+    return doRequest("/badge/levelup", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::reportActivity(const api_activity_interval_t *intervals, const size_t count,
+                                                 const uint32_t totalSteps) {
+    return doRequest("/badge/activity", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::vendItems() {
+    return doRequest("/vend/items", "GET");
+}
+
+ApiClient::ApiResponse ApiClient::vendBuyItem(int itemId) {
+    return doRequest("/vend/buy", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::sendAttack(const int battleId, const int stratagemLength, const int stratagemCount,
+                                             const uint32_t attackDurationMs) {
+    return doRequest("/battle/attack", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::sendFail(const int battleId) {
+    return doRequest("/battle/fail", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::getBattleStatus(const int battleId) {
+    return doRequest(std::format("/battle/status/{}", battleId), "GET");
+}
+
+void ApiClient::abortBattleStatusStream() {
+    stream_aborted = true;
+}
+
+api_err_t ApiClient::streamBattleStatus(const int battleId, const std::function<bool(std::string_view line)> &onLine) {
+    // The stand-in server only answers whole requests, so the caller falls back to polling
+    return api_err_t::API_FAIL;
+}
+
+ApiClient::ApiResponse ApiClient::getSaviorCode() {
+    return doRequest("/battle/savior", "GET");
+}
+
+ApiClient::ApiResponse ApiClient::selfSave(const int battleId) {
+    return doRequest("/battle/self_save", "POST");
+}
+
+ApiClient::ApiResponse ApiClient::afterActionReport(const int battleId) {
+    return doRequest("/battle/aar", "POST");
+}
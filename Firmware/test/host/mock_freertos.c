@@ -0,0 +1,402 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "mock.h"
+
+// FreeRTOS and esp_timer on a simulated clock. Tasks are coroutines: mock_run() switches to the highest priority task that
+// can run, and it runs until it blocks. Once every task is blocked the clock moves on a step.
+
+#define MAX_TICKERS 8
+#define MAX_TASKS   16
+#define TASK_STACK  (256 * 1024) // Host code needs more than the stack sizes the firmware asks for
+
+struct QueueDefinition {
+    bool mutex;
+    UBaseType_t count;
+    UBaseType_t max_count;
+};
+
+struct EventGroupDef_t {
+    EventBits_t bits;
+};
+
+struct tskTaskControlBlock {
+    char name[32];
+    TaskFunction_t function;
+    void *arg;
+    UBaseType_t priority;
+    uint32_t notify_count;
+    bool deleted;
+    ucontext_t context;
+    void *stack;
+
+    // What the task is blocked on, ready is NULL while it can run
+    bool (*ready)(void *arg);
+    void *ready_arg;
+    int64_t deadline_us;
+};
+
+struct esp_timer {
+    esp_timer_create_args_t args;
+    bool active;
+};
+
+mock_freertos_stats_t mock_freertos_stats;
+
+static int64_t now_us;
+
+static struct {
+    mock_ticker_t ticker;
+    void *arg;
+} tickers[MAX_TICKERS];
+static size_t ticker_count;
+
+static struct tskTaskControlBlock tasks[MAX_TASKS];
+static size_t task_count;
+static size_t last_run; // Round robin between tasks of the same priority
+
+// The test itself runs as "main", outside the scheduler
+static struct tskTaskControlBlock main_task = {.name = "main"};
+static struct tskTaskControlBlock *current  = &main_task;
+static ucontext_t scheduler;
+
+void mock_time_add_ticker(mock_ticker_t ticker, void *arg) {
+    if (ticker_count == MAX_TICKERS) {
+        fprintf(stderr, "mock: too many tickers\n");
+        abort();
+    }
+    tickers[ticker_count].ticker = ticker;
+    tickers[ticker_count].arg    = arg;
+    ticker_count++;
+}
+
+void mock_time_advance(int64_t us) {
+    int64_t end_us = now_us + us;
+    while (now_us < end_us) {
+        int64_t step  = end_us - now_us < MOCK_TIME_STEP_US ? end_us - now_us : MOCK_TIME_STEP_US;
+        now_us       += step;
+        for (size_t i = 0; i < ticker_count; i++) {
+            tickers[i].ticker(now_us, tickers[i].arg);
+        }
+    }
+}
+
+/**
+ * @brief Whether a task can run, either because what it waits for happened or because its wait timed out
+ */
+static bool runnable(struct tskTaskControlBlock *task) {
+    return !task->deleted && (task->ready == NULL || task->ready(task->ready_arg) || now_us >= task->deadline_us);
+}
+
+/**
+ * @brief Pick the next task to run, the highest priority runnable one
+ *
+ * @return The task, or NULL if every task is blocked
+ */
+static struct tskTaskControlBlock *pick_task(void) {
+    struct tskTaskControlBlock *best = NULL;
+    if (task_count == 0) {
+        return NULL;
+    }
+    for (size_t i = 1; i <= task_count; i++) {
+        struct tskTaskControlBlock *task = &tasks[(last_run + i) % task_count];
+        if (runnable(task) && (best == NULL || task->priority > best->priority)) {
+            best = task;
+        }
+    }
+    return best;
+}
+
+void mock_run(int64_t duration_us) {
+    int64_t end_us = now_us + duration_us;
+    while (true) {
+        struct tskTaskControlBlock *task = pick_task();
+        if (task != NULL) {
+            last_run = task - tasks;
+            current  = task;
+            swapcontext(&scheduler, &task->context);
+            current = &main_task;
+            if (task->deleted && task->stack != NULL) {
+                free(task->stack);
+                task->stack = NULL;
+            }
+            continue;
+        }
+        if (now_us >= end_us) {
+            return;
+        }
+        mock_time_advance(MOCK_TIME_STEP_US);
+    }
+}
+
+/**
+ * @brief Block until the condition holds or the wait times out
+ *     Tasks hand over to the scheduler, the test itself has nobody to hand over to and moves the clock on directly.
+ *
+ * @param ticks Longest wait, portMAX_DELAY to wait for as long as it takes
+ * @param ready Condition to wait for
+ * @param arg Passed to ready
+ * @return Whether the condition holds
+ */
+static bool block_until(TickType_t ticks, bool (*ready)(void *arg), void *arg) {
+    if (ready(arg)) {
+        return true;
+    }
+    int64_t deadline_us = ticks == portMAX_DELAY ? INT64_MAX : now_us + (int64_t)pdTICKS_TO_MS(ticks) * 1000;
+    if (current == &main_task) {
+        if (ticks == portMAX_DELAY) {
+            fprintf(stderr, "mock: the test would block forever\n");
+            abort();
+        }
+        while (now_us < deadline_us && !ready(arg)) {
+            mock_time_advance(MOCK_TIME_STEP_US);
+        }
+        return ready(arg);
+    }
+
+    struct tskTaskControlBlock *task = current;
+    task->ready                      = ready;
+    task->ready_arg                  = arg;
+    task->deadline_us                = deadline_us;
+    swapcontext(&task->context, &scheduler);
+    task->ready = NULL;
+    return ready(arg);
+}
+
+static void task_entry(void) {
+    current->function(current->arg);
+    // FreeRTOS tasks mustn't return, treat it as deleting itself
+    vTaskDelete(NULL);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority,
+                       TaskHandle_t *created_task) {
+    (void)stack_depth;
+    if (task_count == MAX_TASKS) {
+        return pdFAIL;
+    }
+    struct tskTaskControlBlock *tcb = &tasks[task_count];
+    memset(tcb, 0, sizeof(*tcb));
+    snprintf(tcb->name, sizeof(tcb->name), "%s", name);
+    tcb->function = task;
+    tcb->arg      = arg;
+    tcb->priority = priority;
+    tcb->stack    = malloc(TASK_STACK);
+    if (tcb->stack == NULL) {
+        return pdFAIL;
+    }
+    getcontext(&tcb->context);
+    tcb->context.uc_stack.ss_sp   = tcb->stack;
+    tcb->context.uc_stack.ss_size = TASK_STACK;
+    tcb->context.uc_link          = &scheduler;
+    makecontext(&tcb->context, task_entry, 0);
+    task_count++;
+
+    mock_freertos_stats.tasks_created++;
+    if (created_task != NULL) {
+        *created_task = tcb;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == NULL) {
+        task = current;
+    }
+    if (task == &main_task) {
+        return;
+    }
+    task->deleted = true;
+    if (task == current) {
+        // The scheduler frees the stack once it's off it
+        swapcontext(&task->context, &scheduler);
+    } else {
+        free(task->stack);
+        task->stack = NULL;
+    }
+}
+
+static bool never(void *arg) {
+    (void)arg;
+    return false;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    block_until(ticks, never, NULL);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return current;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(now_us / 1000 / portTICK_PERIOD_MS);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    task->notify_count++;
+    mock_freertos_stats.notifications++;
+    return pdPASS;
+}
+
+static bool notified(void *arg) {
+    return ((struct tskTaskControlBlock *)arg)->notify_count > 0;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+    if (!block_until(ticks_to_wait, notified, current)) {
+        return 0;
+    }
+    uint32_t count        = current->notify_count;
+    current->notify_count = clear_on_exit ? 0 : count - 1;
+    return count;
+}
+
+static SemaphoreHandle_t semaphore_create(bool mutex, UBaseType_t max_count, UBaseType_t initial_count) {
+    SemaphoreHandle_t semaphore = calloc(1, sizeof(*semaphore));
+    if (semaphore != NULL) {
+        semaphore->mutex     = mutex;
+        semaphore->max_count = max_count;
+        semaphore->count     = initial_count;
+    }
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return semaphore_create(true, 1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return semaphore_create(false, 1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    return semaphore_create(false, max_count, initial_count);
+}
+
+static bool semaphore_available(void *arg) {
+    return ((SemaphoreHandle_t)arg)->count > 0;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait) {
+    if (semaphore->mutex && semaphore->count == 0 && ticks_to_wait != 0) {
+        // Tasks only switch when they block and the mutexes are never held across that, so whoever holds it is the caller
+        fprintf(stderr, "mock: %s deadlocked on a mutex it already holds\n", current->name);
+        abort();
+    }
+    if (!block_until(ticks_to_wait, semaphore_available, semaphore)) {
+        return pdFALSE;
+    }
+    semaphore->count--;
+    if (semaphore->mutex) {
+        mock_freertos_stats.mutex_takes++;
+    }
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (semaphore->count == semaphore->max_count) {
+        return pdFALSE;
+    }
+    semaphore->count++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higher_priority_task_woken) {
+    if (higher_priority_task_woken != NULL) {
+        *higher_priority_task_woken = pdFALSE;
+    }
+    return xSemaphoreGive(semaphore);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    free(semaphore);
+}
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    return calloc(1, sizeof(struct EventGroupDef_t));
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t event_group, const EventBits_t bits) {
+    event_group->bits |= bits;
+    return event_group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t event_group, const EventBits_t bits) {
+    EventBits_t previous  = event_group->bits;
+    event_group->bits    &= ~bits;
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t event_group) {
+    return event_group->bits;
+}
+
+typedef struct {
+    EventGroupHandle_t event_group;
+    EventBits_t bits;
+    bool wait_for_all;
+} bits_wait_t;
+
+static bool bits_set(void *arg) {
+    bits_wait_t *wait = arg;
+    EventBits_t set   = wait->event_group->bits & wait->bits;
+    return wait->wait_for_all ? set == wait->bits : set != 0;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t event_group, const EventBits_t bits, const BaseType_t clear_on_exit,
+                                const BaseType_t wait_for_all, TickType_t ticks_to_wait) {
+    bits_wait_t wait = {.event_group = event_group, .bits = bits, .wait_for_all = wait_for_all};
+    bool satisfied   = block_until(ticks_to_wait, bits_set, &wait);
+    EventBits_t ret  = event_group->bits;
+    if (satisfied && clear_on_exit) {
+        event_group->bits &= ~bits;
+    }
+    return ret;
+}
+
+int64_t esp_timer_get_time(void) {
+    return now_us;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    *out_handle = calloc(1, sizeof(**out_handle));
+    if (*out_handle == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    (*out_handle)->args = *create_args;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    (void)period;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    (void)timeout_us;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    free(timer);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer->active;
+}
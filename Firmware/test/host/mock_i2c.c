@@ -0,0 +1,183 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/i2c_master.h"
+#include "mock.h"
+
+// The simulated I2C buses. Transfers complete instantly and don't move the simulated clock, so no other task runs while
+// one holds the bus. The time they would have taken is added up in busy_us instead.
+
+#define SWITCH_ENABLE        0x04
+#define SWITCH_CHANNEL_BITS  0x03
+#define DEFAULT_SCL_SPEED_HZ 100000
+
+struct i2c_master_bus_t {
+    i2c_port_num_t port;
+    int channel; // Channel the switch on this bus has selected, -1 for none
+};
+
+struct i2c_master_dev_t {
+    struct i2c_master_bus_t *bus;
+    uint16_t address;
+    uint32_t scl_speed_hz;
+};
+
+mock_i2c_stats_t mock_i2c_stats;
+
+static struct i2c_master_bus_t buses[SOC_I2C_NUM];
+static mock_i2c_device_t *devices;
+static uint8_t switch_interrupts;
+
+void mock_i2c_attach(mock_i2c_device_t *device) {
+    device->next = devices;
+    devices      = device;
+}
+
+void mock_i2c_set_switch_interrupts(uint8_t lines) {
+    switch_interrupts = lines & 0x0F;
+}
+
+/**
+ * @brief Find the device that answers an address, taking the switch channel into account
+ *
+ * @param bus Bus the transaction is on
+ * @param address 7-bit address
+ * @return The device, or NULL if nothing answers
+ */
+static mock_i2c_device_t *find_device(struct i2c_master_bus_t *bus, uint16_t address) {
+    for (mock_i2c_device_t *device = devices; device != NULL; device = device->next) {
+        if (device->port == bus->port && device->address == address && device->present &&
+            (device->channel < 0 || device->channel == bus->channel)) {
+            return device;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Count a transaction and the time it keeps the bus busy: a start, the address and every byte with their ACK bits,
+ *     and a stop
+ */
+static void count_transaction(uint16_t address, size_t bytes, uint32_t scl_speed_hz) {
+    mock_i2c_stats.transactions++;
+    if (address == MOCK_I2C_SWITCH_ADDR) {
+        mock_i2c_stats.switch_transactions++;
+    }
+    uint64_t bits            = (1 + bytes) * 9 + 2;
+    mock_i2c_stats.busy_us  += bits * 1000000 / (scl_speed_hz ? scl_speed_hz : DEFAULT_SCL_SPEED_HZ);
+}
+
+static void device_write(mock_i2c_device_t *device, const uint8_t *data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    uint8_t reg = data[0];
+    if (device->write == NULL || !device->write(device, reg, data + 1, size - 1)) {
+        for (size_t i = 1; i < size; i++) {
+            device->regs[(uint8_t)(reg + i - 1)] = data[i];
+        }
+    }
+    device->pointer = reg + size - 1;
+}
+
+static void device_read(mock_i2c_device_t *device, uint8_t *data, size_t size) {
+    uint8_t reg = device->pointer;
+    if (device->read == NULL || !device->read(device, reg, data, size)) {
+        for (size_t i = 0; i < size; i++) {
+            data[i] = device->regs[(uint8_t)(reg + i)];
+        }
+    }
+    device->pointer = reg + size;
+}
+
+/**
+ * @brief Run one transaction: an optional write followed by an optional read, with a repeated start between them
+ */
+static esp_err_t transfer(i2c_master_dev_handle_t dev, const uint8_t *tx, size_t tx_size, uint8_t *rx, size_t rx_size) {
+    if (dev == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    count_transaction(dev->address, tx_size + rx_size, dev->scl_speed_hz);
+
+    if (dev->address == MOCK_I2C_SWITCH_ADDR) {
+        if (tx_size > 0) {
+            dev->bus->channel = tx[0] & SWITCH_ENABLE ? tx[0] & SWITCH_CHANNEL_BITS : -1;
+        }
+        for (size_t i = 0; i < rx_size; i++) {
+            uint8_t channel = dev->bus->channel < 0 ? 0 : dev->bus->channel | SWITCH_ENABLE;
+            rx[i]           = channel | switch_interrupts << 4;
+        }
+        return ESP_OK;
+    }
+
+    mock_i2c_device_t *device = find_device(dev->bus, dev->address);
+    if (device == NULL) {
+        mock_i2c_stats.nacks++;
+        return ESP_FAIL;
+    }
+    device_write(device, tx, tx_size);
+    if (rx_size > 0) {
+        device_read(device, rx, rx_size);
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *bus_config, i2c_master_bus_handle_t *ret_bus_handle) {
+    if (bus_config->i2c_port < 0 || bus_config->i2c_port >= SOC_I2C_NUM) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct i2c_master_bus_t *bus = &buses[bus_config->i2c_port];
+    bus->port                    = bus_config->i2c_port;
+    bus->channel                 = -1;
+    *ret_bus_handle              = bus;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle, const i2c_device_config_t *dev_config,
+                                    i2c_master_dev_handle_t *ret_handle) {
+    struct i2c_master_dev_t *dev = calloc(1, sizeof(*dev));
+    if (dev == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    dev->bus          = bus_handle;
+    dev->address      = dev_config->device_address;
+    dev->scl_speed_hz = dev_config->scl_speed_hz;
+    *ret_handle       = dev;
+    mock_i2c_stats.device_adds++;
+    mock_i2c_stats.live_handles++;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t handle) {
+    free(handle);
+    mock_i2c_stats.live_handles--;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer, size_t write_size,
+                              int xfer_timeout_ms) {
+    (void)xfer_timeout_ms;
+    return transfer(i2c_dev, write_buffer, write_size, NULL, 0);
+}
+
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t i2c_dev, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms) {
+    (void)xfer_timeout_ms;
+    return transfer(i2c_dev, NULL, 0, read_buffer, read_size);
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer, size_t write_size,
+                                      uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms) {
+    (void)xfer_timeout_ms;
+    return transfer(i2c_dev, write_buffer, write_size, read_buffer, read_size);
+}
+
+esp_err_t i2c_master_probe(i2c_master_bus_handle_t bus_handle, uint16_t address, int xfer_timeout_ms) {
+    (void)xfer_timeout_ms;
+    mock_i2c_stats.probes++;
+    count_transaction(address, 0, DEFAULT_SCL_SPEED_HZ);
+    if (address == MOCK_I2C_SWITCH_ADDR || find_device(bus_handle, address) != NULL) {
+        return ESP_OK;
+    }
+    mock_i2c_stats.nacks++;
+    return ESP_ERR_NOT_FOUND;
+}
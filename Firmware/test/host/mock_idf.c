@@ -0,0 +1,147 @@
+#include <malloc.h>
+#include "badge.h"
+#include "driver/gpio.h"
+#include "esp_cpu.h"
+#include "esp_err.h"
+#include "esp_event.h"
+#include "esp_heap_caps.h"
+#include "esp_random.h"
+#include "host_test.h"
+#include "mock.h"
+
+// The rest of the IDF surface the components under test touch. Apart from GPIO interrupts none of it has any effect beyond
+// the counters.
+
+#define GPIO_COUNT 49
+#define HEAP_SIZE  (8 * 1024 * 1024) // Nominal heap the free size counts down from
+
+static struct {
+    gpio_isr_t handler;
+    void *args;
+} isr_handlers[GPIO_COUNT];
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_NOT_FINISHED: return "ESP_ERR_NOT_FINISHED";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+    return host_test_cycles();
+}
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    (void)config;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    (void)gpio_num;
+    (void)level;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args) {
+    if (gpio_num < 0 || gpio_num >= GPIO_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    isr_handlers[gpio_num].handler = isr_handler;
+    isr_handlers[gpio_num].args    = args;
+    return ESP_OK;
+}
+
+void mock_gpio_interrupt(int gpio_num) {
+    if (gpio_num >= 0 && gpio_num < GPIO_COUNT && isr_handlers[gpio_num].handler != NULL) {
+        isr_handlers[gpio_num].handler(isr_handlers[gpio_num].args);
+    }
+}
+
+esp_err_t esp_event_loop_create(const esp_event_loop_args_t *event_loop_args, esp_event_loop_handle_t *event_loop) {
+    (void)event_loop_args;
+    static int loop;
+    *event_loop = &loop;
+    return ESP_OK;
+}
+
+esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id,
+                            const void *event_data, size_t event_data_size, TickType_t ticks_to_wait) {
+    (void)event_loop;
+    (void)event_base;
+    (void)event_id;
+    (void)event_data;
+    (void)event_data_size;
+    (void)ticks_to_wait;
+    mock_freertos_stats.events_posted++;
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_register_with(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id,
+                                          esp_event_handler_t event_handler, void *event_handler_arg) {
+    (void)event_loop;
+    (void)event_base;
+    (void)event_id;
+    (void)event_handler;
+    (void)event_handler_arg;
+    return ESP_OK;
+}
+
+esp_err_t esp_event_loop_delete(esp_event_loop_handle_t event_loop) {
+    (void)event_loop;
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler,
+                                              void *event_handler_arg, esp_event_handler_instance_t *instance) {
+    (void)event_base;
+    (void)event_id;
+    (void)event_handler;
+    (void)event_handler_arg;
+    static int instance_handle;
+    *instance = &instance_handle;
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_instance_unregister(esp_event_base_t event_base, int32_t event_id,
+                                                esp_event_handler_instance_t instance) {
+    (void)event_base;
+    (void)event_id;
+    (void)instance;
+    return ESP_OK;
+}
+
+uint32_t esp_random(void) {
+    // xorshift32, the same sequence every run
+    static uint32_t state = 0x2545f491;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    (void)caps;
+    size_t used = mallinfo2().uordblks;
+    return used < HEAP_SIZE ? HEAP_SIZE - used : 0;
+}
+
+void *heap_caps_malloc_prefer(size_t size, size_t num, ...) {
+    (void)num;
+    return malloc(size);
+}
+
+void heap_caps_free(void *ptr) {
+    free(ptr);
+}
+
+void screen_reset_timeout(void) {
+    mock_freertos_stats.screen_resets++;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Host stand-in for components/badge/include/badge.h, just what the components under test call back into
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void screen_reset_timeout(void);
+
+// WiFi state, for the tower tracker
+typedef enum {
+    WIFI_STATUS_DISCONNECTED,
+    WIFI_STATUS_CONNECTING,
+    WIFI_STATUS_CONNECTED,
+} wifi_status_t;
+
+typedef struct {
+    bool ready;
+    wifi_status_t wifi_status;
+} badge_state_t;
+extern badge_state_t badge_state;
+
+// Tower tracker, for the IR code handling
+bool tower_tracker_ready(void);
+int tower_ir_to_id(uint32_t ir_code);
+void tower_seen(int tower_id);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,6 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's driver/rmt_types.h, only the handle types the IR headers mention
+
+typedef struct rmt_channel_t *rmt_channel_handle_t;
+typedef struct rmt_encoder_t *rmt_encoder_handle_t;
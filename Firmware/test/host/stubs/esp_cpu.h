@@ -0,0 +1,10 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_cpu.h
+
+#include <stdint.h>
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+// Backed by the host cycle counter, see host_test_cycles()
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
@@ -0,0 +1,5 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_debug_helpers.h. The UI includes it without calling anything from it.
+
+#include "esp_err.h"
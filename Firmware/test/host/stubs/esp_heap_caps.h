@@ -0,0 +1,25 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_heap_caps.h. There's one heap, its free size is worked out from what malloc() has
+// handed out so differences between two calls mean the same as on the badge.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t heap_caps_get_free_size(uint32_t caps);
+void *heap_caps_malloc_prefer(size_t size, size_t num, ...);
+void heap_caps_free(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_log.h. Errors and warnings go to stderr, the chattier levels are dropped so the
+// benchmark output stays readable.
+
+#include <stdio.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+// Matches what the macros below print
+static inline esp_log_level_t esp_log_level_get(const char *tag) {
+    (void)tag;
+    return ESP_LOG_WARN;
+}
+
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_DROPPED(tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_LOG_DROPPED(tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_LOG_DROPPED(tag, format, ##__VA_ARGS__)
+
+// Still type checks the arguments and counts as using them
+#define ESP_LOG_DROPPED(tag, format, ...)                                                                                 \
+    do {                                                                                                                  \
+        if (0) {                                                                                                          \
+            fprintf(stderr, "%s" format, tag, ##__VA_ARGS__);                                                             \
+        }                                                                                                                 \
+    } while (0)
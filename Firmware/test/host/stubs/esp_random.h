@@ -0,0 +1,7 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_random.h. The numbers are a fixed sequence so simulated runs repeat exactly.
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
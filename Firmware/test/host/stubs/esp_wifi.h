@@ -0,0 +1,16 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_wifi.h. There's no radio: scans return canned results straight away and the scan done
+// event goes the way of every other posted event.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_event.h"
+#include "esp_wifi_types.h"
+
+ESP_EVENT_DECLARE_BASE(WIFI_EVENT);
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block);
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t *number);
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records);
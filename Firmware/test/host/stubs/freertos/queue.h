@@ -0,0 +1,6 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+// Semaphores are queues in FreeRTOS, the mock only implements the semaphore side
+typedef struct QueueDefinition *QueueHandle_t;
@@ -0,0 +1,43 @@
+#pragma once
+
+// The few LVGL 9.2 definitions the host tests need, copied from lv_types.h, lv_color.h and lv_color_op.h so the draw
+// kernels can be checked without pulling in LVGL itself
+
+#include <stdint.h>
+
+typedef enum {
+    LV_RESULT_INVALID = 0,
+    LV_RESULT_OK,
+} lv_result_t;
+
+enum {
+    LV_OPA_TRANSP = 0,
+    LV_OPA_0      = 0,
+    LV_OPA_50     = 127,
+    LV_OPA_100    = 255,
+    LV_OPA_COVER  = 255,
+};
+
+#define LV_OPA_MIN 2   // Opacities below this are transparent
+#define LV_OPA_MAX 253 // Opacities above this are opaque
+
+#define LV_OPA_MIX2(a1, a2) (((int32_t)(a1) * (a2)) >> 8)
+
+static inline uint16_t lv_color_16_16_mix(uint16_t c1, uint16_t c2, uint8_t mix) {
+    if (mix == 255) return c1;
+    if (mix == 0) return c2;
+    if (c1 == c2) return c1;
+
+    uint16_t ret;
+
+    // Source: https://stackoverflow.com/a/50012418/1999969
+    mix = (uint32_t)((uint32_t)mix + 4) >> 3;
+
+    // 0x7E0F81F = 0b00000111111000001111100000011111
+    uint32_t bg     = (uint32_t)(c2 | ((uint32_t)c2 << 16)) & 0x7E0F81F;
+    uint32_t fg     = (uint32_t)(c1 | ((uint32_t)c1 << 16)) & 0x7E0F81F;
+    uint32_t result = ((((fg - bg) * mix) >> 5) + bg) & 0x7E0F81F;
+    ret             = (uint16_t)(result >> 16) | result;
+
+    return ret;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's nvs.h, only the types the badge headers mention
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
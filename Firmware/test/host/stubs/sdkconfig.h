@@ -0,0 +1,27 @@
+#pragma once
+
+// Host stand-in for the generated sdkconfig.h, with the options from sdkconfig.defaults the host tests build against.
+// CONFIG_LCD_DRAW_SW_PIE stays unset since the PIE kernels only exist on the ESP32-S3.
+
+#define CONFIG_LCD_TOUCH_ENABLED            1
+#define CONFIG_LCD_TOUCH_SDA_GPIO           9
+#define CONFIG_LCD_TOUCH_SCL_GPIO           3
+#define CONFIG_I2C_PERIPHERAL_BUS_ENABLED   1
+#define CONFIG_I2C_PERIPHERAL_SDA_GPIO      38
+#define CONFIG_I2C_PERIPHERAL_SCL_GPIO      37
+#define CONFIG_I2C_SWITCH_ENABLED           1
+#define CONFIG_I2C_SWITCH_INT_GPIO          36
+#define CONFIG_LCD_BACKLIGHT_CONTROL_PWM    1
+#define CONFIG_LCD_BACKLIGHT_GPIO           6
+#define CONFIG_ALLOW_EXTERNAL_WIFI_NETWORKS 1
+#define CONFIG_EXTERNAL_WIFI_MAX_NETWORKS   3
+#define CONFIG_API_BASE_URL                 "https://sc24.redactd.net"
+#define CONFIG_API_CLIENT_POOL_SIZE         2
+#define CONFIG_API_CLIENT_IDLE_TIMEOUT_MS   30000
+#define CONFIG_API_BATTLE_STATUS_STREAM     1
+#define CONFIG_LCD_WIDTH                    240
+#define CONFIG_LCD_HEIGHT                   320
+#define CONFIG_LCD_RENDER_MODE_PARTIAL      1
+#define CONFIG_LCD_RENDER_BUFFER_LINES      40
+#define CONFIG_LCD_RENDER_PROFILER_SAMPLES  120
+#define CONFIG_UI_PAGE_CACHE_SIZE_KB        64
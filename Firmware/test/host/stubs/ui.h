@@ -0,0 +1,31 @@
+#pragma once
+
+// Host stand-in for components/ui/include/ui.h, just the handlers the IR code routes to and what the tower tracker
+// touches
+
+#include <stdint.h>
+#include "ir.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PAGE_HOME,
+    PAGE_SETTINGS,
+    PAGE_MAP,
+    PAGE_TOWER_BATTLE,
+    PAGE_SHOP,
+    PAGE_LEVELUP,
+    PAGE_SECRET,
+    PAGE_STATS,
+} content_page_t;
+
+void handle_levelup_code(ir_code_t *ir_code);
+void handle_savior_code(ir_code_t *ir_code, const char *msg);
+void set_status_alert_count(uint8_t count);
+content_page_t get_content_page();
+
+#ifdef __cplusplus
+}
+#endif
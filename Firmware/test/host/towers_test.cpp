@@ -0,0 +1,431 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "api_executor.h"
+#include "badge.h"
+#include "host_test.h"
+#include "mock.h"
+#include "mock_api.h"
+#include "towers.h"
+#include "ui.h"
+
+// Runs the tower tracker against a stand-in API server that answers conditional requests: a 304 when nothing changed since
+// the ETag the badge sent, only the changed towers when it can, the full list otherwise. Checks that each kind of answer
+// lands in the tower list and index, that the change callbacks hear about exactly the towers that changed, and that an
+// answer without an ETag makes the next request unconditional. Then reports bytes and refresh time over a session where
+// towers change now and then, against fetching the full list every time.
+
+#define TOWER_COUNT       40
+#define NETWORK_RTT_US    200000 // Round trip on a kept-alive HTTPS connection
+#define NETWORK_BYTES_SEC 50000  // Body throughput the badge gets over WiFi
+#define SESSION_REFRESHES 60     // One every REFRESH_INTERVAL makes two hours
+
+badge_state_t badge_state = {.ready = true, .wifi_status = WIFI_STATUS_CONNECTED};
+
+extern "C" void set_status_alert_count(uint8_t count) {
+}
+
+extern "C" content_page_t get_content_page() {
+    return PAGE_HOME;
+}
+
+// The API executor, queueing requests until the test runs them
+
+struct queued_request {
+    api_request_fn_t request;
+    void *request_arg;
+    api_complete_cb_t callback;
+    void *user_data;
+};
+static std::deque<queued_request> api_queue;
+static api_request_id_t api_next_id = 1;
+
+extern "C" api_request_id_t api_submit(api_priority_t priority, api_request_fn_t request, void *request_arg,
+                                       api_complete_cb_t callback, void *user_data, const void *owner) {
+    api_queue.push_back({request, request_arg, callback, user_data});
+    return api_next_id++;
+}
+
+// Run everything queued, including what the callbacks queue
+static void run_api() {
+    while (!api_queue.empty()) {
+        queued_request request = api_queue.front();
+        api_queue.pop_front();
+        api_result_t *result = request.request(request.request_arg);
+        if (request.callback != nullptr) {
+            request.callback(result, request.user_data);
+        } else {
+            api_free_result(result, true);
+        }
+    }
+}
+
+// The API server. Every change to the tower list bumps its version, which is what the ETag names.
+
+struct server_tower {
+    json info;
+    int changed_at; // Version the tower last changed in
+};
+
+static struct {
+    std::vector<server_tower> towers;
+    int version     = 1;
+    int removed_at  = 0;    // Version a tower was last removed in, deltas can't carry that
+    bool send_etags = true; // The server can lose its ETags, e.g. on a restart
+    bool deltas     = true;
+
+    // What the badge asked for and got
+    std::string last_if_none_match;
+    int full;
+    int delta;
+    int not_modified;
+    int single;
+    size_t bytes;
+} server;
+
+static json make_tower(int id) {
+    return {
+        {"id", id},
+        {"name", "Tower " + std::to_string(id)},
+        {"location", "Expo Hall, booth " + std::to_string(100 + id)},
+        {"level", 1 + id % 5},
+        {"health", 1000},
+        {"max_health", 1000},
+        {"boot_time", "2026-10-17T09:00:00Z"},
+        {"ir_code", 0x00001000 + id},
+        {"enabled", true},
+        {"status", "VULNERABLE"},
+        {"players_in_range", 0},
+        {"players_in_battle", 0},
+        {"players_joined_tower", 0},
+        {"players_disconnected", 0},
+    };
+}
+
+static server_tower *server_find(int id) {
+    for (auto &tower : server.towers) {
+        if (tower.info["id"] == id) {
+            return &tower;
+        }
+    }
+    return nullptr;
+}
+
+static void server_set(int id, const char *field, const json &value) {
+    server_tower *tower = server_find(id);
+    tower->info[field]  = value;
+    tower->changed_at   = ++server.version;
+}
+
+static void server_add(int id) {
+    server.towers.push_back({make_tower(id), ++server.version});
+}
+
+static void server_remove(int id) {
+    std::erase_if(server.towers, [id](const server_tower &tower) { return tower.info["id"] == id; });
+    server.removed_at = ++server.version;
+}
+
+static std::string server_etag(int version) {
+    return "\"towers-" + std::to_string(version) + "\"";
+}
+
+static ApiClient::ApiResponse server_respond(int status_code, const std::string &body) {
+    ApiClient::ApiResponse response;
+    response.status_code = status_code;
+    response.body        = body;
+    if (server.send_etags) {
+        response.headers.emplace("ETag", server_etag(server.version));
+    }
+    server.bytes += body.size();
+    mock_time_advance(NETWORK_RTT_US + (int64_t)body.size() * 1000000 / NETWORK_BYTES_SEC);
+    return response;
+}
+
+static ApiClient::ApiResponse server_all_tower_status(std::string_view if_none_match) {
+    server.last_if_none_match = if_none_match;
+
+    // The version the badge has, if the ETag is one of ours
+    int since = -1;
+    if (server.send_etags && if_none_match.starts_with("\"towers-")) {
+        since = std::stoi(std::string(if_none_match.substr(8)));
+    }
+
+    if (since == server.version) {
+        server.not_modified++;
+        return server_respond(304, "");
+    }
+
+    json towers = json::array();
+    bool delta  = server.deltas && since != -1 && since >= server.removed_at;
+    for (auto &tower : server.towers) {
+        if (!delta || tower.changed_at > since) {
+            towers.push_back(tower.info);
+        }
+    }
+    (delta ? server.delta : server.full)++;
+    return server_respond(200, json{{"status", true}, {"detail", nullptr}, {"result", towers}, {"delta", delta}}.dump());
+}
+
+static ApiClient::ApiResponse server_tower_status(int id) {
+    server.single++;
+    server_tower *tower = server_find(id);
+    if (tower == nullptr) {
+        return server_respond(404, json{{"status", false}, {"detail", "Tower not found"}}.dump());
+    }
+    return server_respond(200, json{{"status", true}, {"detail", nullptr}, {"result", tower->info}}.dump());
+}
+
+static ApiClient::ApiResponse server_handle(std::string_view method, std::string_view endpoint,
+                                            std::string_view if_none_match) {
+    if (endpoint == "/badge/all_tower_status") {
+        return server_all_tower_status(if_none_match);
+    }
+    if (endpoint.starts_with("/badge/tower_status?tower_id=")) {
+        return server_tower_status(std::stoi(std::string(endpoint.substr(29))));
+    }
+    return ApiClient::ApiResponse();
+}
+
+// What the change callbacks heard about, a NULL entry for a change to the list itself
+
+static std::vector<tower_state_t *> heard_a;
+static std::vector<tower_state_t *> heard_b;
+
+static void callback_a(tower_state_t *tower) {
+    heard_a.push_back(tower);
+}
+
+static void callback_b(tower_state_t *tower) {
+    heard_b.push_back(tower);
+}
+
+static bool heard(const std::vector<tower_state_t *> &calls, int id) {
+    return std::any_of(calls.begin(), calls.end(),
+                       [id](tower_state_t *tower) { return tower != nullptr && tower->info->id == id; });
+}
+
+static int list_changes(const std::vector<tower_state_t *> &calls) {
+    return std::count(calls.begin(), calls.end(), nullptr);
+}
+
+static tower_state_t *state_of(int id) {
+    return get_tower_state(tower_id_to_idx(id));
+}
+
+static void refresh(int tower_id = REFRESH_ALL) {
+    heard_a.clear();
+    heard_b.clear();
+    tower_info_refresh(tower_id);
+    run_api();
+}
+
+static void check_full_refresh(tower_state_t **states) {
+    for (int id = 1; id <= TOWER_COUNT; id++) {
+        server_add(id);
+    }
+
+    refresh();
+    CHECK_EQ(server.full, 1);
+    CHECK(server.last_if_none_match.empty());
+    CHECK_EQ(get_tower_count(), TOWER_COUNT);
+    CHECK_EQ(list_changes(heard_a), 1);
+    CHECK_EQ(heard_a.size(), 1 + TOWER_COUNT);
+    for (int id = 1; id <= TOWER_COUNT; id++) {
+        CHECK_EQ(tower_ir_to_id(0x00001000 + id), id);
+        states[id] = state_of(id);
+        CHECK(states[id] != nullptr && strcmp(states[id]->info->name, ("Tower " + std::to_string(id)).c_str()) == 0);
+    }
+    CHECK_EQ(get_tower_refresh_stats().full, 1);
+
+    // Nothing changed, so the ETag from the last answer gets a 304 and nobody hears a thing
+    refresh();
+    CHECK(server.last_if_none_match == server_etag(server.version));
+    CHECK_EQ(server.not_modified, 1);
+    CHECK_EQ(get_tower_refresh_stats().not_modified, 1);
+    CHECK(heard_a.empty());
+}
+
+static void check_deltas(tower_state_t **states) {
+    // Two towers changed, the rest are left alone and keep their place
+    server_set(5, "health", 640);
+    server_set(9, "players_in_range", 3);
+    refresh();
+    CHECK_EQ(server.delta, 1);
+    CHECK_EQ(get_tower_refresh_stats().deltas, 1);
+    CHECK_EQ(heard_a.size(), 2);
+    CHECK(heard(heard_a, 5) && heard(heard_a, 9));
+    CHECK_EQ(list_changes(heard_a), 0);
+    CHECK(state_of(5) == states[5]);
+    CHECK_EQ(states[5]->info->health, 640);
+    CHECK_EQ(states[9]->info->players_in_range, 3);
+    CHECK_EQ(get_tower_count(), TOWER_COUNT);
+
+    // A tower the server sends again without anything different isn't a change
+    server_set(7, "health", 1000);
+    refresh();
+    CHECK_EQ(server.delta, 2);
+    CHECK(heard_a.empty());
+
+    // A new tower goes on the end of the list, which is a change to the list
+    server_add(TOWER_COUNT + 1);
+    refresh();
+    CHECK_EQ(server.delta, 3);
+    CHECK_EQ(get_tower_count(), TOWER_COUNT + 1);
+    CHECK_EQ(tower_id_to_idx(TOWER_COUNT + 1), TOWER_COUNT);
+    CHECK_EQ(tower_ir_to_id(0x00001000 + TOWER_COUNT + 1), TOWER_COUNT + 1);
+    CHECK_EQ(list_changes(heard_a), 1);
+    CHECK(heard(heard_a, TOWER_COUNT + 1));
+    CHECK(state_of(1) == states[1]);
+
+    // A new IR code moves the tower in the index without changing the list
+    server_set(3, "ir_code", 0x00002003);
+    refresh();
+    CHECK_EQ(tower_ir_to_id(0x00001003), -1);
+    CHECK_EQ(tower_ir_to_id(0x00002003), 3);
+    CHECK_EQ(tower_id_to_idx(3), 2);
+    CHECK_EQ(list_changes(heard_a), 0);
+    CHECK_EQ(heard_a.size(), 1);
+    CHECK(heard(heard_a, 3));
+}
+
+static void check_fan_out() {
+    // Every registered callback hears about every change
+    CHECK_EQ(tower_add_change_callback(callback_b), ESP_OK);
+    server_set(10, "status", "INVULNERABLE");
+    refresh();
+    CHECK(heard(heard_a, 10) && heard(heard_b, 10));
+    CHECK_EQ(state_of(10)->info->status, TOWER_STATUS_INVULNERABLE);
+
+    // And a removed one hears nothing more
+    CHECK_EQ(tower_remove_change_callback(callback_b), ESP_OK);
+    CHECK_EQ(tower_remove_change_callback(callback_b), ESP_FAIL);
+    server_set(11, "health", 10);
+    refresh();
+    CHECK(heard(heard_a, 11));
+    CHECK(heard_b.empty());
+}
+
+static void check_removal(tower_state_t **states) {
+    // A delta can't say a tower is gone, so the server sends the full list and the index is rebuilt around the rest
+    int full = server.full;
+    server_remove(20);
+    refresh();
+    CHECK_EQ(server.full, full + 1);
+    CHECK_EQ(get_tower_count(), TOWER_COUNT);
+    CHECK_EQ(tower_id_to_idx(20), -1);
+    CHECK_EQ(tower_ir_to_id(0x00001000 + 20), -1);
+    CHECK_EQ(list_changes(heard_a), 1);
+    CHECK(state_of(21) == states[21]);
+    CHECK_EQ(tower_id_to_idx(21), 19);
+
+    // The full list only reports the towers whose info changed
+    CHECK_EQ(heard_a.size(), 1);
+}
+
+static void check_etag_reset() {
+    // The server comes back without ETags. Its full answer has none, so the badge forgets the one it had and asks
+    // unconditionally from then on.
+    server.send_etags = false;
+    server_set(12, "level", 5);
+    refresh();
+    CHECK(!server.last_if_none_match.empty());
+    CHECK(heard(heard_a, 12));
+    int full = server.full;
+    refresh();
+    CHECK(server.last_if_none_match.empty());
+    CHECK_EQ(server.full, full + 1);
+    CHECK(heard_a.empty());
+
+    // Once it sends them again the next refresh is conditional again
+    server.send_etags = true;
+    refresh();
+    refresh();
+    CHECK(server.last_if_none_match == server_etag(server.version));
+    CHECK_EQ(server.full, full + 2);
+}
+
+static void check_single_tower() {
+    // Refreshing one tower updates it in place
+    int full = server.full + server.delta;
+    server_set(15, "players_in_battle", 4);
+    refresh(15);
+    CHECK_EQ(server.single, 1);
+    CHECK_EQ(server.full + server.delta, full);
+    CHECK_EQ(heard_a.size(), 1);
+    CHECK(heard(heard_a, 15));
+    CHECK_EQ(state_of(15)->info->players_in_battle, 4);
+
+    // One whose IR code changed needs the index rebuilt, which takes a full refresh
+    server_set(16, "ir_code", 0x00002016);
+    refresh(16);
+    CHECK_EQ(server.single, 2);
+    CHECK_EQ(server.full + server.delta, full + 1);
+    CHECK_EQ(tower_ir_to_id(0x00002016), 16);
+
+    // One the badge doesn't know about yet too
+    server_add(TOWER_COUNT + 2);
+    refresh(TOWER_COUNT + 2);
+    CHECK_EQ(tower_ir_to_id(0x00001000 + TOWER_COUNT + 2), TOWER_COUNT + 2);
+}
+
+// Bytes and refresh time over a stretch of periodic refreshes with a tower changing every few of them
+static void report_session() {
+    tower_refresh_stats_t start = get_tower_refresh_stats();
+    size_t bytes_start          = server.bytes;
+    uint32_t slowest_ms         = 0;
+    uint64_t total_ms           = 0;
+    for (int i = 0; i < SESSION_REFRESHES; i++) {
+        if (i % 5 == 0) {
+            server_set(1 + i % TOWER_COUNT, "health", 900 - i);
+        }
+        refresh();
+        uint32_t ms = get_tower_refresh_stats().last_refresh_ms;
+        total_ms += ms;
+        slowest_ms = std::max(slowest_ms, ms);
+    }
+    tower_refresh_stats_t stats = get_tower_refresh_stats();
+    uint64_t bytes              = stats.bytes_received - start.bytes_received;
+    CHECK_EQ(bytes, server.bytes - bytes_start);
+
+    // The same refreshes, every one of them a full list
+    server.deltas       = false;
+    server.send_etags   = false;
+    size_t full_start   = server.bytes;
+    uint64_t full_total = 0;
+    refresh();
+    refresh();
+    for (int i = 0; i < SESSION_REFRESHES; i++) {
+        refresh();
+        full_total += get_tower_refresh_stats().last_refresh_ms;
+    }
+    size_t full_bytes = (server.bytes - full_start) / (SESSION_REFRESHES + 2) * SESSION_REFRESHES;
+
+    printf("%d refreshes: %" PRIu32 " full, %" PRIu32 " deltas, %" PRIu32 " not modified\n", SESSION_REFRESHES,
+           stats.full - start.full, stats.deltas - start.deltas, stats.not_modified - start.not_modified);
+    printf("conditional:  %7" PRIu64 " bytes, %5" PRIu64 " ms a refresh on average, %5" PRIu32 " ms at most\n", bytes,
+           total_ms / SESSION_REFRESHES, slowest_ms);
+    printf("always full:  %7zu bytes, %5" PRIu64 " ms a refresh on average\n", full_bytes, full_total / SESSION_REFRESHES);
+    CHECK_EQ(stats.full, start.full);
+    CHECK(bytes * 10 < full_bytes);
+}
+
+int main() {
+    mock_api_server = server_handle;
+    tower_add_change_callback(callback_a);
+
+    // Entries for each tower ID, as they were first handed out
+    tower_state_t *states[TOWER_COUNT + 3] = {};
+    check_full_refresh(states);
+    check_deltas(states);
+    check_fan_out();
+    check_removal(states);
+    check_etag_reset();
+    check_single_tower();
+    report_session();
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+// LVGL configuration for the UI simulator, the LVGL options from sdkconfig.defaults that change what gets drawn. The
+// ESP32-S3 draw kernels, the file systems and the image decoders are left out, the pages don't draw anything through them.
+
+// The UI sources get malloc() and free() through the IDF headers on the badge
+#include <stdlib.h>
+
+#define LV_COLOR_DEPTH 16
+
+#define LV_USE_STDLIB_MALLOC  LV_STDLIB_CLIB
+#define LV_USE_STDLIB_STRING  LV_STDLIB_CLIB
+#define LV_USE_STDLIB_SPRINTF LV_STDLIB_CLIB
+#define LV_USE_OS             LV_OS_NONE
+
+#define LV_USE_LOG          1
+#define LV_LOG_LEVEL        LV_LOG_LEVEL_WARN
+#define LV_LOG_PRINTF       1
+#define LV_USE_ASSERT_STYLE 1
+#define LV_OBJ_STYLE_CACHE  1
+
+#define LV_FONT_MONTSERRAT_10 1
+#define LV_FONT_MONTSERRAT_12 1
+#define LV_FONT_MONTSERRAT_14 1
+#define LV_FONT_MONTSERRAT_16 1
+#define LV_FONT_MONTSERRAT_18 1
+#define LV_FONT_MONTSERRAT_20 1
+#define LV_FONT_MONTSERRAT_22 1
+#define LV_FONT_MONTSERRAT_24 1
+#define LV_FONT_MONTSERRAT_26 1
+#define LV_FONT_MONTSERRAT_28 1
+
+#define LV_USE_SNAPSHOT 1
@@ -0,0 +1,369 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "content.h"
+#include "dpad_input.h"
+#include "esp_timer.h"
+#include "host_test.h"
+#include "lvgl.h"
+#include "lvgl_private.h"
+#include "mock.h"
+#include "render_profiler.h"
+#include "screens/main.h"
+#include "theme.h"
+#include "ui_sim.h"
+#include "ui_sim_png.h"
+#include "ui_sim_script.h"
+
+// Headless badge: the main screen drawn by LVGL into a framebuffer standing in for the panel, set up the same way as
+// display.c sets up the real one, and driven by an input script (see ui_sim_script.h). Time is the simulated clock, so
+// a run renders the same frames on any machine. Render times are measured on the host clock.
+//
+//   ui_sim <script> <output directory>
+//
+// Writes the frame dumps and frames.csv, with one line per rendered frame, to the output directory and prints the
+// frames, pixels and render times of each segment. The exit code is 1 if a limit was exceeded.
+
+#define SIM_WIDTH   CONFIG_LCD_HEIGHT // Landscape, like the badge
+#define SIM_HEIGHT  CONFIG_LCD_WIDTH
+#define BUFFER_SIZE (SIM_WIDTH * CONFIG_LCD_RENDER_BUFFER_LINES * sizeof(lv_color16_t))
+
+#define MAX_SCRIPT_SIZE (64 * 1024)
+#define MAX_COMMANDS    512
+#define TAP_HOLD_MS     100 // How long a tap presses the touch screen for
+#define INPUT_SETTLE_MS 50  // Time the UI gets after a tap or key press to react to it
+
+// Frames rendered since the last page command
+typedef struct {
+    char name[UI_SIM_NAME_MAX];
+    uint32_t frames;
+    uint64_t pixels; // Pixels flushed to the panel
+    uint32_t flushes;
+    uint64_t render_total_ns;
+    uint64_t render_max_ns;
+} segment_t;
+
+static const struct {
+    const char *name;
+    content_page_t page;
+} pages[] = {
+    {"home", PAGE_HOME},
+    {"settings", PAGE_SETTINGS},
+    {"map", PAGE_MAP},
+    {"tower_battle", PAGE_TOWER_BATTLE},
+    {"shop", PAGE_SHOP},
+    {"levelup", PAGE_LEVELUP},
+    {"secret", PAGE_SECRET},
+    {"stats", PAGE_STATS},
+};
+#define PAGE_COUNT (sizeof(pages) / sizeof(pages[0]))
+
+static uint16_t framebuffer[SIM_HEIGHT][SIM_WIDTH]; // The panel's memory
+static lv_display_t *display = NULL;
+static lv_indev_t *keypad    = NULL;
+
+static lv_point_t touch_point     = {0};
+static bool touch_pressed         = false;
+static uint32_t keypad_key        = 0;
+static lv_indev_state_t key_state = LV_INDEV_STATE_RELEASED;
+
+static segment_t segment          = {.name = "start"};
+static uint64_t render_start_ns   = 0;
+static uint32_t frame_pixels      = 0;
+static uint32_t frame_invalidated = 0;
+static FILE *frames_csv           = NULL;
+
+static uint32_t tick_cb(void) {
+    return esp_timer_get_time() / 1000;
+}
+
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
+    render_profiler_flush_start();
+    int32_t width       = lv_area_get_width(area);
+    const uint16_t *row = (const uint16_t *)px_map;
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(&framebuffer[y][area->x1], row, width * sizeof(uint16_t));
+        row += width;
+    }
+    frame_pixels += lv_area_get_size(area);
+    segment.flushes++;
+    render_profiler_flush_done();
+    lv_display_flush_ready(disp);
+}
+
+static void render_event_cb(lv_event_t *e) {
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        // Areas merged into others are flagged as joined and don't get rendered on their own
+        frame_invalidated = 0;
+        for (uint32_t i = 0; i < display->inv_p; i++) {
+            if (!display->inv_area_joined[i]) {
+                frame_invalidated += lv_area_get_size(&display->inv_areas[i]);
+            }
+        }
+        frame_pixels = 0;
+        render_profiler_render_start(frame_invalidated);
+        render_start_ns = host_test_ns();
+        return;
+    }
+    uint64_t render_ns = host_test_ns() - render_start_ns;
+    render_profiler_render_ready();
+
+    segment.frames++;
+    segment.pixels          += frame_pixels;
+    segment.render_total_ns += render_ns;
+    if (render_ns > segment.render_max_ns) {
+        segment.render_max_ns = render_ns;
+    }
+    fprintf(frames_csv, "%s,%" PRIu32 ",%" PRId64 ",%" PRIu64 ",%" PRIu32 ",%" PRIu32 "\n", segment.name, segment.frames,
+            esp_timer_get_time() / 1000, render_ns / 1000, frame_invalidated, frame_pixels);
+}
+
+static void pointer_read_cb(lv_indev_t *indev, lv_indev_data_t *data) {
+    data->point = touch_point;
+    data->state = touch_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
+
+static void keypad_read_cb(lv_indev_t *indev, lv_indev_data_t *data) {
+    data->key   = keypad_key;
+    data->state = key_state;
+}
+
+void dpad_input_set_group(lv_group_t *group) {
+    lv_indev_set_group(keypad, group);
+}
+
+/**
+ * @brief Set up LVGL and the display the same way display.c does, with a flush callback that copies into the
+ *     framebuffer
+ */
+static void display_setup(void) {
+    lv_init();
+    lv_tick_set_cb(tick_cb);
+    display = lv_display_create(SIM_WIDTH, SIM_HEIGHT);
+
+    void *buf1 = malloc(BUFFER_SIZE);
+    void *buf2 = malloc(BUFFER_SIZE);
+    lv_display_set_flush_cb(display, flush_cb);
+    lv_display_set_buffers(display, buf1, buf2, BUFFER_SIZE, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_add_event_cb(display, render_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(display, render_event_cb, LV_EVENT_RENDER_READY, NULL);
+
+    lv_indev_t *pointer = lv_indev_create();
+    lv_indev_set_type(pointer, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_display(pointer, display);
+    lv_indev_set_read_cb(pointer, pointer_read_cb);
+
+    // Read on demand like the D-pad, see dpad_input.c
+    keypad = lv_indev_create();
+    lv_indev_set_type(keypad, LV_INDEV_TYPE_KEYPAD);
+    lv_indev_set_display(keypad, display);
+    lv_indev_set_read_cb(keypad, keypad_read_cb);
+    lv_indev_set_mode(keypad, LV_INDEV_MODE_EVENT);
+}
+
+/**
+ * @brief Run LVGL and the simulated tasks for a while, the stand-in for the LVGL task
+ *
+ * @param ms Simulated time to run for
+ */
+static void run_for(uint32_t ms) {
+    int64_t end_us = esp_timer_get_time() + (int64_t)ms * 1000;
+    while (true) {
+        uint64_t start_ns = host_test_ns();
+        uint32_t next_ms  = lv_timer_handler();
+        render_profiler_handler_done((host_test_ns() - start_ns) / 1000);
+
+        int64_t now_us = esp_timer_get_time();
+        if (now_us >= end_us) {
+            return;
+        }
+        int64_t step_us = next_ms == LV_NO_TIMER_READY ? end_us - now_us : (int64_t)next_ms * 1000;
+        if (step_us < 1000) {
+            step_us = 1000;
+        }
+        if (step_us > end_us - now_us) {
+            step_us = end_us - now_us;
+        }
+        mock_run(step_us);
+    }
+}
+
+static void tap(int32_t x, int32_t y) {
+    touch_point.x = x;
+    touch_point.y = y;
+    touch_pressed = true;
+    run_for(TAP_HOLD_MS);
+    touch_pressed = false;
+    run_for(INPUT_SETTLE_MS);
+}
+
+static void press_key(ui_sim_key_t key) {
+    static const uint32_t lv_keys[] = {
+        [UI_SIM_KEY_UP]    = LV_KEY_UP,
+        [UI_SIM_KEY_DOWN]  = LV_KEY_DOWN,
+        [UI_SIM_KEY_LEFT]  = LV_KEY_LEFT,
+        [UI_SIM_KEY_RIGHT] = LV_KEY_RIGHT,
+    };
+    keypad_key = lv_keys[key];
+    key_state  = LV_INDEV_STATE_PRESSED;
+    lv_indev_read(keypad);
+    key_state = LV_INDEV_STATE_RELEASED;
+    lv_indev_read(keypad);
+    run_for(INPUT_SETTLE_MS);
+}
+
+static bool dump(const char *out_dir, const char *name) {
+    // Draw whatever is still invalidated so the dump matches what the UI shows
+    lv_refr_now(display);
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.png", out_dir, name);
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "ui_sim: can't write %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    bool ok = ui_sim_png_write(file, &framebuffer[0][0], SIM_WIDTH, SIM_HEIGHT, sizeof(framebuffer[0]));
+    ok      = fclose(file) == 0 && ok;
+    if (!ok) {
+        fprintf(stderr, "ui_sim: failed writing %s\n", path);
+    }
+    return ok;
+}
+
+static void report_segment(void) {
+    printf("%-16s %6" PRIu32 " frames %10" PRIu64 " px %6" PRIu32 " flushes   render avg %6" PRIu64 " us  max %6" PRIu64
+           " us\n",
+           segment.name, segment.frames, segment.pixels, segment.flushes,
+           segment.frames > 0 ? segment.render_total_ns / segment.frames / 1000 : 0, segment.render_max_ns / 1000);
+}
+
+/**
+ * @brief Check a limit against the segment so far
+ *
+ * @return Whether the segment is within the limit
+ */
+static bool check_limit(const ui_sim_cmd_t *cmd) {
+    uint64_t value   = cmd->limit.what == UI_SIM_LIMIT_FRAMES ? segment.frames : segment.pixels;
+    const char *what = cmd->limit.what == UI_SIM_LIMIT_FRAMES ? "frames" : "pixels";
+    if (value > cmd->limit.max) {
+        printf("line %" PRIu32 ": %s rendered %" PRIu64 " %s, limit %" PRIu64 "\n", cmd->line, segment.name, value, what,
+               cmd->limit.max);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Look up a page by its script name
+ *
+ * @return Index into pages, or PAGE_COUNT if there's no such page
+ */
+static size_t find_page(const char *name) {
+    size_t i = 0;
+    while (i < PAGE_COUNT && strcmp(pages[i].name, name) != 0) {
+        i++;
+    }
+    return i;
+}
+
+static char *read_script(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "ui_sim: can't open %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    char *text  = malloc(MAX_SCRIPT_SIZE + 1);
+    size_t size = fread(text, 1, MAX_SCRIPT_SIZE + 1, file);
+    fclose(file);
+    if (size > MAX_SCRIPT_SIZE) {
+        fprintf(stderr, "ui_sim: %s is over %d bytes\n", path, MAX_SCRIPT_SIZE);
+        free(text);
+        return NULL;
+    }
+    text[size] = '\0';
+    return text;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <script> <output directory>\n", argv[0]);
+        return 2;
+    }
+    const char *out_dir = argv[2];
+
+    char *text = read_script(argv[1]);
+    if (text == NULL) {
+        return 2;
+    }
+    static ui_sim_cmd_t cmds[MAX_COMMANDS];
+    size_t count;
+    uint32_t bad_line = ui_sim_parse_script(text, cmds, MAX_COMMANDS, &count);
+    free(text);
+    if (bad_line != 0) {
+        fprintf(stderr, "%s:%" PRIu32 ": invalid command, or more than %d commands\n", argv[1], bad_line, MAX_COMMANDS);
+        return 2;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (cmds[i].type == UI_SIM_CMD_PAGE && find_page(cmds[i].name) == PAGE_COUNT) {
+            fprintf(stderr, "%s:%" PRIu32 ": unknown page %s\n", argv[1], cmds[i].line, cmds[i].name);
+            return 2;
+        }
+    }
+
+    if (mkdir(out_dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "ui_sim: can't create %s: %s\n", out_dir, strerror(errno));
+        return 2;
+    }
+    char csv_path[512];
+    snprintf(csv_path, sizeof(csv_path), "%s/frames.csv", out_dir);
+    if ((frames_csv = fopen(csv_path, "w")) == NULL) {
+        fprintf(stderr, "ui_sim: can't write %s: %s\n", csv_path, strerror(errno));
+        return 2;
+    }
+    fprintf(frames_csv, "segment,frame,time_ms,render_us,invalidated_px,flushed_px\n");
+
+    // Bring up the main screen the way ui.c does once the splash screen is done
+    display_setup();
+    ui_sim_stubs_init();
+    style_init();
+    lv_screen_load(create_main_screen());
+    render_content();
+    ui_sim_render_status();
+    run_for(INPUT_SETTLE_MS);
+
+    bool passed = true;
+    for (size_t i = 0; i < count; i++) {
+        const ui_sim_cmd_t *cmd = &cmds[i];
+        switch (cmd->type) {
+            case UI_SIM_CMD_PAGE:
+                report_segment();
+                memset(&segment, 0, sizeof(segment));
+                strcpy(segment.name, cmd->name);
+                set_content_page(pages[find_page(cmd->name)].page);
+                break;
+            case UI_SIM_CMD_WAIT: //
+                run_for(cmd->wait_ms);
+                break;
+            case UI_SIM_CMD_TAP: //
+                tap(cmd->tap.x, cmd->tap.y);
+                break;
+            case UI_SIM_CMD_KEY:
+                for (uint32_t n = 0; n < cmd->key.count; n++) {
+                    press_key(cmd->key.key);
+                }
+                break;
+            case UI_SIM_CMD_DUMP: //
+                passed = dump(out_dir, cmd->name) && passed;
+                break;
+            case UI_SIM_CMD_LIMIT: //
+                passed = check_limit(cmd) && passed;
+                break;
+        }
+    }
+    report_segment();
+    fclose(frames_csv);
+    return passed ? 0 : 1;
+}
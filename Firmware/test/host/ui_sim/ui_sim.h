@@ -0,0 +1,14 @@
+#pragma once
+
+// Hooks into the simulated badge in ui_sim_stubs.c
+
+/**
+ * @brief Set up the badge configuration and the towers the UI shows
+ *     Call once the simulated clock is where the run starts, the towers count as seen then.
+ */
+void ui_sim_stubs_init(void);
+
+/**
+ * @brief Render the whole status bar, as the UI task does once the main screen is up
+ */
+void ui_sim_render_status(void);
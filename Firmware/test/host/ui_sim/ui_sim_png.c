@@ -0,0 +1,112 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "ui_sim_png.h"
+
+#define STORED_BLOCK_MAX 65535 // Largest uncompressed deflate block
+#define ADLER_MOD        65521
+
+static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+uint32_t ui_sim_png_crc(uint32_t crc, const uint8_t *data, size_t size) {
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void put_be32(uint8_t *out, uint32_t value) {
+    out[0] = value >> 24;
+    out[1] = value >> 16;
+    out[2] = value >> 8;
+    out[3] = value;
+}
+
+/**
+ * @brief Write a chunk: length, type, data and the CRC of type and data
+ */
+static bool write_chunk(FILE *file, const char *type, const uint8_t *data, uint32_t size) {
+    uint8_t header[8];
+    uint8_t footer[4];
+    put_be32(header, size);
+    memcpy(header + 4, type, 4);
+    put_be32(footer, ui_sim_png_crc(ui_sim_png_crc(0, header + 4, 4), data, size));
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header) && fwrite(data, 1, size, file) == size &&
+           fwrite(footer, 1, sizeof(footer), file) == sizeof(footer);
+}
+
+bool ui_sim_png_write(FILE *file, const uint16_t *pixels, uint32_t width, uint32_t height, uint32_t stride) {
+    // Scanlines with filter type 0, each channel scaled up to 8 bits
+    size_t row_size = 1 + (size_t)width * 3;
+    size_t raw_size = row_size * height;
+    size_t blocks   = raw_size / STORED_BLOCK_MAX + 1;
+    uint8_t *zlib   = malloc(2 + raw_size + blocks * 5 + 4);
+    uint8_t *raw    = malloc(raw_size);
+    if (zlib == NULL || raw == NULL) {
+        free(zlib);
+        free(raw);
+        return false;
+    }
+    for (uint32_t y = 0; y < height; y++) {
+        const uint16_t *row = (const uint16_t *)((const uint8_t *)pixels + (size_t)y * stride);
+        uint8_t *out        = raw + y * row_size;
+        *out++              = 0;
+        for (uint32_t x = 0; x < width; x++) {
+            uint16_t c = row[x];
+            *out++     = ((c >> 11) & 0x1f) * 255 / 31;
+            *out++     = ((c >> 5) & 0x3f) * 255 / 63;
+            *out++     = (c & 0x1f) * 255 / 31;
+        }
+    }
+
+    // zlib stream of stored deflate blocks
+    uint8_t *out = zlib;
+    *out++       = 0x78;
+    *out++       = 0x01;
+    uint32_t a = 1, b = 0;
+    size_t done = 0;
+    do {
+        uint16_t size = raw_size - done > STORED_BLOCK_MAX ? STORED_BLOCK_MAX : raw_size - done;
+        *out++        = done + size == raw_size; // BFINAL, BTYPE 00
+        *out++        = size & 0xff;
+        *out++        = size >> 8;
+        *out++        = ~size & 0xff;
+        *out++        = (uint16_t)~size >> 8;
+        memcpy(out, raw + done, size);
+        for (size_t i = 0; i < size; i++) {
+            a = (a + raw[done + i]) % ADLER_MOD;
+            b = (b + a) % ADLER_MOD;
+        }
+        out  += size;
+        done += size;
+    } while (done < raw_size);
+    put_be32(out, b << 16 | a);
+    out += 4;
+
+    uint8_t ihdr[13];
+    put_be32(ihdr, width);
+    put_be32(ihdr + 4, height);
+    ihdr[8]  = 8; // Bit depth
+    ihdr[9]  = 2; // Truecolor
+    ihdr[10] = 0; // Deflate
+    ihdr[11] = 0; // Adaptive filtering
+    ihdr[12] = 0; // No interlace
+
+    bool ok = fwrite(signature, 1, sizeof(signature), file) == sizeof(signature) &&
+              write_chunk(file, "IHDR", ihdr, sizeof(ihdr)) && write_chunk(file, "IDAT", zlib, out - zlib) &&
+              write_chunk(file, "IEND", NULL, 0);
+    free(zlib);
+    free(raw);
+    return ok;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Write an RGB565 frame as an 8-bit RGB PNG
+ *     The image data is stored without compression, frame dumps are small and this keeps the writer free of zlib.
+ *
+ * @param file File to write to, opened in binary mode
+ * @param pixels RGB565 pixels in host byte order
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param stride Bytes from one row to the next
+ * @return Whether the whole file was written
+ */
+bool ui_sim_png_write(FILE *file, const uint16_t *pixels, uint32_t width, uint32_t height, uint32_t stride);
+
+/**
+ * @brief CRC-32 as used by PNG chunks, continued from a previous value
+ *
+ * @param crc 0 to start, or the result of the previous call
+ * @param data Bytes to add
+ * @param size Number of bytes
+ * @return Updated CRC
+ */
+uint32_t ui_sim_png_crc(uint32_t crc, const uint8_t *data, size_t size);
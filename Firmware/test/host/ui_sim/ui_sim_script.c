@@ -0,0 +1,175 @@
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ui_sim_script.h"
+
+#define MAX_LINE   256
+#define MAX_TOKENS 4
+
+static const char *key_names[] = {"up", "down", "left", "right"};
+
+const char *ui_sim_key_name(ui_sim_key_t key) {
+    return key < sizeof(key_names) / sizeof(key_names[0]) ? key_names[key] : "?";
+}
+
+/**
+ * @brief Parse a whole unsigned decimal number
+ */
+static bool parse_number(const char *text, uint64_t max, uint64_t *value) {
+    if (!isdigit((unsigned char)text[0])) {
+        return false;
+    }
+    char *end;
+    errno                   = 0;
+    unsigned long long read = strtoull(text, &end, 10);
+    if (errno != 0 || *end != '\0' || read > max) {
+        return false;
+    }
+    *value = read;
+    return true;
+}
+
+/**
+ * @brief Check a name is usable as a page name or a file name
+ */
+static bool valid_name(const char *name) {
+    if (name[0] == '\0' || strlen(name) >= UI_SIM_NAME_MAX) {
+        return false;
+    }
+    for (const char *c = name; *c; c++) {
+        if (!isalnum((unsigned char)*c) && *c != '_' && *c != '-') {
+            return false;
+        }
+    }
+    return true;
+}
+
+int ui_sim_parse_line(const char *text, uint32_t line, ui_sim_cmd_t *cmd, const char **error) {
+    char buffer[MAX_LINE];
+    if (strlen(text) >= sizeof(buffer)) {
+        *error = "line too long";
+        return -1;
+    }
+    strcpy(buffer, text);
+    char *comment = strchr(buffer, '#');
+    if (comment != NULL) {
+        *comment = '\0';
+    }
+
+    // Split into words
+    char *tokens[MAX_TOKENS + 1];
+    size_t count = 0;
+    for (char *token = strtok(buffer, " \t\r"); token != NULL; token = strtok(NULL, " \t\r")) {
+        if (count == MAX_TOKENS + 1) {
+            break;
+        }
+        tokens[count++] = token;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->line        = line;
+    const char *verb = tokens[0];
+    uint64_t a, b;
+
+    if (strcmp(verb, "page") == 0 || strcmp(verb, "dump") == 0) {
+        if (count != 2 || !valid_name(tokens[1])) {
+            *error = "expected a name of letters, digits, _ and -";
+            return -1;
+        }
+        cmd->type = verb[0] == 'p' ? UI_SIM_CMD_PAGE : UI_SIM_CMD_DUMP;
+        strcpy(cmd->name, tokens[1]);
+    } else if (strcmp(verb, "wait") == 0) {
+        if (count != 2 || !parse_number(tokens[1], UINT32_MAX, &a)) {
+            *error = "expected wait <ms>";
+            return -1;
+        }
+        cmd->type    = UI_SIM_CMD_WAIT;
+        cmd->wait_ms = a;
+    } else if (strcmp(verb, "tap") == 0) {
+        if (count != 3 || !parse_number(tokens[1], INT32_MAX, &a) || !parse_number(tokens[2], INT32_MAX, &b)) {
+            *error = "expected tap <x> <y>";
+            return -1;
+        }
+        cmd->type  = UI_SIM_CMD_TAP;
+        cmd->tap.x = a;
+        cmd->tap.y = b;
+    } else if (strcmp(verb, "key") == 0) {
+        if (count < 2 || count > 3) {
+            *error = "expected key <up|down|left|right> [count]";
+            return -1;
+        }
+        cmd->type = UI_SIM_CMD_KEY;
+        size_t k  = 0;
+        while (k < sizeof(key_names) / sizeof(key_names[0]) && strcmp(tokens[1], key_names[k]) != 0) {
+            k++;
+        }
+        if (k == sizeof(key_names) / sizeof(key_names[0])) {
+            *error = "unknown key, expected up, down, left or right";
+            return -1;
+        }
+        cmd->key.key   = k;
+        cmd->key.count = 1;
+        if (count == 3) {
+            if (!parse_number(tokens[2], 1000, &a) || a == 0) {
+                *error = "key count must be 1 to 1000";
+                return -1;
+            }
+            cmd->key.count = a;
+        }
+    } else if (strcmp(verb, "limit") == 0) {
+        if (count != 3 || !parse_number(tokens[2], UINT64_MAX, &a)) {
+            *error = "expected limit <frames|pixels> <max>";
+            return -1;
+        }
+        cmd->type      = UI_SIM_CMD_LIMIT;
+        cmd->limit.max = a;
+        if (strcmp(tokens[1], "frames") == 0) {
+            cmd->limit.what = UI_SIM_LIMIT_FRAMES;
+        } else if (strcmp(tokens[1], "pixels") == 0) {
+            cmd->limit.what = UI_SIM_LIMIT_PIXELS;
+        } else {
+            *error = "can only limit frames or pixels";
+            return -1;
+        }
+    } else {
+        *error = "unknown command";
+        return -1;
+    }
+    return 1;
+}
+
+uint32_t ui_sim_parse_script(const char *text, ui_sim_cmd_t *cmds, size_t max_cmds, size_t *count) {
+    *count        = 0;
+    uint32_t line = 1;
+    while (*text != '\0') {
+        size_t length = strcspn(text, "\n");
+        char buffer[MAX_LINE + 1];
+        if (length > MAX_LINE) {
+            return line;
+        }
+        memcpy(buffer, text, length);
+        buffer[length] = '\0';
+
+        const char *error;
+        ui_sim_cmd_t cmd;
+        int result = ui_sim_parse_line(buffer, line, &cmd, &error);
+        if (result < 0 || (result > 0 && *count == max_cmds)) {
+            return line;
+        }
+        if (result > 0) {
+            cmds[(*count)++] = cmd;
+        }
+
+        text += length;
+        if (*text == '\n') {
+            text++;
+        }
+        line++;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Input scripts for the UI simulator. One command per line, # starts a comment:
+//
+//   page <name>                  Show a content page, which also starts a new measurement segment
+//   wait <ms>                    Let the UI run for this much simulated time
+//   tap <x> <y>                  Press and release the touch screen at a point
+//   key <up|down|left|right> [n] Press a D-pad key, n times
+//   dump <name>                  Save the current frame as <name>.png in the output directory
+//   limit <frames|pixels> <max>  Fail if the segment so far rendered more than this
+//
+// Frame and pixel counts only depend on the script, so limits on them hold on any machine. Render times are reported
+// but never checked.
+
+#define UI_SIM_NAME_MAX 32
+
+typedef enum {
+    UI_SIM_CMD_PAGE,
+    UI_SIM_CMD_WAIT,
+    UI_SIM_CMD_TAP,
+    UI_SIM_CMD_KEY,
+    UI_SIM_CMD_DUMP,
+    UI_SIM_CMD_LIMIT,
+} ui_sim_cmd_type_t;
+
+typedef enum {
+    UI_SIM_KEY_UP,
+    UI_SIM_KEY_DOWN,
+    UI_SIM_KEY_LEFT,
+    UI_SIM_KEY_RIGHT,
+} ui_sim_key_t;
+
+typedef enum {
+    UI_SIM_LIMIT_FRAMES,
+    UI_SIM_LIMIT_PIXELS,
+} ui_sim_limit_t;
+
+typedef struct {
+    ui_sim_cmd_type_t type;
+    uint32_t line; // Script line, for error messages
+    char name[UI_SIM_NAME_MAX];
+    union {
+        uint32_t wait_ms;
+        struct {
+            int32_t x;
+            int32_t y;
+        } tap;
+        struct {
+            ui_sim_key_t key;
+            uint32_t count;
+        } key;
+        struct {
+            ui_sim_limit_t what;
+            uint64_t max;
+        } limit;
+    };
+} ui_sim_cmd_t;
+
+/**
+ * @brief Parse one script line
+ *
+ * @param text Line without the newline
+ * @param line Line number to record in the command
+ * @param[out] cmd Parsed command
+ * @param[out] error Set to a static description when the line is invalid
+ * @return 1 for a command, 0 for a blank or comment line, -1 for an invalid line
+ */
+int ui_sim_parse_line(const char *text, uint32_t line, ui_sim_cmd_t *cmd, const char **error);
+
+/**
+ * @brief Parse a whole script
+ *
+ * @param text Script text
+ * @param[out] cmds Commands
+ * @param max_cmds Size of cmds
+ * @param[out] count Commands parsed
+ * @return Line number of the first invalid line, or 0 if the script parsed
+ */
+uint32_t ui_sim_parse_script(const char *text, ui_sim_cmd_t *cmds, size_t max_cmds, size_t *count);
+
+/**
+ * @brief Get the name of a key for reports
+ */
+const char *ui_sim_key_name(ui_sim_key_t key);
@@ -0,0 +1,327 @@
+#include <string.h>
+
+#include "api.h"
+#include "api_executor.h"
+#include "asset_pack.h"
+#include "badge.h"
+#include "display.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "ir_comm.h"
+#include "minibadge.h"
+#include "statusbar.h"
+#include "ui.h"
+#include "ui_sim.h"
+#include "wifi_manager.h"
+
+// The rest of the badge as the UI sees it in the simulator: a registered badge that is offline, with a few towers nearby
+// and some saved networks. Every API request fails, the same as on a badge without WiFi.
+
+#define SIM_TOWER_COUNT 3
+
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+
+badge_state_t badge_state = {
+    .ready       = true,
+    .wifi_status = WIFI_STATUS_DISCONNECTED,
+};
+
+badge_config_t badge_config;
+
+// ui.c stand-ins - the sim renders the status bar straight away instead of going through the UI task
+static ui_state_t ui_state = {.screen = SCREEN_MAIN};
+
+static tower_info_t tower_infos[SIM_TOWER_COUNT] = {
+    {.id = 1, .name = "Alpha", .location = "Hall A", .level = 1, .health = 800, .max_health = 1000, .enabled = true,
+     .status = TOWER_STATUS_VULNERABLE, .players_in_range = 4},
+    {.id = 2, .name = "Bravo", .location = "Hall B", .level = 2, .health = 1500, .max_health = 1500, .enabled = true,
+     .status = TOWER_STATUS_INVULNERABLE, .players_in_range = 1},
+    {.id = 3, .name = "Charlie", .location = "Lobby", .level = 3, .health = 0, .max_health = 2000, .enabled = true,
+     .status = TOWER_STATUS_DEFEATED},
+};
+static tower_state_t towers[SIM_TOWER_COUNT];
+
+static wifi_credentials_t saved_networks[CONFIG_EXTERNAL_WIFI_MAX_NETWORKS] = {
+    {.ssid = "SAINTCON", .password = ""},
+};
+static uint8_t saved_network_count = 1;
+
+static const char *scan_ssids[] = {"SAINTCON", "SAINTCON-Guest", "hotel-wifi"};
+
+void ui_sim_stubs_init(void) {
+    badge_config            = BADGE_DEFAULTS;
+    badge_config.registered = true;
+    badge_config.enabled    = true;
+    badge_config.level      = 3;
+    badge_config.xp         = 1250;
+    badge_config.coins      = 40;
+    strcpy(badge_config.handle, "hostsim");
+
+    for (int i = 0; i < SIM_TOWER_COUNT; i++) {
+        tower_infos[i].ir_code = 0x1000 + i;
+        towers[i].info         = &tower_infos[i];
+        towers[i].last_seen    = esp_timer_get_time();
+    }
+}
+
+// API - offline, nothing ever succeeds or hands out a result
+
+api_result_t *api_get_badge_data() {
+    return NULL;
+}
+
+api_result_t *api_register(const char *handle) {
+    return NULL;
+}
+
+api_result_t *api_join_tower(const uint32_t tower_ir_code) {
+    return NULL;
+}
+
+api_err_t api_leave_tower() {
+    return API_FAIL;
+}
+
+api_result_t *api_join_battle() {
+    return NULL;
+}
+
+api_result_t *api_request_level_up(const int level) {
+    return NULL;
+}
+
+api_result_t *api_vend_get_items() {
+    return NULL;
+}
+
+api_result_t *api_vend_buy_item(int item_id) {
+    return NULL;
+}
+
+api_result_t *api_send_attack(int battle_id, int stratagem_length, int stratagem_count, uint32_t attack_duration) {
+    return NULL;
+}
+
+api_result_t *api_send_attack_fail(int battle_id) {
+    return NULL;
+}
+
+api_result_t *api_get_battle_status(int battle_id) {
+    return NULL;
+}
+
+api_err_t api_stream_battle_status(int battle_id, api_battle_status_stream_cb_t callback, void *user_data) {
+    return API_FAIL;
+}
+
+api_result_t *api_get_savior_code() {
+    return NULL;
+}
+
+api_result_t *api_self_save(int battle_id) {
+    return NULL;
+}
+
+void api_free_result_data(void *data, api_result_type_t type) {
+    // Nothing hands out results
+}
+
+void api_free_result(api_result_t *result, bool free_data) {
+}
+
+api_request_id_t api_submit(api_priority_t priority, api_request_fn_t request, void *request_arg, api_complete_cb_t callback,
+                            void *user_data, const void *owner) {
+    // Requests run straight away on the caller, there's no executor task
+    static api_request_id_t next_id = 1;
+    api_result_t *result            = request(request_arg);
+    if (callback != NULL) {
+        callback(result, user_data);
+    }
+    return next_id++;
+}
+
+api_result_t *api_submit_wait(api_priority_t priority, api_request_fn_t request, void *request_arg, const void *owner,
+                              TickType_t timeout) {
+    return request(request_arg);
+}
+
+int api_cancel_owner(const void *owner) {
+    return 0;
+}
+
+// Badge
+
+esp_err_t set_badge_handle(const char *handle) {
+    strncpy(badge_config.handle, handle, sizeof(badge_config.handle) - 1);
+    return ESP_OK;
+}
+
+esp_err_t set_badge_wrist(badge_wrist_t wrist) {
+    badge_config.wrist = wrist;
+    return ESP_OK;
+}
+
+esp_err_t save_badge_config() {
+    return ESP_OK;
+}
+
+void activity_get_stats(activity_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->steps    = 4321;
+    stats->active_s = 38 * 60;
+}
+
+ir_code_t badge_ir_get_code(uint32_t code) {
+    return (ir_code_t){.code = code};
+}
+
+esp_err_t ir_enable_rx() {
+    return ESP_OK;
+}
+
+esp_err_t ir_disable_rx() {
+    return ESP_OK;
+}
+
+esp_err_t ir_transmit(uint16_t address, uint16_t command) {
+    return ESP_OK;
+}
+
+void minibadge_dpad_poll(bool enable, minibadge_slot_t slot) {
+}
+
+// Towers - all of them seen just now
+
+void tower_info_refresh(int tower_id) {
+}
+
+int tower_id_to_idx(int tower_id) {
+    for (int i = 0; i < SIM_TOWER_COUNT; i++) {
+        if (tower_infos[i].id == tower_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int get_tower_count() {
+    return SIM_TOWER_COUNT;
+}
+
+tower_state_t *get_tower_state(int idx) {
+    return idx >= 0 && idx < SIM_TOWER_COUNT ? &towers[idx] : NULL;
+}
+
+int get_recent_towers(tower_state_t **recent_towers, int64_t time_window) {
+    if (recent_towers != NULL) {
+        for (int i = 0; i < SIM_TOWER_COUNT; i++) {
+            recent_towers[i] = &towers[i];
+        }
+    }
+    return SIM_TOWER_COUNT;
+}
+
+esp_err_t tower_add_change_callback(tower_change_callback_t callback) {
+    return ESP_OK;
+}
+
+esp_err_t tower_remove_change_callback(tower_change_callback_t callback) {
+    return ESP_OK;
+}
+
+// WiFi
+
+esp_err_t get_saved_wifi_networks(wifi_credentials_t *creds, uint8_t *count) {
+    memcpy(creds, saved_networks, saved_network_count * sizeof(wifi_credentials_t));
+    *count = saved_network_count;
+    return ESP_OK;
+}
+
+esp_err_t save_wifi_network(wifi_credentials_t *creds) {
+    for (uint8_t i = 0; i < saved_network_count; i++) {
+        if (strcmp(saved_networks[i].ssid, creds->ssid) == 0) {
+            saved_networks[i] = *creds;
+            return ESP_OK;
+        }
+    }
+    if (saved_network_count == CONFIG_EXTERNAL_WIFI_MAX_NETWORKS) {
+        return ESP_ERR_NO_MEM;
+    }
+    saved_networks[saved_network_count++] = *creds;
+    return ESP_OK;
+}
+
+esp_err_t delete_wifi_network(char *ssid) {
+    for (uint8_t i = 0; i < saved_network_count; i++) {
+        if (strcmp(saved_networks[i].ssid, ssid) == 0) {
+            memmove(&saved_networks[i], &saved_networks[i + 1], (saved_network_count - i - 1) * sizeof(wifi_credentials_t));
+            saved_network_count--;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t *number) {
+    *number = sizeof(scan_ssids) / sizeof(scan_ssids[0]);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records) {
+    uint16_t count = sizeof(scan_ssids) / sizeof(scan_ssids[0]);
+    if (*number < count) {
+        count = *number;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        memset(&ap_records[i], 0, sizeof(wifi_ap_record_t));
+        strcpy((char *)ap_records[i].ssid, scan_ssids[i]);
+        ap_records[i].primary  = 1 + 5 * i;
+        ap_records[i].rssi     = -50 - 10 * i;
+        ap_records[i].authmode = i == 1 ? WIFI_AUTH_OPEN : WIFI_AUTH_WPA2_PSK;
+    }
+    *number = count;
+    return ESP_OK;
+}
+
+// Display and assets
+
+bool lvgl_lock(TickType_t timeout_ticks, const char *file, int line) {
+    // Only the simulator's main loop touches LVGL
+    return true;
+}
+
+bool lvgl_unlock(const char *file, int line) {
+    return true;
+}
+
+void set_backlight(uint8_t level) {
+}
+
+esp_err_t asset_pack_get_image(const char *name, lv_image_dsc_t *dsc) {
+    // Same as a badge flashed without the assets partition
+    return ESP_ERR_NOT_FOUND;
+}
+
+// UI
+
+void set_screen(ui_screen_t screen) {
+    ui_state.screen = screen;
+}
+
+void set_status_label(const char *label) {
+    strncpy(ui_state.label, label, sizeof(ui_state.label) - 1);
+    render_status(&ui_state, STATUS_DIRTY_LABEL);
+}
+
+void set_status_alert_count(uint8_t count) {
+    ui_state.alert_count = count;
+    render_status(&ui_state, STATUS_DIRTY_ALERT);
+}
+
+void ui_sim_render_status(void) {
+    render_status(&ui_state, STATUS_DIRTY_ALL);
+}
@@ -0,0 +1,182 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "ui_sim_png.h"
+#include "ui_sim_script.h"
+
+// Checks the parts of the UI simulator that don't need LVGL: the input script parser and the PNG writer. The PNG is read
+// back chunk by chunk with its CRCs, the stored deflate blocks and the Adler-32 checked, and every pixel compared.
+
+#define WIDTH  320
+#define HEIGHT 240
+
+static void check_script(void) {
+    static const char script[] = "# Battle page with the attack arrows\n"
+                                 "page tower_battle\n"
+                                 "wait 1500   # let the load animation finish\n"
+                                 "\n"
+                                 "tap 200 120\n"
+                                 "key left 3\n"
+                                 "key up\n"
+                                 "dump battle-attack_1\n"
+                                 "limit frames 90\n"
+                                 "limit pixels 4000000\n";
+    ui_sim_cmd_t cmds[16];
+    size_t count;
+    CHECK_EQ(ui_sim_parse_script(script, cmds, 16, &count), 0);
+    CHECK_EQ(count, 8);
+    CHECK_EQ(cmds[0].type, UI_SIM_CMD_PAGE);
+    CHECK(strcmp(cmds[0].name, "tower_battle") == 0);
+    CHECK_EQ(cmds[0].line, 2);
+    CHECK_EQ(cmds[1].type, UI_SIM_CMD_WAIT);
+    CHECK_EQ(cmds[1].wait_ms, 1500);
+    CHECK_EQ(cmds[2].type, UI_SIM_CMD_TAP);
+    CHECK_EQ(cmds[2].tap.x, 200);
+    CHECK_EQ(cmds[2].tap.y, 120);
+    CHECK_EQ(cmds[2].line, 5);
+    CHECK_EQ(cmds[3].key.key, UI_SIM_KEY_LEFT);
+    CHECK_EQ(cmds[3].key.count, 3);
+    CHECK_EQ(cmds[4].key.key, UI_SIM_KEY_UP);
+    CHECK_EQ(cmds[4].key.count, 1);
+    CHECK_EQ(cmds[5].type, UI_SIM_CMD_DUMP);
+    CHECK(strcmp(cmds[5].name, "battle-attack_1") == 0);
+    CHECK_EQ(cmds[6].limit.what, UI_SIM_LIMIT_FRAMES);
+    CHECK_EQ(cmds[6].limit.max, 90);
+    CHECK_EQ(cmds[7].limit.what, UI_SIM_LIMIT_PIXELS);
+    CHECK_EQ(cmds[7].limit.max, 4000000);
+
+    // Every bad line is reported with its line number
+    static const char *bad[] = {
+        "jump 3",      "wait",         "wait -5",      "wait 10ms",    "tap 10",       "tap 1 2 3",    "key north",
+        "key up 0",    "key up 1001",  "page ../etc",  "dump a b",     "limit fps 30", "limit frames",
+        "page this_name_is_far_too_long_to_be_a_page",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        char text[128];
+        snprintf(text, sizeof(text), "wait 1\n%s\n", bad[i]);
+        uint32_t line = ui_sim_parse_script(text, cmds, 16, &count);
+        if (line != 2) {
+            printf("accepted \"%s\"\n", bad[i]);
+        }
+        CHECK_EQ(line, 2);
+    }
+
+    // Too many commands for the buffer
+    CHECK_EQ(ui_sim_parse_script("wait 1\nwait 2\nwait 3\n", cmds, 2, &count), 3);
+}
+
+static uint32_t get_be32(const uint8_t *in) {
+    return (uint32_t)in[0] << 24 | (uint32_t)in[1] << 16 | (uint32_t)in[2] << 8 | in[3];
+}
+
+static void check_png(void) {
+    // Every 5 and 6 bit level on the way across, and a row stride with padding
+    static uint16_t frame[HEIGHT][WIDTH + 8];
+    for (uint32_t y = 0; y < HEIGHT; y++) {
+        for (uint32_t x = 0; x < WIDTH; x++) {
+            frame[y][x] = (x % 32) << 11 | ((x + y) % 64) << 5 | (y % 32);
+        }
+    }
+
+    FILE *file = tmpfile();
+    CHECK(file != NULL);
+    if (file == NULL) {
+        return;
+    }
+    CHECK(ui_sim_png_write(file, &frame[0][0], WIDTH, HEIGHT, sizeof(frame[0])));
+    long size = ftell(file);
+    uint8_t *png = malloc(size);
+    rewind(file);
+    CHECK_EQ(fread(png, 1, size, file), size);
+    fclose(file);
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    CHECK(memcmp(png, signature, 8) == 0);
+
+    // Walk the chunks, collecting the image data
+    const uint8_t *idat = NULL;
+    uint32_t idat_size  = 0;
+    int chunks          = 0;
+    bool ended          = false;
+    for (long at = 8; at + 12 <= size && !ended; chunks++) {
+        uint32_t length = get_be32(png + at);
+        const uint8_t *type = png + at + 4;
+        CHECK(at + 12 + (long)length <= size);
+        CHECK_EQ(get_be32(type + 4 + length), ui_sim_png_crc(0, type, 4 + length));
+        if (memcmp(type, "IHDR", 4) == 0) {
+            CHECK_EQ(chunks, 0);
+            CHECK_EQ(get_be32(type + 4), WIDTH);
+            CHECK_EQ(get_be32(type + 8), HEIGHT);
+            CHECK_EQ(type[12], 8);
+            CHECK_EQ(type[13], 2);
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            idat      = type + 4;
+            idat_size = length;
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            CHECK_EQ(at + 12 + (long)length, size);
+            ended = true;
+        }
+        at += 12 + length;
+    }
+    CHECK_EQ(chunks, 3);
+    CHECK(ended && idat != NULL);
+    if (idat == NULL) {
+        free(png);
+        return;
+    }
+
+    // Undo the stored deflate blocks
+    size_t row_size = 1 + WIDTH * 3;
+    uint8_t *raw    = malloc(row_size * HEIGHT);
+    size_t raw_size = 0;
+    CHECK_EQ(idat[0], 0x78);
+    CHECK_EQ((idat[0] << 8 | idat[1]) % 31, 0);
+    uint32_t at = 2;
+    bool final  = false;
+    while (!final && at + 5 <= idat_size) {
+        final         = idat[at] & 1;
+        uint16_t len  = idat[at + 1] | idat[at + 2] << 8;
+        uint16_t nlen = idat[at + 3] | idat[at + 4] << 8;
+        CHECK_EQ(idat[at] >> 1, 0);
+        CHECK_EQ((uint16_t)~nlen, len);
+        CHECK(raw_size + len <= row_size * HEIGHT);
+        memcpy(raw + raw_size, idat + at + 5, len);
+        raw_size += len;
+        at       += 5 + len;
+    }
+    CHECK(final);
+    CHECK_EQ(raw_size, row_size * HEIGHT);
+    CHECK_EQ(at + 4, idat_size);
+
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw_size; i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    CHECK_EQ(get_be32(idat + at), b << 16 | a);
+
+    // Full scale channels stay full scale, every pixel matches
+    uint32_t mismatches = 0;
+    for (uint32_t y = 0; y < HEIGHT; y++) {
+        const uint8_t *row = raw + y * row_size;
+        mismatches        += row[0] != 0;
+        for (uint32_t x = 0; x < WIDTH; x++) {
+            uint16_t c = frame[y][x];
+            mismatches += row[1 + x * 3] != (c >> 11) * 255 / 31;
+            mismatches += row[2 + x * 3] != ((c >> 5) & 0x3f) * 255 / 63;
+            mismatches += row[3 + x * 3] != (c & 0x1f) * 255 / 31;
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK_EQ(raw[1 + 31 * 3], 255);
+
+    free(raw);
+    free(png);
+}
+
+int main(void) {
+    check_script();
+    check_png();
+    return HOST_TEST_RESULT();
+}
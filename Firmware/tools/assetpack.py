@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""
+Pack files into an asset partition image that the badge memory-maps at runtime (components/ui/asset_pack.c).
+
+Assets are looked up by file name and read straight out of flash through the MMU, so LVGL image descriptors can point at
+the mapped data instead of going through SPIFFS. Every asset starts on a 16 byte boundary.
+
+Image layout (little endian):
+    uint32 magic               'AST1'
+    uint32 count               number of index entries
+    uint32 total_size          size of the whole image, header and index included
+    uint32 index_crc           CRC32 of the index entries
+    entry  index[count]        sorted by name
+    uint8  data[]              asset data
+
+Index entry:
+    char   name[24]            NUL padded file name
+    uint32 offset              from the start of the partition
+    uint32 size                in bytes
+
+Usage:
+    assetpack.py [--size <partition size>] <output.bin> <file> [<file> ...]
+    assetpack.py --check <image.bin> [<file> ...]
+
+--check validates the index of an existing image and, if files are given, that each one is present with the same
+contents. The build runs it on every image it produces.
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+ASSET_MAGIC = 0x31545341  # 'AST1'
+HEADER = struct.Struct("<IIII")
+ENTRY = struct.Struct("<24sII")
+NAME_MAX = ENTRY.size - 8 - 1  # Leave room for the NUL terminator
+ALIGN = 16
+
+
+def align(n):
+    return (n + ALIGN - 1) & ~(ALIGN - 1)
+
+
+def build(paths):
+    """Returns the packed image for the given files"""
+    assets = []
+    for path in paths:
+        name = os.path.basename(path)
+        if len(name.encode()) > NAME_MAX:
+            raise ValueError(f"{path}: name longer than {NAME_MAX} bytes")
+        with open(path, "rb") as f:
+            assets.append((name, f.read()))
+    assets.sort(key=lambda a: a[0])
+
+    names = [name for name, _ in assets]
+    if len(set(names)) != len(names):
+        raise ValueError("duplicate asset names")
+
+    offset = align(HEADER.size + ENTRY.size * len(assets))
+    index = bytearray()
+    data = bytearray()
+    for name, content in assets:
+        index += ENTRY.pack(name.encode(), offset, len(content))
+        data += content + bytes(align(len(content)) - len(content))
+        offset += align(len(content))
+
+    header = HEADER.pack(ASSET_MAGIC, len(assets), offset, zlib.crc32(index))
+    image = header + index
+    return bytes(image + bytes(align(len(image)) - len(image)) + data)
+
+
+def parse(image):
+    """Validate an image and return {name: bytes}, raising ValueError on any inconsistency"""
+    if len(image) < HEADER.size:
+        raise ValueError("image smaller than its header")
+    magic, count, total_size, index_crc = HEADER.unpack_from(image)
+    if magic != ASSET_MAGIC:
+        raise ValueError(f"bad magic 0x{magic:08x}")
+    if total_size != len(image):
+        raise ValueError(f"total size {total_size} doesn't match the image size {len(image)}")
+
+    index_end = HEADER.size + ENTRY.size * count
+    if index_end > total_size:
+        raise ValueError("index runs past the end of the image")
+    if zlib.crc32(image[HEADER.size : index_end]) != index_crc:
+        raise ValueError("index CRC mismatch")
+
+    assets = {}
+    prev_name = None
+    prev_end = align(index_end)
+    for i in range(count):
+        raw_name, offset, size = ENTRY.unpack_from(image, HEADER.size + ENTRY.size * i)
+        if raw_name[-1] != 0:
+            raise ValueError(f"entry {i}: name not NUL terminated")
+        name = raw_name.rstrip(b"\0").decode()
+        if prev_name is not None and name <= prev_name:
+            raise ValueError(f"entry {i}: {name} out of order")
+        if offset % ALIGN:
+            raise ValueError(f"{name}: offset 0x{offset:x} not {ALIGN} byte aligned")
+        if offset < prev_end or offset + size > total_size:
+            raise ValueError(f"{name}: data at 0x{offset:x}+{size} overlaps or runs past the image")
+        assets[name] = image[offset : offset + size]
+        prev_name = name
+        prev_end = offset + size
+    return assets
+
+
+def check(image_path, paths):
+    with open(image_path, "rb") as f:
+        assets = parse(f.read())
+    for path in paths:
+        name = os.path.basename(path)
+        with open(path, "rb") as f:
+            if assets.get(name) != f.read():
+                raise ValueError(f"{name}: missing or different from {path}")
+    if paths and len(assets) != len(paths):
+        raise ValueError(f"image has {len(assets)} assets, expected {len(paths)}")
+    return assets
+
+
+def main(argv):
+    if len(argv) >= 2 and argv[0] == "--check":
+        try:
+            assets = check(argv[1], argv[2:])
+        except ValueError as e:
+            print(f"assetpack: {argv[1]}: {e}", file=sys.stderr)
+            return 1
+        print(f"assetpack: {argv[1]} OK, {len(assets)} assets")
+        return 0
+
+    partition_size = None
+    if len(argv) >= 2 and argv[0] == "--size":
+        partition_size = int(argv[1], 0)
+        argv = argv[2:]
+
+    if len(argv) < 2:
+        print(__doc__)
+        return 1
+
+    out_path, paths = argv[0], argv[1:]
+    image = build(paths)
+    if partition_size is not None and len(image) > partition_size:
+        print(f"assetpack: {len(image)} bytes doesn't fit the {partition_size} byte partition", file=sys.stderr)
+        return 1
+
+    # Never write out something the firmware would reject
+    check_assets = parse(image)
+    assert len(check_assets) == len(paths), "asset index round trip failed"
+
+    with open(out_path, "wb") as f:
+        f.write(image)
+    for name, content in sorted(check_assets.items()):
+        print(f"assetpack: {name:24} {len(content):8} bytes")
+    print(f"assetpack: {out_path} {len(image)} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""
+Pack LVGL RGB565 / RGB565A8 images into run-length encoded image descriptors.
+
+The input is either an LVGL image converter C file (the raw `uint8_t <name>_map[]` array plus its `lv_image_dsc_t`) or a
+PNG (needs Pillow). The output is a C file defining the same `lv_image_dsc_t` symbol, flagged with IMAGE_FLAGS_PACKED so
+the packed image decoder in components/ui/image_cache.c expands it into its PSRAM cache on first draw. Images that don't
+get smaller, or use other color formats, are written out unchanged.
+
+Packed data layout (little endian):
+    uint32 magic              'PKR1'
+    uint32 unpacked_size      size of the raw image data
+    uint32 color_size         size of the packed color plane
+    uint32 alpha_size         size of the packed alpha plane (0 for RGB565)
+    uint8  color[color_size]  RLE of the RGB565 plane in 2 byte blocks
+    uint8  alpha[alpha_size]  RLE of the A8 plane in 1 byte blocks
+
+RLE control byte n: n < 0x80 repeats the following block n + 1 times, n >= 0x80 is followed by (n & 0x7f) + 1 literal
+blocks.
+
+Usage:
+    imgpack.py <input.c|input.png> <output.c>
+    imgpack.py --report <input.c> [<input.c> ...]
+"""
+
+import os
+import re
+import struct
+import sys
+
+PACK_MAGIC = 0x31524B50  # 'PKR1'
+MAX_RUN = 128
+
+
+def rle_encode(data, block):
+    """Run-length encode `data` in blocks of `block` bytes"""
+    blocks = [data[i : i + block] for i in range(0, len(data), block)]
+    out = bytearray()
+    literals = []
+    min_run = 2 if block > 1 else 3
+
+    def flush_literals():
+        while literals:
+            chunk = literals[:MAX_RUN]
+            del literals[:MAX_RUN]
+            out.append(0x80 | (len(chunk) - 1))
+            for b in chunk:
+                out.extend(b)
+
+    i = 0
+    while i < len(blocks):
+        run = 1
+        while i + run < len(blocks) and run < MAX_RUN and blocks[i + run] == blocks[i]:
+            run += 1
+        if run >= min_run:
+            flush_literals()
+            out.append(run - 1)
+            out += blocks[i]
+            i += run
+        else:
+            literals.append(blocks[i])
+            i += 1
+    flush_literals()
+    return bytes(out)
+
+
+def rle_decode(data, block):
+    """Inverse of rle_encode, used to verify the output"""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        n = data[i]
+        i += 1
+        if n & 0x80:
+            count = ((n & 0x7F) + 1) * block
+            out += data[i : i + count]
+            i += count
+        else:
+            out += data[i : i + block] * (n + 1)
+            i += block
+    return bytes(out)
+
+
+def parse_c_image(path):
+    """Pull the name, header fields and raw bytes out of an LVGL image converter C file"""
+    with open(path, "r") as f:
+        src = f.read()
+
+    dsc = re.search(r"const\s+lv_image_dsc_t\s+(\w+)\s*=\s*\{(.*?)\};", src, re.S)
+    if dsc is None:
+        raise ValueError(f"{path}: no lv_image_dsc_t found")
+    name, body = dsc.group(1), dsc.group(2)
+
+    def field(key):
+        m = re.search(r"\." + re.escape(key) + r"\s*=\s*([^,\n]+)", body)
+        return m.group(1).strip() if m else None
+
+    array = re.search(r"uint8_t\s+" + re.escape(field("data")) + r"\s*\[\s*\]\s*=\s*\{(.*?)\};", src, re.S)
+    if array is None:
+        raise ValueError(f"{path}: image data array not found")
+    values = [v.strip() for v in array.group(1).split(",") if v.strip()]
+    data = bytes(int(v, 0) for v in values)
+
+    return {
+        "name": name,
+        "cf": field("header.cf"),
+        "w": int(field("header.w"), 0),
+        "h": int(field("header.h"), 0),
+        "data": data,
+        "source": src,
+    }
+
+
+def load_png(path):
+    """Convert a PNG into RGB565A8 planes the same way the LVGL image converter does"""
+    from PIL import Image
+
+    img = Image.open(path).convert("RGBA")
+    w, h = img.size
+    color = bytearray()
+    alpha = bytearray()
+    for r, g, b, a in img.getdata():
+        c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+        color += struct.pack("<H", c)
+        alpha.append(a)
+    name = re.sub(r"\W", "_", os.path.splitext(os.path.basename(path))[0])
+    return {"name": name, "cf": "LV_COLOR_FORMAT_RGB565A8", "w": w, "h": h, "data": bytes(color + alpha), "source": None}
+
+
+def pack(image):
+    """Returns the packed data, or None if the image can't be packed or doesn't get smaller"""
+    if image["cf"] not in ("LV_COLOR_FORMAT_RGB565", "LV_COLOR_FORMAT_RGB565A8"):
+        return None
+
+    data = image["data"]
+    color_len = image["w"] * image["h"] * 2
+    color = rle_encode(data[:color_len], 2)
+    alpha = rle_encode(data[color_len:], 1) if image["cf"] == "LV_COLOR_FORMAT_RGB565A8" else b""
+    assert rle_decode(color, 2) + rle_decode(alpha, 1) == data, "RLE round trip failed"
+
+    packed = struct.pack("<IIII", PACK_MAGIC, len(data), len(color), len(alpha)) + color + alpha
+    return packed if len(packed) < len(data) else None
+
+
+def write_packed(image, packed, out_path, in_path):
+    name = image["name"]
+    lines = []
+    for i in range(0, len(packed), 24):
+        lines.append("    " + " ".join(f"0x{b:02x}," for b in packed[i : i + 24]))
+
+    with open(out_path, "w") as f:
+        f.write(f"// Generated by tools/imgpack.py from {os.path.basename(in_path)} - do not edit\n")
+        f.write('#include "lvgl.h"\n#include "image_cache.h"\n\n')
+        f.write(f"const LV_ATTRIBUTE_LARGE_CONST uint8_t {name}_map[] = {{\n")
+        f.write("\n".join(lines))
+        f.write("\n};\n\n")
+        f.write(f"const lv_image_dsc_t {name} = {{\n")
+        f.write(f"    .header.cf    = {image['cf']},\n")
+        f.write("    .header.magic = LV_IMAGE_HEADER_MAGIC,\n")
+        f.write("    .header.flags = IMAGE_FLAGS_PACKED,\n")
+        f.write(f"    .header.w     = {image['w']},\n")
+        f.write(f"    .header.h     = {image['h']},\n")
+        f.write(f"    .data_size    = {len(packed)},\n")
+        f.write(f"    .data         = {name}_map,\n")
+        f.write("};\n")
+
+
+def main(argv):
+    if len(argv) >= 2 and argv[0] == "--report":
+        raw_total = packed_total = 0
+        for path in argv[1:]:
+            image = parse_c_image(path)
+            packed = pack(image)
+            size = len(packed) if packed else len(image["data"])
+            raw_total += len(image["data"])
+            packed_total += size
+            print(f"{image['name']:24} {len(image['data']):8} -> {size:8} bytes ({100 * size // len(image['data'])}%)")
+        print(f"{'total':24} {raw_total:8} -> {packed_total:8} bytes ({100 * packed_total // max(raw_total, 1)}%)")
+        return 0
+
+    if len(argv) != 2:
+        print(__doc__)
+        return 1
+
+    in_path, out_path = argv
+    image = load_png(in_path) if in_path.lower().endswith(".png") else parse_c_image(in_path)
+    packed = pack(image)
+    if packed is None:
+        # Not worth packing, pass the original through
+        if image["source"] is None:
+            raise ValueError(f"{in_path}: PNG input didn't pack smaller, convert it with the LVGL image converter")
+        with open(out_path, "w") as f:
+            f.write(image["source"])
+        print(f"imgpack: {image['name']} left unpacked ({len(image['data'])} bytes)")
+        return 0
+
+    write_packed(image, packed, out_path, in_path)
+    print(f"imgpack: {image['name']} {len(image['data'])} -> {len(packed)} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))